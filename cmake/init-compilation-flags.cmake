@@ -139,6 +139,27 @@ if(COMPILE_RUNTIME_LIGHT)
     file(REMOVE "${PROJECT_BINARY_DIR}/check_coroutine_include.cpp")
 endif()
 
+# Profile guided optimization flags, they are applied only to the runtime and the server, the same ones are used by kphp2cpp for the generated code
+set(RUNTIME_PROFILE_FLAGS "")
+if(RUNTIME_PROFILE_GENERATE)
+    list(APPEND RUNTIME_PROFILE_FLAGS -fprofile-generate=${RUNTIME_PROFILE_GENERATE})
+elseif(RUNTIME_PROFILE_USE)
+    list(APPEND RUNTIME_PROFILE_FLAGS -fprofile-use=${RUNTIME_PROFILE_USE})
+elseif(RUNTIME_PROFILE_SAMPLE_USE)
+    if(COMPILER_CLANG)
+        list(APPEND RUNTIME_PROFILE_FLAGS -fprofile-sample-use=${RUNTIME_PROFILE_SAMPLE_USE})
+    else()
+        list(APPEND RUNTIME_PROFILE_FLAGS -fauto-profile=${RUNTIME_PROFILE_SAMPLE_USE})
+    endif()
+endif()
+if(RUNTIME_PROFILE_USE OR RUNTIME_PROFILE_SAMPLE_USE)
+    if(COMPILER_CLANG)
+        list(APPEND RUNTIME_PROFILE_FLAGS -Wno-profile-instr-out-of-date -Wno-profile-instr-unprofiled)
+    else()
+        list(APPEND RUNTIME_PROFILE_FLAGS -Wno-missing-profile -Wno-coverage-mismatch)
+    endif()
+endif()
+
 # Per-third-party extra compile flags. These are consumed by make_third_party_configuration.
 set(THIRD_PARTY_EXTRA_FLAGS_ZSTD       "")
 set(THIRD_PARTY_EXTRA_FLAGS_UBER_H3    "")
@@ -41,3 +41,10 @@ include(CMakeDependentOption)
 
 cmake_dependent_option(RUNTIME_LIGHT_HIDDEN_VISIBILITY "Enable -fvisibility=hidden for runtime-light" OFF COMPILE_RUNTIME_LIGHT OFF)
 cmake_print_variables(RUNTIME_LIGHT_HIDDEN_VISIBILITY)
+
+# The runtime is instrumented or optimized with the same profile as the generated code, see kphp2cpp --profile-generate / --profile-use.
+# For link time optimization across them, build the runtime with -DCMAKE_INTERPROCEDURAL_OPTIMIZATION=ON and pass --lto to kphp2cpp
+set(RUNTIME_PROFILE_GENERATE "" CACHE PATH "Instrument the runtime, the profiles are written into the given directory")
+set(RUNTIME_PROFILE_USE "" CACHE FILEPATH "Optimize the runtime with an instrumentation profile: .profdata file for clang, a directory with .gcda files for gcc")
+set(RUNTIME_PROFILE_SAMPLE_USE "" CACHE FILEPATH "Optimize the runtime with a sampling (AutoFDO) profile")
+cmake_print_variables(RUNTIME_PROFILE_GENERATE RUNTIME_PROFILE_USE RUNTIME_PROFILE_SAMPLE_USE)
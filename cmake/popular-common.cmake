@@ -2,7 +2,7 @@ include_guard(GLOBAL)
 
 set(LIGHT_COMMON_SOURCES
     crc32_generic.cpp md5.cpp algorithms/simd-int-to-string.cpp
-    algorithms/murmur-hash.cpp)
+    algorithms/simd-array.cpp algorithms/simd-string.cpp cpuid.cpp algorithms/murmur-hash.cpp)
 
 if(COMPILE_RUNTIME_LIGHT)
   set(COMMON_SOURCES_FOR_COMP "${LIGHT_COMMON_SOURCES}")
@@ -15,7 +15,9 @@ prepend(LIGHT_COMMON_SOURCES ${COMMON_DIR}/ ${LIGHT_COMMON_SOURCES})
 prepend(
   POPULAR_COMMON_SOURCES
   ${COMMON_DIR}/
+  algorithms/simd-array.cpp
   algorithms/simd-int-to-string.cpp
+  algorithms/simd-string.cpp
   resolver.cpp
   precise-time.cpp
   cpuid.cpp
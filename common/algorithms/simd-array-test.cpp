@@ -0,0 +1,91 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-array.h"
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "common/algorithms/simd-string.h"
+
+namespace {
+
+struct results {
+  std::vector<int64_t> values;
+
+  bool operator==(const results& other) const {
+    return values == other.values;
+  }
+};
+
+results run_all_kernels(const std::vector<int64_t>& ints, const std::vector<double>& doubles) {
+  results res;
+  const int64_t* ints_end = ints.data() + ints.size();
+  const double* doubles_end = doubles.data() + doubles.size();
+  for (size_t i = 0; i < ints.size(); i += 3) {
+    res.values.push_back(vk::simd::find_int64(ints.data(), ints_end, ints[i]) - ints.data());
+    res.values.push_back(vk::simd::find_int64(ints.data() + i, ints_end, ints[i] + 1) - ints.data());
+  }
+  for (size_t i = 0; i < doubles.size(); i += 3) {
+    res.values.push_back(vk::simd::find_double(doubles.data(), doubles_end, doubles[i]) - doubles.data());
+  }
+  res.values.push_back(vk::simd::find_double(doubles.data(), doubles_end, -0.0) - doubles.data());
+  res.values.push_back(vk::simd::find_double(doubles.data(), doubles_end, std::nan("")) - doubles.data());
+  for (size_t len = 0; len <= ints.size(); ++len) {
+    res.values.push_back(vk::simd::sum_int64(ints.data(), ints.data() + len));
+    if (len != 0) {
+      res.values.push_back(vk::simd::min_int64(ints.data(), ints.data() + len));
+      res.values.push_back(vk::simd::max_int64(ints.data(), ints.data() + len));
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(simd_array, known_values) {
+  const std::vector<int64_t> ints = {5, -3, 7, std::numeric_limits<int64_t>::max(), 0, 7, std::numeric_limits<int64_t>::min(), 1, 2, 3};
+  const std::vector<double> doubles = {1.5, std::nan(""), 0.0, -2.5, 1e300, 3.0, 0.1, -1.0, 8.0};
+  const int64_t* ints_end = ints.data() + ints.size();
+  const double* doubles_end = doubles.data() + doubles.size();
+
+  ASSERT_EQ(vk::simd::find_int64(ints.data(), ints_end, 7) - ints.data(), 2);
+  ASSERT_EQ(vk::simd::find_int64(ints.data(), ints_end, 3) - ints.data(), 9);
+  ASSERT_EQ(vk::simd::find_int64(ints.data(), ints_end, 4), ints_end);
+  ASSERT_EQ(vk::simd::find_double(doubles.data(), doubles_end, -0.0) - doubles.data(), 2);
+  ASSERT_EQ(vk::simd::find_double(doubles.data(), doubles_end, 8.0) - doubles.data(), 8);
+  ASSERT_EQ(vk::simd::find_double(doubles.data(), doubles_end, std::nan("")), doubles_end);
+  ASSERT_EQ(vk::simd::sum_int64(ints.data(), ints_end), 5 - 3 + 7 + 0 + 7 + 1 + 2 + 3 - 1);
+  ASSERT_EQ(vk::simd::min_int64(ints.data(), ints_end), std::numeric_limits<int64_t>::min());
+  ASSERT_EQ(vk::simd::max_int64(ints.data(), ints_end), std::numeric_limits<int64_t>::max());
+  ASSERT_EQ(vk::simd::min_int64(ints.data(), ints.data() + 3), -3);
+}
+
+TEST(simd_array, all_levels_match_scalar) {
+  const auto initial_level = vk::simd::get_level();
+  std::mt19937_64 gen{7};
+  for (int iteration = 0; iteration < 1000; ++iteration) {
+    std::vector<int64_t> ints(std::uniform_int_distribution<size_t>{0, 70}(gen));
+    std::vector<double> doubles(ints.size());
+    // a small range of values gives both repeated and absent ones
+    const bool is_small_range = iteration % 2;
+    for (size_t i = 0; i < ints.size(); ++i) {
+      ints[i] = is_small_range ? std::uniform_int_distribution<int64_t>{-20, 20}(gen) : static_cast<int64_t>(gen());
+      doubles[i] = static_cast<double>(ints[i] % 10) / 4;
+    }
+
+    ASSERT_TRUE(vk::simd::set_level(vk::simd::level::scalar));
+    const results expected = run_all_kernels(ints, doubles);
+    for (auto l : {vk::simd::level::sse4_2, vk::simd::level::avx2}) {
+      if (vk::simd::set_level(l)) {
+        ASSERT_TRUE(run_all_kernels(ints, doubles) == expected) << "level " << static_cast<int>(l) << ", iteration " << iteration;
+      }
+    }
+  }
+  vk::simd::set_level(initial_level);
+}
@@ -0,0 +1,223 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-array.h"
+
+#include <algorithm>
+
+#include "common/algorithms/simd-string.h"
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace vk {
+namespace simd {
+
+namespace {
+
+template<class T>
+const T* find_scalar(const T* begin, const T* end, T value) noexcept {
+  for (; begin != end; ++begin) {
+    if (*begin == value) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+int64_t sum_int64_scalar(const int64_t* begin, const int64_t* end, uint64_t sum = 0) noexcept {
+  for (; begin != end; ++begin) {
+    sum += static_cast<uint64_t>(*begin);
+  }
+  return static_cast<int64_t>(sum);
+}
+
+#ifdef __x86_64__
+
+// the vectors are checked in pairs, the matched pair is then scanned by the scalar loop
+
+__attribute__((target("sse4.2"))) const int64_t* find_int64_sse4_2(const int64_t* begin, const int64_t* end, int64_t value) noexcept {
+  const __m128i needle = _mm_set1_epi64x(value);
+  for (; end - begin >= 4; begin += 4) {
+    const __m128i eq = _mm_or_si128(_mm_cmpeq_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), needle),
+                                    _mm_cmpeq_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 2)), needle));
+    if (_mm_movemask_epi8(eq)) {
+      return find_scalar(begin, begin + 4, value);
+    }
+  }
+  return find_scalar(begin, end, value);
+}
+
+__attribute__((target("sse4.2"))) const double* find_double_sse4_2(const double* begin, const double* end, double value) noexcept {
+  const __m128d needle = _mm_set1_pd(value);
+  for (; end - begin >= 4; begin += 4) {
+    const __m128d eq = _mm_or_pd(_mm_cmpeq_pd(_mm_loadu_pd(begin), needle), _mm_cmpeq_pd(_mm_loadu_pd(begin + 2), needle));
+    if (_mm_movemask_pd(eq)) {
+      return find_scalar(begin, begin + 4, value);
+    }
+  }
+  return find_scalar(begin, end, value);
+}
+
+__attribute__((target("sse4.2"))) int64_t sum_int64_sse4_2(const int64_t* begin, const int64_t* end) noexcept {
+  __m128i sum0 = _mm_setzero_si128();
+  __m128i sum1 = _mm_setzero_si128();
+  for (; end - begin >= 4; begin += 4) {
+    sum0 = _mm_add_epi64(sum0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)));
+    sum1 = _mm_add_epi64(sum1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 2)));
+  }
+  const __m128i sum = _mm_add_epi64(sum0, sum1);
+  return sum_int64_scalar(begin, end, static_cast<uint64_t>(_mm_cvtsi128_si64(sum)) + static_cast<uint64_t>(_mm_extract_epi64(sum, 1)));
+}
+
+template<bool is_min>
+__attribute__((target("sse4.2"))) int64_t min_max_int64_sse4_2(const int64_t* begin, const int64_t* end) noexcept {
+  if (end - begin < 2) {
+    return *begin;
+  }
+  __m128i res = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+  for (begin += 2; end - begin >= 2; begin += 2) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i res_is_greater = _mm_cmpgt_epi64(res, block);
+    res = is_min ? _mm_blendv_epi8(res, block, res_is_greater) : _mm_blendv_epi8(block, res, res_is_greater);
+  }
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), res);
+  const int64_t* tail_res = is_min ? std::min_element(begin, end) : std::max_element(begin, end);
+  const int64_t lanes_res = is_min ? std::min(lanes[0], lanes[1]) : std::max(lanes[0], lanes[1]);
+  if (tail_res == end) {
+    return lanes_res;
+  }
+  return is_min ? std::min(lanes_res, *tail_res) : std::max(lanes_res, *tail_res);
+}
+
+__attribute__((target("avx2"))) const int64_t* find_int64_avx2(const int64_t* begin, const int64_t* end, int64_t value) noexcept {
+  const __m256i needle = _mm256_set1_epi64x(value);
+  for (; end - begin >= 8; begin += 8) {
+    const __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)), needle),
+                                       _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 4)), needle));
+    if (_mm256_movemask_epi8(eq)) {
+      return find_scalar(begin, begin + 8, value);
+    }
+  }
+  return find_int64_sse4_2(begin, end, value);
+}
+
+__attribute__((target("avx2"))) const double* find_double_avx2(const double* begin, const double* end, double value) noexcept {
+  const __m256d needle = _mm256_set1_pd(value);
+  for (; end - begin >= 8; begin += 8) {
+    const __m256d eq =
+      _mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(begin), needle, _CMP_EQ_OQ), _mm256_cmp_pd(_mm256_loadu_pd(begin + 4), needle, _CMP_EQ_OQ));
+    if (_mm256_movemask_pd(eq)) {
+      return find_scalar(begin, begin + 8, value);
+    }
+  }
+  return find_double_sse4_2(begin, end, value);
+}
+
+__attribute__((target("avx2"))) int64_t sum_int64_avx2(const int64_t* begin, const int64_t* end) noexcept {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+  for (; end - begin >= 8; begin += 8) {
+    sum0 = _mm256_add_epi64(sum0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)));
+    sum1 = _mm256_add_epi64(sum1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 4)));
+  }
+  const __m256i sum = _mm256_add_epi64(sum0, sum1);
+  const __m128i half_sum = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  return sum_int64_scalar(begin, end, static_cast<uint64_t>(_mm_cvtsi128_si64(half_sum)) + static_cast<uint64_t>(_mm_extract_epi64(half_sum, 1)));
+}
+
+template<bool is_min>
+__attribute__((target("avx2"))) int64_t min_max_int64_avx2(const int64_t* begin, const int64_t* end) noexcept {
+  if (end - begin < 4) {
+    return min_max_int64_sse4_2<is_min>(begin, end);
+  }
+  __m256i res = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+  for (begin += 4; end - begin >= 4; begin += 4) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i res_is_greater = _mm256_cmpgt_epi64(res, block);
+    res = is_min ? _mm256_blendv_epi8(res, block, res_is_greater) : _mm256_blendv_epi8(block, res, res_is_greater);
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), res);
+  const int64_t lanes_res = is_min ? *std::min_element(lanes, lanes + 4) : *std::max_element(lanes, lanes + 4);
+  if (begin == end) {
+    return lanes_res;
+  }
+  const int64_t tail_res = min_max_int64_sse4_2<is_min>(begin, end);
+  return is_min ? std::min(lanes_res, tail_res) : std::max(lanes_res, tail_res);
+}
+
+#endif
+
+} // namespace
+
+const int64_t* find_int64(const int64_t* begin, const int64_t* end, int64_t value) noexcept {
+  switch (get_level()) {
+#ifdef __x86_64__
+    case level::avx2:
+      return find_int64_avx2(begin, end, value);
+    case level::sse4_2:
+      return find_int64_sse4_2(begin, end, value);
+#endif
+    default:
+      return find_scalar(begin, end, value);
+  }
+}
+
+const double* find_double(const double* begin, const double* end, double value) noexcept {
+  switch (get_level()) {
+#ifdef __x86_64__
+    case level::avx2:
+      return find_double_avx2(begin, end, value);
+    case level::sse4_2:
+      return find_double_sse4_2(begin, end, value);
+#endif
+    default:
+      return find_scalar(begin, end, value);
+  }
+}
+
+int64_t sum_int64(const int64_t* begin, const int64_t* end) noexcept {
+  switch (get_level()) {
+#ifdef __x86_64__
+    case level::avx2:
+      return sum_int64_avx2(begin, end);
+    case level::sse4_2:
+      return sum_int64_sse4_2(begin, end);
+#endif
+    default:
+      return sum_int64_scalar(begin, end);
+  }
+}
+
+int64_t min_int64(const int64_t* begin, const int64_t* end) noexcept {
+  switch (get_level()) {
+#ifdef __x86_64__
+    case level::avx2:
+      return min_max_int64_avx2<true>(begin, end);
+    case level::sse4_2:
+      return min_max_int64_sse4_2<true>(begin, end);
+#endif
+    default:
+      return *std::min_element(begin, end);
+  }
+}
+
+int64_t max_int64(const int64_t* begin, const int64_t* end) noexcept {
+  switch (get_level()) {
+#ifdef __x86_64__
+    case level::avx2:
+      return min_max_int64_avx2<false>(begin, end);
+    case level::sse4_2:
+      return min_max_int64_sse4_2<false>(begin, end);
+#endif
+    default:
+      return *std::max_element(begin, end);
+  }
+}
+
+} // namespace simd
+} // namespace vk
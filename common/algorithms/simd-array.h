@@ -0,0 +1,28 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+// Scanning kernels for the contiguous arrays of numbers, used by the array builtins on vectors.
+// An implementation is chosen by vk::simd::get_level() (see simd-string.h): AVX2 (4 numbers per step), SSE4.2 (2 numbers per step) or scalar.
+namespace vk {
+namespace simd {
+
+// returns a pointer to the first element of [begin, end) which is equal to value, or end
+const int64_t* find_int64(const int64_t* begin, const int64_t* end, int64_t value) noexcept;
+
+// the same as find_int64, the numbers are compared as by operator==: 0.0 is equal to -0.0, NaN is not equal to anything
+const double* find_double(const double* begin, const double* end, double value) noexcept;
+
+// returns the sum of [begin, end), an overflow wraps around
+int64_t sum_int64(const int64_t* begin, const int64_t* end) noexcept;
+
+// return the minimum and the maximum of [begin, end), the range must be non-empty
+int64_t min_int64(const int64_t* begin, const int64_t* end) noexcept;
+int64_t max_int64(const int64_t* begin, const int64_t* end) noexcept;
+
+} // namespace simd
+} // namespace vk
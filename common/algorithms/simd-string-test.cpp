@@ -0,0 +1,172 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-string.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct results {
+  std::vector<size_t> positions;
+  std::string converted;
+
+  bool operator==(const results& other) const {
+    return positions == other.positions && converted == other.converted;
+  }
+};
+
+results run_all_kernels(const std::string& s) {
+  const char* begin = s.data();
+  const char* end = s.data() + s.size();
+  results res;
+  for (const char* chars : {"&\"'<>", "\0'\"\\", "<"}) {
+    const size_t chars_count = chars[0] ? std::char_traits<char>::length(chars) : 4;
+    for (const char* p = begin; p != end; ++p) {
+      p = vk::simd::find_first_of(p, end, chars, chars_count);
+      res.positions.push_back(p - begin);
+      if (p == end) {
+        break;
+      }
+    }
+  }
+  res.positions.push_back(vk::simd::find_first_in_ascii_range(begin, end, 'A', 'Z') - begin);
+  res.positions.push_back(vk::simd::find_first_in_ascii_range(begin, end, 'a', 'z') - begin);
+  res.positions.push_back(vk::simd::find_first_non_ascii(begin, end) - begin);
+
+  std::string buffer(2 * s.size(), '\0');
+  vk::simd::ascii_switch_case(begin, s.size(), buffer.data(), 'A', 'Z');
+  res.converted.append(buffer.data(), s.size());
+  vk::simd::ascii_switch_case(begin, s.size(), buffer.data(), 'a', 'z');
+  res.converted.append(buffer.data(), s.size());
+  vk::simd::bin_to_hex(begin, s.size(), buffer.data());
+  res.converted.append(buffer);
+
+  res.positions.push_back(vk::simd::count_utf8_code_points(begin, end));
+  for (size_t n = 0; n <= s.size(); n += 7) {
+    res.positions.push_back(vk::simd::find_utf8_code_point(begin, end, n) - begin);
+  }
+  for (size_t len = 0; len <= s.size(); len += 5) {
+    res.positions.push_back(vk::simd::is_valid_utf8(begin, begin + len));
+  }
+  return res;
+}
+
+std::vector<uint64_t> json_structural_masks_reference(const std::string& s) {
+  std::vector<uint64_t> masks((s.size() + 63) / 64);
+  bool in_string = false;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '\\') {
+      ++i;
+    } else if (s[i] == '"') {
+      in_string = !in_string;
+    } else if (!in_string && std::string_view{"{}[],:"}.find(s[i]) != std::string_view::npos) {
+      masks[i / 64] |= uint64_t{1} << (i % 64);
+    }
+  }
+  return masks;
+}
+
+// a mix of ASCII, valid multibyte sequences and broken ones: overlongs, surrogates, too large, truncated
+std::string random_utf8_like(std::mt19937& gen) {
+  static const std::vector<std::string> pieces = {
+    "a", "Hello, world! ", "\xD0\x9F\xD1\x80\xD0\xB8", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF", "\xEF\xBF\xBF",
+    "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80", "\xF0\x90\x80\x80",
+    "\xC0\xAF", "\xC1\xBF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+    "\x80", "\xBF", "\xC3", "\xE2\x82", "\xF0\x9F\x98", "\xFF", "\xF8\x88\x80\x80\x80"};
+  std::string s;
+  const size_t count = std::uniform_int_distribution<size_t>{0, 60}(gen);
+  for (size_t i = 0; i < count; ++i) {
+    // broken pieces are rare so that long valid strings are checked too
+    const size_t last = std::uniform_int_distribution<int>{0, 30}(gen) == 0 ? pieces.size() - 1 : 12;
+    s += pieces[std::uniform_int_distribution<size_t>{0, last}(gen)];
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(simd_string, known_values) {
+  const std::string s = "Hello, <World> & \"Friends\"\xC0\xFF!";
+  std::string buffer(2 * s.size(), '\0');
+  vk::simd::ascii_switch_case(s.data(), s.size(), buffer.data(), 'A', 'Z');
+  ASSERT_EQ(buffer.substr(0, s.size()), "hello, <world> & \"friends\"\xC0\xFF!");
+  vk::simd::bin_to_hex("\x01\xAB\xFF", 3, buffer.data());
+  ASSERT_EQ(buffer.substr(0, 6), "01abff");
+  ASSERT_EQ(vk::simd::find_first_of(s.data(), s.data() + s.size(), "<&", 2) - s.data(), 7);
+  ASSERT_EQ(vk::simd::find_first_non_ascii(s.data(), s.data() + s.size()) - s.data(), 26);
+
+  const std::string utf8 = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xE2\x82\xAC \xF0\x9F\x98\x80!";
+  ASSERT_EQ(vk::simd::count_utf8_code_points(utf8.data(), utf8.data() + utf8.size()), 12);
+  ASSERT_EQ(vk::simd::find_utf8_code_point(utf8.data(), utf8.data() + utf8.size(), 7) - utf8.data(), 13);
+  ASSERT_EQ(vk::simd::find_utf8_code_point(utf8.data(), utf8.data() + utf8.size(), 12) - utf8.data(), utf8.size());
+  ASSERT_TRUE(vk::simd::is_valid_utf8(utf8.data(), utf8.data() + utf8.size()));
+  ASSERT_FALSE(vk::simd::is_valid_utf8(utf8.data(), utf8.data() + utf8.size() - 2));
+  for (const char* invalid : {"\xC0\xAF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\x80", "\xFF"}) {
+    ASSERT_FALSE(vk::simd::is_valid_utf8(invalid, invalid + std::char_traits<char>::length(invalid))) << invalid;
+  }
+}
+
+TEST(simd_string, json_structural_masks) {
+  const auto initial_level = vk::simd::get_level();
+  std::mt19937 gen{13};
+  const std::string alphabet = "\"\\{}[],: ab";
+  for (int iteration = 0; iteration < 3000; ++iteration) {
+    std::string s(std::uniform_int_distribution<size_t>{0, 300}(gen), ' ');
+    for (char& c : s) {
+      c = alphabet[std::uniform_int_distribution<size_t>{0, alphabet.size() - 1}(gen)];
+    }
+    const auto expected = json_structural_masks_reference(s);
+    for (auto l : {vk::simd::level::scalar, vk::simd::level::sse4_2, vk::simd::level::avx2}) {
+      if (vk::simd::set_level(l)) {
+        std::vector<uint64_t> masks(expected.size());
+        vk::simd::json_structural_masks(s.data(), s.data() + s.size(), masks.data());
+        ASSERT_EQ(masks, expected) << "level " << static_cast<int>(l) << ", iteration " << iteration;
+      }
+    }
+  }
+  vk::simd::set_level(initial_level);
+}
+
+TEST(simd_string, all_levels_match_scalar) {
+  const auto initial_level = vk::simd::get_level();
+  std::mt19937 gen{7};
+  // mostly plain text with rare special chars, so that both long skipped runs and dense matches happen
+  const std::string alphabet = "abcxyzABCXYZ@[`{ 0189\n\r\t&<>\"'\\\x1a";
+  for (int iteration = 0; iteration < 3000; ++iteration) {
+    if (iteration % 2) {
+      const std::string s = random_utf8_like(gen);
+      ASSERT_TRUE(vk::simd::set_level(vk::simd::level::scalar));
+      const results expected = run_all_kernels(s);
+      for (auto l : {vk::simd::level::sse4_2, vk::simd::level::avx2}) {
+        if (vk::simd::set_level(l)) {
+          ASSERT_TRUE(run_all_kernels(s) == expected) << "level " << static_cast<int>(l) << ", iteration " << iteration;
+        }
+      }
+      continue;
+    }
+    std::string s(std::uniform_int_distribution<size_t>{0, 200}(gen), ' ');
+    for (char& c : s) {
+      const int kind = std::uniform_int_distribution<int>{0, 9}(gen);
+      if (kind == 0) {
+        c = static_cast<char>(std::uniform_int_distribution<int>{0, 255}(gen));
+      } else {
+        c = alphabet[std::uniform_int_distribution<size_t>{0, kind < 8 ? 5 : alphabet.size() - 1}(gen)];
+      }
+    }
+
+    ASSERT_TRUE(vk::simd::set_level(vk::simd::level::scalar));
+    const results expected = run_all_kernels(s);
+    for (auto l : {vk::simd::level::sse4_2, vk::simd::level::avx2}) {
+      if (vk::simd::set_level(l)) {
+        ASSERT_TRUE(run_all_kernels(s) == expected) << "level " << static_cast<int>(l) << ", iteration " << iteration;
+      }
+    }
+  }
+  vk::simd::set_level(initial_level);
+}
@@ -0,0 +1,686 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-string.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/cpuid.h"
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace vk {
+namespace simd {
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+const char* find_first_of_scalar(const char* begin, const char* end, const char* chars, size_t chars_count) noexcept {
+  for (; begin != end; ++begin) {
+    for (size_t i = 0; i < chars_count; ++i) {
+      if (*begin == chars[i]) {
+        return begin;
+      }
+    }
+  }
+  return end;
+}
+
+const char* find_first_in_ascii_range_scalar(const char* begin, const char* end, char lo, char hi) noexcept {
+  for (; begin != end; ++begin) {
+    if (*begin >= lo && *begin <= hi) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+const char* find_first_non_ascii_scalar(const char* begin, const char* end) noexcept {
+  for (; begin != end; ++begin) {
+    if (static_cast<unsigned char>(*begin) >= 0x80) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+void ascii_switch_case_scalar(const char* src, size_t len, char* dst, char lo, char hi) noexcept {
+  for (size_t i = 0; i < len; ++i) {
+    dst[i] = static_cast<char>(src[i] ^ ((src[i] >= lo && src[i] <= hi) ? 0x20 : 0));
+  }
+}
+
+void bin_to_hex_scalar(const char* src, size_t len, char* dst) noexcept {
+  for (size_t i = 0; i < len; ++i) {
+    dst[2 * i] = HEX_DIGITS[(static_cast<unsigned char>(src[i]) >> 4) & 15];
+    dst[2 * i + 1] = HEX_DIGITS[src[i] & 15];
+  }
+}
+
+bool is_utf8_continuation(char c) noexcept {
+  return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+size_t count_utf8_code_points_scalar(const char* begin, const char* end) noexcept {
+  size_t count = 0;
+  for (; begin != end; ++begin) {
+    count += !is_utf8_continuation(*begin);
+  }
+  return count;
+}
+
+const char* find_utf8_code_point_scalar(const char* begin, const char* end, size_t n) noexcept {
+  for (; begin != end; ++begin) {
+    if (!is_utf8_continuation(*begin) && n-- == 0) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+bool is_valid_utf8_scalar(const char* begin, const char* end) noexcept {
+  const auto* s = reinterpret_cast<const unsigned char*>(begin);
+  const auto* e = reinterpret_cast<const unsigned char*>(end);
+  while (s != e) {
+    const unsigned int a = *s;
+    if (a < 0x80) {
+      ++s;
+      continue;
+    }
+    ptrdiff_t continuations = 0;
+    if ((a & 0xe0) == 0xc0) {
+      continuations = 1;
+    } else if ((a & 0xf0) == 0xe0) {
+      continuations = 2;
+    } else if ((a & 0xf8) == 0xf0) {
+      continuations = 3;
+    } else {
+      return false;
+    }
+    if (e - s <= continuations) {
+      return false;
+    }
+    for (ptrdiff_t i = 1; i <= continuations; ++i) {
+      if ((s[i] & 0xc0) != 0x80) {
+        return false;
+      }
+    }
+    if (continuations == 1 && (a & 0x1e) == 0) { // overlong
+      return false;
+    }
+    if (continuations == 2) {
+      const unsigned int x = ((a & 0x0f) << 6) | (s[1] & 0x20);
+      if (x == 0 || x == 0x360) { // overlong or surrogate
+        return false;
+      }
+    }
+    if (continuations == 3) {
+      const unsigned int t = ((a & 0x07) << 6) | (s[1] & 0x30);
+      if (t == 0 || t >= 0x110) { // overlong or above U+10FFFF
+        return false;
+      }
+    }
+    s += continuations + 1;
+  }
+  return true;
+}
+
+// bit i of the masks is set if byte i of the 64-byte block is a quote, a backslash or one of {}[],: respectively
+struct json_block_masks {
+  uint64_t quotes;
+  uint64_t backslashes;
+  uint64_t structurals;
+};
+
+json_block_masks json_classify_block_scalar(const char* block) noexcept {
+  json_block_masks masks{0, 0, 0};
+  for (int i = 0; i < 64; ++i) {
+    const uint64_t bit = uint64_t{1} << i;
+    switch (block[i]) {
+      case '"':
+        masks.quotes |= bit;
+        break;
+      case '\\':
+        masks.backslashes |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ',':
+      case ':':
+        masks.structurals |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+  return masks;
+}
+
+// strings are tracked the simdjson way (https://arxiv.org/abs/1902.08318): a byte is escaped if it follows an odd sequence of backslashes,
+// unescaped quotes toggle the "inside a string" state which is a prefix xor of them
+template<json_block_masks (*classify_block)(const char*) noexcept>
+void json_structural_masks_impl(const char* begin, const char* end, uint64_t* masks) noexcept {
+  constexpr uint64_t ODD_BITS = 0xaaaaaaaaaaaaaaaaULL;
+  uint64_t prev_escaped = 0;
+  uint64_t prev_in_string = 0;
+  for (; begin < end; begin += 64) {
+    json_block_masks block;
+    if (end - begin >= 64) {
+      block = classify_block(begin);
+    } else {
+      char tail[64];
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, begin, end - begin);
+      block = classify_block(tail);
+    }
+
+    const uint64_t potential_escape = block.backslashes & ~prev_escaped;
+    const uint64_t maybe_escaped = potential_escape << 1;
+    const uint64_t escape_and_terminal_code = ((maybe_escaped | ODD_BITS) - potential_escape) ^ ODD_BITS;
+    const uint64_t escaped = escape_and_terminal_code ^ (block.backslashes | prev_escaped);
+    prev_escaped = (escape_and_terminal_code & block.backslashes) >> 63;
+
+    uint64_t in_string = block.quotes & ~escaped;
+    for (int shift = 1; shift < 64; shift *= 2) {
+      in_string ^= in_string << shift;
+    }
+    in_string ^= prev_in_string;
+    prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+    *masks++ = block.structurals & ~escaped & ~in_string;
+  }
+}
+
+#ifdef __x86_64__
+
+// all bytes are compared as signed ones: bytes >= 0x80 are negative and never get into an ASCII range
+
+__attribute__((target("sse4.2"))) const char* find_first_of_sse4_2(const char* begin, const char* end, const char* chars, size_t chars_count) noexcept {
+  __m128i needles[8];
+  for (size_t i = 0; i < chars_count; ++i) {
+    needles[i] = _mm_set1_epi8(chars[i]);
+  }
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i eq = _mm_setzero_si128();
+    for (size_t i = 0; i < chars_count; ++i) {
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[i]));
+    }
+    if (const int mask = _mm_movemask_epi8(eq)) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_of_scalar(begin, end, chars, chars_count);
+}
+
+__attribute__((target("sse4.2"))) const char* find_first_in_ascii_range_sse4_2(const char* begin, const char* end, char lo, char hi) noexcept {
+  const __m128i lo_minus_1 = _mm_set1_epi8(static_cast<char>(lo - 1));
+  const __m128i hi_plus_1 = _mm_set1_epi8(static_cast<char>(hi + 1));
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, lo_minus_1), _mm_cmplt_epi8(block, hi_plus_1));
+    if (const int mask = _mm_movemask_epi8(in_range)) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_in_ascii_range_scalar(begin, end, lo, hi);
+}
+
+__attribute__((target("sse4.2"))) const char* find_first_non_ascii_sse4_2(const char* begin, const char* end) noexcept {
+  for (; end - begin >= 16; begin += 16) {
+    if (const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_non_ascii_scalar(begin, end);
+}
+
+__attribute__((target("sse4.2"))) void ascii_switch_case_sse4_2(const char* src, size_t len, char* dst, char lo, char hi) noexcept {
+  const __m128i lo_minus_1 = _mm_set1_epi8(static_cast<char>(lo - 1));
+  const __m128i hi_plus_1 = _mm_set1_epi8(static_cast<char>(hi + 1));
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, lo_minus_1), _mm_cmplt_epi8(block, hi_plus_1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(block, _mm_and_si128(in_range, case_bit)));
+  }
+  ascii_switch_case_scalar(src + i, len - i, dst + i, lo, hi);
+}
+
+__attribute__((target("sse4.2"))) void bin_to_hex_sse4_2(const char* src, size_t len, char* dst) noexcept {
+  const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(block, 4), low_nibble));
+    const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(block, low_nibble));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  bin_to_hex_scalar(src + i, len - i, dst + 2 * i);
+}
+
+__attribute__((target("sse4.2,popcnt"))) size_t count_utf8_code_points_sse4_2(const char* begin, const char* end) noexcept {
+  // continuation bytes are [0x80, 0xbf], i.e. [-128, -65] if signed
+  const __m128i last_continuation = _mm_set1_epi8(-65);
+  size_t count = 0;
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(block, last_continuation)));
+  }
+  return count + count_utf8_code_points_scalar(begin, end);
+}
+
+__attribute__((target("sse4.2,popcnt"))) const char* find_utf8_code_point_sse4_2(const char* begin, const char* end, size_t n) noexcept {
+  const __m128i last_continuation = _mm_set1_epi8(-65);
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, last_continuation)));
+    const auto count = static_cast<size_t>(__builtin_popcount(mask));
+    if (n < count) {
+      for (; n != 0; --n) {
+        mask &= mask - 1;
+      }
+      return begin + __builtin_ctz(mask);
+    }
+    n -= count;
+  }
+  return find_utf8_code_point_scalar(begin, end, n);
+}
+
+// UTF-8 validation by John Keiser and Daniel Lemire (https://arxiv.org/abs/2010.03090):
+// every error is a pattern of the high nibble of a byte, its low nibble and the high nibble of the next one,
+// three table lookups give a bit per kind of error; the 3rd and 4th bytes of sequences are checked separately
+constexpr uint8_t UTF8_TOO_SHORT = 1 << 0;   // 11______ 0_______ or 11______ 11______
+constexpr uint8_t UTF8_TOO_LONG = 1 << 1;    // 0_______ 10______
+constexpr uint8_t UTF8_OVERLONG_3 = 1 << 2;  // 11100000 100_____
+constexpr uint8_t UTF8_TOO_LARGE = 1 << 3;   // 11110100 1001____, 11110100 101_____, 11110101+ 1001____, ...
+constexpr uint8_t UTF8_SURROGATE = 1 << 4;   // 11101101 101_____
+constexpr uint8_t UTF8_OVERLONG_2 = 1 << 5;  // 1100000_ 10______
+constexpr uint8_t UTF8_TOO_LARGE_1000 = 1 << 6; // 11110101+ 1000____
+constexpr uint8_t UTF8_OVERLONG_4 = 1 << 6;  // 11110000 1000____
+constexpr uint8_t UTF8_TWO_CONTS = 1 << 7;   // 10______ 10______
+constexpr uint8_t UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS;
+
+alignas(16) constexpr uint8_t UTF8_BYTE_1_HIGH[16] = {
+  UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+  UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+  UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+  UTF8_TOO_SHORT,
+  UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+  UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4};
+
+alignas(16) constexpr uint8_t UTF8_BYTE_1_LOW[16] = {
+  UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+  UTF8_CARRY | UTF8_OVERLONG_2,
+  UTF8_CARRY,
+  UTF8_CARRY,
+  UTF8_CARRY | UTF8_TOO_LARGE,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+  UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000};
+
+alignas(16) constexpr uint8_t UTF8_BYTE_2_HIGH[16] = {
+  UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+  UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+  UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+  UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+  UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+  UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT};
+
+// a block ending with these bytes has an unfinished sequence: 11______ at the end, 111_____ before it or 1111____ 2 bytes before
+alignas(16) constexpr uint8_t UTF8_INCOMPLETE_MAX[16] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1};
+
+__attribute__((target("sse4.2"))) __m128i utf8_block_errors_sse4_2(__m128i input, __m128i prev_input) noexcept {
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+  const __m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(UTF8_BYTE_1_HIGH)),
+                                               _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+  const __m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(UTF8_BYTE_1_LOW)), _mm_and_si128(prev1, low_nibble));
+  const __m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(UTF8_BYTE_2_HIGH)),
+                                               _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+  const __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  // only 111_____ 2 bytes before and 1111____ 3 bytes before get the high bit: they must be followed by continuations
+  const __m128i is_third_byte = _mm_subs_epu8(_mm_alignr_epi8(input, prev_input, 14), _mm_set1_epi8(0xe0 - 0x80));
+  const __m128i is_fourth_byte = _mm_subs_epu8(_mm_alignr_epi8(input, prev_input, 13), _mm_set1_epi8(0xf0 - 0x80));
+  const __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+__attribute__((target("sse4.2"))) bool is_valid_utf8_sse4_2(const char* begin, const char* end) noexcept {
+  const __m128i incomplete_max = _mm_load_si128(reinterpret_cast<const __m128i*>(UTF8_INCOMPLETE_MAX));
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  const auto check_block = [&](__m128i input) __attribute__((target("sse4.2"))) {
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+      prev_incomplete = _mm_setzero_si128();
+    } else {
+      error = _mm_or_si128(error, utf8_block_errors_sse4_2(input, prev_input));
+      prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+    prev_input = input;
+  };
+
+  for (; end - begin >= 16; begin += 16) {
+    check_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)));
+  }
+  if (begin != end) {
+    // zero padding is ASCII, a sequence cut by the end becomes too short
+    alignas(16) char tail[16] = {0};
+    std::memcpy(tail, begin, end - begin);
+    check_block(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)));
+  }
+  error = _mm_or_si128(error, prev_incomplete);
+  return _mm_testz_si128(error, error);
+}
+
+__attribute__((target("sse4.2"))) json_block_masks json_classify_block_sse4_2(const char* block) noexcept {
+  json_block_masks masks{0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+    const auto is = [chunk](char c) __attribute__((target("sse4.2"))) { return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)); };
+    const __m128i structurals = _mm_or_si128(_mm_or_si128(_mm_or_si128(is('{'), is('}')), _mm_or_si128(is('['), is(']'))), _mm_or_si128(is(','), is(':')));
+    masks.quotes |= static_cast<uint64_t>(_mm_movemask_epi8(is('"'))) << (16 * i);
+    masks.backslashes |= static_cast<uint64_t>(_mm_movemask_epi8(is('\\'))) << (16 * i);
+    masks.structurals |= static_cast<uint64_t>(_mm_movemask_epi8(structurals)) << (16 * i);
+  }
+  return masks;
+}
+
+__attribute__((target("avx2"))) const char* find_first_of_avx2(const char* begin, const char* end, const char* chars, size_t chars_count) noexcept {
+  __m256i needles[8];
+  for (size_t i = 0; i < chars_count; ++i) {
+    needles[i] = _mm256_set1_epi8(chars[i]);
+  }
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i eq = _mm256_setzero_si256();
+    for (size_t i = 0; i < chars_count; ++i) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[i]));
+    }
+    if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_of_sse4_2(begin, end, chars, chars_count);
+}
+
+__attribute__((target("avx2"))) const char* find_first_in_ascii_range_avx2(const char* begin, const char* end, char lo, char hi) noexcept {
+  const __m256i lo_minus_1 = _mm256_set1_epi8(static_cast<char>(lo - 1));
+  const __m256i hi_plus_1 = _mm256_set1_epi8(static_cast<char>(hi + 1));
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(block, lo_minus_1), _mm256_cmpgt_epi8(hi_plus_1, block));
+    if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(in_range))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_in_ascii_range_sse4_2(begin, end, lo, hi);
+}
+
+__attribute__((target("avx2"))) const char* find_first_non_ascii_avx2(const char* begin, const char* end) noexcept {
+  for (; end - begin >= 32; begin += 32) {
+    if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin))))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_non_ascii_sse4_2(begin, end);
+}
+
+__attribute__((target("avx2"))) void ascii_switch_case_avx2(const char* src, size_t len, char* dst, char lo, char hi) noexcept {
+  const __m256i lo_minus_1 = _mm256_set1_epi8(static_cast<char>(lo - 1));
+  const __m256i hi_plus_1 = _mm256_set1_epi8(static_cast<char>(hi + 1));
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(block, lo_minus_1), _mm256_cmpgt_epi8(hi_plus_1, block));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(block, _mm256_and_si256(in_range, case_bit)));
+  }
+  ascii_switch_case_sse4_2(src + i, len - i, dst + i, lo, hi);
+}
+
+__attribute__((target("avx2"))) void bin_to_hex_avx2(const char* src, size_t len, char* dst) noexcept {
+  const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibble));
+    const __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(block, low_nibble));
+    // unpacking works inside 128-bit lanes: the first result has bytes 0-7 and 16-23, the second one has 8-15 and 24-31
+    const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  bin_to_hex_sse4_2(src + i, len - i, dst + 2 * i);
+}
+
+__attribute__((target("avx2,popcnt"))) size_t count_utf8_code_points_avx2(const char* begin, const char* end) noexcept {
+  const __m256i last_continuation = _mm256_set1_epi8(-65);
+  size_t count = 0;
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    count += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, last_continuation))));
+  }
+  return count + count_utf8_code_points_sse4_2(begin, end);
+}
+
+__attribute__((target("avx2,popcnt"))) const char* find_utf8_code_point_avx2(const char* begin, const char* end, size_t n) noexcept {
+  const __m256i last_continuation = _mm256_set1_epi8(-65);
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, last_continuation)));
+    const auto count = static_cast<size_t>(__builtin_popcount(mask));
+    if (n < count) {
+      for (; n != 0; --n) {
+        mask &= mask - 1;
+      }
+      return begin + __builtin_ctz(mask);
+    }
+    n -= count;
+  }
+  return find_utf8_code_point_sse4_2(begin, end, n);
+}
+
+__attribute__((target("avx2"))) __m256i broadcast_table_avx2(const uint8_t* table) noexcept {
+  return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+__attribute__((target("avx2"))) __m256i utf8_block_errors_avx2(__m256i input, __m256i prev_input) noexcept {
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  // the previous bytes cross the 128-bit lanes: take the end of prev_input for the low lane
+  const __m256i prev_lanes = _mm256_permute2x128_si256(prev_input, input, 0x21);
+  const __m256i prev1 = _mm256_alignr_epi8(input, prev_lanes, 15);
+  const __m256i byte_1_high = _mm256_shuffle_epi8(broadcast_table_avx2(UTF8_BYTE_1_HIGH), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+  const __m256i byte_1_low = _mm256_shuffle_epi8(broadcast_table_avx2(UTF8_BYTE_1_LOW), _mm256_and_si256(prev1, low_nibble));
+  const __m256i byte_2_high = _mm256_shuffle_epi8(broadcast_table_avx2(UTF8_BYTE_2_HIGH), _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+  const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  const __m256i is_third_byte = _mm256_subs_epu8(_mm256_alignr_epi8(input, prev_lanes, 14), _mm256_set1_epi8(0xe0 - 0x80));
+  const __m256i is_fourth_byte = _mm256_subs_epu8(_mm256_alignr_epi8(input, prev_lanes, 13), _mm256_set1_epi8(0xf0 - 0x80));
+  const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+__attribute__((target("avx2"))) bool is_valid_utf8_avx2(const char* begin, const char* end) noexcept {
+  // the incomplete check is for the last bytes of the high lane only
+  const __m256i incomplete_max = _mm256_inserti128_si256(_mm256_set1_epi8(static_cast<char>(0xff)),
+                                                         _mm_load_si128(reinterpret_cast<const __m128i*>(UTF8_INCOMPLETE_MAX)), 1);
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+  const auto check_block = [&](__m256i input) __attribute__((target("avx2"))) {
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+      prev_incomplete = _mm256_setzero_si256();
+    } else {
+      error = _mm256_or_si256(error, utf8_block_errors_avx2(input, prev_input));
+      prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    prev_input = input;
+  };
+
+  for (; end - begin >= 32; begin += 32) {
+    check_block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)));
+  }
+  if (begin != end) {
+    alignas(32) char tail[32] = {0};
+    std::memcpy(tail, begin, end - begin);
+    check_block(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)));
+  }
+  error = _mm256_or_si256(error, prev_incomplete);
+  return _mm256_testz_si256(error, error);
+}
+
+__attribute__((target("avx2"))) json_block_masks json_classify_block_avx2(const char* block) noexcept {
+  json_block_masks masks{0, 0, 0};
+  for (int i = 0; i < 2; ++i) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+    const auto is = [chunk](char c) __attribute__((target("avx2"))) { return _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c)); };
+    const __m256i structurals =
+      _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(is('{'), is('}')), _mm256_or_si256(is('['), is(']'))), _mm256_or_si256(is(','), is(':')));
+    masks.quotes |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is('"')))) << (32 * i);
+    masks.backslashes |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is('\\')))) << (32 * i);
+    masks.structurals |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(structurals))) << (32 * i);
+  }
+  return masks;
+}
+
+#endif
+
+struct kernels {
+  level kernels_level;
+  const char* (*find_first_of)(const char*, const char*, const char*, size_t) noexcept;
+  const char* (*find_first_in_ascii_range)(const char*, const char*, char, char) noexcept;
+  const char* (*find_first_non_ascii)(const char*, const char*) noexcept;
+  void (*ascii_switch_case)(const char*, size_t, char*, char, char) noexcept;
+  void (*bin_to_hex)(const char*, size_t, char*) noexcept;
+  size_t (*count_utf8_code_points)(const char*, const char*) noexcept;
+  const char* (*find_utf8_code_point)(const char*, const char*, size_t) noexcept;
+  bool (*is_valid_utf8)(const char*, const char*) noexcept;
+  void (*json_structural_masks)(const char*, const char*, uint64_t*) noexcept;
+};
+
+constexpr kernels SCALAR_KERNELS{level::scalar,           find_first_of_scalar,    find_first_in_ascii_range_scalar,
+                                 find_first_non_ascii_scalar, ascii_switch_case_scalar, bin_to_hex_scalar,
+                                 count_utf8_code_points_scalar, find_utf8_code_point_scalar, is_valid_utf8_scalar,
+                                 json_structural_masks_impl<json_classify_block_scalar>};
+#ifdef __x86_64__
+constexpr kernels SSE4_2_KERNELS{level::sse4_2,           find_first_of_sse4_2,    find_first_in_ascii_range_sse4_2,
+                                 find_first_non_ascii_sse4_2, ascii_switch_case_sse4_2, bin_to_hex_sse4_2,
+                                 count_utf8_code_points_sse4_2, find_utf8_code_point_sse4_2, is_valid_utf8_sse4_2,
+                                 json_structural_masks_impl<json_classify_block_sse4_2>};
+constexpr kernels AVX2_KERNELS{level::avx2,           find_first_of_avx2,    find_first_in_ascii_range_avx2,
+                               find_first_non_ascii_avx2, ascii_switch_case_avx2, bin_to_hex_avx2,
+                               count_utf8_code_points_avx2, find_utf8_code_point_avx2, is_valid_utf8_avx2,
+                               json_structural_masks_impl<json_classify_block_avx2>};
+#endif
+
+kernels current_kernels = SCALAR_KERNELS;
+
+bool is_supported(level l) noexcept {
+  switch (l) {
+    case level::scalar:
+      return true;
+#ifdef __x86_64__
+    case level::sse4_2:
+      return kdb_cpuid()->x86_64.ecx & (1 << 20);
+    case level::avx2:
+      return kdb_cpuid_has_avx2();
+#endif
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+level get_level() noexcept {
+  return current_kernels.kernels_level;
+}
+
+bool set_level(level new_level) noexcept {
+  if (!is_supported(new_level)) {
+    return false;
+  }
+  switch (new_level) {
+#ifdef __x86_64__
+    case level::avx2:
+      current_kernels = AVX2_KERNELS;
+      break;
+    case level::sse4_2:
+      current_kernels = SSE4_2_KERNELS;
+      break;
+#endif
+    default:
+      current_kernels = SCALAR_KERNELS;
+  }
+  return true;
+}
+
+void simd_string_init() __attribute__((constructor(101)));
+void simd_string_init() {
+  set_level(level::avx2) || set_level(level::sse4_2) || set_level(level::scalar);
+}
+
+const char* find_first_of(const char* begin, const char* end, const char* chars, size_t chars_count) noexcept {
+  return current_kernels.find_first_of(begin, end, chars, chars_count);
+}
+
+const char* find_first_in_ascii_range(const char* begin, const char* end, char lo, char hi) noexcept {
+  return current_kernels.find_first_in_ascii_range(begin, end, lo, hi);
+}
+
+const char* find_first_non_ascii(const char* begin, const char* end) noexcept {
+  return current_kernels.find_first_non_ascii(begin, end);
+}
+
+void ascii_switch_case(const char* src, size_t len, char* dst, char lo, char hi) noexcept {
+  current_kernels.ascii_switch_case(src, len, dst, lo, hi);
+}
+
+void bin_to_hex(const char* src, size_t len, char* dst) noexcept {
+  current_kernels.bin_to_hex(src, len, dst);
+}
+
+size_t count_utf8_code_points(const char* begin, const char* end) noexcept {
+  return current_kernels.count_utf8_code_points(begin, end);
+}
+
+const char* find_utf8_code_point(const char* begin, const char* end, size_t n) noexcept {
+  return current_kernels.find_utf8_code_point(begin, end, n);
+}
+
+bool is_valid_utf8(const char* begin, const char* end) noexcept {
+  return current_kernels.is_valid_utf8(begin, end);
+}
+
+void json_structural_masks(const char* begin, const char* end, uint64_t* masks) noexcept {
+  current_kernels.json_structural_masks(begin, end, masks);
+}
+
+} // namespace simd
+} // namespace vk
@@ -0,0 +1,51 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte scanning and transforming kernels for string builtins.
+// An implementation is chosen at startup according to kdb_cpuid(): AVX2 (32 bytes per step), SSE4.2 (16 bytes per step) or scalar.
+namespace vk {
+namespace simd {
+
+enum class level { scalar, sse4_2, avx2 };
+
+level get_level() noexcept;
+// the best supported level is chosen at startup, this function is for tests and benchmarks;
+// returns false if the level is not supported by the cpu
+bool set_level(level new_level) noexcept;
+
+// returns a pointer to the first byte of [begin, end) which is one of chars[0 .. chars_count), or end; chars_count <= 8
+const char* find_first_of(const char* begin, const char* end, const char* chars, size_t chars_count) noexcept;
+
+// returns a pointer to the first byte of [begin, end) which is in [lo, hi], or end; lo and hi must be ASCII
+const char* find_first_in_ascii_range(const char* begin, const char* end, char lo, char hi) noexcept;
+
+// returns a pointer to the first byte of [begin, end) which is >= 0x80, or end
+const char* find_first_non_ascii(const char* begin, const char* end) noexcept;
+
+// copies len bytes from src to dst switching the case of ASCII letters in [lo, hi]: ['A', 'Z'] to lower, ['a', 'z'] to upper
+void ascii_switch_case(const char* src, size_t len, char* dst, char lo, char hi) noexcept;
+
+// writes 2 * len lowercase hex digits of src to dst
+void bin_to_hex(const char* src, size_t len, char* dst) noexcept;
+
+// returns the number of bytes of [begin, end) which are not UTF-8 continuation bytes (10xxxxxx), i.e. the number of code points in valid UTF-8
+size_t count_utf8_code_points(const char* begin, const char* end) noexcept;
+
+// returns a pointer to the n-th (from 0) byte of [begin, end) which is not a UTF-8 continuation byte, or end
+const char* find_utf8_code_point(const char* begin, const char* end, size_t n) noexcept;
+
+// checks that [begin, end) is a valid UTF-8: no overlong forms, surrogates and code points above U+10FFFF
+bool is_valid_utf8(const char* begin, const char* end) noexcept;
+
+// for every 64 bytes of [begin, end) writes a mask to masks[] with bit i set if byte i is one of the JSON structural characters {}[],:
+// outside of strings; a string is "...", a backslash escapes the byte after it; masks must have (end - begin + 63) / 64 elements
+void json_structural_masks(const char* begin, const char* end, uint64_t* masks) noexcept;
+
+} // namespace simd
+} // namespace vk
@@ -3,7 +3,9 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         algorithms/contains-test.cpp
         algorithms/hashes-test.cpp
         algorithms/projections-test.cpp
+        algorithms/simd-array-test.cpp
         algorithms/simd-int-to-string-test.cpp
+        algorithms/simd-string-test.cpp
         algorithms/string-algorithms-test.cpp
         allocators/freelist-test.cpp
         allocators/lockfree-slab-test.cpp
@@ -16,6 +16,14 @@ const kdb_cpuid_t* kdb_cpuid() {
   }
   int a;
   asm volatile("cpuid\n\t" : "=a"(a), "=b"(cached.x86_64.ebx), "=c"(cached.x86_64.ecx), "=d"(cached.x86_64.edx) : "0"(1));
+  int c, d;
+  asm volatile("cpuid\n\t" : "=a"(a), "=b"(cached.x86_64.leaf7_ebx), "=c"(c), "=d"(d) : "0"(7), "2"(0));
+  cached.x86_64.os_saves_ymm = false;
+  if (cached.x86_64.ecx & (1 << 27)) { // OSXSAVE
+    unsigned xcr0_lo, xcr0_hi;
+    asm volatile("xgetbv\n\t" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    cached.x86_64.os_saves_ymm = (xcr0_lo & 6) == 6;
+  }
   cached.type = KDB_CPUID_X86_64;
 #elif defined(__arm64__) // Apple M1
   if (cached.type) {
@@ -37,3 +45,12 @@ const kdb_cpuid_t* kdb_cpuid() {
 
   return &cached;
 }
+
+bool kdb_cpuid_has_avx2() {
+#if defined(__x86_64__)
+  const kdb_cpuid_t* p = kdb_cpuid();
+  return p->x86_64.os_saves_ymm && (p->x86_64.leaf7_ebx & (1 << 5));
+#else
+  return false;
+#endif
+}
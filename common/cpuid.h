@@ -12,8 +12,13 @@ typedef struct {
   union {
     struct {
       int ebx, ecx, edx;
+      int leaf7_ebx;
+      bool os_saves_ymm;
     } x86_64;
   };
 } kdb_cpuid_t;
 
 const kdb_cpuid_t* kdb_cpuid();
+
+// AVX2 is usable only if the OS saves ymm registers on context switches
+bool kdb_cpuid_has_avx2();
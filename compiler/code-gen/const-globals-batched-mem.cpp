@@ -81,6 +81,18 @@ int calc_sizeof_tuple_shape(const TypeData *type);
          : result;
 }
 
+void collect_accessed_globals_batches(VertexPtr root, std::set<int> &batches) {
+  if (auto var = root.try_as<op_var>()) {
+    VarPtr var_id = var->var_id;
+    if (var_id->is_in_global_scope() && !var_id->is_constant() && !var_id->is_builtin_runtime && !var_id->is_foreach_reference) {
+      batches.insert(var_id->batch_idx);
+    }
+  }
+  for (VertexPtr child : *root) {
+    collect_accessed_globals_batches(child, batches);
+  }
+}
+
 } // namespace
 
 
@@ -231,6 +243,7 @@ const GlobalsBatchedMem &GlobalsBatchedMem::prepare_mem_and_assign_offsets(const
     });
 
     int offset = 0;
+    batch.offset_in_linear_mem = mem.total_mem_size;
 
     for (VarPtr var : batch.globals) {
       const TypeData *var_type = tinf::get_type(var);
@@ -256,6 +269,11 @@ const GlobalsBatchedMem &GlobalsBatchedMem::prepare_mem_and_assign_offsets(const
   return mem;
 }
 
+bool GlobalsBatchedMem::is_dirty_tracking_enabled() {
+  // libs are reset by a main script as a whole, and k2 has its own globals storage
+  return !G->is_output_mode_lib() && !G->is_output_mode_k2();
+}
+
 void ConstantsExternCollector::add_extern_from_var(VarPtr var) {
   kphp_assert(var->is_constant());
   extern_constants.insert(var);
@@ -306,6 +324,13 @@ void GlobalsMemAllocation::compile(CodeGenerator &W) const {
   } else {
     W << "php_globals.once_alloc_linear_mem(\"" << G->settings().static_lib_name.get() << "\", " << mem.total_mem_size << ");" << NL;
   }
+  if (GlobalsBatchedMem::is_dirty_tracking_enabled()) {
+    W << "php_globals.once_alloc_batches({";
+    for (const auto &batch : mem.batches) {
+      W << batch.offset_in_linear_mem << ", ";
+    }
+    W << mem.total_mem_size << "});" << NL;
+  }
 }
 
 void PhpMutableGlobalsAssignCurrent::compile(CodeGenerator &W) const {
@@ -328,6 +353,17 @@ void PhpMutableGlobalsConstRefArgument::compile(CodeGenerator &W) const {
   W << "const PhpScriptMutableGlobals &php_globals";
 }
 
+void PhpMutableGlobalsMarkBatchesDirty::compile(CodeGenerator &W) const {
+  if (!GlobalsBatchedMem::is_dirty_tracking_enabled()) {
+    return;
+  }
+  std::set<int> batches;
+  collect_accessed_globals_batches(func_root, batches);
+  for (int batch_idx : batches) {
+    W << "php_globals.mark_batch_dirty(" << batch_idx << ");" << NL;
+  }
+}
+
 void GlobalVarInPhpGlobals::compile(CodeGenerator &W) const {
   if (global_var->is_builtin_runtime) {
     W << "php_globals.get_superglobals().v$" << global_var->name;
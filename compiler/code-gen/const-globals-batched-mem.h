@@ -81,12 +81,19 @@ public:
 // It's done to achieve less incremental re-compilation: when PHP code changes introducing a new global,
 // offsets will be shifted only inside one batch, but not throughout the whole project.
 //
+// Batches are also a unit of reset between requests: every function marks batches it accesses as dirty on entry,
+// and only dirty batches are reset (PhpMutableGlobalsMarkBatchesDirty below). A mark is set on any access, not only on write,
+// since a global can be modified without being assigned: passed by reference, holding a mutated instance, etc.
+// The first reset on worker start is saved by runtime as a pristine image, and dirty batches are restored from it
+// by memcpy afterwards, that's why the runtime is also aware of batches offsets.
+//
 // See globals-vars-reset.cpp and (runtime) php-script-globals.h.
 class GlobalsBatchedMem {
 public:
   struct OneBatchInfo {
     int batch_idx;
     int n_globals{0};
+    int offset_in_linear_mem{0};
     std::vector<VarPtr> globals;
   };
 
@@ -109,6 +116,7 @@ private:
 public:
   static int detect_globals_batch_count(int n_globals);
   static const GlobalsBatchedMem &prepare_mem_and_assign_offsets(const std::vector<VarPtr> &all_globals);
+  static bool is_dirty_tracking_enabled();
 
   const std::vector<OneBatchInfo> &get_batches() const { return batches; }
   const OneBatchInfo &get_batch(int batch_idx) const { return batches.at(batch_idx); }
@@ -152,6 +160,15 @@ struct PhpMutableGlobalsConstRefArgument {
   void compile(CodeGenerator &W) const;
 };
 
+struct PhpMutableGlobalsMarkBatchesDirty {
+  VertexPtr func_root;
+
+  explicit PhpMutableGlobalsMarkBatchesDirty(VertexPtr func_root)
+    : func_root(func_root) {}
+
+  void compile(CodeGenerator &W) const;
+};
+
 struct GlobalVarInPhpGlobals {
   VarPtr global_var;
 
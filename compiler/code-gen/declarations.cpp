@@ -5,6 +5,7 @@
 #include "compiler/code-gen/declarations.h"
 
 #include "common/algorithms/compare.h"
+#include "common/crc32.h"
 
 #include "compiler/code-gen/common.h"
 #include "compiler/code-gen/const-globals-batched-mem.h"
@@ -905,6 +906,19 @@ void ClassDeclaration::compile_accept_json_visitor(CodeGenerator &W, ClassPtr kl
   }
 }
 
+// whether the instances of the class contain only ints, floats, bools and strings (or Optional of them):
+// nothing inside such an instance may refer to another instance, so the instance cache copies it without tracking the aliasing
+static bool has_flat_fields(ClassPtr klass) {
+  if (klass->is_polymorphic_class()) {
+    return false;
+  }
+  bool flat = true;
+  klass->members.for_each([&](ClassMemberInstanceField &field) {
+    flat = flat && vk::any_of_equal(tinf::get_type(field.var)->get_real_ptype(), tp_int, tp_float, tp_bool, tp_string);
+  });
+  return flat;
+}
+
 void ClassDeclaration::compile_accept_visitor_methods(CodeGenerator &W, ClassPtr klass) {
   bool need_generic_accept =
     klass->need_to_array_debug_visitor || (klass->need_instance_cache_visitors && !G->is_output_mode_k2()) || (klass->need_instance_memory_estimate_visitor);
@@ -937,19 +951,58 @@ void ClassDeclaration::compile_accept_visitor_methods(CodeGenerator &W, ClassPtr
     compile_accept_visitor(W, klass, "InstanceDeepCopyVisitor");
     W << NL;
     compile_accept_visitor(W, klass, "InstanceDeepDestroyVisitor");
+    if (has_flat_fields(klass)) {
+      W << NL << "static constexpr bool has_flat_fields = true;" << NL;
+    }
   }
 
   compile_accept_json_visitor(W, klass);
 }
 
+// describes what msgpack_pack() writes: the tags and the types of the serialized fields of the class and its parents,
+// and the same for the serializable classes inside them
+static void describe_msgpack_layout(ClassPtr klass, std::string &out, std::unordered_set<ClassPtr> &described) {
+  if (!described.emplace(klass).second) {
+    return;
+  }
+
+  std::unordered_set<ClassPtr> inner_klasses;
+  out += klass->name;
+  out += '{';
+  for (ClassPtr the_klass = klass; the_klass; the_klass = the_klass->parent_class) {
+    the_klass->members.for_each([&](ClassMemberInstanceField &field) {
+      if (field.serialization_tag != -1) {
+        const TypeData *type = tinf::get_type(field.var);
+        out += fmt_format("{}:{}{};", field.serialization_tag, type->as_human_readable(false), field.serialize_as_float32 ? ":float32" : "");
+        type->get_all_class_types_inside(inner_klasses);
+      }
+    });
+  }
+  out += '}';
+
+  std::vector<ClassPtr> sorted_inner_klasses{inner_klasses.begin(), inner_klasses.end()};
+  std::sort(sorted_inner_klasses.begin(), sorted_inner_klasses.end(), [](ClassPtr c1, ClassPtr c2) { return c1->name < c2->name; });
+  for (ClassPtr inner_klass : sorted_inner_klasses) {
+    if (inner_klass->is_serializable) {
+      describe_msgpack_layout(inner_klass, out, described);
+    }
+  }
+}
+
 void ClassDeclaration::compile_msgpack_declarations(CodeGenerator &W, ClassPtr klass) {
   if (!klass->is_serializable) {
     return;
   }
 
+  std::string layout;
+  std::unordered_set<ClassPtr> described;
+  describe_msgpack_layout(klass, layout, described);
+
   W << NL;
+  // the instance cache accepts the elements handed over by the previous binary only if the layout hash is the same
+  W << "static constexpr uint64_t msgpack_layout_hash = " << fmt_format("{}ULL", compute_crc64(layout.data(), static_cast<long>(layout.size()))) << ";" << NL;
   W << "void msgpack_pack(vk::msgpack::packer<string_buffer> &packer) const noexcept;" << NL << NL;
-  W << "void msgpack_unpack(const vk::msgpack::object &msgpack_o);" << NL;
+  W << "void msgpack_unpack(vk::msgpack::unpacker &unpacker);" << NL;
 }
 
 void ClassDeclaration::compile_virtual_builtin_functions(CodeGenerator &W, ClassPtr klass) {
@@ -1175,17 +1228,17 @@ void ClassMembersDefinition::compile_msgpack_deserialize(CodeGenerator &W, Class
     return;
   }
 
-  //if (msgpack_o.type != vk::msgpack::stored_type::ARRAY) { SerializationLibContext::get().set_msgpack_error(vk::msgpack::TYPE_ERROR); return; }
-  //auto arr = msgpack_o.via.array;
-  //for (size_t i = 0; i < arr.size; i += 2) {
-  //  auto tag = arr.ptr[i].as<uint8_t>();
-  //  [[maybe_unused]] auto elem = arr.ptr[i + 1];
+  //auto msgpack_o = unpacker.next();
+  //if (msgpack_o.type != vk::msgpack::stored_type::ARRAY) { SerializationLibContext::get().set_msgpack_error(vk::msgpack::TYPE_ERROR); unpacker.skip_nested(msgpack_o); return; }
+  //for (size_t i = 0; i + 1 < msgpack_o.via.array.size; i += 2) {
+  //  auto tag = unpacker.unpack<uint8_t>();
   //  switch (tag) {
-  //    case tag_x: elem.convert(x); break;
-  //    case tag_s: elem.convert(s); break;
-  //    default   : break;
+  //    case tag_x: unpacker.unpack(x); break;
+  //    case tag_s: unpacker.unpack(s); break;
+  //    default   : unpacker.skip(); break;
   //  }
   //}
+  //unpacker.skip(msgpack_o.via.array.size % 2);
   //
 
   std::vector<std::string> cases;
@@ -1204,22 +1257,22 @@ void ClassMembersDefinition::compile_msgpack_deserialize(CodeGenerator &W, Class
   for (auto &k : klasses) {
     k->members.for_each([&](ClassMemberInstanceField &field) {
       if (field.serialization_tag != -1) {
-        cases.emplace_back(fmt_format("case {}: elem.convert(${}); break;", field.serialization_tag, field.var->name));
+        cases.emplace_back(fmt_format("case {}: unpacker.unpack(${}); break;", field.serialization_tag, field.var->name));
       }
     });
   }
-  cases.emplace_back("default: break;");
+  cases.emplace_back("default: unpacker.skip(); break;");
 
-  W << "void " << klass->src_name << "::msgpack_unpack(const vk::msgpack::object &msgpack_o) " << BEGIN
-    << "if (msgpack_o.type != vk::msgpack::stored_type::ARRAY) { SerializationLibContext::get().set_msgpack_error(vk::msgpack::TYPE_ERROR); return; }" << NL
-    << "auto arr = msgpack_o.via.array;" << NL
-    << "for (size_t i = 0; i < arr.size; i += 2)" << BEGIN
-    << "auto tag = arr.ptr[i].as<uint8_t>();" << NL
-    << "[[maybe_unused]] auto elem = arr.ptr[i + 1];" << NL
+  W << "void " << klass->src_name << "::msgpack_unpack(vk::msgpack::unpacker &unpacker) " << BEGIN
+    << "auto msgpack_o = unpacker.next();" << NL
+    << "if (msgpack_o.type != vk::msgpack::stored_type::ARRAY) { SerializationLibContext::get().set_msgpack_error(vk::msgpack::TYPE_ERROR); unpacker.skip_nested(msgpack_o); return; }" << NL
+    << "for (size_t i = 0; i + 1 < msgpack_o.via.array.size; i += 2)" << BEGIN
+    << "auto tag = unpacker.unpack<uint8_t>();" << NL
     << "switch (tag) " << BEGIN
     << JoinValues(cases, "", join_mode::multiple_lines) << NL
     << END << NL
     << END << NL
+    << "unpacker.skip(msgpack_o.via.array.size % 2);" << NL
     << END << NL;
 }
 
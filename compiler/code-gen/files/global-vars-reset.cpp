@@ -68,6 +68,13 @@ void GlobalVarsReset::compile_globals_reset_part(CodeGenerator &W, const Globals
 void GlobalVarsReset::compile_globals_reset(CodeGenerator &W, const GlobalsBatchedMem &all_globals_in_mem) {
   W << OpenNamespace();
   FunctionSignatureGenerator(W) << "void global_vars_reset(" << PhpMutableGlobalsRefArgument() << ")" << BEGIN;
+  if (GlobalsBatchedMem::is_dirty_tracking_enabled()) {
+    // only the first reset runs constructors below, after it dirty batches are copied from a saved image
+    W << "if (php_globals.has_pristine_snapshot())" << BEGIN;
+    W << "php_globals.restore_dirty_batches_from_snapshot();" << NL;
+    W << "return;" << NL;
+    W << END << NL;
+  }
 
   for (const auto &batch : all_globals_in_mem.get_batches()) {
     const std::string func_name_i = "global_vars_reset_file" + std::to_string(batch.batch_idx);
@@ -76,6 +83,9 @@ void GlobalVarsReset::compile_globals_reset(CodeGenerator &W, const GlobalsBatch
     // function call
     W << func_name_i << "(php_globals);" << NL;
   }
+  if (GlobalsBatchedMem::is_dirty_tracking_enabled()) {
+    W << "php_globals.save_pristine_snapshot();" << NL;
+  }
 
   W << END;
   W << NL;
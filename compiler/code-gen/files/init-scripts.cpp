@@ -288,6 +288,9 @@ void LibVersionHFile::compile(CodeGenerator &W) const {
   W << "// CXX: " << G->settings().cxx.get() << NL;
   W << "// CXXFLAGS DEFAULT: " << G->settings().cxx_flags_default.flags.get() << NL;
   W << "// CXXFLAGS WITH EXTRA: " << G->settings().cxx_flags_with_debug.flags.get() << NL;
+  if (!G->settings().profile_sha256.get().empty()) {
+    W << "// Profile sha256: " << G->settings().profile_sha256.get() << NL;
+  }
   W << CloseFile();
 }
 
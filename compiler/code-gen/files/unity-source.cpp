@@ -0,0 +1,28 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/code-gen/files/unity-source.h"
+
+#include "compiler/code-gen/common.h"
+#include "compiler/code-gen/includes.h"
+#include "compiler/unity-build.h"
+
+void UnityCpp::compile(CodeGenerator &W) const {
+  // a source excluded from debug info excludes the whole unit, as the flags are per translation unit
+  bool compile_with_debug_info_flag = true;
+  for (const std::string &source : sources) {
+    const vk::string_view file_name = vk::string_view{source}.substr(source.rfind('/') + 1);
+    for (const auto &exclude_symbol : G->get_exclude_namespaces()) {
+      compile_with_debug_info_flag = compile_with_debug_info_flag && !file_name.starts_with(exclude_symbol);
+    }
+  }
+
+  W << OpenFile(UnityBuild::get_unity_file_name(unity_id), UnityBuild::SUBDIR, compile_with_debug_info_flag);
+  // it must go first to capture the precompiled header
+  W << ExternInclude(G->settings().runtime_headers.get());
+  for (const std::string &source : sources) {
+    W << Include(source);
+  }
+  W << CloseFile();
+}
@@ -0,0 +1,24 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "compiler/code-gen/code-gen-root-cmd.h"
+
+// a unity translation unit: it includes the sources of several functions to compile them at once, see UnityBuild
+struct UnityCpp : CodeGenRootCmd {
+  UnityCpp(uint32_t unity_id, std::vector<std::string> sources) noexcept :
+    unity_id(unity_id),
+    sources(std::move(sources)) {}
+
+  void compile(CodeGenerator &W) const final;
+
+private:
+  const uint32_t unity_id;
+  const std::vector<std::string> sources;
+};
@@ -1516,7 +1516,11 @@ void compile_function_resumable(VertexAdaptor<op_function> func_root, CodeGenera
     }
     W << Indent(-2);
   }
-  W << " " << BEGIN << END << NL;
+  W << " " << BEGIN;
+  if (func->has_global_vars_inside) {
+    W << PhpMutableGlobalsMarkBatchesDirty(func_root);
+  }
+  W << END << NL;
 
   if (compile_tracing_profiler(func, W)) {
     FunctionSignatureGenerator(W) << "bool run_profiling_resumable()" << BEGIN;
@@ -1580,6 +1584,7 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   W << FunctionDeclaration(func, false) << " " << BEGIN;
   if (func->has_global_vars_inside) {
     W << PhpMutableGlobalsAssignCurrent() << NL;
+    W << PhpMutableGlobalsMarkBatchesDirty(func_root);
   }
 
   if (func->kphp_tracing && !G->is_output_mode_k2()) {
@@ -1588,6 +1593,11 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   }
   compile_tracing_profiler(func, W);
 
+  if (func->is_memoized) {
+    // the body is placed into a lambda, which is called only if there is no cached result, see runtime/memoize.h
+    W << "return memoize_call(\"" << func->name << "\", [&]() -> " << TypeName(tinf::get_type(func, -1)) << " " << BEGIN;
+  }
+
   for (auto var : func->local_var_ids) {
     if (var->type() != VarData::var_local_inplace_t && !var->is_foreach_reference) {
       W << VarDeclaration(var);
@@ -1604,7 +1614,15 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
     W << name_of_variadic_param << " = f$array_values(" << name_of_variadic_param << ");" << NL;
     W << END << NL;
   }
-  W << AsSeq{func_root->cmd()} << END << NL;
+  W << AsSeq{func_root->cmd()};
+  if (func->is_memoized) {
+    W << END;
+    for (VarPtr param : func->param_ids) {
+      W << ", " << VarName(param);
+    }
+    W << ");" << NL;
+  }
+  W << END << NL;
 }
 
 struct StrlenInfo {
@@ -4,11 +4,15 @@
 
 #include "compiler/compiler-settings.h"
 
+#include <algorithm>
 #include <chrono>
+#include <dirent.h>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "openssl/sha.h"
@@ -173,13 +177,7 @@ void append_apple_options(std::string &cxx_flags, std::string &ld_flags) noexcep
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
-std::string calc_cxx_flags_sha256(vk::string_view cxx, vk::string_view cxx_flags_line) noexcept {
-  SHA256_CTX sha256;
-  SHA256_Init(&sha256);
-
-  SHA256_Update(&sha256, cxx.data(), cxx.size());
-  SHA256_Update(&sha256, cxx_flags_line.data(), cxx_flags_line.size());
-
+std::string sha256_final_hex(SHA256_CTX &sha256) noexcept {
   unsigned char hash[SHA256_DIGEST_LENGTH] = {0};
   SHA256_Final(hash, &sha256);
 
@@ -191,6 +189,56 @@ std::string calc_cxx_flags_sha256(vk::string_view cxx, vk::string_view cxx_flags
   return hash_str;
 }
 
+std::string calc_cxx_flags_sha256(vk::string_view cxx, vk::string_view cxx_flags_line) noexcept {
+  SHA256_CTX sha256;
+  SHA256_Init(&sha256);
+
+  SHA256_Update(&sha256, cxx.data(), cxx.size());
+  SHA256_Update(&sha256, cxx_flags_line.data(), cxx_flags_line.size());
+
+  return sha256_final_hex(sha256);
+}
+
+// a profile is a file (clang .profdata, AutoFDO profile) or a directory with a .gcda file per object (gcc)
+std::string calc_profile_sha256(const std::string &profile_path) {
+  std::string dir_path;
+  std::vector<std::string> files;
+  struct stat st;
+  if (stat(profile_path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    dir_path = as_dir(profile_path);
+    std::unique_ptr<DIR, int (*)(DIR *)> dir{opendir(profile_path.c_str()), closedir};
+    if (!dir) {
+      throw std::runtime_error{fmt_format("Failed to open profile dir [{}] : {}", profile_path, strerror(errno))};
+    }
+    while (const auto *entry = readdir(dir.get())) {
+      if (entry->d_name[0] != '.') {
+        files.emplace_back(entry->d_name);
+      }
+    }
+    std::sort(files.begin(), files.end());
+  } else {
+    files.emplace_back(profile_path);
+  }
+
+  SHA256_CTX sha256;
+  SHA256_Init(&sha256);
+  std::vector<char> buf(1 << 16);
+  for (const std::string &file : files) {
+    std::ifstream in{dir_path + file, std::ios::binary};
+    if (!in) {
+      throw std::runtime_error{fmt_format("Failed to read profile file [{}]", dir_path + file)};
+    }
+    // the names of .gcda files matter, they are matched with the objects
+    if (!dir_path.empty()) {
+      SHA256_Update(&sha256, file.data(), file.size() + 1);
+    }
+    while (in.read(buf.data(), buf.size()) || in.gcount() > 0) {
+      SHA256_Update(&sha256, buf.data(), static_cast<size_t>(in.gcount()));
+    }
+  }
+  return sha256_final_hex(sha256);
+}
+
 #pragma GCC diagnostic pop
 
 } // namespace
@@ -277,6 +325,41 @@ void CompilerSettings::init() {
     throw std::runtime_error{"Option " + static_lib_out_dir.get_env_var() + " is allowed only for static lib mode"};
   }
 
+  if (lto.get()) {
+    if (is_k2_mode || mode.get() == "lib") {
+      throw std::runtime_error{"Option " + lto.get_env_var() + " is allowed only for server and cli modes"};
+    }
+    if (dynamic_incremental_linkage.get()) {
+      throw std::runtime_error{"Option " + lto.get_env_var() + " is incompatible with " + dynamic_incremental_linkage.get_env_var()};
+    }
+  }
+  if (!profile_use.get().empty() && !profile_sample_use.get().empty()) {
+    throw std::runtime_error{"Options " + profile_use.get_env_var() + " and " + profile_sample_use.get_env_var() + " are mutually exclusive"};
+  }
+  if (!profile_generate_dir.get().empty()) {
+    if (!profile_use.get().empty() || !profile_sample_use.get().empty()) {
+      throw std::runtime_error{"Option " + profile_generate_dir.get_env_var() + " is incompatible with the profile use options"};
+    }
+    // the instrumented binary is launched from anywhere, so the path must be absolute
+    mkdir_recursive(profile_generate_dir.get().c_str(), 0777);
+    profile_generate_dir.value_ = get_full_path(profile_generate_dir.get());
+    if (profile_generate_dir.get().empty()) {
+      throw std::runtime_error{"Option " + profile_generate_dir.get_env_var() + ": can't create the profile dir: " + strerror(errno)};
+    }
+  }
+  // the profile path is a part of the compiler flags, and its content hash is written to _lib_version.h,
+  // so that all the objects are rebuilt when the profile changes, and the cached ones are reused otherwise
+  for (KphpOption<std::string> *profile : {&profile_use, &profile_sample_use}) {
+    if (!profile->get().empty()) {
+      const std::string full_path = get_full_path(profile->get());
+      if (full_path.empty()) {
+        throw std::runtime_error{fmt_format("Failed to open profile [{}] : {}", profile->get(), strerror(errno))};
+      }
+      profile->value_ = full_path;
+      profile_sha256.value_ = calc_profile_sha256(full_path);
+    }
+  }
+
   if (!jobs_count.get()) {
     jobs_count.value_ = get_default_threads_count();
   }
@@ -320,9 +403,25 @@ void CompilerSettings::init() {
   if (is_k2_mode || dynamic_incremental_linkage.get()) {
     ss << " -fPIC";
   }
-  if (vk::contains(cxx.get(), "clang")) {
+  const bool is_clang = vk::contains(cxx.get(), "clang");
+  if (is_clang) {
     ss << " -Wno-invalid-source-encoding";
   }
+  if (lto.get()) {
+    ss << (is_clang ? " -flto=thin" : " -flto");
+  }
+  if (!profile_generate_dir.get().empty()) {
+    ss << " -fprofile-generate=" << profile_generate_dir.get();
+  }
+  if (!profile_use.get().empty()) {
+    ss << " -fprofile-use=" << profile_use.get();
+  } else if (!profile_sample_use.get().empty()) {
+    ss << (is_clang ? " -fprofile-sample-use=" : " -fauto-profile=") << profile_sample_use.get();
+  }
+  if (!profile_use.get().empty() || !profile_sample_use.get().empty()) {
+    // a profile is collected on a previous version of the code, the functions changed since then are just optimized without it
+    ss << (is_clang ? " -Wno-profile-instr-out-of-date -Wno-profile-instr-unprofiled" : " -Wno-missing-profile -Wno-coverage-mismatch");
+  }
   #if __cplusplus <= 201703L
     ss << " -std=c++17";
   #elif __cplusplus <= 202002L
@@ -368,6 +467,12 @@ void CompilerSettings::init() {
   remove_extra_spaces(extra_ld_flags.value_);
 
   ld_flags.value_ = extra_ld_flags.get();
+  if (lto.get()) {
+    ld_flags.value_ += is_clang ? " -flto=thin" : " -flto=auto";
+  }
+  if (!profile_generate_dir.get().empty()) {
+    ld_flags.value_ += " -fprofile-generate=" + profile_generate_dir.get();
+  }
   append_apple_options(cxx_default_flags, ld_flags.value_);
   std::vector<vk::string_view> system_installed_static_libs{};
   std::vector<vk::string_view> system_installed_dynamic_libs{"pthread", "m", "dl"};
@@ -447,6 +552,7 @@ void CompilerSettings::init() {
   tl_classname_prefix.value_ = "C$VK$TL$";
 
   option_as_dir(composer_root);
+  option_as_dir(frontend_cache_dir);
 }
 
 std::string CompilerSettings::read_runtime_sha256_file(const std::string &filename) {
@@ -151,6 +151,7 @@ public:
 
   KphpOption<std::string> stats_file;
   KphpOption<std::string> compilation_metrics_file;
+  KphpOption<std::string> build_trace_file;
   KphpOption<std::string> override_kphp_version;
   KphpOption<std::string> php_code_version;
   KphpOption<std::string> php_code_commit_hash;
@@ -164,6 +165,11 @@ public:
   KphpOption<std::string> extra_cxx_debug_level;
   KphpOption<std::string> archive_creator;
   KphpOption<bool> dynamic_incremental_linkage;
+  KphpOption<double> unity_build_tu_time;
+  KphpOption<bool> lto;
+  KphpOption<std::string> profile_generate_dir;
+  KphpOption<std::string> profile_use;
+  KphpOption<std::string> profile_sample_use;
 
   KphpOption<double> debug_info_force_disable_prob;
   KphpOption<uint64_t> debug_info_force_disable_prob_seed;
@@ -171,10 +177,12 @@ public:
   KphpOption<uint64_t> profiler_level;
   KphpOption<bool> enable_global_vars_memory_stats;
   KphpOption<bool> enable_full_performance_analyze;
+  KphpOption<bool> auto_apply_performance_inspections;
   KphpOption<bool> print_resumable_graph;
 
   KphpOption<bool> no_pch;
   KphpOption<bool> no_index_file;
+  KphpOption<std::string> frontend_cache_dir;
   KphpOption<bool> show_progress;
 
   CxxFlags cxx_flags_default;
@@ -194,6 +202,7 @@ public:
 
   KphpImplicitOption runtime_headers;
   KphpImplicitOption runtime_sha256;
+  KphpImplicitOption profile_sha256;
 
   KphpImplicitOption tl_namespace_prefix;
   KphpImplicitOption tl_classname_prefix;
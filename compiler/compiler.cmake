@@ -26,6 +26,7 @@ prepend(KPHP_COMPILER_COMMON ${COMMON_DIR}/
 
 prepend(KPHP_COMPILER_THREADING_SOURCES threading/
         allocator.cpp
+        build-trace.cpp
         profiler.cpp
         thread-id.cpp)
 
@@ -103,6 +104,7 @@ prepend(KPHP_COMPILER_CODEGEN_SOURCES code-gen/
         files/shape-keys.cpp
         files/tracing-autogen.cpp
         files/type-tagger.cpp
+        files/unity-source.cpp
         includes.cpp
         raw-data.cpp
         vertex-compiler.cpp
@@ -206,6 +208,7 @@ prepend(KPHP_COMPILER_SOURCES ${KPHP_COMPILER_DIR}/
         cpp-dest-dir-initializer.cpp
         debug.cpp
         compiler-settings.cpp
+        frontend-cache.cpp
         function-colors.cpp
         gentree.cpp
         vertex-util.cpp
@@ -221,6 +224,7 @@ prepend(KPHP_COMPILER_SOURCES ${KPHP_COMPILER_DIR}/
         stats.cpp
         type-hint.cpp
         tl-classes.cpp
+        unity-build.cpp
         vertex.cpp
         utils/string-utils.cpp)
 
@@ -23,6 +23,7 @@
 
 #include "compiler/compiler-core.h"
 #include "compiler/cpp-dest-dir-initializer.h"
+#include "compiler/frontend-cache.h"
 #include "compiler/lexer.h"
 #include "compiler/make/make.h"
 #include "compiler/pipes/analyze-performance.h"
@@ -97,6 +98,8 @@
 #include "compiler/scheduler/pipe_with_progress.h"
 #include "compiler/scheduler/scheduler.h"
 #include "compiler/stage.h"
+#include "compiler/threading/build-trace.h"
+#include "compiler/unity-build.h"
 
 class lockf_wrapper {
   std::string locked_filename_;
@@ -185,6 +188,9 @@ bool compiler_execute(CompilerSettings *settings) {
   double st = dl_time();
   G = new CompilerCore();
   G->register_settings(settings);
+  if (!settings->build_trace_file.get().empty()) {
+    vk::singleton<BuildTrace>::get().enable(settings->build_trace_file.get());
+  }
   G->start();
   if (!settings->warnings_file.get().empty()) {
     FILE *f = fopen(settings->warnings_file.get().c_str(), "w");
@@ -229,6 +235,14 @@ bool compiler_execute(CompilerSettings *settings) {
     vk::singleton<CppDestDirInitializer>::get().initialize_async(scheduler_threads + 1);
   }
 
+  // tokens depend only on the lexer, which differs between kphp builds and between k2/non-k2 modes;
+  // get_version() isn't used, as --kphp-version-override may stay the same after an upgrade
+  vk::singleton<FrontendCache>::get().init(G->settings().frontend_cache_dir.get(),
+                                           std::string{get_version_string()} + "/" + G->settings().mode.get());
+  if (G->settings().unity_build_tu_time.get() > 0) {
+    vk::singleton<UnityBuild>::get().init(G->settings().dest_dir.get() + "unity_build_state");
+  }
+
   G->try_load_tl_classes();
   stage::set_name("Load Composer packages");
   G->init_composer_class_loader();
@@ -376,6 +390,8 @@ bool compiler_execute(CompilerSettings *settings) {
     run_make();
   }
 
+  vk::singleton<BuildTrace>::get().flush();
+
   const std::string compilation_metrics_file = G->settings().compilation_metrics_file.get();
   const std::string image_version = G->settings().build_timestamp.get();
   G->finish();
@@ -110,6 +110,7 @@ public:
   // or use bit fields like we do in vertex base class
   bool has_variadic_param = false;
   bool should_be_sync = false;
+  bool is_memoized = false;             // @kphp-memoize: results are cached between requests, see check_memoized_functions()
   bool should_not_throw = false;
   bool kphp_lib_export = false;
   bool is_auto_inherited = false;
@@ -0,0 +1,210 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/frontend-cache.h"
+
+#include <cstdio>
+#include <memory>
+#include <unistd.h>
+
+#include "common/containers/final_action.h"
+#include "common/php-functions.h"
+#include "common/wrappers/fmt_format.h"
+#include "common/wrappers/mkdir_recursive.h"
+
+#include "compiler/data/src-file.h"
+#include "compiler/kphp_assert.h"
+#include "compiler/stage.h"
+#include "compiler/utils/string-utils.h"
+
+namespace {
+
+// bump it on every change of the entry layout below
+constexpr uint32_t FRONTEND_CACHE_MAGIC = 0x4b464301; // "KFC" + format version
+// bump it on every change of the lexer output, so that the entries written by a development build without a new commit are dropped
+constexpr uint32_t LEXER_VERSION = 1;
+
+// string_views inside tokens either point to the file text or to a separate heap buffer (see string_view_dup in lexer)
+enum class TokenStrKind : uint8_t {
+  empty,
+  in_text,
+  own,
+};
+
+class EntryWriter {
+public:
+  explicit EntryWriter(FILE *f) : f_(f) {}
+
+  template<class T>
+  void write(const T &value) {
+    ok_ = ok_ && fwrite(&value, sizeof(T), 1, f_) == 1;
+  }
+
+  void write_bytes(const char *data, size_t len) {
+    ok_ = ok_ && (len == 0 || fwrite(data, len, 1, f_) == 1);
+  }
+
+  void write_str(vk::string_view s, vk::string_view text) {
+    if (s.empty()) {
+      write(TokenStrKind::empty);
+    } else if (s.begin() >= text.begin() && s.end() <= text.end()) {
+      write(TokenStrKind::in_text);
+      write(static_cast<uint32_t>(s.begin() - text.begin()));
+      write(static_cast<uint32_t>(s.size()));
+    } else {
+      write(TokenStrKind::own);
+      write(static_cast<uint32_t>(s.size()));
+      write_bytes(s.begin(), s.size());
+    }
+  }
+
+  bool ok() const { return ok_; }
+
+private:
+  FILE *f_;
+  bool ok_{true};
+};
+
+class EntryReader {
+public:
+  explicit EntryReader(FILE *f) : f_(f) {}
+
+  template<class T>
+  T read() {
+    T value{};
+    ok_ = ok_ && fread(&value, sizeof(T), 1, f_) == 1;
+    return value;
+  }
+
+  vk::string_view read_str(vk::string_view text) {
+    switch (read<TokenStrKind>()) {
+      case TokenStrKind::empty:
+        return {};
+      case TokenStrKind::in_text: {
+        const auto offset = read<uint32_t>();
+        const auto len = read<uint32_t>();
+        ok_ = ok_ && static_cast<size_t>(offset) + len <= text.size();
+        return ok_ ? text.substr(offset, len) : vk::string_view{};
+      }
+      case TokenStrKind::own: {
+        const auto len = read<uint32_t>();
+        std::string buf(len, '\0');
+        ok_ = ok_ && (len == 0 || fread(&buf[0], len, 1, f_) == 1);
+        return ok_ ? string_view_dup(buf) : vk::string_view{};
+      }
+    }
+    ok_ = false;
+    return {};
+  }
+
+  bool ok() const { return ok_; }
+
+private:
+  FILE *f_;
+  bool ok_{true};
+};
+
+uint64_t calc_text_hash(const std::string &text) {
+  return static_cast<uint64_t>(string_hash(text.c_str(), text.size()));
+}
+
+} // namespace
+
+void FrontendCache::init(const std::string &cache_dir, const std::string &compiler_version_key) {
+  cache_dir_.clear();
+  if (cache_dir.empty()) {
+    return;
+  }
+  if (!mkdir_recursive(cache_dir.c_str(), 0777)) {
+    kphp_warning(fmt_format("Can't create frontend cache dir '{}': {}, the cache is disabled", cache_dir, strerror(errno)));
+    return;
+  }
+  cache_dir_ = cache_dir;
+  const std::string version_key = compiler_version_key + "/lexer" + std::to_string(LEXER_VERSION);
+  compiler_version_hash_ = static_cast<uint64_t>(string_hash(version_key.c_str(), version_key.size()));
+}
+
+std::string FrontendCache::get_entry_path(SrcFilePtr file) const {
+  return fmt_format("{}{:016x}.tokens", cache_dir_, static_cast<uint64_t>(string_hash(file->file_name.c_str(), file->file_name.size())));
+}
+
+std::optional<std::vector<Token>> FrontendCache::load_tokens(SrcFilePtr file) {
+  if (!is_enabled()) {
+    return std::nullopt;
+  }
+
+  std::unique_ptr<FILE, int (*)(FILE *)> f{fopen(get_entry_path(file).c_str(), "rb"), fclose};
+  if (!f) {
+    ++misses_;
+    return std::nullopt;
+  }
+
+  EntryReader reader{f.get()};
+  const bool header_matches = reader.read<uint32_t>() == FRONTEND_CACHE_MAGIC
+                              && reader.read<uint64_t>() == compiler_version_hash_
+                              && reader.read<uint64_t>() == file->text.size()
+                              && reader.read<uint64_t>() == calc_text_hash(file->text);
+  if (!reader.ok() || !header_matches) {
+    ++misses_;
+    return std::nullopt;
+  }
+
+  const vk::string_view text{file->text};
+  const auto tokens_count = reader.read<uint32_t>();
+  std::vector<Token> tokens;
+  tokens.reserve(tokens_count);
+  for (uint32_t i = 0; i < tokens_count && reader.ok(); ++i) {
+    Token &token = tokens.emplace_back(static_cast<TokenType>(reader.read<uint16_t>()));
+    token.line_num = reader.read<int32_t>();
+    token.str_val = reader.read_str(text);
+    token.debug_str = reader.read_str(text);
+  }
+
+  // a broken entry is treated as a miss, it will be rewritten by store_tokens()
+  if (!reader.ok() || tokens.empty() || tokens.back().type() != tok_end) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  return tokens;
+}
+
+void FrontendCache::store_tokens(SrcFilePtr file, const std::vector<Token> &tokens) {
+  if (!is_enabled()) {
+    return;
+  }
+
+  const std::string entry_path = get_entry_path(file);
+  std::string tmp_path = entry_path + "XXXXXX";
+  const int tmp_fd = mkstemp(&tmp_path[0]);
+  if (tmp_fd == -1) {
+    kphp_warning(fmt_format("Can't create tmp file for frontend cache entry '{}': {}", entry_path, strerror(errno)));
+    return;
+  }
+  auto tmp_deleter = vk::finally([&tmp_path]() { unlink(tmp_path.c_str()); });
+  std::unique_ptr<FILE, int (*)(FILE *)> f{fdopen(tmp_fd, "wb"), fclose};
+  kphp_assert(f);
+
+  const vk::string_view text{file->text};
+  EntryWriter writer{f.get()};
+  writer.write(FRONTEND_CACHE_MAGIC);
+  writer.write(compiler_version_hash_);
+  writer.write(static_cast<uint64_t>(file->text.size()));
+  writer.write(calc_text_hash(file->text));
+  writer.write(static_cast<uint32_t>(tokens.size()));
+  for (const Token &token : tokens) {
+    writer.write(static_cast<uint16_t>(token.type()));
+    writer.write(static_cast<int32_t>(token.line_num));
+    writer.write_str(token.str_val, text);
+    writer.write_str(token.debug_str, text);
+  }
+
+  if (!writer.ok() || fclose(f.release()) != 0) {
+    kphp_warning(fmt_format("Can't write frontend cache entry '{}'", tmp_path));
+    return;
+  }
+  if (rename(tmp_path.c_str(), entry_path.c_str()) == -1) {
+    kphp_warning(fmt_format("Can't rename '{}' into '{}': {}", tmp_path, entry_path, strerror(errno)));
+  }
+}
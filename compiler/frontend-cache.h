@@ -0,0 +1,49 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+#include "compiler/data/data_ptr.h"
+#include "compiler/token.h"
+
+// FrontendCache is an on-disk cache of the lexer output (FileToTokensF) of every source file, shared between kphp2cpp launches
+// every entry is keyed by the source file path, validated by a hash of its contents and by a hash of the compiler build identity,
+// so a stale entry is never used: it's just overwritten after the file is processed again
+// ASTs and inference results are not cached: gentree registers functions, classes and constants in CompilerCore while parsing,
+// so the trees point to the objects of the current launch, and the types of a function depend on its callers,
+// not only on its CalcFuncDepPass dependencies, so parsing and type inference still run over the whole codebase
+class FrontendCache : vk::not_copyable {
+public:
+  friend class vk::singleton<FrontendCache>;
+
+  // an empty cache_dir disables the cache
+  void init(const std::string &cache_dir, const std::string &compiler_version_key);
+  bool is_enabled() const { return !cache_dir_.empty(); }
+
+  std::optional<std::vector<Token>> load_tokens(SrcFilePtr file);
+  void store_tokens(SrcFilePtr file, const std::vector<Token> &tokens);
+
+  uint64_t get_hits() const { return hits_; }
+  uint64_t get_misses() const { return misses_; }
+
+private:
+  FrontendCache() = default;
+
+  std::string get_entry_path(SrcFilePtr file) const;
+
+  std::string cache_dir_;
+  uint64_t compiler_version_hash_{0};
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
@@ -262,6 +262,8 @@ int main(int argc, char *argv[]) {
              "stats-file", "KPHP_STATS_FILE");
   parser.add("Save transpilation metrics to file", settings->compilation_metrics_file,
              "compilation-metrics-file", "KPHP_COMPILATION_METRICS_FILE");
+  parser.add("Save a timeline of transpilation pipes and make jobs to file in Chrome trace format, and print its summary", settings->build_trace_file,
+             "build-trace-file", "KPHP_BUILD_TRACE_FILE");
   parser.add("Override kphp version string", settings->override_kphp_version,
              "kphp-version-override", "KPHP_VERSION_OVERRIDE");
   parser.add("Specify the compiled php code version", settings->php_code_version,
@@ -287,18 +289,32 @@ int main(int argc, char *argv[]) {
              "archive-creator", "KPHP_ARCHIVE_CREATOR", "ar");
   parser.add("Use dynamic incremental linkage for building the output binary", settings->dynamic_incremental_linkage,
              "dynamic-incremental-linkage", "KPHP_DYNAMIC_INCREMENTAL_LINKAGE");
+  parser.add("Compile generated functions in unity translation units of about the given compile time in seconds, 0 disables it", settings->unity_build_tu_time,
+             "unity-build-tu-time", "KPHP_UNITY_BUILD_TU_TIME", "0");
+  parser.add("Use link time optimization across the generated code and the runtime: ThinLTO for clang, LTO for gcc", settings->lto,
+             "lto", "KPHP_LTO");
+  parser.add("Build an instrumented binary, that writes execution profiles into the given directory", settings->profile_generate_dir,
+             "profile-generate", "KPHP_PROFILE_GENERATE");
+  parser.add("Optimize the output binary with an instrumentation profile: a .profdata file for clang, a directory with .gcda files for gcc", settings->profile_use,
+             "profile-use", "KPHP_PROFILE_USE");
+  parser.add("Optimize the output binary with a sampling (AutoFDO) profile converted from perf data", settings->profile_sample_use,
+             "profile-sample-use", "KPHP_PROFILE_SAMPLE_USE");
   parser.add("Profile functions: 0 - disabled, 1 - enabled for marked functions, 2 - enabled for all", settings->profiler_level,
              'g', "profiler", "KPHP_PROFILER", "0", {"0", "1", "2"});
   parser.add("Enable an ability to get global vars memory stats", settings->enable_global_vars_memory_stats,
              "enable-global-vars-memory-stats", "KPHP_ENABLE_GLOBAL_VARS_MEMORY_STATS");
   parser.add("Enable all inspections available for @kphp-analyze-performance for all reachable functions", settings->enable_full_performance_analyze,
              "enable-full-performance-analyze", "KPHP_ENABLE_FULL_PERFORMANCE_ANALYZE");
+  parser.add("Apply the safe rewrites suggested by performance inspections instead of warning about them", settings->auto_apply_performance_inspections,
+             "auto-apply-performance-inspections", "KPHP_AUTO_APPLY_PERFORMANCE_INSPECTIONS");
   parser.add("Print graph of resumable calls to stderr", settings->print_resumable_graph,
              'p', "print-graph", "KPHP_PRINT_RESUMABLE_GRAPH");
   parser.add("Forbid to use the precompile header", settings->no_pch,
              "no-pch", "KPHP_NO_PCH");
   parser.add("Forbid to use an index file which contains codegen hashes from previous compilation", settings->no_index_file,
              "no-index-file", "KPHP_NO_INDEX_FILE");
+  parser.add("Directory for caching lexer tokens of source files between launches, disabled if empty", settings->frontend_cache_dir,
+             "frontend-cache-dir", "KPHP_FRONTEND_CACHE_DIR");
   parser.add("Show transpilation progress", settings->show_progress,
              "show-progress", "KPHP_SHOW_PROGRESS");
   parser.add("A folder that contains composer.json file", settings->composer_root,
@@ -321,6 +337,7 @@ int main(int argc, char *argv[]) {
   parser.add_implicit_option("Static lib name", settings->static_lib_name);
   parser.add_implicit_option("Build timestamp", settings->build_timestamp);
   parser.add_implicit_option("Runtime SHA256", settings->runtime_sha256);
+  parser.add_implicit_option("Profile SHA256", settings->profile_sha256);
   parser.add_implicit_option("Runtime headers", settings->runtime_headers);
   parser.add_implicit_option("C++ compiler flags default", settings->cxx_flags_default.flags);
   parser.add_implicit_option("C++ compiler flags default SHA256", settings->cxx_flags_default.flags_sha256);
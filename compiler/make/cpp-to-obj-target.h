@@ -34,7 +34,7 @@ public:
     return ss.str();
   }
 
-  void compute_priority() final {
+  void compute_priority() override {
     priority = 0;
     for (auto *dep : deps) {
       if (File *dep_file = dep->get_file()) {
@@ -10,6 +10,7 @@
 #include "common/server/signals.h"
 
 #include "compiler/compiler-core.h"
+#include "compiler/threading/build-trace.h"
 #include "compiler/utils/string-utils.h"
 
 void MakeRunner::run_target(Target *target) {
@@ -128,6 +129,7 @@ bool MakeRunner::start_job(Target *target) {
     return false;
   }
   jobs[pid] = target;
+  trace_job_started(target);
   return true;
 }
 
@@ -135,10 +137,12 @@ bool MakeRunner::finish_job(int pid, int return_code, int by_signal) {
   auto it = jobs.find(pid);
   assert (it != jobs.end());
   Target *target = it->second;
+  target->finish_time = dl_time();
   if (stats_file_) {
-    double passed = dl_time() - target->start_time;
+    double passed = target->finish_time - target->start_time;
     fmt_fprintf(stats_file_, "{}s {}\n", passed, target->get_name());
   }
+  trace_job_finished(target);
   jobs.erase(it);
   if (return_code != 0) {
     if (!fail_flag) {
@@ -275,9 +279,62 @@ bool MakeRunner::make_targets(const std::vector<Target *> &targets, const std::s
   for (auto *target : targets) {
     is_ready = is_ready && target->is_ready;
   }
+  trace_critical_path(build_message);
   return !fail_flag && is_ready;
 }
 
+void MakeRunner::trace_job_started(Target *target) {
+  if (!vk::singleton<BuildTrace>::get().is_enabled()) {
+    return;
+  }
+  auto free_lane = std::find(busy_trace_lanes.begin(), busy_trace_lanes.end(), false);
+  target->trace_lane = static_cast<int>(free_lane - busy_trace_lanes.begin());
+  if (free_lane == busy_trace_lanes.end()) {
+    busy_trace_lanes.push_back(true);
+  } else {
+    *free_lane = true;
+  }
+}
+
+void MakeRunner::trace_job_finished(Target *target) {
+  if (target->trace_lane < 0) {
+    return;
+  }
+  busy_trace_lanes[target->trace_lane] = false;
+  vk::singleton<BuildTrace>::get().on_make_job(target->get_name(), target->trace_lane, target->start_time, target->finish_time);
+}
+
+// the critical path of an actual schedule: start from the job finished last and go back through a dependency finished last,
+// i.e. through the one that delayed the start of the job
+void MakeRunner::trace_critical_path(const std::string &build_message) {
+  if (!vk::singleton<BuildTrace>::get().is_enabled()) {
+    return;
+  }
+  const auto finished_later = [](const Target *a, const Target *b) {
+    return a->finish_time < b->finish_time;
+  };
+
+  Target *cur = nullptr;
+  for (Target *target : all_targets) {
+    if (target->trace_lane >= 0 && (!cur || finished_later(cur, target))) {
+      cur = target;
+    }
+  }
+  std::vector<BuildTrace::Event> critical_path;
+  while (cur) {
+    critical_path.emplace_back(BuildTrace::Event{cur->get_name(), {}, BuildTrace::CATEGORY_MAKE, cur->trace_lane, cur->start_time, cur->finish_time});
+    Target *next = nullptr;
+    for (Target *dep : cur->deps) {
+      if (dep->trace_lane >= 0 && (!next || finished_later(next, dep))) {
+        next = dep;
+      }
+    }
+    cur = next;
+  }
+  std::reverse(critical_path.begin(), critical_path.end());
+  vk::singleton<BuildTrace>::get().on_make_critical_path(build_message, std::move(critical_path));
+}
+
 MakeRunner::MakeRunner(FILE *stats_file) noexcept:
   stats_file_(stats_file) {
 }
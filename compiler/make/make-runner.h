@@ -26,6 +26,7 @@ private:
 
   std::priority_queue<Target *, std::vector<Target *>, compare_by_priority> pending_jobs;
   std::map<int, Target *> jobs;
+  std::vector<bool> busy_trace_lanes;
 
   bool fail_flag = false;
   static int signal_flag;
@@ -41,6 +42,10 @@ private:
   void wait_target(Target *target);
   void require_target(Target *target);
 
+  void trace_job_started(Target *target);
+  void trace_job_finished(Target *target);
+  void trace_critical_path(const std::string &build_message);
+
 public:
   void register_target(Target *target, std::vector<Target *> &&deps);
   bool make_targets(const std::vector<Target *> &target, const std::string &build_message, std::size_t jobs_count = 32);
@@ -32,6 +32,7 @@
 #include "compiler/make/objs-to-obj-target.h"
 #include "compiler/make/objs-to-static-lib-target.h"
 #include "compiler/make/runtime-src-to-obj-target.h"
+#include "compiler/make/unity-cpp-to-obj-target.h"
 #include "compiler/runtime_build_info.h"
 #include "compiler/stage.h"
 #include "compiler/threading/profiler.h"
@@ -95,6 +96,10 @@ public:
     return create_target(new Cpp2ObjTarget(), to_targets(cpp), obj);
   }
 
+  Target *create_unity_cpp2obj_target(File *cpp, File *obj, std::vector<std::string> source_paths, std::vector<File *> source_files) {
+    return create_target(new UnityCpp2ObjTarget(std::move(source_paths), std::move(source_files)), to_targets(cpp), obj);
+  }
+
   Target *create_h2pch_target(File *header_h, File *pch) {
     return create_target(new H2PchTarget(), to_targets(header_h), pch);
   }
@@ -363,12 +368,37 @@ static std::unordered_map<File *, long long> create_dep_mtime(const Index &cpp_d
 static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, const Index &cpp_dir,
                                             const std::forward_list<Index> &imported_headers) {
   std::unordered_map<File *, long long> dep_mtime = create_dep_mtime(cpp_dir, imported_headers);
+
+  // the sources included by unity sources are not compiled on their own, see UnityBuild
+  const std::string unity_subdir = std::string{UnityBuild::SUBDIR} + "/";
+  std::unordered_map<File *, std::vector<std::string>> unity_sources;
+  std::unordered_set<File *> sources_in_unity;
+  for (const auto &cpp_file : cpp_dir.get_files()) {
+    if (cpp_file->ext == ".cpp" && cpp_file->subdir == unity_subdir) {
+      for (const auto &include : cpp_file->includes) {
+        if (vk::string_view{include}.ends_with(".cpp")) {
+          unity_sources[cpp_file].emplace_back(include);
+          sources_in_unity.insert(cpp_dir.get_file(include));
+        }
+      }
+    }
+  }
+
   std::vector<File *> objs;
   for (const auto &cpp_file : cpp_dir.get_files()) {
-    if (cpp_file->ext == ".cpp") {
+    if (cpp_file->ext == ".cpp" && !vk::contains(sources_in_unity, cpp_file)) {
       File *obj_file = obj_dir.insert_file(static_cast<std::string>(cpp_file->name_without_ext) + ".o");
       obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
-      make->create_cpp2obj_target(cpp_file, obj_file);
+      auto unity_it = unity_sources.find(cpp_file);
+      if (unity_it != unity_sources.end()) {
+        std::vector<File *> source_files;
+        for (const auto &source_path : unity_it->second) {
+          source_files.emplace_back(cpp_dir.get_file(source_path));
+        }
+        make->create_unity_cpp2obj_target(cpp_file, obj_file, std::move(unity_it->second), std::move(source_files));
+      } else {
+        make->create_cpp2obj_target(cpp_file, obj_file);
+      }
       Target *cpp_target = cpp_file->target;
       cpp_target->force_changed(dep_mtime[cpp_file]);
       objs.push_back(obj_file);
@@ -376,6 +406,12 @@ static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, con
   }
   fmt_fprintf(stderr, "objs cnt = {}\n", objs.size());
 
+  // with LTO, a partial link would either run the optimization per subdir or keep the bitcode anyway,
+  // so all the objects are passed to the final link as is
+  if (G->settings().lto.get()) {
+    return objs;
+  }
+
   std::map<vk::string_view, std::vector<File *>> subdirs;
   std::vector<File *> tmp_objs;
   for (auto *obj_file : objs) {
@@ -592,6 +628,9 @@ void run_make() {
 
   bool ok = make.make_target(&bin_file, build_stage, settings.jobs_count.get());
   kphp_error(ok, build_stage + " stage failure");
+  if (vk::singleton<UnityBuild>::get().is_enabled()) {
+    vk::singleton<UnityBuild>::get().save_state();
+  }
 
   if (make_stats_file) {
     fclose(make_stats_file);
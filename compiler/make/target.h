@@ -24,6 +24,7 @@ private:
   bool is_required = false;
   bool is_waiting = false;
   bool is_ready = false;
+  int trace_lane = -1;
   File *file = nullptr;
 
 protected:
@@ -34,7 +35,8 @@ protected:
   const CompilerSettings *settings{nullptr};
 public:
   long long priority;
-  double start_time;
+  double start_time = 0;
+  double finish_time = 0;
   Target() = default;
   virtual ~Target() = default;
 
@@ -0,0 +1,32 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "compiler/make/cpp-to-obj-target.h"
+#include "compiler/unity-build.h"
+
+// a unity translation unit, see UnityBuild: the measured compile time is used to balance the units at the next launch
+class UnityCpp2ObjTarget final : public Cpp2ObjTarget {
+public:
+  UnityCpp2ObjTarget(std::vector<std::string> source_paths, std::vector<File *> source_files) noexcept :
+    source_paths_(std::move(source_paths)),
+    source_files_(std::move(source_files)) {}
+
+  void compute_priority() final {
+    Cpp2ObjTarget::compute_priority();
+    for (File *source : source_files_) {
+      priority += source->file_size;
+    }
+  }
+
+  bool after_run_success() final {
+    vk::singleton<UnityBuild>::get().on_unity_compiled(source_paths_, finish_time - start_time);
+    return Cpp2ObjTarget::after_run_success();
+  }
+
+private:
+  std::vector<std::string> source_paths_;
+  std::vector<File *> source_files_;
+};
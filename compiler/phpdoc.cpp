@@ -42,7 +42,7 @@ struct KnownPhpDocTag {
 };
 
 class AllDocTags {
-  static constexpr int N_TAGS = 42;
+  static constexpr int N_TAGS = 43;
   static const KnownPhpDocTag ALL_TAGS[N_TAGS];
 
 public:
@@ -79,6 +79,7 @@ const KnownPhpDocTag AllDocTags::ALL_TAGS[] = {
   KnownPhpDocTag("@kphp-required", PhpDocType::kphp_required),
   KnownPhpDocTag("@kphp-lib-export", PhpDocType::kphp_lib_export),
   KnownPhpDocTag("@kphp-sync", PhpDocType::kphp_sync),
+  KnownPhpDocTag("@kphp-memoize", PhpDocType::kphp_memoize),
   KnownPhpDocTag("@kphp-should-not-throw", PhpDocType::kphp_should_not_throw),
   KnownPhpDocTag("@kphp-throws", PhpDocType::kphp_throws),
   KnownPhpDocTag("@kphp-disable-warnings", PhpDocType::kphp_disable_warnings),
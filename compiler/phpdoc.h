@@ -25,6 +25,7 @@ enum class PhpDocType {
   kphp_required,
   kphp_lib_export,
   kphp_sync,
+  kphp_memoize,
   kphp_should_not_throw,
   kphp_throws,
   kphp_template,
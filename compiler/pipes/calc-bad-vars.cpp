@@ -13,7 +13,9 @@
 #include "compiler/data/class-data.h"
 #include "compiler/data/data_ptr.h"
 #include "compiler/data/src-file.h"
+#include "compiler/data/var-data.h"
 #include "compiler/function-pass.h"
+#include "compiler/inferring/public.h"
 #include "compiler/kphp_assert.h"
 #include "compiler/pipes/calc-func-dep.h"
 #include "compiler/utils/idmap.h"
@@ -630,6 +632,60 @@ class CalcBadVars {
     }
   }
 
+  // @kphp-memoize functions are cached between requests, so their result must depend only on arguments (and confdata):
+  // neither such a function nor anything it calls may touch globals / static vars, perform net queries
+  // or call builtins with side effects (see is_memoize_safe_builtin());
+  // arguments are a part of a cache key (a returned instance is checked in final-check.cpp)
+  static void check_memoized_functions(const FuncCallGraph &call_graph, const std::vector<DepData> &dep_datas) {
+    IdMap<char> uses_mutable_globals(call_graph.n);
+    IdMap<FunctionPtr> impure_builtin_call(call_graph.n);
+    for (int i = 0; i < call_graph.n; ++i) {
+      uses_mutable_globals[call_graph.functions[i]] = dep_datas[i].uses_mutable_globals;
+      impure_builtin_call[call_graph.functions[i]] = dep_datas[i].impure_builtin_call;
+    }
+
+    for (FunctionPtr func : call_graph.functions) {
+      if (!func->is_memoized) {
+        continue;
+      }
+      stage::set_function(func);
+      for (VarPtr param : func->param_ids) {
+        const TypeData *param_type = tinf::get_type(param);
+        kphp_error(!param->is_reference && !param_type->use_optional() && vk::any_of_equal(param_type->ptype(), tp_int, tp_float, tp_string, tp_bool),
+                   fmt_format("@kphp-memoize function parameters can only be int, float, string or bool, but ${} is {}",
+                              param->name, param_type->as_human_readable()));
+      }
+      kphp_error(!func->has_variadic_param, "@kphp-memoize function can't be variadic");
+
+      IdMap<char> reachable(call_graph.n);
+      IdMap<FunctionPtr> parents(call_graph.n);
+      mark(call_graph.graph, reachable, func, parents);
+      for (FunctionPtr f : call_graph.functions) {
+        if (!reachable[f]) {
+          continue;
+        }
+        if (uses_mutable_globals[f]) {
+          kphp_error(false, fmt_format("@kphp-memoize function {} is not pure: it uses global or static variables\n"
+                                       "Globals are used along the following chain:\n{}\n",
+                                       func->as_human_readable(), get_call_path(f, parents)));
+          break;
+        }
+        if (impure_builtin_call[f]) {
+          kphp_error(false, fmt_format("@kphp-memoize function {} is not pure: it calls {}(), which may have side effects or depend on something besides its arguments\n"
+                                       "The builtin is called along the following chain:\n{}\n",
+                                       func->as_human_readable(), impure_builtin_call[f]->name, get_call_path(f, parents)));
+          break;
+        }
+        if (f->is_resumable) {
+          kphp_error(false, fmt_format("@kphp-memoize function {} is not pure: it is resumable\n"
+                                       "Function transitively calls the resumable function along the following chain:\n{}\n",
+                                       func->as_human_readable(), get_call_path(f, parents)));
+          break;
+        }
+      }
+    }
+  }
+
   void save_func_dep(const FuncCallGraph &call_graph) {
     for (int i = 0; i < call_graph.n; i++) {
       FunctionPtr function = call_graph.functions[i];
@@ -735,6 +791,7 @@ public:
       } else {
         calc_resumable(call_graph, dep_datas);
       }
+      check_memoized_functions(call_graph, dep_datas);
       generate_bad_vars(call_graph, dep_datas);
       check_func_colors(call_graph);
       save_func_dep(call_graph);
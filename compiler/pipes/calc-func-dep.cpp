@@ -4,12 +4,49 @@
 
 #include "compiler/pipes/calc-func-dep.h"
 
+#include <unordered_set>
+
+#include "common/wrappers/string_view.h"
+
 #include "auto/compiler/vertex/vertex-types.h"
 #include "compiler/data/class-data.h"
 #include "compiler/data/var-data.h"
 #include "compiler/inferring/public.h"
 #include "compiler/vertex.h"
 
+namespace {
+
+// @kphp-memoize functions may call only the builtins whose result depends on arguments (and confdata) and which have no side effects:
+// it's a whitelist, as most builtins do I/O, depend on time or randomness, or touch some runtime state
+bool is_memoize_safe_builtin(FunctionPtr function) {
+  static const std::unordered_set<vk::string_view> safe_builtins{
+    // strings
+    "strlen", "substr", "_tmp_substr", "str_repeat", "str_pad", "str_replace", "str_ireplace", "str_split", "str_starts_with",
+    "str_ends_with", "str_contains", "strpos", "stripos", "strrpos", "strripos", "strstr", "strtr", "strrev", "strcmp", "strcasecmp",
+    "strncmp", "strtolower", "strtoupper", "ucfirst", "lcfirst", "ucwords", "trim", "ltrim", "rtrim", "_tmp_trim", "implode", "join",
+    "explode", "_explode_nth", "_explode_1", "_explode_tuple2", "_explode_tuple3", "_explode_tuple4", "sprintf", "vsprintf",
+    "number_format", "htmlspecialchars", "addslashes", "nl2br", "wordwrap", "ord", "chr", "bin2hex", "hex2bin", "base64_encode",
+    "base64_decode", "urlencode", "rawurlencode", "urldecode", "rawurldecode", "md5", "sha1", "crc32", "mb_strlen", "mb_substr",
+    "mb_strtolower", "mb_strtoupper", "preg_match", "preg_replace", "preg_split", "preg_quote", "json_encode", "json_decode",
+    "intval", "floatval", "strval", "boolval", "is_numeric", "is_null", "is_bool", "is_int", "is_float", "is_string", "is_array",
+    "is_object", "is_scalar", "gettype", "get_class",
+    // arrays
+    "count", "sizeof", "array_keys", "array_values", "array_merge", "_array_merge_self", "_array_reserve_for_push_back",
+    "array_slice", "array_splice", "array_reverse", "array_flip", "array_unique", "array_fill", "array_fill_keys", "array_pad",
+    "array_combine", "array_chunk", "array_column", "array_diff", "array_diff_key", "array_intersect", "array_intersect_key",
+    "array_key_exists", "array_search", "in_array", "array_sum", "array_product", "array_map", "array_filter", "array_reduce",
+    "array_push", "array_pop", "array_shift", "array_unshift", "array_first_key", "array_first_value", "array_last_key",
+    "array_last_value", "array_key_first", "array_key_last", "range", "sort", "rsort", "usort", "ksort", "krsort", "uksort", "asort", "arsort", "uasort", "min", "max",
+    // confdata is a part of the cache key
+    "is_confdata_loaded", "confdata_get_value", "confdata_get_values_by_any_wildcard", "confdata_get_values_by_predefined_wildcard",
+    // exceptions are not cached
+    "_exception_set_location",
+  };
+  return function->is_pure || safe_builtins.count(function->name);
+}
+
+} // namespace
+
 VertexPtr CalcFuncDepPass::on_enter_vertex(VertexPtr vertex) {
   if (!calls.empty() && calls.back()->is_extern() && vertex->type() == op_callback_of_builtin) {
     FunctionPtr callback_passed_to_extern_func = vertex.as<op_callback_of_builtin>()->func_id;
@@ -64,6 +101,9 @@ VertexPtr CalcFuncDepPass::on_enter_vertex(VertexPtr vertex) {
     }
     calls.push_back(other_function);
     if (other_function->is_extern()) {
+      if (!data.impure_builtin_call && !is_memoize_safe_builtin(other_function)) {
+        data.impure_builtin_call = other_function;
+      }
       if (other_function->cpp_template_call) {
         const auto *tp = tinf::get_type(call);
         if (auto klass = tp->class_type()) {
@@ -102,6 +142,7 @@ VertexPtr CalcFuncDepPass::on_enter_vertex(VertexPtr vertex) {
     data.dep.push_back(as_callback_of_builtin->func_id);
   } else if (auto var_vertex = vertex.try_as<op_var>()) {
     VarPtr var = var_vertex->var_id;
+    data.uses_mutable_globals |= var->is_in_global_scope();
     // here we add var for later ub check; we store only vars that can potentially lead to ub, see check-ub.cpp
     if ((var->is_global_var() || var->is_class_static_var()) &&   // only globals (not even static inside functions)
         vertex->rl_type == val_l &&                               // only modified in one way or another
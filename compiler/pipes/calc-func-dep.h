@@ -14,6 +14,8 @@
 struct DepData : private vk::movable_only {
   std::vector<FunctionPtr> dep;               // functions accessible directly from the current (called or lambdas) (except extern)
   std::vector<VarPtr> modified_global_vars;   // val_l globals for ub check later
+  bool uses_mutable_globals{false};           // any global or static var, to check @kphp-memoize purity
+  FunctionPtr impure_builtin_call;            // the first called builtin not known to be side-effect free, to check @kphp-memoize purity
 
   std::forward_list<VarPtr> ref_param_vars;                       // param &$refs from func declaration
   std::forward_list<std::pair<VarPtr, VarPtr>> ref_ref_edges;     // calls to f($v) when $v is a reference
@@ -22,6 +22,7 @@
 #include "compiler/code-gen/files/tl2cpp/tl2cpp.h"
 #include "compiler/code-gen/files/tracing-autogen.h"
 #include "compiler/code-gen/files/type-tagger.h"
+#include "compiler/code-gen/files/unity-source.h"
 #include "compiler/code-gen/raw-data.h"
 #include "compiler/compiler-core.h"
 #include "compiler/cpp-dest-dir-initializer.h"
@@ -33,6 +34,7 @@
 #include "compiler/inferring/public.h"
 #include "compiler/pipes/collect-forkable-types.h"
 #include "compiler/type-hint.h"
+#include "compiler/unity-build.h"
 
 void CodeGenF::execute(FunctionPtr function, DataStream<std::unique_ptr<CodeGenRootCmd>> &unused_os __attribute__ ((unused))) {
   if (function->does_need_codegen() || function->is_imported_from_static_lib()) {
@@ -69,6 +71,9 @@ void CodeGenF::on_finish(DataStream<std::unique_ptr<CodeGenRootCmd>> &os) {
     code_gen_start_root_task(os, std::make_unique<FunctionH>(f));
     code_gen_start_root_task(os, std::make_unique<FunctionCpp>(f));
   }
+  if (vk::singleton<UnityBuild>::get().is_enabled()) {
+    generate_unity_sources(all_functions, os);
+  }
 
   for (ClassPtr c : all_classes) {
     if (c->kphp_json_tags && G->get_class("JsonEncoder")->is_parent_of(c)) {
@@ -181,6 +186,35 @@ void CodeGenF::prepare_generate_function(FunctionPtr func) {
   }
 }
 
+// function sources are still generated one per function, but they are compiled only as a part of unity sources, see UnityBuild
+void CodeGenF::generate_unity_sources(const std::forward_list<FunctionPtr> &all_functions, DataStream<std::unique_ptr<CodeGenRootCmd>> &os) {
+  auto get_source_path = [](FunctionPtr f) {
+    return f->src_name.empty() || f->is_imported_from_static_lib() ? std::string{} : f->subdir + "/" + f->src_name;
+  };
+
+  std::vector<UnityBuild::Source> sources;
+  for (FunctionPtr f : all_functions) {
+    std::string path = get_source_path(f);
+    if (path.empty()) {
+      continue;
+    }
+    UnityBuild::Source &source = sources.emplace_back(UnityBuild::Source{std::move(path), {}});
+    for (FunctionPtr dep : f->dep) {
+      std::string dep_path = get_source_path(dep);
+      if (!dep_path.empty()) {
+        source.deps.emplace_back(std::move(dep_path));
+      }
+    }
+  }
+
+  auto &unity_build = vk::singleton<UnityBuild>::get();
+  auto units = unity_build.assign(std::move(sources), G->settings().unity_build_tu_time.get(), 2 * G->settings().jobs_count.get());
+  unity_build.save_state();
+  for (auto &[unity_id, unit_sources] : units) {
+    code_gen_start_root_task(os, std::make_unique<UnityCpp>(unity_id, std::move(unit_sources)));
+  }
+}
+
 std::string CodeGenF::shorten_occurence_of_class_in_file_name(ClassPtr occuring_class, const std::string &file_name) {
   size_t pos = occuring_class->name.rfind('\\');
   if (pos == std::string::npos) {
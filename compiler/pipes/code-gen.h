@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <forward_list>
+
 #include "compiler/code-gen/code-gen-root-cmd.h"
 #include "compiler/code-gen/writer-data.h"
 #include "compiler/pipes/sync.h"
@@ -18,6 +20,7 @@ class CodeGenF final : public SyncPipeF<FunctionPtr, std::unique_ptr<CodeGenRoot
 
   void prepare_generate_function(FunctionPtr func);
   std::string calc_subdir_for_function(FunctionPtr func);
+  void generate_unity_sources(const std::forward_list<FunctionPtr> &all_functions, DataStream<std::unique_ptr<CodeGenRootCmd>> &os);
   std::string shorten_occurence_of_class_in_file_name(ClassPtr occuring_class, const std::string &file_name);
 
 public:
@@ -5,6 +5,7 @@
 #include "compiler/pipes/file-to-tokens.h"
 
 #include "compiler/data/src-file.h"
+#include "compiler/frontend-cache.h"
 #include "compiler/lexer.h"
 #include "compiler/stage.h"
 #include "compiler/threading/profiler.h"
@@ -15,11 +16,19 @@ void FileToTokensF::execute(SrcFilePtr file, DataStream<std::pair<SrcFilePtr, st
   kphp_assert(file);
 
   kphp_assert(file->loaded);
+  auto &frontend_cache = vk::singleton<FrontendCache>::get();
+  if (auto cached_tokens = frontend_cache.load_tokens(file)) {
+    os << std::make_pair(file, std::move(*cached_tokens));
+    return;
+  }
+
   auto tokens = php_text_to_tokens(file->text);
 
   if (stage::has_error()) {
     return;
   }
 
+  frontend_cache.store_tokens(file, tokens);
+
   os << std::make_pair(file, std::move(tokens));
 }
@@ -145,15 +145,13 @@ void check_instance_cache_fetch_call(VertexAdaptor<op_func_call> call) {
   }
 }
 
-void check_instance_cache_store_call(VertexAdaptor<op_func_call> call) {
-  const auto *type = tinf::get_type(call->args()[1]);
-  kphp_error_return(type->ptype() == tp_Class, "Called instance_cache_store() with a non-instance argument");
-  auto klass = type->class_type();
-  kphp_error(!klass->is_empty_class(), fmt_format("Can not store instance of empty class {} with instance_cache_store call", klass->name));
+// `where` is used in error messages: instance_cache_store call, @kphp-memoize function
+void check_instance_cache_stored_class(ClassPtr klass, const char *where) {
+  kphp_error(!klass->is_empty_class(), fmt_format("Can not store instance of empty class {} with {}", klass->name, where));
 
   kphp_error_return(klass->is_immutable || klass->is_interface(),
-                    fmt_format("Can not store instance of mutable class {} with instance_cache_store call", klass->name));
-  kphp_error_return(klass->is_serializable, fmt_format("Can not store instance of non-serializable class {} with instance_cache_store call", klass->name));
+                    fmt_format("Can not store instance of mutable class {} with {}", klass->name, where));
+  kphp_error_return(klass->is_serializable, fmt_format("Can not store instance of non-serializable class {} with {}", klass->name, where));
 
   if (G->is_output_mode_k2()) {
     // To be able to store instances in request cache
@@ -168,6 +166,20 @@ void check_instance_cache_store_call(VertexAdaptor<op_func_call> call) {
   }
 }
 
+void check_instance_cache_store_call(VertexAdaptor<op_func_call> call) {
+  const auto *type = tinf::get_type(call->args()[1]);
+  kphp_error_return(type->ptype() == tp_Class, "Called instance_cache_store() with a non-instance argument");
+  check_instance_cache_stored_class(type->class_type(), "instance_cache_store call");
+}
+
+// results of @kphp-memoize functions are stored in instance cache, see runtime/memoize.h
+void check_memoized_function(FunctionPtr function) {
+  const TypeData *return_type = tinf::get_type(function, -1);
+  kphp_error_return(return_type->ptype() == tp_Class,
+                    fmt_format("@kphp-memoize function must return an instance, but it returns {}", return_type->as_human_readable()));
+  check_instance_cache_stored_class(return_type->class_type(), "@kphp-memoize function");
+}
+
 void to_array_debug_on_class(ClassPtr klass) {
   kphp_error(!klass->is_ffi_cdata(), "Called to_array_debug() with CData");
   klass->deeply_require_to_array_debug_visitor();
@@ -621,6 +633,10 @@ void FinalCheckPass::on_start() {
     check_lib_exported_function(current_function);
   }
 
+  if (current_function->is_memoized) {
+    check_memoized_function(current_function);
+  }
+
   if (!current_function->check_throws.empty()) {
     check_function_throws(current_function);
   }
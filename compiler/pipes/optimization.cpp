@@ -170,6 +170,41 @@ VertexPtr optimize_set_push_back(VertexPtr set_op, VertexAdaptor<op_index> index
   return result;
 }
 
+bool is_array_without_optional(const TypeData *type) {
+  return type->ptype() == tp_array && !type->use_optional();
+}
+
+// only the current statement can read or modify such a variable, calls and other forks can't
+bool is_local_value_var(VarPtr var) {
+  return vk::any_of_equal(var->type(), VarData::var_local_t, VarData::var_param_t) && !var->is_reference && !var->is_foreach_reference;
+}
+
+bool has_var_usage(VertexPtr tree, VarPtr var) {
+  if (auto var_vertex = tree.try_as<op_var>()) {
+    return var_vertex->var_id == var;
+  }
+  return std::any_of(tree->begin(), tree->end(), [&var](VertexPtr child) { return has_var_usage(child, var); });
+}
+
+bool has_loop_exits(VertexPtr tree) {
+  if (vk::any_of_equal(tree->type(), op_break, op_continue, op_return)) {
+    return true;
+  }
+  return std::any_of(tree->begin(), tree->end(), has_loop_exits);
+}
+
+VertexAdaptor<op_func_call> create_internal_call(const std::string &name, VertexPtr array_var, VertexPtr arg, const Location &location) {
+  array_var->rl_type = val_l;
+  arg->rl_type = val_r;
+  auto call = VertexAdaptor<op_func_call>::create(array_var, arg).set_location(location);
+  call->str_val = name;
+  call->func_id = G->get_function(name);
+  kphp_assert(call->func_id);
+  call->auto_inserted = true;
+  call->rl_type = val_none;
+  return call;
+}
+
 } // namespace
 
 VertexPtr OptimizationPass::optimize_set_with_offset(VertexAdaptor<op_set> set_op) {
@@ -226,6 +261,53 @@ VertexPtr OptimizationPass::optimize_postfix_dec(VertexPtr root) {
   }
   return root;
 }
+
+// `$a = array_merge($a, $b)` copies $a on every call, which is quadratic in a loop: merge $b into $a in place instead
+VertexPtr OptimizationPass::optimize_array_merge(VertexAdaptor<op_set> set_op) {
+  auto lhs = set_op->lhs().try_as<op_var>();
+  auto call = remove_extra_conversions(set_op->rhs()).try_as<op_func_call>();
+  if (set_op->rl_type != val_none || !lhs || !is_local_value_var(lhs->var_id) ||
+      !call || !call->func_id->is_extern() || call->func_id->name != "array_merge" || call->args().size() != 2) {
+    return set_op;
+  }
+
+  auto first_arg = remove_extra_conversions(call->args()[0]).try_as<op_var>();
+  VertexPtr another_array = call->args()[1];
+  const auto *type = tinf::get_type(lhs);
+  if (!first_arg || first_arg->var_id != lhs->var_id || has_var_usage(another_array, lhs->var_id) || !is_array_without_optional(type) ||
+      !are_equal_types(type, tinf::get_type(call)) || !are_equal_types(type, tinf::get_type(remove_extra_conversions(another_array)))) {
+    return set_op;
+  }
+  return create_internal_call("_array_merge_self", lhs, another_array, set_op->get_location());
+}
+
+// `foreach ($xs as ...) { $result[] = ...; }` inserts exactly count($xs) elements if the loop can't be left earlier,
+// so $result is reserved before the loop
+VertexPtr OptimizationPass::reserve_arrays_before_foreach(VertexAdaptor<op_foreach> foreach_op) {
+  auto xs = foreach_op->params()->xs().try_as<op_var>();
+  if (!xs || !is_array_without_optional(tinf::get_type(xs)) || has_loop_exits(foreach_op->cmd())) {
+    return foreach_op;
+  }
+
+  std::vector<VertexPtr> seq;
+  std::set<VarPtr> reserved_vars;
+  for (auto statement : *foreach_op->cmd()) {
+    auto push_back = statement.try_as<op_push_back>();
+    auto array_var = push_back ? push_back->array().try_as<op_var>() : VertexAdaptor<op_var>{};
+    if (array_var && array_var->var_id != xs->var_id && is_local_value_var(array_var->var_id) &&
+        is_array_without_optional(tinf::get_type(array_var)) && reserved_vars.emplace(array_var->var_id).second) {
+      seq.emplace_back(create_internal_call("_array_reserve_for_push_back", array_var.clone(), xs.clone(), foreach_op->get_location()));
+    }
+  }
+  if (seq.empty()) {
+    return foreach_op;
+  }
+  seq.emplace_back(foreach_op);
+  auto new_root = VertexAdaptor<op_seq>::create(seq).set_location(foreach_op);
+  new_root->rl_type = val_none;
+  return new_root;
+}
+
 VertexPtr OptimizationPass::optimize_index(VertexAdaptor<op_index> index) {
   if (!index->has_key()) {
     if (index->rl_type == val_l) {
@@ -350,6 +432,9 @@ VertexPtr OptimizationPass::on_enter_vertex(VertexPtr root) {
   if (auto set_vertex = root.try_as<op_set>()) {
     explicit_cast_array_type(set_vertex->rhs(), tinf::get_type(set_vertex->lhs()), &current_function->explicit_const_var_ids);
     root = optimize_set_with_offset(set_vertex);
+    if (G->settings().auto_apply_performance_inspections.get() && root->type() == op_set) {
+      root = optimize_array_merge(root.as<op_set>());
+    }
   } else if (root->type() == op_string_build || root->type() == op_concat) {
     root = optimize_string_building(root);
   } else if (root->type() == op_postfix_inc) {
@@ -425,6 +510,15 @@ bool OptimizationPass::user_recursion(VertexPtr root) {
   return false;
 }
 
+VertexPtr OptimizationPass::on_exit_vertex(VertexPtr root) {
+  if (auto foreach_vertex = root.try_as<op_foreach>()) {
+    if (G->settings().auto_apply_performance_inspections.get()) {
+      root = reserve_arrays_before_foreach(foreach_vertex);
+    }
+  }
+  return root;
+}
+
 bool OptimizationPass::check_function(FunctionPtr function) const {
   return !function->is_extern();
 }
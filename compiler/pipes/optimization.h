@@ -15,6 +15,8 @@ private:
   VertexPtr optimize_postfix_inc(VertexPtr root);
   VertexPtr optimize_postfix_dec(VertexPtr root);
   VertexPtr optimize_index(VertexAdaptor<op_index> index);
+  VertexPtr optimize_array_merge(VertexAdaptor<op_set> set_op);
+  VertexPtr reserve_arrays_before_foreach(VertexAdaptor<op_foreach> foreach_op);
   VertexPtr remove_extra_conversions(VertexPtr root);
 
   static VertexPtr try_convert_expr_to_call_to_string_method(VertexPtr expr);
@@ -31,6 +33,8 @@ public:
 
   bool user_recursion(VertexPtr root) override;
 
+  VertexPtr on_exit_vertex(VertexPtr root) override;
+
   void on_finish() override;
 
   size_t var_init_expression_optimization_depth_{0};
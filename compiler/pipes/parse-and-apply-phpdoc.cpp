@@ -237,6 +237,13 @@ private:
         break;
       }
 
+      case PhpDocType::kphp_memoize: {
+        kphp_error(!G->is_output_mode_k2(), "@kphp-memoize is not supported in K2 mode");
+        kphp_error(!f_->modifiers.is_instance(), "@kphp-memoize can't be used for instance methods: $this is not a part of the cache key, use a free function or a static method");
+        f_->is_memoized = true;
+        break;
+      }
+
       case PhpDocType::kphp_should_not_throw: {
         f_->should_not_throw = true;
         break;
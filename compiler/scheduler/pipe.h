@@ -6,8 +6,11 @@
 
 #include <typeinfo>
 
+#include "common/dl-utils-lite.h"
+
 #include "compiler/scheduler/node.h"
 #include "compiler/scheduler/task.h"
+#include "compiler/threading/build-trace.h"
 #include "compiler/threading/profiler.h"
 
 template<class T, class Enable = void>
@@ -33,6 +36,23 @@ private:
     return *cache;
   }
 
+  void execute_profiled() {
+    if (NeedProfiler<typename PipeType::PipeFunctionType>::value) {
+      AutoProfiler prof{get_task_profiler()};
+      pipe_ptr->process_input(std::move(input));
+    } else {
+      pipe_ptr->process_input(std::move(input));
+    }
+  }
+
+  void execute_traced() {
+    static const std::string pipe_name = demangle(typeid(typename PipeType::PipeFunctionType).name());
+    std::string detail = get_build_trace_detail(input);
+    const double start = dl_time();
+    execute_profiled();
+    vk::singleton<BuildTrace>::get().on_pipe_task(pipe_name, std::move(detail), start, dl_time());
+  }
+
 public:
   PipeTask(InputType &&input, PipeType *pipe_ptr) :
     input(std::move(input)),
@@ -40,11 +60,10 @@ public:
   }
 
   void execute() override {
-    if (NeedProfiler<typename PipeType::PipeFunctionType>::value) {
-      AutoProfiler prof{get_task_profiler()};
-      pipe_ptr->process_input(std::move(input));
+    if (vk::singleton<BuildTrace>::get().is_enabled()) {
+      execute_traced();
     } else {
-      pipe_ptr->process_input(std::move(input));
+      execute_profiled();
     }
   }
 };
@@ -72,7 +91,7 @@ private:
   OutputStreamType *output_stream = nullptr;
   PipeF function;
 
-  void on_finish(std::true_type) {
+  void on_finish_profiled() {
     if (NeedOnFinishProfiler<PipeF>::value) {
       AutoProfiler prof{get_profiler(demangle(typeid(PipeF).name()) + "::on_finish")};
       function.on_finish(*output_stream);
@@ -81,6 +100,16 @@ private:
     }
   }
 
+  void on_finish(std::true_type) {
+    if (vk::singleton<BuildTrace>::get().is_enabled()) {
+      const double start = dl_time();
+      on_finish_profiled();
+      vk::singleton<BuildTrace>::get().on_sync_stage(demangle(typeid(PipeF).name()) + "::on_finish", start, dl_time());
+    } else {
+      on_finish_profiled();
+    }
+  }
+
   void on_finish(std::false_type) {}
 
 public:
@@ -7,6 +7,7 @@
 #include "common/dl-utils-lite.h"
 
 #include "compiler/data/function-data.h"
+#include "compiler/frontend-cache.h"
 
 void Stats::on_var_inserting(VarData::Type type) {
   switch (type) {
@@ -89,6 +90,8 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   out << indent << "compilation.transpilation_time: " << transpilation_time << std::endl;
   out << indent << "compilation.total_time: " << total_time << std::endl;
   out << indent << "compilation.object_out_size: " << object_out_size << std::endl;
+  out << indent << "compilation.frontend_cache_hits: " << vk::singleton<FrontendCache>::get().get_hits() << std::endl;
+  out << indent << "compilation.frontend_cache_misses: " << vk::singleton<FrontendCache>::get().get_misses() << std::endl;
   out << block_sep;
   out << indent << "hash_tables.max_files: " << ht_max_files << std::endl;
   out << indent << "hash_tables.total_files: " << ht_total_files << std::endl;
@@ -0,0 +1,192 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/threading/build-trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "common/dl-utils-lite.h"
+#include "common/wrappers/fmt_format.h"
+
+#include "compiler/data/function-data.h"
+#include "compiler/data/src-file.h"
+
+namespace {
+
+constexpr int TRANSPILER_PID = 1;
+constexpr int MAKE_PID = 2;
+
+std::string escape_json(const std::string &s) {
+  std::string res;
+  res.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        res += "\\\"";
+        break;
+      case '\\':
+        res += "\\\\";
+        break;
+      case '\n':
+        res += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          res += fmt_format("\\u{:04x}", static_cast<int>(c));
+        } else {
+          res += c;
+        }
+    }
+  }
+  return res;
+}
+
+double duration(const BuildTrace::Event &event) {
+  return event.finish - event.start;
+}
+
+template<class Key>
+std::vector<std::pair<Key, double>> top_by_value(const std::map<Key, double> &values, size_t top_n) {
+  std::vector<std::pair<Key, double>> res{values.begin(), values.end()};
+  std::sort(res.begin(), res.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+  res.resize(std::min(res.size(), top_n));
+  return res;
+}
+
+} // namespace
+
+void BuildTrace::enable(std::string trace_file) {
+  trace_file_ = std::move(trace_file);
+  trace_start_ = dl_time();
+  enabled_ = true;
+}
+
+void BuildTrace::disable() {
+  enabled_ = false;
+  for (int i = 0; i <= MAX_THREADS_COUNT + 1; ++i) {
+    pipe_events_.get(i).clear();
+  }
+  make_events_.clear();
+  make_critical_paths_.clear();
+}
+
+void BuildTrace::on_pipe_task(const std::string &pipe_name, std::string detail, double start, double finish) {
+  pipe_events_->emplace_back(Event{pipe_name, std::move(detail), CATEGORY_PIPE, get_thread_id(), start, finish});
+}
+
+void BuildTrace::on_sync_stage(const std::string &pipe_name, double start, double finish) {
+  pipe_events_->emplace_back(Event{pipe_name, {}, CATEGORY_SYNC, get_thread_id(), start, finish});
+}
+
+void BuildTrace::on_make_job(std::string target_name, int lane, double start, double finish) {
+  make_events_.emplace_back(Event{std::move(target_name), {}, CATEGORY_MAKE, lane, start, finish});
+}
+
+void BuildTrace::on_make_critical_path(const std::string &build_message, std::vector<Event> &&critical_path) {
+  make_critical_paths_.emplace_back(build_message, std::move(critical_path));
+}
+
+void BuildTrace::write_trace_events(FILE *f) {
+  const auto to_us = [this](double t) { return static_cast<int64_t>((t - trace_start_) * 1e6); };
+  const auto write_event = [&](const Event &event, int pid) {
+    fmt_fprintf(f, ",\n" R"({{"name":"{}","cat":"{}","ph":"X","pid":{},"tid":{},"ts":{},"dur":{})",
+                escape_json(event.name), event.category, pid, event.lane, to_us(event.start), to_us(event.finish) - to_us(event.start));
+    if (!event.detail.empty()) {
+      fmt_fprintf(f, R"(,"args":{{"input":"{}"}})", escape_json(event.detail));
+    }
+    fmt_fprintf(f, "}}");
+  };
+
+  fmt_fprintf(f, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fmt_fprintf(f, R"({{"name":"process_name","ph":"M","pid":{},"args":{{"name":"kphp2cpp transpiling"}}}},)" "\n", TRANSPILER_PID);
+  fmt_fprintf(f, R"({{"name":"process_name","ph":"M","pid":{},"args":{{"name":"make"}}}})", MAKE_PID);
+  for (int i = 0; i <= MAX_THREADS_COUNT + 1; ++i) {
+    for (const auto &event : pipe_events_.get(i)) {
+      write_event(event, TRANSPILER_PID);
+    }
+  }
+  for (const auto &event : make_events_) {
+    write_event(event, MAKE_PID);
+  }
+  fmt_fprintf(f, "\n]}}\n");
+}
+
+void BuildTrace::write_summary(FILE *f, size_t top_n) {
+  std::map<std::string, double> sync_stages;
+  std::map<std::string, double> pipes_busy_time;
+  std::map<std::string, std::pair<double, double>> pipes_span;
+  std::map<std::string, double> inputs;
+  for (int i = 0; i <= MAX_THREADS_COUNT + 1; ++i) {
+    for (const auto &event : pipe_events_.get(i)) {
+      if (event.category == CATEGORY_SYNC) {
+        sync_stages[event.name] += duration(event);
+        continue;
+      }
+      pipes_busy_time[event.name] += duration(event);
+      auto span_it = pipes_span.emplace(event.name, std::make_pair(event.start, event.finish)).first;
+      span_it->second.first = std::min(span_it->second.first, event.start);
+      span_it->second.second = std::max(span_it->second.second, event.finish);
+      if (!event.detail.empty()) {
+        inputs[event.detail] += duration(event);
+      }
+    }
+  }
+  std::map<std::string, double> make_jobs;
+  for (const auto &event : make_events_) {
+    make_jobs[event.name] = std::max(make_jobs[event.name], duration(event));
+  }
+
+  fmt_fprintf(f, "Build trace summary (the full trace is in {}):\n", trace_file_);
+  fmt_fprintf(f, "  Sync points (single-threaded, every one of them is on the critical path):\n");
+  for (const auto &[name, time] : top_by_value(sync_stages, top_n)) {
+    fmt_fprintf(f, "    {:>10.3f} sec  {}\n", time, name);
+  }
+  fmt_fprintf(f, "  Pipes by total working time (wall-clock span in brackets):\n");
+  for (const auto &[name, time] : top_by_value(pipes_busy_time, top_n)) {
+    const auto &span = pipes_span.at(name);
+    fmt_fprintf(f, "    {:>10.3f} sec  [{:>8.3f} sec]  {}\n", time, span.second - span.first, name);
+  }
+  fmt_fprintf(f, "  Slowest functions and files (summed over all pipes):\n");
+  for (const auto &[name, time] : top_by_value(inputs, top_n)) {
+    fmt_fprintf(f, "    {:>10.3f} sec  {}\n", time, name);
+  }
+  fmt_fprintf(f, "  Slowest make jobs:\n");
+  for (const auto &[name, time] : top_by_value(make_jobs, top_n)) {
+    fmt_fprintf(f, "    {:>10.3f} sec  {}\n", time, name);
+  }
+  for (const auto &[build_message, critical_path] : make_critical_paths_) {
+    double total = 0;
+    for (const auto &event : critical_path) {
+      total += duration(event);
+    }
+    fmt_fprintf(f, "  {} critical path: {} jobs, {:.3f} sec\n", build_message, critical_path.size(), total);
+    for (const auto &event : critical_path) {
+      fmt_fprintf(f, "    {:>10.3f} sec  {}\n", duration(event), event.name);
+    }
+  }
+}
+
+void BuildTrace::flush(size_t top_n) {
+  if (!is_enabled()) {
+    return;
+  }
+  std::unique_ptr<FILE, int (*)(FILE *)> f{fopen(trace_file_.c_str(), "w"), fclose};
+  if (!f) {
+    fmt_fprintf(stderr, "Can't open build trace file {}: {}\n", trace_file_, std::strerror(errno));
+    return;
+  }
+  write_trace_events(f.get());
+  write_summary(stderr, top_n);
+}
+
+std::string get_build_trace_detail(FunctionPtr function) {
+  return function ? function->name : std::string{};
+}
+
+std::string get_build_trace_detail(SrcFilePtr file) {
+  return file ? file->relative_file_name : std::string{};
+}
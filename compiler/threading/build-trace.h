@@ -0,0 +1,88 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+#include "compiler/data/data_ptr.h"
+#include "compiler/threading/tls.h"
+
+// BuildTrace collects a timeline of kphp2cpp work: every pipe task per transpiler thread and every make job (cxx, linker, etc.)
+// the timeline is written in the Chrome trace event format (can be opened in chrome://tracing or ui.perfetto.dev),
+// followed by a text summary: the slowest sync points, functions and translation units, and the make critical path
+// when disabled (by default), recording costs a single relaxed load per pipe task
+class BuildTrace : vk::not_copyable {
+public:
+  friend class vk::singleton<BuildTrace>;
+
+  struct Event {
+    std::string name;
+    std::string detail;
+    const char *category{nullptr};
+    int lane{0};
+    double start{0};
+    double finish{0};
+  };
+
+  static constexpr const char *CATEGORY_PIPE = "pipe";
+  static constexpr const char *CATEGORY_SYNC = "sync";
+  static constexpr const char *CATEGORY_MAKE = "make";
+
+  void enable(std::string trace_file);
+  // drops the recorded events
+  void disable();
+  bool is_enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+  // called from transpiler threads, lane is a thread id
+  void on_pipe_task(const std::string &pipe_name, std::string detail, double start, double finish);
+  void on_sync_stage(const std::string &pipe_name, double start, double finish);
+
+  // called from the make thread only, lane is a number of a job slot
+  void on_make_job(std::string target_name, int lane, double start, double finish);
+  void on_make_critical_path(const std::string &build_message, std::vector<Event> &&critical_path);
+
+  // writes the trace file and prints the summary to stderr
+  void flush(size_t top_n = 20);
+
+private:
+  BuildTrace() = default;
+
+  void write_trace_events(FILE *f);
+  void write_summary(FILE *f, size_t top_n);
+
+  std::atomic<bool> enabled_{false};
+  std::string trace_file_;
+  double trace_start_{0};
+
+  TLS<std::vector<Event>> pipe_events_;
+  std::vector<Event> make_events_;
+  std::vector<std::pair<std::string, std::vector<Event>>> make_critical_paths_;
+};
+
+// a human-readable description of a pipe task input, which is shown in the trace
+std::string get_build_trace_detail(FunctionPtr function);
+std::string get_build_trace_detail(SrcFilePtr file);
+
+template<class T>
+std::string get_build_trace_detail(const std::pair<FunctionPtr, T> &function_and_data) {
+  return get_build_trace_detail(function_and_data.first);
+}
+
+template<class T>
+std::string get_build_trace_detail(const std::pair<SrcFilePtr, T> &file_and_data) {
+  return get_build_trace_detail(file_and_data.first);
+}
+
+template<class T>
+std::string get_build_trace_detail(const T &) {
+  return {};
+}
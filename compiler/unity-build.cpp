@@ -0,0 +1,276 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/unity-build.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <unistd.h>
+
+#include "common/containers/final_action.h"
+#include "common/wrappers/fmt_format.h"
+
+#include "compiler/kphp_assert.h"
+#include "compiler/stage.h"
+
+namespace {
+
+// bump it on every change of the state file format
+constexpr const char *STATE_FILE_HEADER = "kphp-unity-build-state-v1";
+// a function source of a typical size is compiled with a precompiled header in about this time, it's used until anything is measured
+constexpr double DEFAULT_SOURCE_COMPILE_TIME = 0.2;
+constexpr uint32_t NO_UNIT = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+void UnityBuild::init(const std::string &state_file) {
+  state_file_ = state_file;
+  state_.clear();
+  load_state();
+}
+
+// the state is just a hint: if it's missing or broken, the sources are grouped from scratch
+void UnityBuild::load_state() {
+  std::unique_ptr<FILE, int (*)(FILE *)> f{fopen(state_file_.c_str(), "r"), fclose};
+  if (!f) {
+    return;
+  }
+  char header[64] = {0};
+  if (fscanf(f.get(), "%63s", header) != 1 || std::string{header} != STATE_FILE_HEADER) {
+    return;
+  }
+
+  char path[501] = {0};
+  SourceState source_state;
+  while (fscanf(f.get(), "%u %lf %500s", &source_state.unity_id, &source_state.compile_time, path) == 3) {
+    state_[path] = source_state;
+  }
+}
+
+void UnityBuild::save_state() const {
+  std::string state_file_tmp_name = state_file_ + "XXXXXX";
+  const int tmp_state_file_fd = mkstemp(&state_file_tmp_name[0]);
+  if (tmp_state_file_fd == -1) {
+    kphp_warning(fmt_format("Can't create tmp file for unity build state file '{}': {}", state_file_, strerror(errno)));
+    return;
+  }
+
+  std::unique_ptr<FILE, int (*)(FILE *)> f{fdopen(tmp_state_file_fd, "w"), fclose};
+  kphp_assert(f);
+  auto file_deleter = vk::finally([&state_file_tmp_name]() { unlink(state_file_tmp_name.c_str()); });
+
+  bool ok = fprintf(f.get(), "%s\n", STATE_FILE_HEADER) > 0;
+  for (const auto &[path, source_state] : state_) {
+    ok = ok && fprintf(f.get(), "%u %.6f %s\n", source_state.unity_id, source_state.compile_time, path.c_str()) > 0;
+  }
+  if (!ok || fclose(f.release()) != 0) {
+    kphp_warning(fmt_format("Can't write tmp unity build state file '{}'", state_file_tmp_name));
+    return;
+  }
+  if (rename(state_file_tmp_name.c_str(), state_file_.c_str()) == -1) {
+    kphp_warning(fmt_format("Can't rename '{}' into '{}': {}", state_file_tmp_name, state_file_, strerror(errno)));
+  }
+}
+
+std::string UnityBuild::get_unity_file_name(uint32_t unity_id) {
+  return fmt_format("unity_{}.cpp", unity_id);
+}
+
+double UnityBuild::get_default_compile_time() const {
+  double total_compile_time = 0;
+  size_t measured_count = 0;
+  for (const auto &[path, source_state] : state_) {
+    if (source_state.compile_time > 0) {
+      total_compile_time += source_state.compile_time;
+      ++measured_count;
+    }
+  }
+  return measured_count ? total_compile_time / measured_count : DEFAULT_SOURCE_COMPILE_TIME;
+}
+
+double UnityBuild::get_estimated_compile_time(const std::string &path, double default_compile_time) const {
+  auto it = state_.find(path);
+  return it != state_.end() && it->second.compile_time > 0 ? it->second.compile_time : default_compile_time;
+}
+
+std::map<uint32_t, std::vector<std::string>> UnityBuild::assign(std::vector<Source> sources, double max_unity_compile_time, size_t min_units_count) {
+  std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) { return a.path < b.path; });
+  const size_t n = sources.size();
+
+  std::unordered_map<std::string, size_t> source_ids;
+  for (size_t i = 0; i != n; ++i) {
+    source_ids.emplace(sources[i].path, i);
+  }
+  // the graph is undirected: a function shares headers with its callers as well as with its callees
+  std::vector<std::vector<size_t>> neighbours(n);
+  for (size_t i = 0; i != n; ++i) {
+    for (const std::string &dep : sources[i].deps) {
+      auto it = source_ids.find(dep);
+      if (it != source_ids.end() && it->second != i) {
+        neighbours[i].push_back(it->second);
+        neighbours[it->second].push_back(i);
+      }
+    }
+  }
+
+  const double default_compile_time = get_default_compile_time();
+  std::vector<double> compile_times(n);
+  double total_compile_time = 0;
+  for (size_t i = 0; i != n; ++i) {
+    compile_times[i] = get_estimated_compile_time(sources[i].path, default_compile_time);
+    total_compile_time += compile_times[i];
+  }
+  // small projects are split into enough units to load all the jobs
+  if (min_units_count) {
+    max_unity_compile_time = std::min(max_unity_compile_time, total_compile_time / min_units_count);
+  }
+
+  struct Unit {
+    double compile_time{0};
+    std::vector<size_t> sources;
+  };
+  std::map<uint32_t, Unit> units;
+  std::vector<size_t> unassigned;
+  for (size_t i = 0; i != n; ++i) {
+    auto it = state_.find(sources[i].path);
+    if (it == state_.end()) {
+      unassigned.push_back(i);
+      continue;
+    }
+    Unit &unit = units[it->second.unity_id];
+    unit.sources.push_back(i);
+    unit.compile_time += compile_times[i];
+  }
+
+  // a unit that has become too heavy keeps its first sources within the limit, the rest are placed again
+  for (auto &[unity_id, unit] : units) {
+    if (unit.compile_time <= 2 * max_unity_compile_time) {
+      continue;
+    }
+    size_t kept_count = 0;
+    double kept_compile_time = 0;
+    while (kept_count != unit.sources.size()
+           && (kept_count == 0 || kept_compile_time + compile_times[unit.sources[kept_count]] <= max_unity_compile_time)) {
+      kept_compile_time += compile_times[unit.sources[kept_count++]];
+    }
+    unassigned.insert(unassigned.end(), unit.sources.begin() + kept_count, unit.sources.end());
+    unit.sources.resize(kept_count);
+    unit.compile_time = kept_compile_time;
+  }
+
+  // the units that have become too light (their functions were removed) are merged with the other ones,
+  // a single light unit is left as is, otherwise it would be recreated on every launch
+  std::vector<uint32_t> light_units;
+  for (const auto &[unity_id, unit] : units) {
+    if (unit.compile_time < max_unity_compile_time / 4) {
+      light_units.push_back(unity_id);
+    }
+  }
+  if (light_units.size() > 1) {
+    for (uint32_t unity_id : light_units) {
+      const auto &unit_sources = units[unity_id].sources;
+      unassigned.insert(unassigned.end(), unit_sources.begin(), unit_sources.end());
+      units.erase(unity_id);
+    }
+  }
+
+  std::vector<uint32_t> unit_of(n, NO_UNIT);
+  for (const auto &[unity_id, unit] : units) {
+    for (size_t i : unit.sources) {
+      unit_of[i] = unity_id;
+    }
+  }
+
+  // the sources to place are traversed depth-first over the dependency graph, so that the neighbours go one after another
+  std::sort(unassigned.begin(), unassigned.end());
+  std::vector<bool> visited(n, true);
+  for (size_t i : unassigned) {
+    visited[i] = false;
+  }
+  std::vector<size_t> order;
+  std::vector<size_t> stack;
+  for (size_t start : unassigned) {
+    stack.push_back(start);
+    while (!stack.empty()) {
+      const size_t i = stack.back();
+      stack.pop_back();
+      if (visited[i]) {
+        continue;
+      }
+      visited[i] = true;
+      order.push_back(i);
+      for (auto it = neighbours[i].rbegin(); it != neighbours[i].rend(); ++it) {
+        if (!visited[*it]) {
+          stack.push_back(*it);
+        }
+      }
+    }
+  }
+
+  // a source goes to the unit with most of its neighbours if it fits there, otherwise to the last created unit,
+  // and a new unit is created only if it doesn't fit anywhere
+  uint32_t free_unity_id = 0;
+  uint32_t last_created_unit = NO_UNIT;
+  for (size_t i : order) {
+    auto fits = [&](uint32_t unity_id) { return units[unity_id].compile_time + compile_times[i] <= max_unity_compile_time; };
+
+    std::map<uint32_t, size_t> neighbours_in_unit;
+    for (size_t neighbour : neighbours[i]) {
+      if (unit_of[neighbour] != NO_UNIT) {
+        ++neighbours_in_unit[unit_of[neighbour]];
+      }
+    }
+    uint32_t best_unit = NO_UNIT;
+    size_t best_neighbours_count = 0;
+    for (const auto &[unity_id, neighbours_count] : neighbours_in_unit) {
+      if (fits(unity_id) && neighbours_count > best_neighbours_count) {
+        best_unit = unity_id;
+        best_neighbours_count = neighbours_count;
+      }
+    }
+    if (best_unit == NO_UNIT && last_created_unit != NO_UNIT && fits(last_created_unit)) {
+      best_unit = last_created_unit;
+    }
+    if (best_unit == NO_UNIT) {
+      while (units.count(free_unity_id)) {
+        ++free_unity_id;
+      }
+      best_unit = last_created_unit = free_unity_id;
+    }
+
+    Unit &unit = units[best_unit];
+    unit.sources.push_back(i);
+    unit.compile_time += compile_times[i];
+    unit_of[i] = best_unit;
+  }
+
+  // the removed sources are forgotten, the measured times of the present ones are kept
+  std::unordered_map<std::string, SourceState> new_state;
+  std::map<uint32_t, std::vector<std::string>> result;
+  for (size_t i = 0; i != n; ++i) {
+    auto it = state_.find(sources[i].path);
+    new_state[sources[i].path] = SourceState{unit_of[i], it != state_.end() ? it->second.compile_time : 0};
+    result[unit_of[i]].push_back(sources[i].path);
+  }
+  state_ = std::move(new_state);
+  return result;
+}
+
+void UnityBuild::on_unity_compiled(const std::vector<std::string> &sources, double compile_time) {
+  const double default_compile_time = get_default_compile_time();
+  std::vector<double> estimated_compile_times;
+  double estimated_total_compile_time = 0;
+  for (const std::string &path : sources) {
+    estimated_compile_times.push_back(get_estimated_compile_time(path, default_compile_time));
+    estimated_total_compile_time += estimated_compile_times.back();
+  }
+  for (size_t i = 0; i != sources.size(); ++i) {
+    auto it = state_.find(sources[i]);
+    if (it != state_.end()) {
+      it->second.compile_time = compile_time * estimated_compile_times[i] / estimated_total_compile_time;
+    }
+  }
+}
@@ -0,0 +1,60 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+// UnityBuild groups generated function sources into unity translation units — files that just #include them,
+// so the headers shared by a group are parsed once, not once per function
+// a function is placed into a group with the functions it calls or is called by (see CalcFuncDepPass),
+// and it stays there between launches, so that a change in one function recompiles only its group;
+// groups are balanced by compile times measured at previous launches, kept in a state file in the destination dir
+class UnityBuild : vk::not_copyable {
+public:
+  friend class vk::singleton<UnityBuild>;
+
+  static constexpr const char *SUBDIR = "o_unity";
+
+  struct Source {
+    std::string path;               // relative to the cpp dir, e.g. "o_12/f@foo.cpp"
+    std::vector<std::string> deps;  // paths of the sources of called functions
+  };
+
+  void init(const std::string &state_file);
+  bool is_enabled() const { return !state_file_.empty(); }
+
+  // returns the sources grouped by unity id; max_unity_compile_time is the desired compile time of a group in seconds,
+  // it's lowered if there would be less than min_units_count groups
+  std::map<uint32_t, std::vector<std::string>> assign(std::vector<Source> sources, double max_unity_compile_time, size_t min_units_count);
+
+  // called after a unity translation unit is compiled: the time is shared between its sources proportionally to their previous estimates
+  void on_unity_compiled(const std::vector<std::string> &sources, double compile_time);
+
+  void save_state() const;
+
+  static std::string get_unity_file_name(uint32_t unity_id);
+
+private:
+  UnityBuild() = default;
+
+  struct SourceState {
+    uint32_t unity_id{0};
+    double compile_time{0}; // 0 if it wasn't measured yet
+  };
+
+  void load_state();
+  double get_default_compile_time() const;
+  double get_estimated_compile_time(const std::string &path, double default_compile_time) const;
+
+  std::string state_file_;
+  std::unordered_map<std::string, SourceState> state_;
+};
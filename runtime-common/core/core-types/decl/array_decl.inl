@@ -29,7 +29,18 @@ struct array_size {
 namespace dl {
 template<class T, class TT, class T1>
 void sort(TT* begin_init, TT* end_init, T1 compare) noexcept;
-}
+
+// The comparators of the builtin sorts declare the order they define with a static 'order' member,
+// then the arrays of numbers and strings are sorted without calling them:
+// numbers_* orders are applied only to int and float values, bytes_* orders only to string values
+enum class sort_order { unspecified, numbers_ascending, numbers_descending, bytes_ascending, bytes_descending };
+
+template<class T1, class = void>
+struct comparator_sort_order : std::integral_constant<sort_order, sort_order::unspecified> {};
+
+template<class T1>
+struct comparator_sort_order<T1, std::void_t<decltype(T1::order)>> : std::integral_constant<sort_order, T1::order> {};
+} // namespace dl
 
 namespace array_functions_impl_ {
 /*
@@ -434,8 +445,11 @@ public:
   T* get_vector_pointer();                   // unsafe
 
   bool is_equal_inner_pointer(const array& other) const noexcept;
+  const void* get_inner_identity() const noexcept; // unsafe, can only be used as a cache key for immutable arrays
 
   void reserve(int64_t int_size, bool make_vector_if_possible);
+  // the same, but the buffer grows at least twice, so the repeated calls are amortized like push_back()
+  void reserve_with_growth(int64_t int_size, bool make_vector_if_possible);
 
   size_t estimate_memory_usage() const noexcept;
   size_t calculate_memory_for_copying() const noexcept;
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <type_traits>
+#include <utility>
 
 #include "common/algorithms/fastmod.h"
 
@@ -38,57 +41,392 @@ array_size& array_size::min(const array_size& other) noexcept {
 
 namespace dl {
 
-template<class T, class T1>
-void sort(T* begin_init, T* end_init, const T1& compare) {
-  T* begin_stack[32];
-  T* end_stack[32];
+namespace sort_impl_ {
+
+// the ranges of this size are sorted by insertions
+constexpr int64_t INSERTION_SORT_THRESHOLD = 24;
+// the pivot of the larger ranges is chosen as the median of three medians
+constexpr int64_t NINTHER_THRESHOLD = 128;
+// an already partitioned range is checked for being sorted until this number of elements is moved
+constexpr int64_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+// the smaller arrays of numbers are sorted by comparisons
+constexpr int64_t RADIX_SORT_THRESHOLD = 256;
+// the smaller arrays of strings are sorted without the prefixes
+constexpr int64_t PREFIX_SORT_THRESHOLD = 64;
+
+// All the loops check the bounds, so an inconsistent user comparator may only produce an unsorted array
+template<class T, class Less>
+void insertion_sort(T* begin, T* end, const Less& less) {
+  for (T* cur = begin + 1; cur < end; ++cur) {
+    if (less(*cur, cur[-1])) {
+      T tmp = std::move(*cur);
+      T* sift = cur;
+      do {
+        *sift = std::move(sift[-1]);
+        --sift;
+      } while (sift != begin && less(tmp, sift[-1]));
+      *sift = std::move(tmp);
+    }
+  }
+}
 
-  begin_stack[0] = begin_init;
-  end_stack[0] = end_init - 1;
+// gives up after moving PARTIAL_INSERTION_SORT_LIMIT elements, returns whether the range is sorted
+template<class T, class Less>
+bool partial_insertion_sort(T* begin, T* end, const Less& less) {
+  int64_t moved = 0;
+  for (T* cur = begin + 1; cur < end; ++cur) {
+    if (less(*cur, cur[-1])) {
+      T tmp = std::move(*cur);
+      T* sift = cur;
+      do {
+        *sift = std::move(sift[-1]);
+        --sift;
+      } while (sift != begin && less(tmp, sift[-1]));
+      *sift = std::move(tmp);
+      moved += cur - sift;
+      if (moved > PARTIAL_INSERTION_SORT_LIMIT) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-  for (int depth = 0; depth >= 0; --depth) {
-    T* begin = begin_stack[depth];
-    T* end = end_stack[depth];
+template<class T, class Less>
+void sort2(T* a, T* b, const Less& less) {
+  if (less(*b, *a)) {
+    swap(*a, *b);
+  }
+}
 
-    while (begin < end) {
-      const auto offset = (end - begin) >> 1;
-      swap(*begin, begin[offset]);
+template<class T, class Less>
+void sort3(T* a, T* b, T* c, const Less& less) {
+  sort2(a, b, less);
+  sort2(b, c, less);
+  sort2(a, b, less);
+}
 
-      T *i = begin + 1, *j = end;
+// partitions the range around *begin: the elements less than the pivot go to the left of it;
+// returns the position of the pivot and whether the range was already partitioned
+template<class T, class Less>
+std::pair<T*, bool> partition_right(T* begin, T* end, const Less& less) {
+  T pivot = std::move(*begin);
+  T* first = begin + 1;
+  T* last = end - 1;
+  while (first <= last && less(*first, pivot)) {
+    ++first;
+  }
+  while (first <= last && !less(*last, pivot)) {
+    --last;
+  }
+  const bool already_partitioned = first > last;
+  while (first < last) {
+    swap(*first++, *last--);
+    while (first <= last && less(*first, pivot)) {
+      ++first;
+    }
+    while (first <= last && !less(*last, pivot)) {
+      --last;
+    }
+  }
 
-      while (1) {
-        while (i < j && compare(*begin, *i) > 0) {
-          i++;
-        }
+  T* pivot_pos = first - 1;
+  if (pivot_pos != begin) {
+    *begin = std::move(*pivot_pos);
+  }
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
 
-        while (i <= j && compare(*j, *begin) > 0) {
-          j--;
-        }
+// partitions the range around *begin: the elements equal to the pivot go to the left of it, so they are never touched again;
+// it's used when the pivot is equal to the element before the range, i.e. the range has no elements less than the pivot
+template<class T, class Less>
+T* partition_left(T* begin, T* end, const Less& less) {
+  T pivot = std::move(*begin);
+  T* first = begin + 1;
+  T* last = end - 1;
+  while (first <= last && less(pivot, *last)) {
+    --last;
+  }
+  while (first <= last && !less(pivot, *first)) {
+    ++first;
+  }
+  while (first < last) {
+    swap(*first++, *last--);
+    while (first <= last && less(pivot, *last)) {
+      --last;
+    }
+    while (first <= last && !less(pivot, *first)) {
+      ++first;
+    }
+  }
 
-        if (i >= j) {
-          break;
-        }
+  T* pivot_pos = last;
+  if (pivot_pos != begin) {
+    *begin = std::move(*pivot_pos);
+  }
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
 
-        swap(*i++, *j--);
-      }
+template<class T>
+void swap_away(T* lhs, T* rhs) {
+  if (lhs != rhs) {
+    swap(*lhs, *rhs);
+  }
+}
 
-      swap(*begin, *j);
+// pattern-defeating quicksort: the sorted and the reversed runs take a linear time,
+// the unbalanced partitions are fixed by shuffling, and the heap sort is the last resort
+template<class T, class Less>
+void pdq_sort(T* begin, T* end, const Less& less, int bad_allowed, bool leftmost) {
+  while (true) {
+    const int64_t size = end - begin;
+    if (size < INSERTION_SORT_THRESHOLD) {
+      insertion_sort(begin, end, less);
+      return;
+    }
+
+    const int64_t half = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(begin, begin + half, end - 1, less);
+      sort3(begin + 1, begin + (half - 1), end - 2, less);
+      sort3(begin + 2, begin + (half + 1), end - 3, less);
+      sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+      swap(*begin, begin[half]);
+    } else {
+      sort3(begin + half, begin, end - 1, less);
+    }
 
-      if (j - begin <= end - j) {
-        if (j + 1 < end) {
-          begin_stack[depth] = j + 1;
-          end_stack[depth++] = end;
+    if (!leftmost && !less(begin[-1], *begin)) {
+      begin = partition_left(begin, end, less) + 1;
+      continue;
+    }
+
+    const auto [pivot_pos, already_partitioned] = partition_right(begin, end, less);
+    const int64_t left_size = pivot_pos - begin;
+    const int64_t right_size = end - (pivot_pos + 1);
+
+    if (left_size < size / 8 || right_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, less);
+        std::sort_heap(begin, end, less);
+        return;
+      }
+      if (left_size >= INSERTION_SORT_THRESHOLD) {
+        swap_away(begin, begin + left_size / 4);
+        swap_away(pivot_pos - 1, pivot_pos - left_size / 4);
+        if (left_size > NINTHER_THRESHOLD) {
+          swap_away(begin + 1, begin + (left_size / 4 + 1));
+          swap_away(begin + 2, begin + (left_size / 4 + 2));
+          swap_away(pivot_pos - 2, pivot_pos - (left_size / 4 + 1));
+          swap_away(pivot_pos - 3, pivot_pos - (left_size / 4 + 2));
         }
-        end = j - 1;
-      } else {
-        if (begin < j - 1) {
-          begin_stack[depth] = begin;
-          end_stack[depth++] = j - 1;
+      }
+      if (right_size >= INSERTION_SORT_THRESHOLD) {
+        swap_away(pivot_pos + 1, pivot_pos + (1 + right_size / 4));
+        swap_away(end - 1, end - right_size / 4);
+        if (right_size > NINTHER_THRESHOLD) {
+          swap_away(pivot_pos + 2, pivot_pos + (2 + right_size / 4));
+          swap_away(pivot_pos + 3, pivot_pos + (3 + right_size / 4));
+          swap_away(end - 2, end - (1 + right_size / 4));
+          swap_away(end - 3, end - (2 + right_size / 4));
         }
-        begin = j + 1;
       }
+    } else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, less) && partial_insertion_sort(pivot_pos + 1, end, less)) {
+      return;
+    }
+
+    // the recursion goes into the smaller part only, so its depth is logarithmic
+    if (left_size < right_size) {
+      pdq_sort(begin, pivot_pos, less, bad_allowed, leftmost);
+      begin = pivot_pos + 1;
+      leftmost = false;
+    } else {
+      pdq_sort(pivot_pos + 1, end, less, bad_allowed, false);
+      end = pivot_pos;
+    }
+  }
+}
+
+template<class T>
+struct sort_item {
+  uint64_t key;
+  T value;
+};
+
+inline uint64_t get_item_key(uint64_t key) {
+  return key;
+}
+
+template<class T>
+uint64_t get_item_key(const sort_item<T>& item) {
+  return item.key;
+}
+
+// LSD radix sort by the unsigned keys, the bytes which are the same for all the keys are skipped;
+// the sorted and the reversed ranges are detected while the bytes are counted
+template<class Item>
+void radix_sort(Item* begin, Item* end) {
+  static_assert(std::is_trivially_copyable_v<Item>);
+  const size_t n = end - begin;
+  uint32_t counts[sizeof(uint64_t)][256] = {};
+  bool is_sorted = true;
+  bool is_reversed = true;
+  uint64_t prev_key = get_item_key(*begin);
+  for (const Item* item = begin; item != end; ++item) {
+    const uint64_t key = get_item_key(*item);
+    is_sorted &= prev_key <= key;
+    is_reversed &= prev_key >= key;
+    prev_key = key;
+    for (size_t byte = 0; byte != sizeof(uint64_t); ++byte) {
+      ++counts[byte][(key >> (byte * 8)) & 0xFF];
+    }
+  }
+  if (is_sorted) {
+    return;
+  }
+  if (is_reversed) {
+    std::reverse(begin, end);
+    return;
+  }
+
+  auto* buffer = static_cast<Item*>(RuntimeAllocator::get().alloc_script_memory(n * sizeof(Item)));
+  Item* from = begin;
+  Item* to = buffer;
+  for (size_t byte = 0; byte != sizeof(uint64_t); ++byte) {
+    uint32_t* byte_counts = counts[byte];
+    if (byte_counts[(get_item_key(*begin) >> (byte * 8)) & 0xFF] == n) {
+      continue;
+    }
+    uint32_t position = 0;
+    for (size_t value = 0; value != 256; ++value) {
+      position += std::exchange(byte_counts[value], position);
+    }
+    for (const Item* item = from; item != from + n; ++item) {
+      to[byte_counts[(get_item_key(*item) >> (byte * 8)) & 0xFF]++] = *item;
     }
+    std::swap(from, to);
   }
+  if (from != begin) {
+    std::memcpy(begin, from, n * sizeof(Item));
+  }
+  RuntimeAllocator::get().free_script_memory(buffer, n * sizeof(Item));
+}
+
+// maps the numbers to the unsigned keys of the same order and back
+inline uint64_t get_radix_key(int64_t number, bool descending) {
+  const uint64_t key = static_cast<uint64_t>(number) ^ (uint64_t{1} << 63);
+  return descending ? ~key : key;
+}
+
+inline uint64_t get_radix_key(double number, bool descending) {
+  uint64_t key = 0;
+  std::memcpy(&key, &number, sizeof(key));
+  key = (key >> 63) ? ~key : key ^ (uint64_t{1} << 63);
+  return descending ? ~key : key;
+}
+
+inline void restore_from_radix_key(uint64_t key, bool descending, int64_t& number) {
+  key = descending ? ~key : key;
+  number = static_cast<int64_t>(key ^ (uint64_t{1} << 63));
+}
+
+inline void restore_from_radix_key(uint64_t key, bool descending, double& number) {
+  key = descending ? ~key : key;
+  key = (key >> 63) ? key ^ (uint64_t{1} << 63) : ~key;
+  std::memcpy(&number, &key, sizeof(key));
+}
+
+// the first 8 bytes of the string in the order of comparison, the shorter strings are padded with zeroes
+inline uint64_t get_prefix_key(const string& str, bool descending) {
+  uint64_t key = 0;
+  std::memcpy(&key, str.c_str(), std::min<size_t>(str.size(), sizeof(key)));
+  key = __builtin_bswap64(key);
+  return descending ? ~key : key;
+}
+
+// sorts the items by the keys, the items with the same keys are compared as the strings
+template<class T, class F>
+void prefix_sort(sort_item<T>* begin, sort_item<T>* end, bool descending, const F& get_string) {
+  const auto less = [descending, &get_string](const sort_item<T>& lhs, const sort_item<T>& rhs) {
+    if (lhs.key != rhs.key) {
+      return lhs.key < rhs.key;
+    }
+    const int64_t res = get_string(lhs.value).compare(get_string(rhs.value));
+    return descending ? res > 0 : res < 0;
+  };
+  pdq_sort(begin, end, less, 64 - __builtin_clzll(end - begin), true);
+}
+
+// returns the minimal number of T values which are sorted by keys with the comparator, zero if they can't be
+template<class T, class T1>
+constexpr int64_t get_sort_by_keys_threshold() {
+  constexpr sort_order order = comparator_sort_order<T1>::value;
+  constexpr bool is_number = std::is_same_v<T, int64_t> || std::is_same_v<T, double>;
+  if constexpr (is_number && (order == sort_order::numbers_ascending || order == sort_order::numbers_descending)) {
+    return RADIX_SORT_THRESHOLD;
+  } else if constexpr (std::is_same_v<T, string> && (order == sort_order::bytes_ascending || order == sort_order::bytes_descending)) {
+    return PREFIX_SORT_THRESHOLD;
+  } else {
+    return 0;
+  }
+}
+
+// sorts the elements by the keys of their values: get_value(const U& element) returns a number or a string
+template<sort_order order, class U, class F>
+void sort_by_keys(U* begin, U* end, const F& get_value) {
+  constexpr bool by_prefix = order == sort_order::bytes_ascending || order == sort_order::bytes_descending;
+  constexpr bool descending = order == sort_order::numbers_descending || order == sort_order::bytes_descending;
+  const size_t n = end - begin;
+  if constexpr (std::is_same_v<U, int64_t> || std::is_same_v<U, double>) {
+    // the numbers are restored from their keys, so only the keys are sorted
+    auto* keys = static_cast<uint64_t*>(RuntimeAllocator::get().alloc_script_memory(n * sizeof(uint64_t)));
+    for (size_t i = 0; i != n; ++i) {
+      keys[i] = get_radix_key(begin[i], descending);
+    }
+    radix_sort(keys, keys + n);
+    for (size_t i = 0; i != n; ++i) {
+      restore_from_radix_key(keys[i], descending, begin[i]);
+    }
+    RuntimeAllocator::get().free_script_memory(keys, n * sizeof(uint64_t));
+    return;
+  }
+
+  auto* items = static_cast<sort_item<U>*>(RuntimeAllocator::get().alloc_script_memory(n * sizeof(sort_item<U>)));
+  for (size_t i = 0; i != n; ++i) {
+    uint64_t key = 0;
+    if constexpr (by_prefix) {
+      key = get_prefix_key(get_value(begin[i]), descending);
+    } else {
+      key = get_radix_key(get_value(begin[i]), descending);
+    }
+    new (items + i) sort_item<U>{key, std::move(begin[i])};
+  }
+
+  if constexpr (by_prefix) {
+    prefix_sort(items, items + n, descending, get_value);
+  } else {
+    radix_sort(items, items + n);
+  }
+
+  for (size_t i = 0; i != n; ++i) {
+    begin[i] = std::move(items[i].value);
+    items[i].~sort_item<U>();
+  }
+  RuntimeAllocator::get().free_script_memory(items, n * sizeof(sort_item<U>));
+}
+
+} // namespace sort_impl_
+
+// compare(lhs, rhs) > 0 means that lhs should go after rhs
+template<class T, class T1>
+void sort(T* begin, T* end, const T1& compare) {
+  if (end - begin < 2) {
+    return;
+  }
+  const auto less = [&compare](const T& lhs, const T& rhs) { return compare(rhs, lhs) > 0; };
+  sort_impl_::pdq_sort(begin, end, less, 64 - __builtin_clzll(end - begin), true);
 }
 
 } // namespace dl
@@ -793,6 +1131,13 @@ void array<T>::reserve(int64_t int_size, bool make_vector_if_possible) {
   }
 }
 
+template<class T>
+void array<T>::reserve_with_growth(int64_t int_size, bool make_vector_if_possible) {
+  if (int_size > int64_t{p->buf_size}) {
+    reserve(std::max(int_size, int64_t{p->buf_size} * 2), make_vector_if_possible);
+  }
+}
+
 template<class T>
 size_t array<T>::estimate_memory_usage() const noexcept {
   return p->estimate_memory_usage();
@@ -1865,6 +2210,7 @@ int64_t array<T>::get_next_key() const {
 template<class T>
 template<class T1>
 void array<T>::sort(const T1& compare, bool renumber) {
+  constexpr int64_t sort_by_keys_threshold = dl::sort_impl_::get_sort_by_keys_threshold<T, T1>();
   int64_t n = count();
 
   if (renumber) {
@@ -1884,8 +2230,14 @@ void array<T>::sort(const T1& compare, bool renumber) {
       mutate_if_vector_shared();
     }
 
-    const auto elements_cmp = [&compare](const T& lhs, const T& rhs) { return compare(lhs, rhs) > 0; };
     T* begin = reinterpret_cast<T*>(p->entries());
+    if constexpr (sort_by_keys_threshold > 0) {
+      if (n >= sort_by_keys_threshold) {
+        dl::sort_impl_::sort_by_keys<dl::comparator_sort_order<T1>::value>(begin, begin + n, [](const T& value) -> const T& { return value; });
+        return;
+      }
+    }
+    const auto elements_cmp = [&compare](const T& lhs, const T& rhs) { return compare(lhs, rhs) > 0; };
     dl::sort<T, decltype(elements_cmp)>(begin, begin + n, elements_cmp);
     return;
   }
@@ -1907,8 +2259,14 @@ void array<T>::sort(const T1& compare, bool renumber) {
   }
   php_assert(i == n);
 
-  const auto hash_entry_cmp = [&compare](const array_bucket* lhs, const array_bucket* rhs) { return compare(lhs->value, rhs->value) > 0; };
-  dl::sort<array_bucket*, decltype(hash_entry_cmp)>(arTmp, arTmp + n, hash_entry_cmp);
+  if (sort_by_keys_threshold > 0 && n >= sort_by_keys_threshold) {
+    if constexpr (sort_by_keys_threshold > 0) {
+      dl::sort_impl_::sort_by_keys<dl::comparator_sort_order<T1>::value>(arTmp, arTmp + n, [](const array_bucket* bucket) -> const T& { return bucket->value; });
+    }
+  } else {
+    const auto hash_entry_cmp = [&compare](const array_bucket* lhs, const array_bucket* rhs) { return compare(lhs->value, rhs->value) > 0; };
+    dl::sort<array_bucket*, decltype(hash_entry_cmp)>(arTmp, arTmp + n, hash_entry_cmp);
+  }
 
   arTmp[0]->prev = p->get_pointer(p->end());
   p->end()->next = p->get_pointer(arTmp[0]);
@@ -1942,7 +2300,20 @@ void array<T>::ksort(const T1& compare) {
   }
 
   key_type* keysp = (key_type*)keys.p->entries();
-  dl::sort<key_type, T1>(keysp, keysp + n, compare);
+  constexpr dl::sort_order order = dl::comparator_sort_order<T1>::value;
+  if constexpr (order == dl::sort_order::numbers_ascending || order == dl::sort_order::numbers_descending) {
+    if (n >= dl::sort_impl_::RADIX_SORT_THRESHOLD && std::all_of(keysp, keysp + n, [](const key_type& key) { return key.is_int(); })) {
+      auto* int_keys = static_cast<int64_t*>(RuntimeAllocator::get().alloc_script_memory(n * sizeof(int64_t)));
+      std::transform(keysp, keysp + n, int_keys, [](const key_type& key) { return key.as_int(); });
+      dl::sort_impl_::sort_by_keys<order>(int_keys, int_keys + n, [](int64_t key) { return key; });
+      std::copy(int_keys, int_keys + n, keysp);
+      RuntimeAllocator::get().free_script_memory(int_keys, n * sizeof(int64_t));
+    } else {
+      dl::sort<key_type, T1>(keysp, keysp + n, compare);
+    }
+  } else {
+    dl::sort<key_type, T1>(keysp, keysp + n, compare);
+  }
 
   list_hash_entry* prev = (list_hash_entry*)p->end();
   for (uint32_t j = 0; j < n; j++) {
@@ -2182,6 +2553,11 @@ bool array<T>::is_equal_inner_pointer(const array& other) const noexcept {
   return p == other.p;
 }
 
+template<class T>
+const void* array<T>::get_inner_identity() const noexcept {
+  return p;
+}
+
 template<class T>
 void swap(array<T>& lhs, array<T>& rhs) {
   lhs.swap(rhs);
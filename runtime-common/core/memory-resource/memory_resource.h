@@ -46,6 +46,9 @@ public:
 
   size_t total_allocations{0};      // the total number of allocations
   size_t total_memory_allocated{0}; // the total amount of the memory allocated (doesn't take the freed memory into the account)
+
+  size_t bump_allocations{0};    // the number of allocations served by the bump pointer
+  size_t bump_mode_fallbacks{0}; // the number of times the bump pointer mode was left for the pooled allocation
 };
 
 } // namespace memory_resource
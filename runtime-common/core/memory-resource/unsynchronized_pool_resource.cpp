@@ -4,8 +4,10 @@
 
 #include "runtime-common/core/memory-resource/unsynchronized_pool_resource.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <iterator>
+#include <new>
 
 #include "common/wrappers/likely.h"
 #include "runtime-common/core/memory-resource/details/memory_ordered_chunk_list.h"
@@ -22,6 +24,9 @@ void unsynchronized_pool_resource::init(void* buffer, size_t buffer_size, size_t
   extra_memory_head_ = &extra_memory_tail_;
 
   oom_handling_memory_size_ = oom_handling_buffer_size;
+  bump_end_ = nullptr;
+  reserved_memory_end_ = nullptr;
+  reserved_pieces_ = nullptr;
 }
 
 void unsynchronized_pool_resource::hard_reset() noexcept {
@@ -36,8 +41,70 @@ void unsynchronized_pool_resource::unfreeze_oom_handling_memory() noexcept {
 
 void unsynchronized_pool_resource::perform_defragmentation() noexcept {
   memory_debug("perform memory defragmentation\n");
+  leave_bump_mode();
   details::memory_ordered_chunk_list mem_list{memory_begin_, memory_end_};
+  flush_free_memory_to(mem_list);
 
+  for (auto* free_mem = mem_list.flush(); free_mem;) {
+    auto* next_mem = mem_list.get_next(free_mem);
+    put_memory_back(free_mem, free_mem->size());
+    free_mem = next_mem;
+  }
+
+  // update stat
+  register_deallocation(0);
+  ++stats_.defragmentation_calls;
+}
+
+void unsynchronized_pool_resource::reserve_memory_above(const void* boundary) noexcept {
+  memory_debug("reserve memory above %p\n", boundary);
+  php_assert(!reserved_memory_end_ && !reserved_pieces_);
+  leave_bump_mode();
+  details::memory_ordered_chunk_list mem_list{memory_begin_, memory_end_};
+  flush_free_memory_to(mem_list);
+
+  // the merged pieces go in the address order
+  const auto* bound = static_cast<const char*>(boundary);
+  reserved_piece** reserved_pieces_tail = &reserved_pieces_;
+  for (auto* free_mem = mem_list.flush(); free_mem;) {
+    auto* next_mem = mem_list.get_next(free_mem);
+    auto* mem = reinterpret_cast<char*>(free_mem);
+    const size_t size = free_mem->size();
+    size_t available_size = bound > mem ? std::min(size, details::align_for_chunk(static_cast<size_t>(bound - mem))) : 0;
+    // the last piece gives the memory back to the pool, and a tiny piece can't be reserved
+    if (mem + size == memory_current_ || size - available_size < sizeof(reserved_piece)) {
+      available_size = size;
+    }
+    if (available_size) {
+      put_memory_back(mem, available_size);
+    }
+    if (available_size != size) {
+      *reserved_pieces_tail = new (mem + available_size) reserved_piece{nullptr, size - available_size};
+      reserved_pieces_tail = &(*reserved_pieces_tail)->next;
+    }
+    free_mem = next_mem;
+  }
+
+  reserved_memory_end_ = memory_end_;
+  memory_end_ = memory_current_;
+  register_deallocation(0);
+}
+
+void unsynchronized_pool_resource::release_reserved_memory() noexcept {
+  memory_debug("release reserved memory\n");
+  php_assert(reserved_memory_end_);
+  memory_end_ = reserved_memory_end_;
+  reserved_memory_end_ = nullptr;
+  for (reserved_piece* piece = reserved_pieces_; piece;) {
+    reserved_piece* next = piece->next;
+    put_memory_back(piece, piece->size);
+    piece = next;
+  }
+  reserved_pieces_ = nullptr;
+  register_deallocation(0);
+}
+
+void unsynchronized_pool_resource::flush_free_memory_to(details::memory_ordered_chunk_list& mem_list) noexcept {
   huge_pieces_.flush_to(mem_list);
   if (const auto fallback_resource_left_size{fallback_resource_.size()};
       fallback_resource_left_size > 0 &&
@@ -58,15 +125,6 @@ void unsynchronized_pool_resource::perform_defragmentation() noexcept {
 
   stats_.small_memory_pieces = 0;
   stats_.huge_memory_pieces = 0;
-  for (auto* free_mem = mem_list.flush(); free_mem;) {
-    auto* next_mem = mem_list.get_next(free_mem);
-    put_memory_back(free_mem, free_mem->size());
-    free_mem = next_mem;
-  }
-
-  // update stat
-  register_deallocation(0);
-  ++stats_.defragmentation_calls;
 }
 
 void* unsynchronized_pool_resource::allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept {
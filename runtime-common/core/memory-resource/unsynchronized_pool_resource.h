@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 
@@ -30,6 +31,17 @@ public:
   void* allocate(size_t size) noexcept {
     void* mem = nullptr;
     const auto aligned_size = details::align_for_chunk(size);
+    if (bump_end_) {
+      if (likely(static_cast<size_t>(bump_end_ - memory_current_) >= aligned_size)) {
+        mem = memory_current_;
+        memory_current_ += aligned_size;
+        ++stats_.bump_allocations;
+        memory_debug("allocate %zu, allocated address by bump pointer %p\n", aligned_size, mem);
+        register_allocation(mem, aligned_size);
+        return mem;
+      }
+      leave_bump_mode();
+    }
     if (aligned_size < MAX_CHUNK_BLOCK_SIZE) {
       mem = try_allocate_small_piece(aligned_size);
       if (!mem) {
@@ -63,12 +75,35 @@ public:
   void deallocate(void* mem, size_t size) noexcept {
     memory_debug("deallocate %zu at %p\n", size, mem);
     const auto aligned_size = details::align_for_chunk(size);
-    put_memory_back(mem, aligned_size);
+    if (bump_end_) {
+      // the freed pieces are not reused until the resource is reinitialized, only the last one is given back to the pool
+      if (static_cast<char*>(mem) + aligned_size == memory_current_) {
+        memory_current_ = static_cast<char*>(mem);
+      }
+    } else {
+      put_memory_back(mem, aligned_size);
+    }
     register_deallocation(aligned_size);
   }
 
+  // all the allocations are served by a bump pointer and the freed memory isn't tracked,
+  // until the used part of the buffer exceeds the limit, then the pooled allocation takes over;
+  // it is reset by init()
+  void enable_bump_mode(size_t bump_limit) noexcept {
+    bump_end_ = memory_begin_ + std::min(bump_limit, static_cast<size_t>(memory_end_ - memory_begin_));
+  }
+
+  bool is_bump_mode_enabled() const noexcept {
+    return bump_end_ != nullptr;
+  }
+
   void perform_defragmentation() noexcept;
 
+  // until the reservation is released, the memory that was never used and the freed pieces above the boundary are hidden,
+  // so the live data can be moved down into the holes, and the used part of the buffer shrinks
+  void reserve_memory_above(const void* boundary) noexcept;
+  void release_reserved_memory() noexcept;
+
   bool is_enough_memory_for(size_t size) const noexcept {
     const auto aligned_size = details::align_for_chunk(size);
     // not using free_chunks_ here as the real size can be smaller
@@ -116,7 +151,16 @@ private:
     return mem;
   }
 
+  void leave_bump_mode() noexcept {
+    if (bump_end_) {
+      memory_debug("leave bump pointer mode, %zu bytes used\n", static_cast<size_t>(memory_current_ - memory_begin_));
+      bump_end_ = nullptr;
+      ++stats_.bump_mode_fallbacks;
+    }
+  }
+
   void* allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept;
+  void flush_free_memory_to(details::memory_ordered_chunk_list& mem_list) noexcept;
   void* perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept;
   bool is_memory_from_extra_pool(void* mem, size_t size) const noexcept;
 
@@ -141,6 +185,14 @@ private:
   details::memory_chunk_tree huge_pieces_;
   monotonic_buffer_resource fallback_resource_;
   size_t oom_handling_memory_size_{0};
+  char* bump_end_{nullptr};
+
+  struct reserved_piece {
+    reserved_piece* next;
+    size_t size;
+  };
+  char* reserved_memory_end_{nullptr};
+  reserved_piece* reserved_pieces_{nullptr};
 
   extra_memory_pool* extra_memory_head_{nullptr};
   extra_memory_pool extra_memory_tail_{sizeof(extra_memory_pool)};
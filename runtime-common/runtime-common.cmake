@@ -18,6 +18,7 @@ add_dependencies(runtime-common-pic UBER_H3::pic::uber-h3 KPHP_TIMELIB::pic::tim
 
 target_link_libraries(runtime-common-no-pic PUBLIC UBER_H3::no-pic::uber-h3 KPHP_TIMELIB::no-pic::timelib)
 add_dependencies(runtime-common-no-pic UBER_H3::no-pic::uber-h3 KPHP_TIMELIB::no-pic::timelib)
+target_compile_options(runtime-common-no-pic PRIVATE ${RUNTIME_PROFILE_FLAGS})
 
 if(COMPILE_RUNTIME_LIGHT)
   target_compile_options(runtime-common-pic PUBLIC -stdlib=libc++ ${RUNTIME_LIGHT_VISIBILITY})
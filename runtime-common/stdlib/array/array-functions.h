@@ -4,11 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <numeric>
 #include <tuple>
 
+#include "common/algorithms/simd-array.h"
 #include "common/type_traits/function_traits.h"
 #include "common/type_traits/list_of_types.h"
 #include "common/vector-product.h"
@@ -51,6 +54,8 @@ array<T> array_diff(const array<T>& a1, const array<T1>& a2, const Proj& key_pro
 
 template<class T>
 struct sort_compare {
+  static constexpr dl::sort_order order = dl::sort_order::numbers_ascending;
+
   bool operator()(const T& h1, const T& h2) const {
     return lt(h2, h1);
   }
@@ -59,6 +64,7 @@ struct sort_compare {
 template<class T>
 struct sort_compare_numeric {
   static_assert(!std::is_same<T, int>{}, "int is forbidden");
+  static constexpr dl::sort_order order = dl::sort_order::numbers_ascending;
 
   bool operator()(const T& h1, const T& h2) const {
     return f$floatval(h1) > f$floatval(h2);
@@ -66,10 +72,14 @@ struct sort_compare_numeric {
 };
 
 template<>
-struct sort_compare_numeric<int64_t> : std::greater<int64_t> {};
+struct sort_compare_numeric<int64_t> : std::greater<int64_t> {
+  static constexpr dl::sort_order order = dl::sort_order::numbers_ascending;
+};
 
 template<class T>
 struct sort_compare_string {
+  static constexpr dl::sort_order order = dl::sort_order::bytes_ascending;
+
   bool operator()(const T& h1, const T& h2) const {
     return f$strval(h1).compare(f$strval(h2)) > 0;
   }
@@ -84,6 +94,8 @@ struct sort_compare_natural {
 
 template<class T>
 struct rsort_compare {
+  static constexpr dl::sort_order order = dl::sort_order::numbers_descending;
+
   bool operator()(const T& h1, const T& h2) const {
     return lt(h1, h2);
   }
@@ -92,6 +104,7 @@ struct rsort_compare {
 template<class T>
 struct rsort_compare_numeric {
   static_assert(!std::is_same<T, int>{}, "int is forbidden");
+  static constexpr dl::sort_order order = dl::sort_order::numbers_descending;
 
   bool operator()(const T& h1, const T& h2) const {
     return f$floatval(h1) < f$floatval(h2);
@@ -99,15 +112,59 @@ struct rsort_compare_numeric {
 };
 
 template<>
-struct rsort_compare_numeric<int64_t> : std::less<int64_t> {};
+struct rsort_compare_numeric<int64_t> : std::less<int64_t> {
+  static constexpr dl::sort_order order = dl::sort_order::numbers_descending;
+};
 
 template<class T>
 struct rsort_compare_string {
+  static constexpr dl::sort_order order = dl::sort_order::bytes_descending;
+
   bool operator()(const T& h1, const T& h2) const {
     return f$strval(h1).compare(f$strval(h2)) < 0;
   }
 };
 
+// the vectors of the numbers and the strings are scanned without the iterators;
+// the numbers are compared in the same way by == and ===, while the strings only by ===
+template<class T, class T1>
+inline constexpr bool is_vector_scan_supported =
+  std::is_same_v<T, T1> && (std::is_same_v<T, int64_t> || std::is_same_v<T, double> || std::is_same_v<T, string>);
+
+// the length and the first 8 bytes are checked before the whole string
+inline bool strings_equal_by_prefix(const string& lhs, const string& rhs) noexcept {
+  const string::size_type size = lhs.size();
+  if (size != rhs.size() || lhs.c_str() == rhs.c_str()) {
+    return size == rhs.size();
+  }
+  if (size >= sizeof(uint64_t)) {
+    uint64_t lhs_prefix = 0;
+    uint64_t rhs_prefix = 0;
+    std::memcpy(&lhs_prefix, lhs.c_str(), sizeof(uint64_t));
+    std::memcpy(&rhs_prefix, rhs.c_str(), sizeof(uint64_t));
+    if (lhs_prefix != rhs_prefix) {
+      return false;
+    }
+  }
+  return std::memcmp(lhs.c_str(), rhs.c_str(), size) == 0;
+}
+
+// returns the index of the first element of the vector equal to the value, or -1
+template<class T>
+int64_t find_in_vector(const array<T>& a, const T& value) noexcept {
+  const T* begin = a.get_const_vector_pointer();
+  const T* end = begin + a.count();
+  const T* found = end;
+  if constexpr (std::is_same_v<T, int64_t>) {
+    found = vk::simd::find_int64(begin, end, value);
+  } else if constexpr (std::is_same_v<T, double>) {
+    found = vk::simd::find_double(begin, end, value);
+  } else {
+    found = std::find_if(begin, end, [&value](const string& element) { return strings_equal_by_prefix(element, value); });
+  }
+  return found == end ? -1 : found - begin;
+}
+
 } // namespace array_functions_impl_
 
 template<class T>
@@ -367,6 +424,16 @@ void f$array_merge_into(T& a, const T1& another_array) noexcept {
   a.merge_with(another_array);
 }
 
+template<class T>
+void f$_array_merge_self(array<T>& a, const array<T>& another_array) noexcept {
+  // array_merge() renumbers the integer keys of the first array, so only a vector can be merged in place
+  if (!a.is_vector()) {
+    a = f$array_merge(a, another_array);
+    return;
+  }
+  a.merge_with(another_array);
+}
+
 template<class T>
 void f$array_reserve(array<T>& a, int64_t int_size, int64_t string_size, bool make_vector_if_possible = true) noexcept {
   a.reserve(int_size + string_size, make_vector_if_possible);
@@ -393,6 +460,12 @@ void f$array_reserve_from(array<T1>& a, const array<T2>& base) noexcept {
   f$array_reserve(a, size_info.size, size_info.is_vector);
 }
 
+template<class T1, class T2>
+void f$_array_reserve_for_push_back(array<T1>& a, const array<T2>& base) noexcept {
+  // in nested loops it's called for the same array many times
+  a.reserve_with_growth(a.count() + base.count(), true);
+}
+
 template<class T>
 array<array<T>> f$array_chunk(const array<T>& a, int64_t chunk_size, bool preserve_keys = false) noexcept {
   if (unlikely(chunk_size <= 0)) {
@@ -543,6 +616,13 @@ template<class T, class ReturnT = std::conditional_t<std::is_same<T, int64_t>{},
 ReturnT f$array_sum(const array<T>& a) noexcept {
   static_assert(!std::is_same_v<T, int>, "int is forbidden");
 
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      const int64_t* begin = a.get_const_vector_pointer();
+      return vk::simd::sum_int64(begin, begin + a.count());
+    }
+  }
+
   ReturnT result = 0;
   for (const auto& it : a) {
     if constexpr (std::is_same_v<T, int64_t>) {
@@ -556,6 +636,13 @@ ReturnT f$array_sum(const array<T>& a) noexcept {
 
 template<class T, class T1>
 typename array<T>::key_type f$array_search(const T1& val, const array<T>& a, bool strict = false) noexcept {
+  if constexpr (array_functions_impl_::is_vector_scan_supported<T, T1>) {
+    if (a.is_vector() && (strict || !std::is_same_v<T, string>)) {
+      const int64_t index = array_functions_impl_::find_in_vector(a, val);
+      return index == -1 ? typename array<T>::key_type(false) : typename array<T>::key_type(index);
+    }
+  }
+
   for (const auto& it : a) {
     if (strict ? equals(it.get_value(), val) : eq2(it.get_value(), val)) {
       return it.get_key();
@@ -567,6 +654,12 @@ typename array<T>::key_type f$array_search(const T1& val, const array<T>& a, boo
 
 template<class T, class T1>
 bool f$in_array(const T1& value, const array<T>& a, bool strict = false) noexcept {
+  if constexpr (array_functions_impl_::is_vector_scan_supported<T, T1>) {
+    if (a.is_vector() && (strict || !std::is_same_v<T, string>)) {
+      return array_functions_impl_::find_in_vector(a, value) != -1;
+    }
+  }
+
   if (!strict) {
     for (const auto& it : a) {
       if (eq2(it.get_value(), value)) {
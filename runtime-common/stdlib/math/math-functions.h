@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <limits>
 
+#include "common/algorithms/simd-array.h"
 #include "runtime-common/core/runtime-core.h"
 
 namespace math_functions_impl_ {
@@ -178,6 +179,11 @@ T f$min(const array<T>& a) noexcept {
     php_warning("Empty array specified to function min");
     return T();
   }
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      return vk::simd::min_int64(a.get_const_vector_pointer(), a.get_const_vector_pointer() + a.count());
+    }
+  }
 
   typename array<T>::const_iterator p = a.begin();
   T res = p.get_value();
@@ -195,6 +201,11 @@ T f$max(const array<T>& a) noexcept {
     php_warning("Empty array specified to function max");
     return T();
   }
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      return vk::simd::max_int64(a.get_const_vector_pointer(), a.get_const_vector_pointer() + a.count());
+    }
+  }
 
   typename array<T>::const_iterator p = a.begin();
   T res = p.get_value();
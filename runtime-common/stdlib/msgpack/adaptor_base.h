@@ -7,7 +7,7 @@
 
 namespace vk::msgpack {
 
-struct object;
+class unpacker;
 
 template<typename Stream>
 class packer;
@@ -16,8 +16,8 @@ namespace adaptor {
 
 template<typename T>
 struct convert {
-  void operator()(const msgpack::object& o, T& v) const {
-    v.msgpack_unpack(o);
+  void operator()(msgpack::unpacker& unpacker, T& v) const {
+    v.msgpack_unpack(unpacker);
   }
 };
 
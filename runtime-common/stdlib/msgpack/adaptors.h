@@ -10,6 +10,7 @@
 #include "runtime-common/stdlib/msgpack/check_instance_depth.h"
 #include "runtime-common/stdlib/msgpack/object.h"
 #include "runtime-common/stdlib/msgpack/packer.h"
+#include "runtime-common/stdlib/msgpack/unpacker.h"
 
 namespace vk::msgpack {
 
@@ -72,36 +73,36 @@ namespace adaptor {
 
 template<>
 struct convert<int32_t> {
-  void operator()(const msgpack::object& o, int32_t& v) const {
-    v = detail::convert_integer<int32_t>(o);
+  void operator()(msgpack::unpacker& unpacker, int32_t& v) const {
+    v = detail::convert_integer<int32_t>(unpacker.next_scalar());
   }
 };
 
 template<>
 struct convert<int64_t> {
-  void operator()(const msgpack::object& o, int64_t& v) const {
-    v = detail::convert_integer<int64_t>(o);
+  void operator()(msgpack::unpacker& unpacker, int64_t& v) const {
+    v = detail::convert_integer<int64_t>(unpacker.next_scalar());
   }
 };
 
 template<>
 struct convert<uint8_t> {
-  void operator()(const msgpack::object& o, uint8_t& v) const {
-    v = detail::convert_integer<uint8_t>(o);
+  void operator()(msgpack::unpacker& unpacker, uint8_t& v) const {
+    v = detail::convert_integer<uint8_t>(unpacker.next_scalar());
   }
 };
 
 template<>
 struct convert<uint32_t> {
-  void operator()(const msgpack::object& o, uint32_t& v) const {
-    v = detail::convert_integer<uint32_t>(o);
+  void operator()(msgpack::unpacker& unpacker, uint32_t& v) const {
+    v = detail::convert_integer<uint32_t>(unpacker.next_scalar());
   }
 };
 
 template<>
 struct convert<uint64_t> {
-  void operator()(const msgpack::object& o, uint64_t& v) const {
-    v = detail::convert_integer<uint64_t>(o);
+  void operator()(msgpack::unpacker& unpacker, uint64_t& v) const {
+    v = detail::convert_integer<uint64_t>(unpacker.next_scalar());
   }
 };
 
@@ -147,7 +148,8 @@ struct pack<uint64_t> {
 
 template<>
 struct convert<bool> {
-  void operator()(const msgpack::object& o, bool& v) const {
+  void operator()(msgpack::unpacker& unpacker, bool& v) const {
+    const msgpack::object o = unpacker.next_scalar();
     if (o.type != stored_type::BOOLEAN) {
       SerializationLibContext::get().set_msgpack_error(TYPE_ERROR);
       return;
@@ -170,7 +172,8 @@ struct pack<bool> {
 
 template<>
 struct convert<float> {
-  void operator()(const msgpack::object& o, float& v) const {
+  void operator()(msgpack::unpacker& unpacker, float& v) const {
+    const msgpack::object o = unpacker.next_scalar();
     if (o.type == stored_type::FLOAT32 || o.type == stored_type::FLOAT64) {
       v = static_cast<float>(o.via.f64);
     } else if (o.type == stored_type::POSITIVE_INTEGER) {
@@ -194,7 +197,8 @@ struct pack<float> {
 
 template<>
 struct convert<double> {
-  void operator()(const msgpack::object& o, double& v) const {
+  void operator()(msgpack::unpacker& unpacker, double& v) const {
+    const msgpack::object o = unpacker.next_scalar();
     if (o.type == stored_type::FLOAT32 || o.type == stored_type::FLOAT64) {
       v = o.via.f64;
     } else if (o.type == stored_type::POSITIVE_INTEGER) {
@@ -218,47 +222,46 @@ struct pack<double> {
 
 template<class T>
 struct convert<array<T>> {
-  const msgpack::object& operator()(const msgpack::object& obj, array<T>& res_arr) const {
+  void operator()(msgpack::unpacker& unpacker, array<T>& res_arr) const {
+    const msgpack::object obj = unpacker.next();
     if (obj.type == stored_type::ARRAY) {
       res_arr.reserve(obj.via.array.size, true);
 
       for (uint32_t i = 0; i < obj.via.array.size; ++i) {
-        res_arr.set_value(static_cast<int64_t>(i), obj.via.array.ptr[i].as<T>());
+        res_arr.set_value(static_cast<int64_t>(i), unpacker.unpack<T>());
       }
 
-      return obj;
+      return;
     }
 
     if (obj.type == stored_type::MAP) {
-      fill_array_as_map(obj.via.map, res_arr);
-      return obj;
+      fill_array_as_map(unpacker, obj.via.map, res_arr);
+      return;
     }
     SerializationLibContext::get().set_msgpack_error("couldn't recognize type of unpacking array");
-    return obj;
   }
 
 private:
-  static void fill_array_as_map(const msgpack::object_map& obj_map, array<T>& res_arr) {
+  static void fill_array_as_map(msgpack::unpacker& unpacker, const msgpack::object_map& obj_map, array<T>& res_arr) {
     res_arr.reserve(obj_map.size, false);
 
-    for (size_t i = 0; i < obj_map.size; ++i) {
-      auto& key = obj_map.ptr[i].key;
-      auto& value = obj_map.ptr[i].val;
-
-      switch (key.type) {
+    for (uint32_t i = 0; i < obj_map.size; ++i) {
+      switch (unpacker.peek().type) {
       case stored_type::POSITIVE_INTEGER:
       case stored_type::NEGATIVE_INTEGER: {
-        const auto key_php = key.as<int64_t>();
-        res_arr.set_value(key_php, value.as<T>());
+        const auto key_php = unpacker.unpack<int64_t>();
+        res_arr.set_value(key_php, unpacker.unpack<T>());
         break;
       }
       case stored_type::STR: {
-        const auto& key_php = key.as<string>();
-        res_arr.set_value(key_php, value.as<T>());
+        const auto key_php = unpacker.unpack<string>();
+        res_arr.set_value(key_php, unpacker.unpack<T>());
         break;
       }
       default:
         SerializationLibContext::get().set_msgpack_error("expected string or integer in array unpacking");
+        // the rest of the keys and values are not needed
+        unpacker.skip(2 * static_cast<uint64_t>(obj_map.size - i));
         return;
       }
     }
@@ -293,21 +296,21 @@ struct pack<array<T>> {
 
 template<class T>
 struct convert<class_instance<T>> {
-  const msgpack::object& operator()(const msgpack::object& obj, class_instance<T>& instance) const {
-    switch (obj.type) {
+  void operator()(msgpack::unpacker& unpacker, class_instance<T>& instance) const {
+    switch (unpacker.peek().type) {
     case stored_type::NIL:
+      unpacker.skip();
       instance = class_instance<T>{};
       break;
     case stored_type::ARRAY:
       instance = class_instance<T>{}.alloc();
-      obj.convert(*instance.get());
+      unpacker.unpack(*instance.get());
       break;
     default:
       SerializationLibContext::get().set_msgpack_error("Expected NIL or ARRAY type for unpacking class_instance");
-      return obj;
+      unpacker.skip();
+      return;
     }
-
-    return obj;
   }
 };
 
@@ -331,14 +334,13 @@ struct pack<class_instance<T>> {
 
 template<>
 struct convert<string> {
-  const msgpack::object& operator()(const msgpack::object& obj, string& res_s) const {
+  void operator()(msgpack::unpacker& unpacker, string& res_s) const {
+    const msgpack::object obj = unpacker.next_scalar();
     if (obj.type != stored_type::STR) {
       SerializationLibContext::get().set_msgpack_error(TYPE_ERROR);
-      return obj;
+      return;
     }
     res_s = string(obj.via.str.ptr, obj.via.str.size);
-
-    return obj;
   }
 };
 
@@ -354,16 +356,16 @@ struct pack<string> {
 
 template<typename Tuple, std::size_t N>
 struct StdTupleConverter {
-  static void convert(const msgpack::object& o, Tuple& v) {
-    StdTupleConverter<Tuple, N - 1>::convert(o, v);
-    if (o.via.array.size >= N)
-      o.via.array.ptr[N - 1].convert<typename std::remove_reference<decltype(std::get<N - 1>(v))>::type>(std::get<N - 1>(v));
+  static void convert(msgpack::unpacker& unpacker, uint32_t size, Tuple& v) {
+    StdTupleConverter<Tuple, N - 1>::convert(unpacker, size, v);
+    if (size >= N)
+      unpacker.unpack(std::get<N - 1>(v));
   }
 };
 
 template<typename Tuple>
 struct StdTupleConverter<Tuple, 0> {
-  static void convert(const msgpack::object& /*o*/, Tuple& /*v*/) {}
+  static void convert(msgpack::unpacker& /*unpacker*/, uint32_t /*size*/, Tuple& /*v*/) {}
 };
 
 template<size_t N>
@@ -383,12 +385,17 @@ struct PackValueHelper<0> {
 
 template<typename... Args>
 struct convert<std::tuple<Args...>> {
-  void operator()(const msgpack::object& o, std::tuple<Args...>& v) const {
+  void operator()(msgpack::unpacker& unpacker, std::tuple<Args...>& v) const {
+    const msgpack::object o = unpacker.next();
     if (o.type != stored_type::ARRAY) {
       SerializationLibContext::get().set_msgpack_error(TYPE_ERROR);
+      unpacker.skip_nested(o);
       return;
     }
-    StdTupleConverter<decltype(v), sizeof...(Args)>::convert(o, v);
+    StdTupleConverter<std::tuple<Args...>, sizeof...(Args)>::convert(unpacker, o.via.array.size, v);
+    if (o.via.array.size > sizeof...(Args)) {
+      unpacker.skip(o.via.array.size - sizeof...(Args));
+    }
   }
 };
 
@@ -403,28 +410,27 @@ struct pack<std::tuple<Args...>> {
 
 template<class T>
 struct convert<Optional<T>> {
-  const msgpack::object& operator()(const msgpack::object& obj, Optional<T>& v) const {
-    switch (obj.type) {
+  void operator()(msgpack::unpacker& unpacker, Optional<T>& v) const {
+    switch (unpacker.peek().type) {
     case stored_type::BOOLEAN: {
-      bool value = obj.as<bool>();
+      bool value = unpacker.unpack<bool>();
       if (!std::is_same<T, bool>{} && value) {
         char err_msg[256];
         snprintf(err_msg, 256, "Expected false for type `%s|false` but true was given", typeid(T).name());
         SerializationLibContext::get().set_msgpack_error(err_msg);
-        return obj;
+        return;
       }
       v = value;
       break;
     }
     case stored_type::NIL:
+      unpacker.skip();
       v = Optional<T>{};
       break;
     default:
-      v = obj.as<T>();
+      v = unpacker.unpack<T>();
       break;
     }
-
-    return obj;
   }
 };
 
@@ -452,38 +458,38 @@ struct pack<Optional<T>> {
 
 template<>
 struct convert<mixed> {
-  const msgpack::object& operator()(const msgpack::object& obj, mixed& v) const {
-    switch (obj.type) {
+  void operator()(msgpack::unpacker& unpacker, mixed& v) const {
+    switch (unpacker.peek().type) {
     case stored_type::STR:
-      v = obj.as<string>();
+      v = unpacker.unpack<string>();
       break;
     case stored_type::ARRAY:
-      v = obj.as<array<mixed>>();
+      v = unpacker.unpack<array<mixed>>();
       break;
     case stored_type::NEGATIVE_INTEGER:
     case stored_type::POSITIVE_INTEGER:
-      v = obj.as<int64_t>();
+      v = unpacker.unpack<int64_t>();
       break;
     case stored_type::FLOAT32:
     case stored_type::FLOAT64:
-      v = obj.as<double>();
+      v = unpacker.unpack<double>();
       break;
     case stored_type::BOOLEAN:
-      v = obj.as<bool>();
+      v = unpacker.unpack<bool>();
       break;
     case stored_type::MAP:
-      v = obj.as<array<mixed>>();
+      v = unpacker.unpack<array<mixed>>();
       break;
     case stored_type::NIL:
+      unpacker.skip();
       v = mixed{};
       break;
     default:
 
       SerializationLibContext::get().set_msgpack_error(TYPE_ERROR);
-      return obj;
+      unpacker.skip();
+      return;
     }
-
-    return obj;
   }
 };
 
@@ -0,0 +1,86 @@
+// Compiler for PHP (aka KPHP)
+// msgpack (c) https://github.com/msgpack/msgpack-c/tree/cpp_master (copied as third-party and slightly modified)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "common/mixin/not_copyable.h"
+#include "common/wrappers/string_view.h"
+
+namespace vk::msgpack {
+
+// Visits the values without storing them anywhere:
+// the parser only checks the input, and then msgpack::unpacker reads the values straight from it
+class check_visitor : vk::not_copyable {
+public:
+  bool visit_nil() const noexcept {
+    return true;
+  }
+  bool visit_boolean(bool /*v*/) const noexcept {
+    return true;
+  }
+  bool visit_positive_integer(uint64_t /*v*/) const noexcept {
+    return true;
+  }
+  bool visit_negative_integer(int64_t /*v*/) const noexcept {
+    return true;
+  }
+  bool visit_float32(float /*v*/) const noexcept {
+    return true;
+  }
+  bool visit_float64(double /*v*/) const noexcept {
+    return true;
+  }
+  bool visit_str(const char* /*v*/, uint32_t /*size*/) const noexcept {
+    return true;
+  }
+  bool start_array(uint32_t /*num_elements*/) const noexcept {
+    return true;
+  }
+  bool start_map(uint32_t /*num_kv_pairs*/) const noexcept {
+    return true;
+  }
+  bool start_array_item() const noexcept {
+    return true;
+  }
+  bool end_array_item() const noexcept {
+    return true;
+  }
+  bool end_array() const noexcept {
+    return true;
+  }
+  bool start_map_key() const noexcept {
+    return true;
+  }
+  bool end_map_key() const noexcept {
+    return true;
+  }
+  bool start_map_value() const noexcept {
+    return true;
+  }
+  bool end_map_value() const noexcept {
+    return true;
+  }
+  bool end_map() const noexcept {
+    return true;
+  }
+  void parse_error(size_t /*parsed_offset*/, size_t /*error_offset*/) noexcept {
+    error = "parse error";
+  }
+  void insufficient_bytes(size_t /*parsed_offset*/, size_t /*error_offset*/) noexcept {
+    error = "insufficient bytes";
+  }
+
+  std::optional<vk::string_view> get_error() const noexcept {
+    return error;
+  }
+
+private:
+  std::optional<vk::string_view> error;
+};
+
+} // namespace vk::msgpack
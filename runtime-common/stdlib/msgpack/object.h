@@ -6,9 +6,6 @@
 #pragma once
 
 #include <cstdint>
-#include <type_traits>
-
-#include "runtime-common/stdlib/msgpack/adaptor_base.h"
 
 namespace vk::msgpack {
 enum class stored_type {
@@ -24,17 +21,12 @@ enum class stored_type {
   MAP = 0x07
 };
 
-struct object;
-struct object_kv;
-
 struct object_array {
   uint32_t size;
-  object* ptr;
 };
 
 struct object_map {
   uint32_t size;
-  object_kv* ptr;
 };
 
 struct object_str {
@@ -42,9 +34,10 @@ struct object_str {
   const char* ptr;
 };
 
-/// Object class that corresponding to MessagePack format object
+/// The header of a MessagePack format object, as it is read by msgpack::unpacker
 /**
- * See https://github.com/msgpack/msgpack-c/wiki/v1_1_cpp_object
+ * Scalars are complete, strings point into the unpacked input,
+ * arrays and maps know only their sizes: the elements (keys and values) follow them in the input.
  */
 struct object {
   union union_type {
@@ -59,39 +52,6 @@ struct object {
 
   stored_type type{stored_type::NIL};
   union_type via{};
-
-  /// Get value as T
-  /**
-   * If the object can't be converted to T, type_error would be thrown.
-   * @tparam T The type you want to get.
-   * @return The converted object.
-   */
-  template<typename T>
-  T as() const {
-    // Without initializationg we have maybe-uninitialized warning.
-    // Assume that default constructor is cheap.
-    T v{};
-    convert(v);
-    return v;
-  }
-
-  /// Convert the object
-  /**
-   * If the object can't be converted to T, type_error would be thrown.
-   * @tparam T The type of v.
-   * @param v The value you want to get. `v` is output parameter. `v` is overwritten by converted value from the object.
-   * @return The reference of `v`.
-   */
-  template<typename T>
-  std::enable_if_t<!std::is_array_v<T> && !std::is_pointer_v<T>, T&> convert(T& v) const {
-    adaptor::convert<T>{}(*this, v);
-    return v;
-  }
-};
-
-struct object_kv {
-  object key;
-  object val;
 };
 
 } // namespace vk::msgpack
@@ -9,7 +9,7 @@
 
 #include "runtime-common/core/allocator/script-allocator.h"
 #include "runtime-common/core/std/containers.h"
-#include "runtime-common/stdlib/msgpack/object_visitor.h"
+#include "runtime-common/stdlib/msgpack/check_visitor.h"
 #include "runtime-common/stdlib/msgpack/parser.h"
 #include "runtime-common/stdlib/msgpack/sysdep.h"
 
@@ -626,5 +626,5 @@ parse_return parser<Visitor>::parse(const char* data, size_t len, size_t& off, V
   }
 }
 
-template parse_return parser<object_visitor>::parse(const char* data, size_t len, size_t& off, object_visitor& v);
+template parse_return parser<check_visitor>::parse(const char* data, size_t len, size_t& off, check_visitor& v);
 } // namespace vk::msgpack
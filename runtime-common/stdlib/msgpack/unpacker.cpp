@@ -5,25 +5,173 @@
 
 #include "runtime-common/stdlib/msgpack/unpacker.h"
 
+#include <cstring>
+#include <type_traits>
+
 #include "runtime-common/core/runtime-core.h"
-#include "runtime-common/stdlib/msgpack/object_visitor.h"
+#include "runtime-common/stdlib/msgpack/check_visitor.h"
 #include "runtime-common/stdlib/msgpack/parser.h"
+#include "runtime-common/stdlib/msgpack/sysdep.h"
 #include "runtime-common/stdlib/serialization/serialization-context.h"
 
 namespace vk::msgpack {
 
-msgpack::object unpacker::unpack() {
-  object_visitor visitor{zone_};
-  parse_return ret = parser<object_visitor>::parse(input_.c_str(), input_.size(), bytes_consumed_, visitor);
+namespace {
+
+template<typename T>
+T load(const char* pos) noexcept {
+  T value{};
+  if constexpr (sizeof(T) == 1) {
+    std::memcpy(&value, pos, 1);
+  } else if constexpr (sizeof(T) == 2) {
+    _msgpack_load16(T, pos, &value);
+  } else if constexpr (sizeof(T) == 4) {
+    _msgpack_load32(T, pos, &value);
+  } else {
+    _msgpack_load64(T, pos, &value);
+  }
+  return value;
+}
+
+template<typename T>
+const char* read_integer(const char* pos, msgpack::object& obj) noexcept {
+  const T value = load<T>(pos);
+  // the same as the parser visitors get them: signed formats with nonnegative values are positive integers
+  if constexpr (std::is_signed_v<T>) {
+    if (value < 0) {
+      obj.type = stored_type::NEGATIVE_INTEGER;
+      obj.via.i64 = value;
+      return pos + sizeof(T);
+    }
+  }
+  obj.type = stored_type::POSITIVE_INTEGER;
+  obj.via.u64 = static_cast<uint64_t>(value);
+  return pos + sizeof(T);
+}
+
+template<typename T>
+const char* read_str(const char* pos, msgpack::object& obj) noexcept {
+  obj.type = stored_type::STR;
+  obj.via.str.size = load<T>(pos);
+  obj.via.str.ptr = pos + sizeof(T);
+  return obj.via.str.ptr + obj.via.str.size;
+}
+
+} // namespace
+
+void unpacker::check_input() noexcept {
+  check_visitor visitor;
+  parser<check_visitor>::parse(input_.c_str(), input_.size(), bytes_consumed_, visitor);
   visitor_error_ = visitor.get_error();
+  pos_ = input_.c_str();
+}
 
-  switch (ret) {
-  case parse_return::SUCCESS:
-  case parse_return::EXTRA_BYTES:
-    return std::move(visitor).flush();
+const char* unpacker::read_header(const char* pos, msgpack::object& obj) noexcept {
+  const auto selector = static_cast<uint8_t>(*pos++);
+  if (selector <= 0x7f) { // Positive Fixnum
+    obj.type = stored_type::POSITIVE_INTEGER;
+    obj.via.u64 = selector;
+    return pos;
+  }
+  if (selector >= 0xe0) { // Negative Fixnum
+    obj.type = stored_type::NEGATIVE_INTEGER;
+    obj.via.i64 = static_cast<int8_t>(selector);
+    return pos;
+  }
+  if (selector >= 0xa0 && selector <= 0xbf) { // FixStr
+    obj.type = stored_type::STR;
+    obj.via.str.size = selector & 0x1f;
+    obj.via.str.ptr = pos;
+    return pos + obj.via.str.size;
+  }
+  if (selector >= 0x90 && selector <= 0x9f) { // FixArray
+    obj.type = stored_type::ARRAY;
+    obj.via.array.size = selector & 0x0f;
+    return pos;
+  }
+  if (selector >= 0x80 && selector <= 0x8f) { // FixMap
+    obj.type = stored_type::MAP;
+    obj.via.map.size = selector & 0x0f;
+    return pos;
+  }
+
+  switch (selector) {
+  case 0xc0:
+    obj.type = stored_type::NIL;
+    return pos;
+  case 0xc2:
+  case 0xc3:
+    obj.type = stored_type::BOOLEAN;
+    obj.via.boolean = selector == 0xc3;
+    return pos;
+  case 0xca: {
+    const auto bits = load<uint32_t>(pos);
+    float value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    obj.type = stored_type::FLOAT32;
+    obj.via.f64 = value;
+    return pos + sizeof(bits);
+  }
+  case 0xcb: {
+    const auto bits = load<uint64_t>(pos);
+    obj.type = stored_type::FLOAT64;
+    std::memcpy(&obj.via.f64, &bits, sizeof(bits));
+    return pos + sizeof(bits);
+  }
+  case 0xcc:
+    return read_integer<uint8_t>(pos, obj);
+  case 0xcd:
+    return read_integer<uint16_t>(pos, obj);
+  case 0xce:
+    return read_integer<uint32_t>(pos, obj);
+  case 0xcf:
+    return read_integer<uint64_t>(pos, obj);
+  case 0xd0:
+    return read_integer<int8_t>(pos, obj);
+  case 0xd1:
+    return read_integer<int16_t>(pos, obj);
+  case 0xd2:
+    return read_integer<int32_t>(pos, obj);
+  case 0xd3:
+    return read_integer<int64_t>(pos, obj);
+  case 0xd9:
+    return read_str<uint8_t>(pos, obj);
+  case 0xda:
+    return read_str<uint16_t>(pos, obj);
+  case 0xdb:
+    return read_str<uint32_t>(pos, obj);
+  case 0xdc:
+    obj.type = stored_type::ARRAY;
+    obj.via.array.size = load<uint16_t>(pos);
+    return pos + sizeof(uint16_t);
+  case 0xdd:
+    obj.type = stored_type::ARRAY;
+    obj.via.array.size = load<uint32_t>(pos);
+    return pos + sizeof(uint32_t);
+  case 0xde:
+    obj.type = stored_type::MAP;
+    obj.via.map.size = load<uint16_t>(pos);
+    return pos + sizeof(uint16_t);
+  case 0xdf:
+    obj.type = stored_type::MAP;
+    obj.via.map.size = load<uint32_t>(pos);
+    return pos + sizeof(uint32_t);
   default:
-    // Error happened
-    return {};
+    // bin and ext are rejected by check_input()
+    php_assert(false);
+    return pos;
+  }
+}
+
+void unpacker::skip(uint64_t count) noexcept {
+  while (count != 0) {
+    const msgpack::object obj = next();
+    --count;
+    if (obj.type == stored_type::ARRAY) {
+      count += obj.via.array.size;
+    } else if (obj.type == stored_type::MAP) {
+      count += 2 * static_cast<uint64_t>(obj.via.map.size);
+    }
   }
 }
 
@@ -5,30 +5,85 @@
 
 #pragma once
 
+#include <optional>
+
 #include "common/mixin/not_copyable.h"
 #include "common/wrappers/string_view.h"
 #include "runtime-common/core/runtime-core.h"
+#include "runtime-common/stdlib/msgpack/adaptor_base.h"
 #include "runtime-common/stdlib/msgpack/object.h"
-#include "runtime-common/stdlib/msgpack/zone.h"
 
 namespace vk::msgpack {
 
+// A pull decoder: the adaptors and the generated msgpack_unpack() methods read the values one by one
+// straight from the input into the resulting kphp values, there is no intermediate tree of objects.
+// The whole input is checked by check_input() first, so that the values are read without bounds checks
+// and the parse errors are reported before any value is converted.
 class unpacker : private vk::not_copyable {
 public:
   explicit unpacker(const string& input) noexcept
       : input_(input) {}
 
-  msgpack::object unpack();
+  void check_input() noexcept;
+
+  template<typename T>
+  void unpack(T& v) {
+    adaptor::convert<T>{}(*this, v);
+  }
+
+  template<typename T>
+  T unpack() {
+    // Without initializationg we have maybe-uninitialized warning.
+    // Assume that default constructor is cheap.
+    T v{};
+    unpack(v);
+    return v;
+  }
+
+  // the header of the next value, see msgpack::object
+  msgpack::object peek() const noexcept {
+    msgpack::object obj;
+    read_header(pos_, obj);
+    return obj;
+  }
+
+  // reads the header of the next value, the nested values of arrays and maps are read after it
+  msgpack::object next() noexcept {
+    msgpack::object obj;
+    pos_ = read_header(pos_, obj);
+    return obj;
+  }
+
+  // reads the next value, skipping the nested values of arrays and maps: only their headers are returned
+  msgpack::object next_scalar() noexcept {
+    const msgpack::object obj = next();
+    skip_nested(obj);
+    return obj;
+  }
+
+  // skips the count of values with all the nested ones
+  void skip(uint64_t count = 1) noexcept;
+
+  // skips the nested values of the header read by next()
+  void skip_nested(const msgpack::object& obj) noexcept {
+    if (obj.type == stored_type::ARRAY) {
+      skip(obj.via.array.size);
+    } else if (obj.type == stored_type::MAP) {
+      skip(2 * static_cast<uint64_t>(obj.via.map.size));
+    }
+  }
+
   bool has_error() const noexcept;
   string get_error_msg() const noexcept;
 
 private:
+  static const char* read_header(const char* pos, msgpack::object& obj) noexcept;
+
   const string& input_;
+  const char* pos_{nullptr};
   std::size_t bytes_consumed_{0};
-  msgpack::zone zone_;
 
-  // It's awful because unpacker and visitor are strongly logically connected,
-  // but there is no aggregation or composition. Should be fixed some day.
+  // the error found by check_input()
   std::optional<vk::string_view> visitor_error_;
 };
 
@@ -7,13 +7,15 @@
 #include "runtime-common/core/runtime-core.h"
 #include "runtime-common/stdlib/serialization/json-functions.h"
 #include "runtime-common/stdlib/serialization/json-processor-utils.h"
+#include "runtime-common/stdlib/serialization/json-tape.h"
 #include "runtime-common/stdlib/serialization/serialization-context.h"
 
 template<class Tag>
 class FromJsonVisitor {
 public:
-  explicit FromJsonVisitor(const mixed& json, bool flatten_class, JsonPath& json_path) noexcept
+  explicit FromJsonVisitor(JsonTape::Value json, bool flatten_class, JsonPath& json_path) noexcept
       : json_(json),
+        members_(json),
         flatten_class_(flatten_class),
         json_path_(json_path) {}
 
@@ -27,7 +29,7 @@ public:
       return;
     }
     json_path_.enter(key);
-    const auto* json_value = json_.as_array().find_value(string{key});
+    const auto json_value = members_.find(key);
     if (required && !json_value) {
       error_.append("absent required field ");
       error_.append(json_path_.to_string());
@@ -50,18 +52,18 @@ public:
   }
 
 private:
-  [[gnu::noinline]] void on_input_type_mismatch(const mixed& json) noexcept {
+  [[gnu::noinline]] void on_input_type_mismatch(JsonTape::Value json) noexcept {
     error_.assign("unexpected type ");
     if (json.is_array()) {
-      error_.append(json.as_array().is_vector() ? "array" : "object");
+      error_.append(json.is_vector() ? "array" : "object");
     } else {
-      error_.append(json.get_type_str());
+      error_.append(json.get_type_c_str());
     }
     error_.append(" for key ");
     error_.append(json_path_.to_string());
   }
 
-  void do_set(bool& value, const mixed& json) noexcept {
+  void do_set(bool& value, JsonTape::Value json) noexcept {
     if (!json.is_bool()) {
       on_input_type_mismatch(json);
       return;
@@ -69,7 +71,7 @@ private:
     value = json.as_bool();
   }
 
-  void do_set(std::int64_t& value, const mixed& json) noexcept {
+  void do_set(std::int64_t& value, JsonTape::Value json) noexcept {
     if (!json.is_int()) {
       on_input_type_mismatch(json);
       return;
@@ -77,7 +79,7 @@ private:
     value = json.as_int();
   }
 
-  void do_set(double& value, const mixed& json) noexcept {
+  void do_set(double& value, JsonTape::Value json) noexcept {
     if (!json.is_float() && !json.is_int()) {
       on_input_type_mismatch(json);
       return;
@@ -85,7 +87,7 @@ private:
     value = json.is_int() ? json.as_int() : json.as_double();
   }
 
-  void do_set(string& value, const mixed& json) noexcept {
+  void do_set(string& value, JsonTape::Value json) noexcept {
     if (!json.is_string()) {
       on_input_type_mismatch(json);
       return;
@@ -93,9 +95,9 @@ private:
     value = json.as_string();
   }
 
-  void do_set(JsonRawString& value, const mixed& json) noexcept {
+  void do_set(JsonRawString& value, JsonTape::Value json) noexcept {
     runtime_context_buffer.clean();
-    if (!impl_::JsonEncoder{0, false, get_json_obj_magic_key()}.encode(json, runtime_context_buffer)) {
+    if (!impl_::JsonEncoder{0, false, get_json_obj_magic_key()}.encode(json.to_mixed(), runtime_context_buffer)) {
       error_.append("failed to decode @kphp-json raw_string field ");
       error_.append(json_path_.to_string());
       return;
@@ -104,7 +106,7 @@ private:
   }
 
   template<class T>
-  void do_set(Optional<T>& value, const mixed& json) noexcept {
+  void do_set(Optional<T>& value, JsonTape::Value json) noexcept {
     if (json.is_null()) {
       value = Optional<bool>{};
       return;
@@ -113,32 +115,30 @@ private:
   }
 
   template<class I>
-  void do_set(class_instance<I>& klass, const mixed& json) noexcept;
+  void do_set(class_instance<I>& klass, JsonTape::Value json) noexcept;
 
   // just don't fail compilation with empty untyped arrays
-  void do_set(array<Unknown>& /*array*/, const mixed& /*json*/) noexcept {}
+  void do_set(array<Unknown>& /*array*/, JsonTape::Value /*json*/) noexcept {}
 
   template<class T>
-  void do_set_array(array<T>& array, const mixed& json) noexcept {
-    const auto& json_array = json.as_array();
-    const auto array_size = json_array.size();
+  void do_set_array(array<T>& array, JsonTape::Value json) noexcept {
+    const auto array_size = json.get_array_size();
     // overwrite (but not just merge) array data
     array.clear();
     array.reserve(array_size.size, array_size.is_vector);
 
     json_path_.enter(nullptr);
-    for (const auto it : json_array) {
-      auto json_key = it.get_key();
+    json.for_each_element([this, &array](const mixed& json_key, JsonTape::Value json_value) {
       if (json_key.is_string() && !strcmp(json_key.as_string().c_str(), get_json_obj_magic_key())) {
-        continue; // don't deserialize magic
+        return; // don't deserialize magic
       }
-      do_set(array[json_key], it.get_value());
-    }
+      do_set(array[json_key], json_value);
+    });
     json_path_.leave();
   }
 
   template<class T>
-  void do_set(array<T>& array, const mixed& json) noexcept {
+  void do_set(array<T>& array, JsonTape::Value json) noexcept {
     if (json.is_array()) {
       do_set_array(array, json);
     } else {
@@ -146,18 +146,19 @@ private:
     }
   }
 
-  void do_set(mixed& value, const mixed& json) noexcept {
+  void do_set(mixed& value, JsonTape::Value json) noexcept {
     if (json.is_array()) {
       array<mixed> array;
       do_set(array, json);
       value = std::move(array);
     } else {
-      value = json;
+      value = json.to_mixed();
     }
   }
 
   string error_;
-  const mixed& json_;
+  JsonTape::Value json_;
+  JsonTape::Members members_;
   bool flatten_class_{false};
   JsonPath& json_path_;
 
@@ -165,7 +166,7 @@ private:
 };
 
 template<class I, class Tag>
-class_instance<I> from_json_impl(const mixed& json, JsonPath& json_path) noexcept {
+class_instance<I> from_json_impl(JsonTape::Value json, JsonPath& json_path) noexcept {
   class_instance<I> instance;
   if constexpr (std::is_empty_v<I>) {
     instance.empty_alloc();
@@ -186,12 +187,12 @@ class_instance<I> from_json_impl(const mixed& json, JsonPath& json_path) noexcep
 
 template<class Tag>
 template<class I>
-void FromJsonVisitor<Tag>::do_set(class_instance<I>& klass, const mixed& json) noexcept {
+void FromJsonVisitor<Tag>::do_set(class_instance<I>& klass, JsonTape::Value json) noexcept {
   if constexpr (!impl_::IsJsonFlattenClass<I>::value) {
     if (json.is_null()) {
       return;
     }
-    if (!json.is_array() || json.as_array().is_vector()) {
+    if (!json.is_array() || json.is_vector()) {
       on_input_type_mismatch(json);
       return;
     }
@@ -204,16 +205,16 @@ ClassName f$JsonEncoder$$from_json_impl(Tag /*tag*/, const string& json_string,
   auto& msg = SerializationLibContext::get().last_json_processor_error;
   msg = {};
 
-  auto opt_json = json_decode({json_string.c_str(), json_string.size()}, {FromJsonVisitor<Tag>::get_json_obj_magic_key()});
-
-  if (!opt_json.has_value()) {
+  // the json is parsed into a tape, and the fields are decoded right from the json text, without a mixed tree
+  JsonTape tape;
+  if (!tape.parse({json_string.c_str(), json_string.size()}, FromJsonVisitor<Tag>::get_json_obj_magic_key())) {
     msg.append(json_string.empty() ? "provided empty json string" : "failed to parse json string");
     return {};
   }
 
-  auto json = *std::move(opt_json);
+  const auto json = tape.root();
   if constexpr (!impl_::IsJsonFlattenClass<typename ClassName::ClassType>::value) {
-    if (!json.is_array() || json.as_array().is_vector()) {
+    if (!json.is_array() || json.is_vector()) {
       msg.append("root element of json string must be an object type, got ");
       msg.append(json.get_type_c_str());
       return {};
@@ -4,12 +4,16 @@
 
 #include "runtime-common/stdlib/serialization/json-functions.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <optional>
 #include <string_view>
 
 #include "common/algorithms/find.h"
+#include "common/algorithms/simd-string.h"
+#include "runtime-common/core/allocator/script-allocator.h"
 #include "runtime-common/core/runtime-core.h"
+#include "runtime-common/core/std/containers.h"
 #include "runtime-common/stdlib/string/string-functions.h"
 
 // note: json-functions.cpp is used for non-typed json implementation: for json_encode() and json_decode()
@@ -320,17 +324,236 @@ bool JsonEncoder::encode(const mixed& v, string_buffer& sb) noexcept {
 
 namespace {
 
-void json_skip_blanks(const char* s, size_t& i) noexcept {
-  while (vk::any_of_equal(s[i], ' ', '\t', '\r', '\n')) {
-    i++;
+constexpr char JSON_STRING_SPECIAL_CHARS[] = {'"', '\\'};
+
+} // namespace
+
+namespace impl_ {
+
+bool json_decode_string(std::string_view s, size_t& i, string* value) noexcept {
+  const char* s_end = s.data() + s.size();
+  const char* closing_quote = s.data() + i + 1;
+  int slashes = 0;
+  while ((closing_quote = vk::simd::find_first_of(closing_quote, s_end, JSON_STRING_SPECIAL_CHARS, sizeof(JSON_STRING_SPECIAL_CHARS))) != s_end &&
+         *closing_quote == '\\') {
+    slashes++;
+    closing_quote = s_end - closing_quote > 2 ? closing_quote + 2 : s_end;
+  }
+  if (closing_quote == s_end) {
+    return false;
+  }
+  int j = closing_quote - s.data();
+  int len = j - i - 1 - slashes;
+
+  if (slashes == 0) {
+    if (value) {
+      *value = string(s.data() + i + 1, len);
+    }
+    i = j + 1;
+    return true;
+  }
+
+  if (value) {
+    *value = string(len, false);
+  }
+  // the escapes are checked even if the value isn't needed
+  char* const out = value ? value->buffer() : nullptr;
+  const auto put = [out](int l, char c) {
+    if (out) {
+      out[l] = c;
+    }
+  };
+
+  i++;
+  int l;
+  for (l = 0; l < len && i < j; l++) {
+    char c = s[i];
+    if (c == '\\') {
+      i++;
+      switch (s[i]) {
+      case '"':
+      case '\\':
+      case '/':
+        put(l, s[i]);
+        break;
+      case 'b':
+        put(l, '\b');
+        break;
+      case 'f':
+        put(l, '\f');
+        break;
+      case 'n':
+        put(l, '\n');
+        break;
+      case 'r':
+        put(l, '\r');
+        break;
+      case 't':
+        put(l, '\t');
+        break;
+      case 'u':
+        if (isxdigit(s[i + 1]) && isxdigit(s[i + 2]) && isxdigit(s[i + 3]) && isxdigit(s[i + 4])) {
+          int num = 0;
+          for (int t = 0; t < 4; t++) {
+            char c = s[++i];
+            if ('0' <= c && c <= '9') {
+              num = num * 16 + c - '0';
+            } else {
+              c |= 0x20;
+              if ('a' <= c && c <= 'f') {
+                num = num * 16 + c - 'a' + 10;
+              }
+            }
+          }
+
+          if (0xD7FF < num && num < 0xE000) {
+            if (s[i + 1] == '\\' && s[i + 2] == 'u' && isxdigit(s[i + 3]) && isxdigit(s[i + 4]) && isxdigit(s[i + 5]) && isxdigit(s[i + 6])) {
+              i += 2;
+              int u = 0;
+              for (int t = 0; t < 4; t++) {
+                char c = s[++i];
+                if ('0' <= c && c <= '9') {
+                  u = u * 16 + c - '0';
+                } else {
+                  c |= 0x20;
+                  if ('a' <= c && c <= 'f') {
+                    u = u * 16 + c - 'a' + 10;
+                  }
+                }
+              }
+
+              if (0xD7FF < u && u < 0xE000) {
+                num = (((num & 0x3FF) << 10) | (u & 0x3FF)) + 0x10000;
+              } else {
+                i -= 6;
+                return false;
+              }
+            } else {
+              return false;
+            }
+          }
+
+          if (num < 128) {
+            put(l, static_cast<char>(num));
+          } else if (num < 0x800) {
+            put(l++, static_cast<char>(0xc0 + (num >> 6)));
+            put(l, static_cast<char>(0x80 + (num & 63)));
+          } else if (num < 0xffff) {
+            put(l++, static_cast<char>(0xe0 + (num >> 12)));
+            put(l++, static_cast<char>(0x80 + ((num >> 6) & 63)));
+            put(l, static_cast<char>(0x80 + (num & 63)));
+          } else {
+            put(l++, static_cast<char>(0xf0 + (num >> 18)));
+            put(l++, static_cast<char>(0x80 + ((num >> 12) & 63)));
+            put(l++, static_cast<char>(0x80 + ((num >> 6) & 63)));
+            put(l, static_cast<char>(0x80 + (num & 63)));
+          }
+          break;
+        }
+        /* fallthrough */
+      default:
+        return false;
+      }
+      i++;
+    } else {
+      put(l, s[i++]);
+    }
+  }
+  if (value) {
+    value->shrink(l);
   }
+  i++;
+  return true;
 }
 
-bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view json_obj_magic_key) noexcept {
+bool json_decode_number(std::string_view s, size_t& i, mixed& v) noexcept {
+  int j = i;
+  while (s[j] == '-' || ('0' <= s[j] && s[j] <= '9') || s[j] == 'e' || s[j] == 'E' || s[j] == '+' || s[j] == '.') {
+    j++;
+  }
+  if (j > i) {
+    int64_t intval = 0;
+    if (php_try_to_int(s.data() + i, j - i, &intval)) {
+      i = j;
+      v = intval;
+      return true;
+    }
+
+    char* end_ptr;
+    double floatval = strtod(s.data() + i, &end_ptr);
+    if (end_ptr == s.data() + j) {
+      i = j;
+      v = floatval;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace impl_
+
+namespace {
+
+
+// Sizes of all arrays and objects in the order of their opening brackets, found by a vectorized pass over structural characters
+// before parsing, so that the parser allocates each array once. These are only capacity hints: on a malformed json they may be wrong,
+// and the parser doesn't rely on them.
+class json_container_sizes {
+public:
+  // the structural pass doesn't pay off for small jsons
+  static constexpr size_t MIN_JSON_SIZE = 256;
+  // larger arrays grow as usual, this bounds the memory reserved because of a malformed json
+  static constexpr uint32_t MAX_SIZE_HINT = 1 << 16;
+
+  explicit json_container_sizes(std::string_view s) noexcept {
+    if (s.size() < MIN_JSON_SIZE) {
+      return;
+    }
+    kphp::stl::vector<uint64_t, kphp::memory::script_allocator> masks((s.size() + 63) / 64);
+    vk::simd::json_structural_masks(s.data(), s.data() + s.size(), masks.data());
+
+    kphp::stl::vector<uint32_t, kphp::memory::script_allocator> open_containers;
+    for (size_t block = 0; block < masks.size(); ++block) {
+      for (uint64_t mask = masks[block]; mask != 0; mask &= mask - 1) {
+        switch (s[block * 64 + __builtin_ctzll(mask)]) {
+          case '[':
+          case '{':
+            open_containers.push_back(sizes_.size());
+            sizes_.push_back(1);
+            break;
+          case ',':
+            if (!open_containers.empty()) {
+              sizes_[open_containers.back()]++;
+            }
+            break;
+          case ']':
+          case '}':
+            if (!open_containers.empty()) {
+              open_containers.pop_back();
+            }
+            break;
+          default:
+            break;
+        }
+      }
+    }
+  }
+
+  // must be called for every opening bracket met by the parser
+  int64_t next() noexcept {
+    return next_ < sizes_.size() ? std::min(sizes_[next_++], MAX_SIZE_HINT) : 0;
+  }
+
+private:
+  kphp::stl::vector<uint32_t, kphp::memory::script_allocator> sizes_;
+  size_t next_{0};
+};
+
+bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view json_obj_magic_key, json_container_sizes& sizes) noexcept {
   if (!v.is_null()) {
     v.destroy();
   }
-  json_skip_blanks(s.data(), i);
+  impl_::json_skip_blanks(s.data(), i);
   switch (s[i]) {
   case 'n':
     if (s[i + 1] == 'u' && s[i + 2] == 'l' && s[i + 3] == 'l') {
@@ -353,135 +576,29 @@ bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view js
     }
     break;
   case '"': {
-    int j = i + 1;
-    int slashes = 0;
-    while (j < s.size() && s[j] != '"') {
-      if (s[j] == '\\') {
-        slashes++;
-        j++;
-      }
-      j++;
-    }
-    if (j < s.size()) {
-      int len = j - i - 1 - slashes;
-
-      string value(len, false);
-
-      i++;
-      int l;
-      for (l = 0; l < len && i < j; l++) {
-        char c = s[i];
-        if (c == '\\') {
-          i++;
-          switch (s[i]) {
-          case '"':
-          case '\\':
-          case '/':
-            value[l] = s[i];
-            break;
-          case 'b':
-            value[l] = '\b';
-            break;
-          case 'f':
-            value[l] = '\f';
-            break;
-          case 'n':
-            value[l] = '\n';
-            break;
-          case 'r':
-            value[l] = '\r';
-            break;
-          case 't':
-            value[l] = '\t';
-            break;
-          case 'u':
-            if (isxdigit(s[i + 1]) && isxdigit(s[i + 2]) && isxdigit(s[i + 3]) && isxdigit(s[i + 4])) {
-              int num = 0;
-              for (int t = 0; t < 4; t++) {
-                char c = s[++i];
-                if ('0' <= c && c <= '9') {
-                  num = num * 16 + c - '0';
-                } else {
-                  c |= 0x20;
-                  if ('a' <= c && c <= 'f') {
-                    num = num * 16 + c - 'a' + 10;
-                  }
-                }
-              }
-
-              if (0xD7FF < num && num < 0xE000) {
-                if (s[i + 1] == '\\' && s[i + 2] == 'u' && isxdigit(s[i + 3]) && isxdigit(s[i + 4]) && isxdigit(s[i + 5]) && isxdigit(s[i + 6])) {
-                  i += 2;
-                  int u = 0;
-                  for (int t = 0; t < 4; t++) {
-                    char c = s[++i];
-                    if ('0' <= c && c <= '9') {
-                      u = u * 16 + c - '0';
-                    } else {
-                      c |= 0x20;
-                      if ('a' <= c && c <= 'f') {
-                        u = u * 16 + c - 'a' + 10;
-                      }
-                    }
-                  }
-
-                  if (0xD7FF < u && u < 0xE000) {
-                    num = (((num & 0x3FF) << 10) | (u & 0x3FF)) + 0x10000;
-                  } else {
-                    i -= 6;
-                    return false;
-                  }
-                } else {
-                  return false;
-                }
-              }
-
-              if (num < 128) {
-                value[l] = static_cast<char>(num);
-              } else if (num < 0x800) {
-                value[l++] = static_cast<char>(0xc0 + (num >> 6));
-                value[l] = static_cast<char>(0x80 + (num & 63));
-              } else if (num < 0xffff) {
-                value[l++] = static_cast<char>(0xe0 + (num >> 12));
-                value[l++] = static_cast<char>(0x80 + ((num >> 6) & 63));
-                value[l] = static_cast<char>(0x80 + (num & 63));
-              } else {
-                value[l++] = static_cast<char>(0xf0 + (num >> 18));
-                value[l++] = static_cast<char>(0x80 + ((num >> 12) & 63));
-                value[l++] = static_cast<char>(0x80 + ((num >> 6) & 63));
-                value[l] = static_cast<char>(0x80 + (num & 63));
-              }
-              break;
-            }
-            /* fallthrough */
-          default:
-            return false;
-          }
-          i++;
-        } else {
-          value[l] = s[i++];
-        }
-      }
-      value.shrink(l);
-
-      new (&v) mixed(value);
-      i++;
+    string value;
+    if (impl_::json_decode_string(s, i, &value)) {
+      new (&v) mixed(std::move(value));
       return true;
     }
-    break;
+    return false;
   }
   case '[': {
+    const int64_t size_hint = sizes.next();
     array<mixed> res;
     i++;
-    json_skip_blanks(s.data(), i);
+    impl_::json_skip_blanks(s.data(), i);
     if (s[i] != ']') {
+      if (size_hint > 1) {
+        res.reserve(size_hint, true);
+      }
       do {
         mixed value;
-        if (!do_json_decode(s, i, value, json_obj_magic_key)) {
+        if (!do_json_decode(s, i, value, json_obj_magic_key, sizes)) {
           return false;
         }
         res.push_back(value);
-        json_skip_blanks(s.data(), i);
+        impl_::json_skip_blanks(s.data(), i);
       } while (s[i++] == ',');
 
       if (s[i - 1] != ']') {
@@ -495,24 +612,29 @@ bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view js
     return true;
   }
   case '{': {
+    const int64_t size_hint = sizes.next();
     array<mixed> res;
     i++;
-    json_skip_blanks(s.data(), i);
+    impl_::json_skip_blanks(s.data(), i);
     if (s[i] != '}') {
       do {
         mixed key;
-        if (!do_json_decode(s, i, key, json_obj_magic_key) || !key.is_string()) {
+        if (!do_json_decode(s, i, key, json_obj_magic_key, sizes) || !key.is_string()) {
           return false;
         }
-        json_skip_blanks(s.data(), i);
+        impl_::json_skip_blanks(s.data(), i);
         if (s[i++] != ':') {
           return false;
         }
 
-        if (!do_json_decode(s, i, res[key], json_obj_magic_key)) {
+        if (!do_json_decode(s, i, res[key], json_obj_magic_key, sizes)) {
           return false;
         }
-        json_skip_blanks(s.data(), i);
+        // reserved after the first key, so that an object with keys "0", "1", ... stays a vector as before
+        if (size_hint > 1 && res.count() == 1) {
+          res.reserve(size_hint, true);
+        }
+        impl_::json_skip_blanks(s.data(), i);
       } while (s[i++] == ',');
 
       if (s[i - 1] != '}') {
@@ -531,31 +653,9 @@ bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view js
     new (&v) mixed(res);
     return true;
   }
-  default: {
-    int j = i;
-    while (s[j] == '-' || ('0' <= s[j] && s[j] <= '9') || s[j] == 'e' || s[j] == 'E' || s[j] == '+' || s[j] == '.') {
-      j++;
-    }
-    if (j > i) {
-      int64_t intval = 0;
-      if (php_try_to_int(s.data() + i, j - i, &intval)) {
-        i = j;
-        new (&v) mixed(intval);
-        return true;
-      }
-
-      char* end_ptr;
-      double floatval = strtod(s.data() + i, &end_ptr);
-      if (end_ptr == s.data() + j) {
-        i = j;
-        new (&v) mixed(floatval);
-        return true;
-      }
-    }
-    break;
-  }
+  default:
+    return impl_::json_decode_number(s, i, v);
   }
-
   return false;
 }
 
@@ -564,8 +664,9 @@ bool do_json_decode(std::string_view s, size_t& i, mixed& v, std::string_view js
 std::optional<mixed> json_decode(std::string_view v, std::string_view json_obj_magic_key) noexcept {
   mixed result{};
   size_t i{};
-  if (do_json_decode(v, i, result, json_obj_magic_key)) {
-    json_skip_blanks(v.data(), i);
+  json_container_sizes sizes{v};
+  if (do_json_decode(v, i, result, json_obj_magic_key, sizes)) {
+    impl_::json_skip_blanks(v.data(), i);
     if (i == v.size()) {
       return result;
     }
@@ -8,6 +8,7 @@
 #include <optional>
 #include <string_view>
 
+#include "common/algorithms/find.h"
 #include "common/mixin/not_copyable.h"
 #include "runtime-common/core/runtime-core.h"
 
@@ -178,4 +179,19 @@ inline Optional<string> f$vk_json_encode(const T& v) noexcept {
 
 std::optional<mixed> json_decode(std::string_view v, std::string_view json_obj_magic_key = {}) noexcept;
 
+namespace impl_ {
+
+inline void json_skip_blanks(const char* s, size_t& i) noexcept {
+  while (vk::any_of_equal(s[i], ' ', '\t', '\r', '\n')) {
+    i++;
+  }
+}
+
+// the parts of json_decode(), for the parsers which must accept exactly the same jsons (see JsonTape);
+// they parse a value starting at s[i] and move i past it, the string value may be null to only check the string
+bool json_decode_string(std::string_view s, size_t& i, string* value) noexcept;
+bool json_decode_number(std::string_view s, size_t& i, mixed& value) noexcept;
+
+} // namespace impl_
+
 mixed f$json_decode(const string& v, bool assoc = false) noexcept;
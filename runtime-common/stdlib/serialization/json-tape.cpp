@@ -0,0 +1,282 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime-common/stdlib/serialization/json-tape.h"
+
+#include <cstring>
+
+#include "runtime-common/stdlib/serialization/json-functions.h"
+
+bool JsonTape::parse(std::string_view json, std::string_view json_obj_magic_key) noexcept {
+  json_ = json;
+  json_obj_magic_key_ = json_obj_magic_key;
+  nodes_.clear();
+  size_t i = 0;
+  if (!parse_value(i)) {
+    return false;
+  }
+  impl_::json_skip_blanks(json_.data(), i);
+  return i == json_.size();
+}
+
+// mirrors do_json_decode() of json-functions.cpp, see the comments there
+bool JsonTape::parse_value(size_t& i) noexcept {
+  const std::string_view s = json_;
+  impl_::json_skip_blanks(s.data(), i);
+
+  const auto index = static_cast<uint32_t>(nodes_.size());
+  Node& node = nodes_.emplace_back();
+  node.offset = static_cast<uint32_t>(i);
+  node.next = index + 1;
+  node.size = 0;
+  node.bool_value = false;
+  node.is_vector_object = false;
+  node.int_value = 0;
+
+  switch (s[i]) {
+  case 'n':
+    if (s[i + 1] == 'u' && s[i + 2] == 'l' && s[i + 3] == 'l') {
+      i += 4;
+      node.type = Type::null;
+      return true;
+    }
+    break;
+  case 't':
+    if (s[i + 1] == 'r' && s[i + 2] == 'u' && s[i + 3] == 'e') {
+      i += 4;
+      node.type = Type::boolean;
+      node.bool_value = true;
+      return true;
+    }
+    break;
+  case 'f':
+    if (s[i + 1] == 'a' && s[i + 2] == 'l' && s[i + 3] == 's' && s[i + 4] == 'e') {
+      i += 5;
+      node.type = Type::boolean;
+      return true;
+    }
+    break;
+  case '"':
+    node.type = Type::string;
+    if (!impl_::json_decode_string(s, i, nullptr)) {
+      return false;
+    }
+    // the raw length, without quotes
+    nodes_[index].size = static_cast<uint32_t>(i - nodes_[index].offset - 2);
+    return true;
+  case '[': {
+    node.type = Type::array;
+    uint32_t size = 0;
+    i++;
+    impl_::json_skip_blanks(s.data(), i);
+    if (s[i] != ']') {
+      do {
+        if (!parse_value(i)) {
+          return false;
+        }
+        size++;
+        impl_::json_skip_blanks(s.data(), i);
+      } while (s[i++] == ',');
+
+      if (s[i - 1] != ']') {
+        return false;
+      }
+    } else {
+      i++;
+    }
+    // the vector may be reallocated by the nested values
+    nodes_[index].size = size;
+    nodes_[index].next = static_cast<uint32_t>(nodes_.size());
+    return true;
+  }
+  case '{': {
+    node.type = Type::object;
+    uint32_t size = 0;
+    // an empty object is an empty vector, unless it gets the magic key
+    bool is_vector = json_obj_magic_key_.empty();
+    int64_t vector_size = 0;
+    i++;
+    impl_::json_skip_blanks(s.data(), i);
+    if (s[i] != '}') {
+      is_vector = true;
+      do {
+        const auto key_index = static_cast<uint32_t>(nodes_.size());
+        if (!parse_value(i) || nodes_[key_index].type != Type::string) {
+          return false;
+        }
+        impl_::json_skip_blanks(s.data(), i);
+        if (s[i++] != ':') {
+          return false;
+        }
+        if (!parse_value(i)) {
+          return false;
+        }
+        size++;
+
+        // the same as array<mixed>::operator[] does with the keys
+        if (is_vector) {
+          int64_t int_key = 0;
+          if (key_to_int(key_index, &int_key) && int_key >= 0 && int_key <= vector_size) {
+            vector_size += int_key == vector_size;
+          } else {
+            is_vector = false;
+          }
+        }
+        impl_::json_skip_blanks(s.data(), i);
+      } while (s[i++] == ',');
+
+      if (s[i - 1] != '}') {
+        return false;
+      }
+    } else {
+      i++;
+    }
+    nodes_[index].size = size;
+    nodes_[index].is_vector_object = is_vector;
+    nodes_[index].next = static_cast<uint32_t>(nodes_.size());
+    return true;
+  }
+  default: {
+    mixed number;
+    if (!impl_::json_decode_number(s, i, number)) {
+      return false;
+    }
+    if (number.is_int()) {
+      node.type = Type::integer;
+      node.int_value = number.as_int();
+    } else {
+      node.type = Type::floating;
+      node.float_value = number.as_double();
+    }
+    return true;
+  }
+  }
+
+  return false;
+}
+
+bool JsonTape::key_equals(uint32_t key_index, std::string_view key) const noexcept {
+  const Node& node = nodes_[key_index];
+  const char* raw_key = json_.data() + node.offset + 1;
+  // escapes always make the raw string longer than the decoded one
+  if (node.size == key.size()) {
+    return std::memcmp(raw_key, key.data(), key.size()) == 0 && key.find('\\') == std::string_view::npos;
+  }
+  if (node.size < key.size() || std::memchr(raw_key, '\\', node.size) == nullptr) {
+    return false;
+  }
+  const string decoded = Value{*this, key_index}.as_string();
+  return decoded.size() == key.size() && std::memcmp(decoded.c_str(), key.data(), key.size()) == 0;
+}
+
+bool JsonTape::key_to_int(uint32_t key_index, int64_t* int_key) const noexcept {
+  const Node& node = nodes_[key_index];
+  const char* raw_key = json_.data() + node.offset + 1;
+  if (std::memchr(raw_key, '\\', node.size) == nullptr) {
+    return php_try_to_int(raw_key, node.size, int_key);
+  }
+  return Value{*this, key_index}.as_string().try_to_int(int_key);
+}
+
+mixed JsonTape::key_to_mixed(uint32_t key_index) const noexcept {
+  int64_t int_key = 0;
+  if (key_to_int(key_index, &int_key)) {
+    return int_key;
+  }
+  return Value{*this, key_index}.as_string();
+}
+
+string JsonTape::Value::as_string() const noexcept {
+  string value;
+  size_t i = node().offset;
+  impl_::json_decode_string(tape_->json_, i, &value);
+  return value;
+}
+
+const char* JsonTape::Value::get_type_c_str() const noexcept {
+  switch (type()) {
+  case Type::null:
+    return "NULL";
+  case Type::boolean:
+    return "boolean";
+  case Type::integer:
+    return "integer";
+  case Type::floating:
+    return "double";
+  case Type::string:
+    return "string";
+  case Type::array:
+  case Type::object:
+    return "array";
+  }
+  __builtin_unreachable();
+}
+
+mixed JsonTape::Value::to_mixed() const noexcept {
+  switch (type()) {
+  case Type::null:
+    return {};
+  case Type::boolean:
+    return as_bool();
+  case Type::integer:
+    return as_int();
+  case Type::floating:
+    return as_double();
+  case Type::string:
+    return as_string();
+  case Type::array:
+  case Type::object: {
+    array<mixed> value{get_array_size()};
+    for_each_element([&value](const mixed& key, Value element) { value.set_value(key, element.to_mixed()); });
+    // see do_json_decode() about the magic key
+    if (type() == Type::object && node().size == 0 && !tape_->json_obj_magic_key_.empty()) {
+      const auto& magic_key = tape_->json_obj_magic_key_;
+      value.set_value(string{magic_key.data(), static_cast<string::size_type>(magic_key.size())}, true);
+    }
+    return value;
+  }
+  }
+  __builtin_unreachable();
+}
+
+std::optional<JsonTape::Value> JsonTape::Value::find_member(std::string_view key) const noexcept {
+  if (type() != Type::object) {
+    return std::nullopt;
+  }
+  std::optional<Value> found;
+  const auto& nodes = tape_->nodes_;
+  for (uint32_t key_index = index_ + 1; key_index != node().next; key_index = nodes[key_index + 1].next) {
+    if (tape_->key_equals(key_index, key)) {
+      found = Value{*tape_, key_index + 1};
+    }
+  }
+  return found;
+}
+
+array_size JsonTape::Value::get_array_size() const noexcept {
+  return array_size{node().size, is_vector()};
+}
+
+JsonTape::Members::Members(Value object) noexcept
+    : object_(object) {
+  if (object.type() != Type::object || object.node().size < MIN_INDEXED_SIZE) {
+    return;
+  }
+  const JsonTape& tape = *object.tape_;
+  value_indices_.reserve(object.node().size, false);
+  for (uint32_t key_index = object.index_ + 1; key_index != object.node().next; key_index = tape.nodes_[key_index + 1].next) {
+    value_indices_.set_value(tape.key_to_mixed(key_index), key_index + 1);
+  }
+}
+
+std::optional<JsonTape::Value> JsonTape::Members::find(std::string_view key) const noexcept {
+  if (value_indices_.empty()) {
+    return object_.find_member(key);
+  }
+  const int64_t* value_index = value_indices_.find_value(key.data(), static_cast<string::size_type>(key.size()));
+  if (value_index == nullptr) {
+    return std::nullopt;
+  }
+  return Value{*object_.tape_, static_cast<uint32_t>(*value_index)};
+}
@@ -0,0 +1,167 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "runtime-common/core/allocator/script-allocator.h"
+#include "runtime-common/core/runtime-core.h"
+#include "runtime-common/core/std/containers.h"
+
+// A parsed json without a mixed tree: a flat sequence of nodes in the order of the json text.
+// Containers know their sizes and where their nested nodes end, strings are decoded from the text only when accessed.
+// It accepts exactly the same jsons as json_decode() and describes the values it would produce, so that typed decoding
+// (see FromJsonVisitor) reads the text directly and never materializes the fields it skips.
+class JsonTape {
+public:
+  enum class Type : uint8_t { null, boolean, integer, floating, string, array, object };
+
+private:
+  struct Node {
+    Type type;
+    bool bool_value;
+    bool is_vector_object;
+    // the index of the node after this value and all the nested ones
+    uint32_t next;
+    // the number of array elements or object members, the raw length of a string
+    uint32_t size;
+    // the position of the value in the json text
+    uint32_t offset;
+    union {
+      int64_t int_value;
+      double float_value;
+    };
+  };
+
+public:
+  class Value {
+  public:
+    Type type() const noexcept {
+      return node().type;
+    }
+
+    bool is_null() const noexcept {
+      return type() == Type::null;
+    }
+    bool is_bool() const noexcept {
+      return type() == Type::boolean;
+    }
+    bool is_int() const noexcept {
+      return type() == Type::integer;
+    }
+    bool is_float() const noexcept {
+      return type() == Type::floating;
+    }
+    bool is_string() const noexcept {
+      return type() == Type::string;
+    }
+    // json arrays and objects both become php arrays
+    bool is_array() const noexcept {
+      return type() == Type::array || type() == Type::object;
+    }
+    // whether the php array is a vector: json objects with keys "0", "1", ... are decoded into vectors
+    bool is_vector() const noexcept {
+      return type() == Type::array || node().is_vector_object;
+    }
+
+    bool as_bool() const noexcept {
+      return node().bool_value;
+    }
+    int64_t as_int() const noexcept {
+      return node().int_value;
+    }
+    double as_double() const noexcept {
+      return node().float_value;
+    }
+    string as_string() const noexcept;
+
+    // the same as mixed::get_type_c_str() of the decoded value
+    const char* get_type_c_str() const noexcept;
+
+    // the value json_decode() would produce for this part of the json
+    mixed to_mixed() const noexcept;
+
+    // the value of the member with the key, the last one if the key is repeated, as json_decode() does;
+    // it scans all the members, use Members to look up several keys of an object
+    std::optional<Value> find_member(std::string_view key) const noexcept;
+
+    // the capacity for the php array: repeated object keys are counted every time, the magic key of an empty object is not
+    array_size get_array_size() const noexcept;
+
+    // calls f(const mixed& key, Value value) for every element of the php array in its order, except the magic key of an empty object
+    template<class F>
+    void for_each_element(F&& f) const noexcept;
+
+  private:
+    friend class JsonTape;
+
+    Value(const JsonTape& tape, uint32_t index) noexcept
+        : tape_(&tape),
+          index_(index) {}
+
+    const Node& node() const noexcept {
+      return tape_->nodes_[index_];
+    }
+
+    const JsonTape* tape_;
+    uint32_t index_;
+  };
+
+  // looks up the members of an object by keys: a small object is scanned, a bigger one is indexed once,
+  // so that decoding all the fields of an object is linear in the number of its members
+  class Members {
+  public:
+    explicit Members(Value object) noexcept;
+
+    std::optional<Value> find(std::string_view key) const noexcept;
+
+  private:
+    static constexpr uint32_t MIN_INDEXED_SIZE = 8;
+
+    Value object_;
+    // php array keys of the members mapped to their value nodes, the last one for a repeated key
+    array<int64_t> value_indices_;
+  };
+
+  // returns false if the json is malformed; the json text must outlive the tape
+  bool parse(std::string_view json, std::string_view json_obj_magic_key) noexcept;
+
+  Value root() const noexcept {
+    return Value{*this, 0};
+  }
+
+private:
+  bool parse_value(size_t& i) noexcept;
+  bool key_equals(uint32_t key_index, std::string_view key) const noexcept;
+  bool key_to_int(uint32_t key_index, int64_t* int_key) const noexcept;
+  mixed key_to_mixed(uint32_t key_index) const noexcept;
+
+  std::string_view json_;
+  std::string_view json_obj_magic_key_;
+  kphp::stl::vector<Node, kphp::memory::script_allocator> nodes_;
+};
+
+template<class F>
+void JsonTape::Value::for_each_element(F&& f) const noexcept {
+  const auto& nodes = tape_->nodes_;
+  if (type() == Type::array) {
+    int64_t key = 0;
+    for (uint32_t element = index_ + 1; element != node().next; element = nodes[element].next) {
+      f(mixed{key++}, Value{*tape_, element});
+    }
+    return;
+  }
+
+  // repeated keys: the first position, the last value
+  array<int64_t> value_indices{array_size{node().size, node().is_vector_object}};
+  for (uint32_t key = index_ + 1; key != node().next; key = nodes[key + 1].next) {
+    value_indices.set_value(tape_->key_to_mixed(key), key + 1);
+  }
+  for (const auto& it : value_indices) {
+    f(it.get_key(), Value{*tape_, static_cast<uint32_t>(it.get_value())});
+  }
+}
@@ -2,9 +2,9 @@ prepend(STDLIB_ARRAY stdlib/array/ array-functions.cpp)
 prepend(STDLIB_CRYPTO stdlib/crypto/ crypto-functions.cpp)
 prepend(STDLIB_MATH stdlib/math/ math-functions.cpp
         bcmath-functions.cpp math-context.cpp)
-prepend(STDLIB_MSGPACK stdlib/msgpack/ object_visitor.cpp
-        packer.cpp parser.cpp unpacker.cpp zone.cpp)
-prepend(STDLIB_SERIALIZATION stdlib/serialization/ json-functions.cpp
+prepend(STDLIB_MSGPACK stdlib/msgpack/ packer.cpp
+        parser.cpp unpacker.cpp)
+prepend(STDLIB_SERIALIZATION stdlib/serialization/ json-functions.cpp json-tape.cpp
         json-writer.cpp serialize-functions.cpp)
 prepend(STDLIB_STRING stdlib/string/ mbstring-functions.cpp
         regex-functions.cpp string-functions.cpp)
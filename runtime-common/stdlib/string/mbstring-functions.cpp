@@ -4,6 +4,7 @@
 
 #include "runtime-common/stdlib/string/mbstring-functions.h"
 
+#include "common/algorithms/simd-string.h"
 #include "common/unicode/unicode-utils.h"
 #include "common/unicode/utf8-utils.h"
 #include "runtime-common/stdlib/string/string-functions.h"
@@ -23,83 +24,20 @@ int mb_detect_encoding(const string& encoding) noexcept {
 }
 
 int64_t mb_UTF8_strlen(const char* s) {
-  int64_t res = 0;
-  for (int64_t i = 0; s[i]; i++) {
-    if (((static_cast<unsigned char>(s[i])) & 0xc0) != 0x80) {
-      res++;
-    }
-  }
-  return res;
+  return vk::simd::count_utf8_code_points(s, s + strlen(s));
 }
 
 int64_t mb_UTF8_advance(const char* s, int64_t cnt) {
   php_assert(cnt >= 0);
-  int64_t i = 0;
-  for (i = 0; s[i] && cnt >= 0; i++) {
-    if (((static_cast<unsigned char>(s[i])) & 0xc0) != 0x80) {
-      cnt--;
-    }
-  }
-  if (cnt < 0) {
-    i--;
-  }
-  return i;
+  return vk::simd::find_utf8_code_point(s, s + strlen(s), cnt) - s;
 }
 
 int64_t mb_UTF8_get_offset(const char* s, int64_t pos) {
-  int64_t res = 0;
-  for (int64_t i = 0; i < pos && s[i]; i++) {
-    if (((static_cast<unsigned char>(s[i])) & 0xc0) != 0x80) {
-      res++;
-    }
-  }
-  return res;
+  return pos > 0 ? vk::simd::count_utf8_code_points(s, s + strnlen(s, pos)) : 0;
 }
 
 bool mb_UTF8_check(const char* s) noexcept {
-  do {
-#define CHECK(condition)                                                                                                                                       \
-  if (!(condition)) {                                                                                                                                          \
-    return false;                                                                                                                                              \
-  }
-    unsigned int a = static_cast<unsigned char>(*s++);
-    if ((a & 0x80) == 0) {
-      if (a == 0) {
-        return true;
-      }
-      continue;
-    }
-
-    CHECK((a & 0x40) != 0);
-
-    unsigned int b = static_cast<unsigned char>(*s++);
-    CHECK((b & 0xc0) == 0x80);
-    if ((a & 0x20) == 0) {
-      CHECK((a & 0x1e) > 0);
-      continue;
-    }
-
-    unsigned int c = static_cast<unsigned char>(*s++);
-    CHECK((c & 0xc0) == 0x80);
-    if ((a & 0x10) == 0) {
-      int x = (((a & 0x0f) << 6) | (b & 0x20));
-      CHECK(x != 0 && x != 0x360); // surrogates
-      continue;
-    }
-
-    unsigned int d = static_cast<unsigned char>(*s++);
-    CHECK((d & 0xc0) == 0x80);
-    if ((a & 0x08) == 0) {
-      int t = (((a & 0x07) << 6) | (b & 0x30));
-      CHECK(0 < t && t < 0x110); // end of unicode
-      continue;
-    }
-
-    return false;
-#undef CHECK
-  } while (true);
-
-  php_assert(0);
+  return vk::simd::is_valid_utf8(s, s + strlen(s));
 }
 
 bool f$mb_check_encoding(const string& str, const string& encoding) noexcept {
@@ -13,6 +13,7 @@
 #include "runtime-common/core/allocator/platform-malloc-interface.h"
 #include "runtime-common/core/runtime-core.h"
 #include "runtime-common/core/utils/kphp-assert-core.h"
+#include "runtime-common/stdlib/string/strtr-matcher.h"
 
 namespace string_context_impl_ {
 
@@ -43,6 +44,8 @@ struct StringLibContext final : private vk::not_copyable {
   std::array<char, MASK_BUFFER_LENGTH> mask_buf;
   // TODO In case of K2 it can actually be more efficient to use script allocator.
   std::unique_ptr<char, decltype(std::addressof(kphp::memory::platform::free))> static_buf;
+  // strtr() matchers for constant replace_pairs arrays, keyed by their storage identity; valid during one request
+  array<kphp::strings::strtr_matcher> strtr_matchers;
 
   StringLibContext() noexcept
       : static_buf(static_cast<char*>(kphp::memory::platform::alloc(STATIC_BUFFER_LENGTH + 1)), kphp::memory::platform::free) {
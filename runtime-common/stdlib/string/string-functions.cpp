@@ -4,12 +4,14 @@
 
 #include "runtime-common/stdlib/string/string-functions.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstdint>
 #include <functional>
 #include <iterator>
 #include <optional>
 
+#include "common/algorithms/simd-string.h"
 #include "common/containers/final_action.h"
 #include "common/macos-ports.h"
 #include "common/unicode/unicode-utils.h"
@@ -87,24 +89,32 @@ string f$addcslashes(const string& str, const string& what) noexcept {
   return static_SB.str();
 }
 
+// the escaping functions copy runs of bytes that need no escaping at once, vk::simd::find_first_of() finds the end of a run
+constexpr char ADDSLASHES_CHARS[] = {'\0', '\'', '"', '\\'};
+constexpr char HTMLSPECIALCHARS_CHARS[] = {'&', '"', '\'', '<', '>'};
+constexpr char MYSQL_ESCAPE_CHARS[] = {'\0', '\n', '\r', 26, '\'', '"', '\\'};
+
 string f$addslashes(const string& str) noexcept {
   int len = str.size();
 
   auto& static_SB = RuntimeContext::get().static_SB;
   static_SB.clean().reserve(2 * len);
-  for (int i = 0; i < len; i++) {
-    switch (str[i]) {
+  const char* end = str.c_str() + len;
+  for (const char* piece = str.c_str();; ++piece) {
+    const char* special = vk::simd::find_first_of(piece, end, ADDSLASHES_CHARS, sizeof(ADDSLASHES_CHARS));
+    static_SB.append_unsafe(piece, static_cast<int>(special - piece));
+    if (special == end) {
+      break;
+    }
+    piece = special;
+    switch (*piece) {
     case '\0':
       static_SB.append_char('\\');
       static_SB.append_char('0');
       break;
-    case '\'':
-    case '\"':
-    case '\\':
-      static_SB.append_char('\\');
-      /* fallthrough */
     default:
-      static_SB.append_char(str[i]);
+      static_SB.append_char('\\');
+      static_SB.append_char(*piece);
     }
   }
   return static_SB.str();
@@ -408,8 +418,15 @@ string f$htmlspecialchars(const string& str, int64_t flags) noexcept {
   auto& static_SB = RuntimeContext::get().static_SB;
   static_SB.clean().reserve(6 * len);
 
-  for (string::size_type i = 0; i < len; i++) {
-    switch (str[i]) {
+  const char* end = str.c_str() + len;
+  for (const char* piece = str.c_str();; ++piece) {
+    const char* special = vk::simd::find_first_of(piece, end, HTMLSPECIALCHARS_CHARS, sizeof(HTMLSPECIALCHARS_CHARS));
+    static_SB.append_unsafe(piece, static_cast<int>(special - piece));
+    if (special == end) {
+      break;
+    }
+    piece = special;
+    switch (*piece) {
     case '&':
       static_SB.append_char('&');
       static_SB.append_char('a');
@@ -453,8 +470,6 @@ string f$htmlspecialchars(const string& str, int64_t flags) noexcept {
       static_SB.append_char('t');
       static_SB.append_char(';');
       break;
-    default:
-      static_SB.append_char(str[i]);
     }
   }
 
@@ -547,20 +562,16 @@ string f$mysql_escape_string(const string& str) noexcept {
   int len = str.size();
   auto& static_SB = RuntimeContext::get().static_SB;
   static_SB.clean().reserve(2 * len);
-  for (int i = 0; i < len; i++) {
-    switch (str[i]) {
-    case '\0':
-    case '\n':
-    case '\r':
-    case 26:
-    case '\'':
-    case '\"':
-    case '\\':
-      static_SB.append_char('\\');
-      /* fallthrough */
-    default:
-      static_SB.append_char(str[i]);
+  const char* end = str.c_str() + len;
+  for (const char* piece = str.c_str();; ++piece) {
+    const char* special = vk::simd::find_first_of(piece, end, MYSQL_ESCAPE_CHARS, sizeof(MYSQL_ESCAPE_CHARS));
+    static_SB.append_unsafe(piece, static_cast<int>(special - piece));
+    if (special == end) {
+      break;
     }
+    piece = special;
+    static_SB.append_char('\\');
+    static_SB.append_char(*piece);
   }
   return static_SB.str();
 }
@@ -1298,6 +1309,8 @@ static bool php_tag_find(const string& tag, const string& allow) {
   return memmem(allow.c_str(), allow.size(), norm.c_str(), norm.size()) != nullptr;
 }
 
+constexpr char STRIP_TAGS_TEXT_CHARS[] = {'\0', '<'};
+
 string f$strip_tags(const string& str, const string& allow) {
   int br = 0;
   int depth = 0;
@@ -1312,6 +1325,15 @@ string f$strip_tags(const string& str, const string& allow) {
   char lc = 0;
   int len = str.size();
   for (int i = 0; i < len; i++) {
+    if (state == 0 && depth == 0) {
+      // outside of tags only '\0' and '<' are special
+      const char* text_end = vk::simd::find_first_of(str.c_str() + i, str.c_str() + len, STRIP_TAGS_TEXT_CHARS, sizeof(STRIP_TAGS_TEXT_CHARS));
+      static_SB.append(str.c_str() + i, static_cast<size_t>(text_end - (str.c_str() + i)));
+      i = static_cast<int>(text_end - str.c_str());
+      if (i == len) {
+        break;
+      }
+    }
     char c = str[i];
     switch (c) {
     case '\0':
@@ -1830,53 +1852,40 @@ Optional<string> f$strstr(const string& haystack, const string& needle, bool bef
   return haystack.substr(pos, haystack.size() - pos);
 }
 
-string f$strtolower(const string& str) noexcept {
+// ASCII letters are converted by the vectorized kernel;
+// bytes >= 0x80 are passed to std::tolower()/std::toupper() as before, they depend on the current locale
+static string switch_case(const string& str, char lo, char hi, int (*convert)(int)) noexcept {
   int n = str.size();
 
-  // if there is no upper case char inside the string, we can
+  // if there is no char to convert inside the string, we can
   // return the argument unchanged, avoiding the allocation and data copying;
-  // while at it, memorize the first upper case char, so we can
-  // use memcpy to copy everything before that pos;
-  // note: do not use islower() here, the compiler does not inline that function call;
-  // it could be beneficial to use 256-byte LUT here, but SIMD approach could be even better
+  // while at it, memorize the first such char, so we can
+  // use memcpy to copy everything before that pos
   const char* end = str.c_str() + n;
-  const char* uppercase_pos = std::find_if(str.c_str(), end, [](unsigned char ch) { return ch >= 'A' && ch <= 'Z'; });
-  if (uppercase_pos == end) {
+  const char* convert_pos = vk::simd::find_first_in_ascii_range(str.c_str(), end, lo, hi);
+  if (convert_pos == end) {
     return str;
   }
 
   string res(n, false);
-  int64_t lowercase_prefix = uppercase_pos - str.c_str();
-  if (lowercase_prefix != 0) { // avoid unnecessary function call
-    std::memcpy(res.buffer(), str.c_str(), lowercase_prefix);
+  int64_t prefix = convert_pos - str.c_str();
+  if (prefix != 0) { // avoid unnecessary function call
+    std::memcpy(res.buffer(), str.c_str(), prefix);
   }
-  for (int i = lowercase_prefix; i < n; i++) {
-    res[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(str[i])));
+  vk::simd::ascii_switch_case(convert_pos, n - prefix, res.buffer() + prefix, lo, hi);
+  for (const char* p = vk::simd::find_first_non_ascii(convert_pos, end); p != end; p = vk::simd::find_first_non_ascii(p + 1, end)) {
+    res[p - str.c_str()] = static_cast<char>(convert(static_cast<unsigned char>(*p)));
   }
 
   return res;
 }
 
-string f$strtoupper(const string& str) noexcept {
-  int n = str.size();
-
-  // same optimization as in strtolower
-  const char* end = str.c_str() + n;
-  const char* lowercase_pos = std::find_if(str.c_str(), end, [](unsigned char ch) { return ch >= 'a' && ch <= 'z'; });
-  if (lowercase_pos == end) {
-    return str;
-  }
-
-  string res(n, false);
-  int64_t uppercase_prefix = lowercase_pos - str.c_str();
-  if (uppercase_prefix != 0) { // avoid unnecessary function call
-    std::memcpy(res.buffer(), str.c_str(), uppercase_prefix);
-  }
-  for (int i = uppercase_prefix; i < n; i++) {
-    res[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-  }
+string f$strtolower(const string& str) noexcept {
+  return switch_case(str, 'A', 'Z', [](int c) { return std::tolower(c); });
+}
 
-  return res;
+string f$strtoupper(const string& str) noexcept {
+  return switch_case(str, 'a', 'z', [](int c) { return std::toupper(c); });
 }
 
 string f$strtr(const string& subject, const string& from, const string& to) noexcept {
@@ -1894,6 +1903,123 @@ string f$strtr(const string& subject, const string& from, const string& to) noex
   return result;
 }
 
+namespace kphp {
+namespace strings {
+
+void strtr_matcher::prepare() noexcept {
+  const int64_t n = from_.count();
+  for (int64_t i = 0; i < n; ++i) {
+    has_empty_key_ |= from_.get_value(i).empty();
+  }
+  if (n == 0 || has_empty_key_) {
+    return;
+  }
+
+  const string* from = from_.get_const_vector_pointer();
+  array<int64_t> order{array_size{n, true}};
+  for (int64_t i = 0; i < n; ++i) {
+    order.push_back(i);
+  }
+  std::sort(order.get_vector_pointer(), order.get_vector_pointer() + n, [from](int64_t lhs, int64_t rhs) {
+    const int res = std::memcmp(from[lhs].c_str(), from[rhs].c_str(), std::min(from[lhs].size(), from[rhs].size()));
+    return res < 0 || (res == 0 && from[lhs].size() < from[rhs].size());
+  });
+
+  // every node is a range of sorted keys with a common prefix of the node depth
+  array<int64_t> range_begin;
+  array<int64_t> range_end;
+  array<int64_t> depth;
+  const auto add_node = [&](int64_t begin, int64_t end, int64_t node_depth) {
+    node_key_.push_back(-1);
+    range_begin.push_back(begin);
+    range_end.push_back(end);
+    depth.push_back(node_depth);
+  };
+  add_node(0, n, 0);
+  edges_begin_.push_back(0);
+  for (int64_t v = 0; v < node_key_.count(); ++v) {
+    int64_t begin = range_begin.get_value(v);
+    const int64_t end = range_end.get_value(v);
+    const int64_t d = depth.get_value(v);
+    // a key equal to the prefix goes first in the lexicographical order
+    if (from[order.get_value(begin)].size() == d) {
+      node_key_[v] = order.get_value(begin++);
+    }
+    while (begin < end) {
+      const char c = from[order.get_value(begin)][d];
+      int64_t next = begin + 1;
+      while (next < end && from[order.get_value(next)][d] == c) {
+        ++next;
+      }
+      edge_bytes_.push_back(c);
+      add_node(begin, next, d + 1);
+      begin = next;
+    }
+    edges_begin_.push_back(edge_bytes_.size());
+  }
+
+  root_child_.fill(0);
+  for (int64_t e = 0; e < edges_begin_.get_value(1); ++e) {
+    root_child_[static_cast<unsigned char>(edge_bytes_[e])] = e + 1;
+  }
+}
+
+string strtr_matcher::replace(const string& subject) const noexcept {
+  if (has_empty_key_ || from_.empty()) {
+    return subject;
+  }
+
+  const char* s = subject.c_str();
+  const string::size_type n = subject.size();
+  const string* from = from_.get_const_vector_pointer();
+  const string* to = to_.get_const_vector_pointer();
+  const int64_t* edges_begin = edges_begin_.get_const_vector_pointer();
+  const int64_t* node_key = node_key_.get_const_vector_pointer();
+  const char* edge_bytes = edge_bytes_.c_str();
+  const auto byte_less = [](char lhs, char rhs) { return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs); };
+
+  string result;
+  string::size_type copied_till = 0;
+  for (string::size_type i = 0; i < n;) {
+    int64_t v = root_child_[static_cast<unsigned char>(s[i])];
+    if (v == 0) {
+      ++i;
+      continue;
+    }
+    int64_t matched = node_key[v];
+    for (string::size_type j = i + 1; j < n; ++j) {
+      const char* edges_end = edge_bytes + edges_begin[v + 1];
+      const char* edge = std::lower_bound(edge_bytes + edges_begin[v], edges_end, s[j], byte_less);
+      if (edge == edges_end || *edge != s[j]) {
+        break;
+      }
+      v = edge - edge_bytes + 1;
+      if (node_key[v] != -1) {
+        matched = node_key[v];
+      }
+    }
+    if (matched == -1) {
+      ++i;
+      continue;
+    }
+    if (copied_till == 0) {
+      result.reserve_at_least(n);
+    }
+    result.append(s + copied_till, i - copied_till);
+    result.append(to[matched]);
+    i += from[matched].size();
+    copied_till = i;
+  }
+  if (copied_till == 0) {
+    return subject;
+  }
+  result.append(s + copied_till, n - copied_till);
+  return result;
+}
+
+} // namespace strings
+} // namespace kphp
+
 string f$str_pad(const string& input, int64_t len, const string& pad_str, int64_t pad_type) noexcept {
   string::size_type old_len = input.size();
   if (len <= old_len) {
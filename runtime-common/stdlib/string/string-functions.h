@@ -11,6 +11,7 @@
 #include <optional>
 #include <string_view>
 
+#include "common/algorithms/simd-string.h"
 #include "common/unicode/unicode-utils.h"
 #include "runtime-common/core/runtime-core.h"
 #include "runtime-common/core/utils/kphp-assert-core.h"
@@ -20,15 +21,8 @@ namespace kphp {
 namespace strings {
 
 inline string bin2hex(std::string_view str) noexcept {
-  int len = str.size();
-  string result(2 * len, false);
-
-  const auto& string_lib_constants{StringLibConstants::get()};
-  for (int i = 0; i < len; i++) {
-    result[2 * i] = string_lib_constants.lhex_digits[(str[i] >> 4) & 15];
-    result[2 * i + 1] = string_lib_constants.lhex_digits[str[i] & 15];
-  }
-
+  string result(2 * str.size(), false);
+  vk::simd::bin_to_hex(str.data(), str.size(), result.buffer());
   return result;
 }
 
@@ -452,40 +446,20 @@ inline Optional<string> f$strstr(const string& haystack, const mixed& needle, bo
   }
 }
 
+// constant arrays are never mutated, so a matcher prepared for them is reused during a request
 template<class T>
 string f$strtr(const string& subject, const array<T>& replace_pairs) noexcept {
-  const char* piece = subject.c_str();
-  const char* piece_end = subject.c_str() + subject.size();
-  string result;
-  while (true) {
-    const char* best_pos = nullptr;
-    int64_t best_len = -1;
-    string replace;
-    for (typename array<T>::const_iterator p = replace_pairs.begin(); p != replace_pairs.end(); ++p) {
-      const string search = f$strval(p.get_key());
-      int64_t search_len = search.size();
-      if (search_len == 0) {
-        return subject;
-      }
-      const char* pos = static_cast<const char*>(memmem(static_cast<const void*>(piece), static_cast<size_t>(piece_end - piece),
-                                                        static_cast<const void*>(search.c_str()), static_cast<size_t>(search_len)));
-      if (pos != nullptr && (best_pos == nullptr || best_pos > pos || (best_pos == pos && search_len > best_len))) {
-        best_pos = pos;
-        best_len = search_len;
-        replace = f$strval(p.get_value());
-      }
-    }
-    if (best_pos == nullptr) {
-      result.append(piece, static_cast<string::size_type>(piece_end - piece));
-      break;
-    }
-
-    result.append(piece, static_cast<string::size_type>(best_pos - piece));
-    result.append(replace);
-
-    piece = best_pos + best_len;
+  if (!replace_pairs.is_reference_counter(ExtraRefCnt::for_global_const)) {
+    return kphp::strings::strtr_matcher{replace_pairs}.replace(subject);
   }
-
+  auto& matchers{StringLibContext::get().strtr_matchers};
+  const auto key{reinterpret_cast<int64_t>(replace_pairs.get_inner_identity())};
+  if (const auto* matcher{matchers.find_value(key)}; matcher != nullptr) {
+    return matcher->replace(subject);
+  }
+  kphp::strings::strtr_matcher matcher{replace_pairs};
+  string result{matcher.replace(subject)};
+  matchers.set_value(key, std::move(matcher));
   return result;
 }
 
@@ -0,0 +1,54 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "runtime-common/core/runtime-core.h"
+
+namespace kphp {
+namespace strings {
+
+// strtr_matcher implements strtr($subject, $replace_pairs) in a single pass over the subject:
+// at every position the longest matching key is replaced, and the search continues after it.
+// Keys are put into a trie, so a position costs at most the length of the longest key whatever the number of keys is
+// (O(subject length * max key length) in the worst case, like in PHP), and bytes that start no key are skipped at once.
+class strtr_matcher {
+public:
+  strtr_matcher() noexcept = default;
+
+  template<class T>
+  explicit strtr_matcher(const array<T>& replace_pairs) noexcept {
+    from_.reserve(replace_pairs.count(), true);
+    to_.reserve(replace_pairs.count(), true);
+    for (const auto& it : replace_pairs) {
+      from_.push_back(f$strval(it.get_key()));
+      to_.push_back(f$strval(it.get_value()));
+    }
+    prepare();
+  }
+
+  string replace(const string& subject) const noexcept;
+
+private:
+  void prepare() noexcept;
+
+  array<string> from_;
+  array<string> to_;
+  // trie nodes are numbered in BFS order, the root is 0; the children of node v are reached by the edges
+  // edge_bytes_[edges_begin_[v]..edges_begin_[v + 1]) sorted by byte, and edge e leads to node e + 1
+  array<int64_t> edges_begin_;
+  string edge_bytes_;
+  // an index of from_ ending at the node or -1
+  array<int64_t> node_key_;
+  // a child of the root by the byte or 0
+  std::array<int64_t, 256> root_child_{};
+  // PHP returns the subject as is if there is an empty key
+  bool has_empty_key_{false};
+};
+
+} // namespace strings
+} // namespace kphp
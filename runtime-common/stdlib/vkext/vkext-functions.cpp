@@ -3,9 +3,11 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 #include "runtime-common/stdlib/vkext/vkext-functions.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 
+#include "common/algorithms/simd-string.h"
 #include "flex/flex.h"
 
 #include "runtime-common/core/utils/kphp-assert-core.h"
@@ -75,6 +77,8 @@ constexpr std::array<int, 256> win_to_utf8_convert = {
     0x42c, 0x42d, 0x42e, 0x42f, 0x430, 0x431,  0x432,  0x433,  0x434,  0x435,  0x436,  0x437,  0x438,  0x439,  0x43a,  0x43b,  0x43c,  0x43d,  0x43e, 0x43f,
     0x440, 0x441, 0x442, 0x443, 0x444, 0x445,  0x446,  0x447,  0x448,  0x449,  0x44a,  0x44b,  0x44c,  0x44d,  0x44e,  0x44f};
 
+constexpr char WIN_TO_UTF8_SPECIAL_CHARS[] = {'&', '\0'};
+
 int utf8_to_win_char(int c) noexcept {
   if (c < 0x80) {
     return c;
@@ -168,6 +172,16 @@ struct buffered_write {
         break;
       }
       int c = static_cast<unsigned char>(s[i]);
+      if (c < 0x80 && !st) {
+        // ASCII is copied as is, skip the whole run at once
+        size_t run = vk::simd::find_first_non_ascii(s + i, s + len) - (s + i);
+        if (max_len) {
+          run = std::min(run, static_cast<size_t>(max_len - result.size()));
+        }
+        write_buff(s + i, run);
+        i += static_cast<int>(run) - 1;
+        continue;
+      }
       if (c < 0x80) {
         if (st) {
           if (exit_on_error) {
@@ -332,6 +346,16 @@ struct buffered_write {
     int save_pos = -1;
     int64_t cur_num = 0;
     for (int i = 0; i < len; i++) {
+      if (state == 0) {
+        // the characters below 0x80 are the same in CP1251 and UTF-8, only '&' starts an entity and '\0' is dropped
+        const char* ascii_end = vk::simd::find_first_non_ascii(s + i, s + len);
+        const int run = static_cast<int>(vk::simd::find_first_of(s + i, ascii_end, WIN_TO_UTF8_SPECIAL_CHARS, sizeof(WIN_TO_UTF8_SPECIAL_CHARS)) - (s + i));
+        if (run > 0) {
+          write_buff(s + i, run);
+          i += run - 1;
+          continue;
+        }
+      }
       if (state == 0 && s[i] == '&') {
         save_pos = result.size();
         cur_num = 0;
@@ -9,6 +9,7 @@
 
 #include "common/mixin/not_copyable.h"
 #include "runtime-common/core/allocator/runtime-allocator.h"
+#include "runtime-light/allocator/coroutine-frame-pool.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
 
 inline constexpr auto DEFAULT_MIN_EXTRA_MEMORY_POOL_SIZE{static_cast<size_t>(1 * 1024U * 1024U)}; // 1Mib
@@ -18,6 +19,7 @@ class AllocatorState final : private vk::not_copyable {
 
 public:
   RuntimeAllocator allocator;
+  kphp::memory::coroutine_frame_pool coroutine_frame_pool{allocator};
 
   void enable_libc_alloc() noexcept {
     ++m_libc_alloc_allowed;
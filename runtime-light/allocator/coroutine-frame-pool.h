@@ -0,0 +1,85 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "common/mixin/not_copyable.h"
+#include "runtime-common/core/allocator/runtime-allocator.h"
+
+namespace kphp::memory {
+
+// Coroutine frames are created and destroyed millions of times per request, and most of them are of a few sizes.
+// A freed frame is kept in the free list of its size class and is reused by the next frame of this class,
+// the memory of the free lists is returned only with the whole allocator.
+class coroutine_frame_pool final : private vk::not_copyable {
+public:
+  static constexpr size_t SIZE_CLASS_GRANULARITY{64};
+  // frames up to 4KiB are pooled, larger ones are rare and go directly to the allocator
+  static constexpr size_t SIZE_CLASSES_COUNT{64};
+
+  struct stats {
+    uint64_t allocations{};
+    uint64_t reused_allocations{};
+    uint64_t unpooled_allocations{};
+    std::array<uint64_t, SIZE_CLASSES_COUNT> size_class_allocations{};
+  };
+
+  explicit coroutine_frame_pool(RuntimeAllocator& allocator) noexcept
+      : m_allocator(allocator) {}
+
+  void* allocate(size_t size) noexcept {
+    ++m_stats.allocations;
+    const size_t size_class{get_size_class(size)};
+    if (size_class >= SIZE_CLASSES_COUNT) [[unlikely]] {
+      ++m_stats.unpooled_allocations;
+      return m_allocator.alloc_script_memory(size);
+    }
+
+    ++m_stats.size_class_allocations[size_class];
+    if (free_frame* frame{m_free_frames[size_class]}; frame != nullptr) {
+      m_free_frames[size_class] = frame->next;
+      ++m_stats.reused_allocations;
+      return frame;
+    }
+    return m_allocator.alloc_script_memory(get_size_class_bound(size_class));
+  }
+
+  // the size must be the same as the one passed to allocate(), sized operator delete guarantees this for coroutine frames
+  void deallocate(void* ptr, size_t size) noexcept {
+    const size_t size_class{get_size_class(size)};
+    if (size_class >= SIZE_CLASSES_COUNT) [[unlikely]] {
+      m_allocator.free_script_memory(ptr, size);
+      return;
+    }
+    m_free_frames[size_class] = new (ptr) free_frame{.next = m_free_frames[size_class]};
+  }
+
+  const stats& get_stats() const noexcept {
+    return m_stats;
+  }
+
+  static constexpr size_t get_size_class_bound(size_t size_class) noexcept {
+    return (size_class + 1) * SIZE_CLASS_GRANULARITY;
+  }
+
+private:
+  struct free_frame {
+    free_frame* next;
+  };
+
+  static constexpr size_t get_size_class(size_t size) noexcept {
+    return size == 0 ? 0 : (size - 1) / SIZE_CLASS_GRANULARITY;
+  }
+
+  RuntimeAllocator& m_allocator;
+  std::array<free_frame*, SIZE_CLASSES_COUNT> m_free_frames{};
+  stats m_stats;
+};
+
+} // namespace kphp::memory
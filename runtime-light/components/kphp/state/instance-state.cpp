@@ -4,12 +4,17 @@
 
 #include "runtime-light/components/kphp/state/instance-state.h"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <span>
 #include <string_view>
+#include <tuple>
 #include <utility>
 
 #include "runtime-common/core/allocator/script-allocator.h"
@@ -26,6 +31,7 @@
 #include "runtime-light/server/rpc/init-functions.h"
 #include "runtime-light/stdlib/component/component-api.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
+#include "runtime-light/stdlib/diagnostics/metrics.h"
 #include "runtime-light/stdlib/fork/fork-functions.h"
 #include "runtime-light/stdlib/fork/fork-state.h"
 #include "runtime-light/stdlib/time/time-functions.h"
@@ -52,6 +58,31 @@ consteval std::string_view resolve_sapi_name() noexcept {
   }
 }
 
+void send_coroutine_frame_metrics() noexcept {
+  using tag = std::pair<std::string_view, std::string_view>;
+  const auto& stats{AllocatorState::get().coroutine_frame_pool.get_stats()};
+  if (stats.allocations == 0) {
+    return;
+  }
+  const auto send_count{[](std::string_view metric_name, tag metric_tag, uint64_t count) noexcept {
+    const auto capped_count{static_cast<uint32_t>(std::min<uint64_t>(count, std::numeric_limits<uint32_t>::max()))};
+    std::ignore = kphp::diagnostics::metric::empty().send_count(metric_name, std::array{metric_tag}, capped_count);
+  }};
+
+  send_count("kphp_coroutine_frame_allocations", tag{"kind", "total"}, stats.allocations);
+  send_count("kphp_coroutine_frame_allocations", tag{"kind", "reused"}, stats.reused_allocations);
+  send_count("kphp_coroutine_frame_allocations", tag{"kind", "unpooled"}, stats.unpooled_allocations);
+  for (size_t size_class = 0; size_class != stats.size_class_allocations.size(); ++size_class) {
+    if (stats.size_class_allocations[size_class] != 0) {
+      std::array<char, std::numeric_limits<size_t>::digits10 + 1> size_bound{};
+      const auto* size_bound_end{
+          std::to_chars(size_bound.data(), size_bound.data() + size_bound.size(), kphp::memory::coroutine_frame_pool::get_size_class_bound(size_class)).ptr};
+      send_count("kphp_coroutine_frame_size", tag{"size_bound", std::string_view{size_bound.data(), size_bound_end}},
+                 stats.size_class_allocations[size_class]);
+    }
+  }
+}
+
 } // namespace
 
 // === initialization =============================================================================
@@ -218,6 +249,7 @@ kphp::coro::task<> InstanceState::run_instance_epilogue() noexcept {
     kphp::log::error("unexpected image kind: {}", std::to_underlying(image_kind()));
   }
   shutdown_state_ = shutdown_state::finished;
+  send_coroutine_frame_metrics();
 
   // Stop session with internal Web component
   if (auto& web_state{WebInstanceState::get()}; web_state.session.has_value()) {
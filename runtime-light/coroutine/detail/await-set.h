@@ -8,11 +8,12 @@
 #include <cstddef>
 #include <expected>
 #include <memory>
+#include <new>
 #include <optional>
 
 #include "common/containers/intrusive-list.h"
-#include "runtime-common/core/allocator/script-malloc-interface.h"
 #include "runtime-light/coroutine/async-stack.h"
+#include "runtime-light/coroutine/detail/frame-allocation.h"
 #include "runtime-light/coroutine/type-traits.h"
 #include "runtime-light/coroutine/void-value.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
@@ -53,16 +54,20 @@ public:
 
   template<typename... Args>
   void* operator new(size_t n, [[maybe_unused]] Args&&... args) noexcept {
-    return kphp::memory::script::alloc(n);
+    return kphp::coro::detail::allocate_frame(n);
   }
 
   template<typename... Args>
   auto operator new(size_t n, std::align_val_t al, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc_aligned(n, al);
+    return kphp::coro::detail::allocate_aligned_frame(n, al);
   }
 
-  void operator delete(void* ptr, [[maybe_unused]] size_t n) noexcept {
-    kphp::memory::script::free(ptr);
+  void operator delete(void* ptr, size_t n) noexcept {
+    kphp::coro::detail::deallocate_frame(ptr, n);
+  }
+
+  void operator delete(void* ptr, [[maybe_unused]] size_t n, [[maybe_unused]] std::align_val_t al) noexcept {
+    kphp::coro::detail::deallocate_aligned_frame(ptr);
   }
 
   void start_task(await_set_task<return_type>&& task, kphp::coro::async_stack_root& coroutine_stack_root, void* return_address) noexcept {
@@ -175,16 +180,20 @@ public:
 
   template<typename... Args>
   void* operator new(size_t n, [[maybe_unused]] Args&&... args) noexcept {
-    return kphp::memory::script::alloc(n);
+    return kphp::coro::detail::allocate_frame(n);
   }
 
   template<typename... Args>
   auto operator new(size_t n, std::align_val_t al, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc_aligned(n, al);
+    return kphp::coro::detail::allocate_aligned_frame(n, al);
+  }
+
+  void operator delete(void* ptr, size_t n) noexcept {
+    kphp::coro::detail::deallocate_frame(ptr, n);
   }
 
-  void operator delete(void* ptr, [[maybe_unused]] size_t n) noexcept {
-    kphp::memory::script::free(ptr);
+  void operator delete(void* ptr, [[maybe_unused]] size_t n, [[maybe_unused]] std::align_val_t al) noexcept {
+    kphp::coro::detail::deallocate_aligned_frame(ptr);
   }
 
   std::suspend_always initial_suspend() const noexcept {
@@ -0,0 +1,33 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#include "runtime-common/core/allocator/script-malloc-interface.h"
+#include "runtime-light/allocator/allocator-state.h"
+
+namespace kphp::coro::detail {
+
+// promises of all the coroutine types allocate their frames here, see kphp::memory::coroutine_frame_pool
+inline auto allocate_frame(size_t n) noexcept -> void* {
+  return AllocatorState::get_mutable().coroutine_frame_pool.allocate(n);
+}
+
+inline auto deallocate_frame(void* ptr, size_t n) noexcept -> void {
+  AllocatorState::get_mutable().coroutine_frame_pool.deallocate(ptr, n);
+}
+
+// over-aligned frames are rare, they are not pooled
+inline auto allocate_aligned_frame(size_t n, std::align_val_t al) noexcept -> void* {
+  return kphp::memory::script::alloc_aligned(n, al);
+}
+
+inline auto deallocate_aligned_frame(void* ptr) noexcept -> void {
+  kphp::memory::script::free(ptr);
+}
+
+} // namespace kphp::coro::detail
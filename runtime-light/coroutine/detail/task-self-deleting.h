@@ -7,12 +7,13 @@
 #include <coroutine>
 #include <cstddef>
 #include <memory>
+#include <new>
 
 #include "common/containers/intrusive-list.h"
-#include "runtime-common/core/allocator/script-malloc-interface.h"
 #include "runtime-light/coroutine/async-stack.h"
 #include "runtime-light/coroutine/concepts.h"
 #include "runtime-light/coroutine/coroutine-state.h"
+#include "runtime-light/coroutine/detail/frame-allocation.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
 
 namespace kphp::coro::detail {
@@ -35,16 +36,20 @@ struct promise_self_deleting : kphp::coro::async_stack_element {
 
   template<typename... Args>
   auto operator new(size_t n, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc(n);
+    return kphp::coro::detail::allocate_frame(n);
   }
 
   template<typename... Args>
   auto operator new(size_t n, std::align_val_t al, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc_aligned(n, al);
+    return kphp::coro::detail::allocate_aligned_frame(n, al);
   }
 
-  auto operator delete(void* ptr, [[maybe_unused]] size_t n) noexcept -> void {
-    kphp::memory::script::free(ptr);
+  auto operator delete(void* ptr, size_t n) noexcept -> void {
+    kphp::coro::detail::deallocate_frame(ptr, n);
+  }
+
+  auto operator delete(void* ptr, [[maybe_unused]] size_t n, [[maybe_unused]] std::align_val_t al) noexcept -> void {
+    kphp::coro::detail::deallocate_aligned_frame(ptr);
   }
 
   auto get_return_object() noexcept -> task_self_deleting;
@@ -9,6 +9,7 @@
 #include <coroutine>
 #include <cstddef>
 #include <memory>
+#include <new>
 #include <optional>
 #include <tuple>
 #include <type_traits>
@@ -16,6 +17,7 @@
 
 #include "runtime-light/coroutine/async-stack.h"
 #include "runtime-light/coroutine/concepts.h"
+#include "runtime-light/coroutine/detail/frame-allocation.h"
 #include "runtime-light/coroutine/type-traits.h"
 #include "runtime-light/coroutine/void-value.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
@@ -152,16 +154,20 @@ public:
 
   template<typename... Args>
   auto operator new(size_t n, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc(n);
+    return kphp::coro::detail::allocate_frame(n);
   }
 
   template<typename... Args>
   auto operator new(size_t n, std::align_val_t al, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc_aligned(n, al);
+    return kphp::coro::detail::allocate_aligned_frame(n, al);
   }
 
-  auto operator delete(void* ptr, [[maybe_unused]] size_t n) noexcept -> void {
-    kphp::memory::script::free(ptr);
+  auto operator delete(void* ptr, size_t n) noexcept -> void {
+    kphp::coro::detail::deallocate_frame(ptr, n);
+  }
+
+  auto operator delete(void* ptr, [[maybe_unused]] size_t n, [[maybe_unused]] std::align_val_t al) noexcept -> void {
+    kphp::coro::detail::deallocate_aligned_frame(ptr);
   }
 
   auto initial_suspend() const noexcept -> std::suspend_always {
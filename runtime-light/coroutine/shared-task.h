@@ -16,8 +16,8 @@
 #include <variant>
 
 #include "common/containers/intrusive-list.h"
-#include "runtime-common/core/allocator/script-malloc-interface.h"
 #include "runtime-light/coroutine/async-stack.h"
+#include "runtime-light/coroutine/detail/frame-allocation.h"
 #include "runtime-light/coroutine/void-value.h"
 #include "runtime-light/stdlib/diagnostics/logs.h"
 
@@ -125,16 +125,20 @@ public:
 
   template<typename... Args>
   auto operator new(size_t n, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc(n);
+    return kphp::coro::detail::allocate_frame(n);
   }
 
   template<typename... Args>
   auto operator new(size_t n, std::align_val_t al, [[maybe_unused]] Args&&... args) noexcept -> void* {
-    return kphp::memory::script::alloc_aligned(n, al);
+    return kphp::coro::detail::allocate_aligned_frame(n, al);
   }
 
-  auto operator delete(void* ptr, [[maybe_unused]] size_t n) noexcept -> void {
-    kphp::memory::script::free(ptr);
+  auto operator delete(void* ptr, size_t n) noexcept -> void {
+    kphp::coro::detail::deallocate_frame(ptr, n);
+  }
+
+  auto operator delete(void* ptr, [[maybe_unused]] size_t n, [[maybe_unused]] std::align_val_t al) noexcept -> void {
+    kphp::coro::detail::deallocate_aligned_frame(ptr);
   }
 
 private:
@@ -0,0 +1,760 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime-light/k2-host/host-state.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "runtime-light/stdlib/diagnostics/metrics.h"
+
+namespace kphp::k2_host {
+
+namespace {
+
+uint64_t to_ns(std::chrono::nanoseconds duration) noexcept {
+  return static_cast<uint64_t>(duration.count());
+}
+
+// Reads the TL serialized metrics described in k2_write_metrics
+class metrics_fetcher {
+public:
+  metrics_fetcher(const void* data, size_t len) noexcept
+      : m_data(static_cast<const char*>(data)),
+        m_len(len) {}
+
+  bool empty() const noexcept {
+    return m_pos == m_len;
+  }
+
+  template<typename T>
+  std::optional<T> fetch_trivial() noexcept {
+    if (m_len - m_pos < sizeof(T)) {
+      return std::nullopt;
+    }
+    T value{};
+    std::memcpy(std::addressof(value), m_data + m_pos, sizeof(T));
+    m_pos += sizeof(T);
+    return value;
+  }
+
+  std::optional<std::string_view> fetch_string() noexcept {
+    const auto first_byte{fetch_trivial<uint8_t>()};
+    if (!first_byte) {
+      return std::nullopt;
+    }
+    size_t header_len{1};
+    uint64_t str_len{*first_byte};
+    if (*first_byte >= 0xfe) {
+      const size_t len_bytes{*first_byte == 0xfe ? 3UL : 7UL};
+      if (m_len - m_pos < len_bytes) {
+        return std::nullopt;
+      }
+      str_len = 0;
+      for (size_t i = 0; i < len_bytes; ++i) {
+        str_len |= static_cast<uint64_t>(static_cast<uint8_t>(m_data[m_pos + i])) << (8 * i);
+      }
+      m_pos += len_bytes;
+      header_len += len_bytes;
+    }
+    const size_t padding{((header_len + str_len + 3) & ~3UL) - (header_len + str_len)};
+    if (m_len - m_pos < str_len + padding) {
+      return std::nullopt;
+    }
+    const std::string_view str{m_data + m_pos, str_len};
+    m_pos += str_len + padding;
+    return str;
+  }
+
+private:
+  const char* m_data;
+  size_t m_len;
+  size_t m_pos{};
+};
+
+} // namespace
+
+host& host::get() noexcept {
+  static host host_state;
+  return host_state;
+}
+
+// === driver interface ===========================================================================
+
+bool host::load_image(const char* path) noexcept {
+  void* handle{dlopen(path, RTLD_NOW | RTLD_LOCAL)};
+  if (handle == nullptr) {
+    // images use initial-exec TLS, glibc.rtld.optional_static_tls tunable may be required to load them
+    std::fprintf(stderr, "can't load image %s: %s\n", path, dlerror());
+    return false;
+  }
+
+  bool ok{true};
+  const auto resolve{[handle, &ok]<typename F>(F*& entry_point, const char* name) noexcept {
+    entry_point = reinterpret_cast<F*>(dlsym(handle, name));
+    if (entry_point == nullptr) {
+      std::fprintf(stderr, "image doesn't export %s\n", name);
+      ok = false;
+    }
+  }};
+  ImageState* (*k2_create_image)(){};
+  void (*k2_init_image)(){};
+  ComponentState* (*k2_create_component)(){};
+  void (*k2_init_component)(){};
+  resolve(k2_create_image, "k2_create_image");
+  resolve(k2_init_image, "k2_init_image");
+  resolve(k2_create_component, "k2_create_component");
+  resolve(k2_init_component, "k2_init_component");
+  resolve(m_k2_create_instance, "k2_create_instance");
+  resolve(m_k2_init_instance, "k2_init_instance");
+  resolve(m_k2_poll, "k2_poll");
+  resolve(m_k2_warmup, "k2_warmup");
+  resolve(m_k2_describe, "k2_describe");
+  if (!ok) {
+    return false;
+  }
+  if (const auto header_version{m_k2_describe()->header_h_version}; header_version != K2_PLATFORM_HEADER_H_VERSION) {
+    std::fprintf(stderr, "image is built with k2-header.h version %" PRIu64 ", host version is %d\n", header_version, K2_PLATFORM_HEADER_H_VERSION);
+    return false;
+  }
+
+  m_scope = scope::image;
+  m_image_state = k2_create_image();
+  k2_init_image();
+  m_scope = scope::component;
+  m_component_state = k2_create_component();
+  k2_init_component();
+  return true;
+}
+
+const ImageInfo* host::describe() const noexcept {
+  return m_k2_describe();
+}
+
+bool host::warmup() noexcept {
+  const bool is_oneshot{static_cast<bool>(describe()->is_oneshot)};
+  if (m_instance_state == nullptr) {
+    create_instance();
+  }
+
+  PollStatus status{PollStatus::PollReschedule};
+  while (status != PollStatus::PollFinishedOk && status != PollStatus::PollFinishedError) {
+    status = poll(m_k2_warmup);
+    if (status == PollStatus::PollBlocked && m_updates.empty() && !advance_clock()) {
+      std::fprintf(stderr, "warmup is blocked, but there are no events to wait for\n");
+      status = PollStatus::PollFinishedError;
+    }
+  }
+  // oneshot images are warmed up on a throwaway instance
+  if (is_oneshot || status != PollStatus::PollFinishedOk) {
+    destroy_instance();
+  }
+  return status == PollStatus::PollFinishedOk;
+}
+
+request_result host::run_request(std::string_view request) noexcept {
+  const bool is_oneshot{static_cast<bool>(describe()->is_oneshot)};
+  if (m_instance_state == nullptr) {
+    create_instance();
+  }
+
+  auto stream{std::make_shared<channel>()};
+  stream->inbound.data = request;
+  stream->inbound.write_closed = true;
+  push_update(add_descriptor(stream_descriptor{.stream = stream}), UpdateStatus::NewDescriptor);
+
+  request_result result{};
+  const auto start{std::chrono::steady_clock::now()};
+  for (;;) {
+    const auto status{poll(m_k2_poll)};
+    if (result.latency_ns == 0 && stream->outbound.write_closed) {
+      result.latency_ns = to_ns(std::chrono::steady_clock::now() - start);
+    }
+    if (status == PollStatus::PollFinishedOk || status == PollStatus::PollFinishedError) {
+      result.ok = status == PollStatus::PollFinishedOk;
+      result.instance_finished = true;
+      break;
+    }
+    if (status == PollStatus::PollReschedule || !m_updates.empty()) {
+      continue;
+    }
+    // multishot instance handles the next request in the same instance after the response is sent
+    if (!is_oneshot && stream->outbound.write_closed) {
+      result.ok = true;
+      break;
+    }
+    if (!advance_clock()) {
+      std::fprintf(stderr, "instance is blocked, but there are no events to wait for\n");
+      result.instance_finished = true;
+      break;
+    }
+  }
+  if (result.latency_ns == 0) {
+    result.latency_ns = to_ns(std::chrono::steady_clock::now() - start);
+  }
+  result.response = std::move(stream->outbound.data);
+  result.instance_allocator_stats = get_allocator_stats(scope::instance);
+
+  if (is_oneshot || result.instance_finished) {
+    destroy_instance();
+  }
+  return result;
+}
+
+void host::create_instance() noexcept {
+  m_scope = scope::instance;
+  m_instance_state = nullptr;
+  m_instance_state = m_k2_create_instance();
+  m_k2_init_instance();
+  ++m_instances_created;
+}
+
+void host::destroy_instance() noexcept {
+  // k2-node releases the whole instance memory at once, the component doesn't free it itself
+  for (auto it{m_allocations.begin()}; it != m_allocations.end();) {
+    if (it->second == scope::instance) {
+      std::free(it->first);
+      it = m_allocations.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto& [d, desc] : m_descriptors) {
+    if (const auto* file{std::get_if<file_descriptor>(std::addressof(desc))}; file != nullptr) {
+      std::fclose(file->file);
+    } else if (const auto* mapping{std::get_if<mmap_descriptor>(std::addressof(desc))}; mapping != nullptr) {
+      ::munmap(mapping->addr, mapping->length);
+    }
+  }
+  m_descriptors.clear();
+  m_updates.clear();
+  m_events.clear();
+  m_allocator_stats[static_cast<size_t>(scope::instance)] = allocator_stats{};
+  m_instance_state = nullptr;
+  m_scope = scope::component;
+}
+
+PollStatus host::poll(PollStatus (*poll_fn)()) noexcept {
+  m_is_polling = true;
+  if (setjmp(m_exit_point) != 0) {
+    m_is_polling = false;
+    return m_exit_code == 0 ? PollStatus::PollFinishedOk : PollStatus::PollFinishedError;
+  }
+  const auto status{poll_fn()};
+  m_is_polling = false;
+  return status;
+}
+
+// === descriptors and events =====================================================================
+
+template<typename T>
+T* host::get_descriptor(uint64_t d) noexcept {
+  const auto it{m_descriptors.find(d)};
+  return it != m_descriptors.end() ? std::get_if<T>(std::addressof(it->second)) : nullptr;
+}
+
+uint64_t host::add_descriptor(descriptor desc) noexcept {
+  const uint64_t d{m_next_descriptor++};
+  m_descriptors.emplace(d, std::move(desc));
+  return d;
+}
+
+void host::push_update(uint64_t d, UpdateStatus status) noexcept {
+  m_updates.emplace_back(d, status);
+}
+
+UpdateStatus host::take_update(uint64_t* d) noexcept {
+  if (m_updates.empty()) {
+    *d = 0;
+    return UpdateStatus::NoUpdates;
+  }
+  const auto [update_d, status]{m_updates.front()};
+  m_updates.pop_front();
+  *d = update_d;
+  return status;
+}
+
+void host::schedule(uint64_t delay_ns, std::function<void()> event) noexcept {
+  m_events.emplace(instant_ns() + delay_ns, std::move(event));
+}
+
+bool host::advance_clock() noexcept {
+  if (m_events.empty()) {
+    return false;
+  }
+  if (const auto now{instant_ns()}, deadline{m_events.begin()->first}; deadline > now) {
+    m_skipped_ns += deadline - now;
+  }
+  const auto now{instant_ns()};
+  while (!m_events.empty() && m_events.begin()->first <= now) {
+    auto event{std::move(m_events.begin()->second)};
+    m_events.erase(m_events.begin());
+    event();
+  }
+  return true;
+}
+
+void host::respond(std::shared_ptr<channel> stream, uint64_t d) noexcept {
+  schedule(m_config.loopback_latency_ns, [this, stream = std::move(stream), d]() noexcept {
+    if (const auto it{m_config.loopback_responses.find(*stream->responder)}; it != m_config.loopback_responses.end()) {
+      stream->inbound.data.append(it->second);
+    } else {
+      stream->inbound.data.append(stream->outbound.data, stream->outbound.read_offset);
+    }
+    stream->inbound.write_closed = true;
+    if (m_descriptors.contains(d)) {
+      push_update(d, UpdateStatus::UpdateExisted);
+    }
+  });
+}
+
+uint64_t host::instant_ns() const noexcept {
+  return to_ns(std::chrono::steady_clock::now().time_since_epoch()) + m_skipped_ns;
+}
+
+uint64_t host::system_time_ns() const noexcept {
+  return to_ns(std::chrono::system_clock::now().time_since_epoch()) + m_skipped_ns;
+}
+
+// === memory =====================================================================================
+
+void host::track_allocation(void* ptr, scope s) noexcept {
+  auto& stats{m_allocator_stats[static_cast<size_t>(s)]};
+  stats.memory_usage += malloc_usable_size(ptr);
+  stats.peak_memory_usage = std::max(stats.peak_memory_usage, stats.memory_usage);
+  m_allocations.emplace(ptr, s);
+}
+
+scope host::untrack_allocation(void* ptr) noexcept {
+  const auto it{m_allocations.find(ptr)};
+  if (it == m_allocations.end()) {
+    return m_scope;
+  }
+  const scope s{it->second};
+  m_allocator_stats[static_cast<size_t>(s)].memory_usage -= malloc_usable_size(ptr);
+  m_allocations.erase(it);
+  return s;
+}
+
+void* host::alloc(size_t size, size_t align) noexcept {
+  align = std::max(align, alignof(std::max_align_t));
+  void* ptr{std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) & ~(align - 1))};
+  if (ptr != nullptr) {
+    ++m_allocator_stats[static_cast<size_t>(m_scope)].allocations;
+    track_allocation(ptr, m_scope);
+  }
+  return ptr;
+}
+
+void* host::realloc(void* ptr, size_t new_size) noexcept {
+  if (ptr == nullptr) {
+    return alloc(new_size, 0);
+  }
+  const scope s{untrack_allocation(ptr)};
+  void* new_ptr{std::realloc(ptr, new_size)};
+  track_allocation(new_ptr != nullptr ? new_ptr : ptr, s);
+  ++m_allocator_stats[static_cast<size_t>(s)].reallocations;
+  return new_ptr;
+}
+
+void* host::realloc_checked(void* ptr, size_t old_size, size_t align, size_t new_size) noexcept {
+  if (align <= alignof(std::max_align_t)) {
+    return realloc(ptr, new_size);
+  }
+  void* new_ptr{alloc(new_size, align)};
+  if (new_ptr != nullptr && ptr != nullptr) {
+    std::memcpy(new_ptr, ptr, std::min(old_size, new_size));
+    free(ptr);
+  }
+  return new_ptr;
+}
+
+void host::free(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  ++m_allocator_stats[static_cast<size_t>(untrack_allocation(ptr))].deallocations;
+  std::free(ptr);
+}
+
+int32_t host::alloc_shared_memory(size_t size, size_t align, void** pointer) noexcept {
+  if (pointer == nullptr || size == 0 || (align & (align - 1)) != 0) {
+    return EINVAL;
+  }
+  align = std::max(align, static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+  *pointer = std::aligned_alloc(align, (size + align - 1) & ~(align - 1));
+  if (*pointer == nullptr) {
+    return ENOMEM;
+  }
+  m_shared_memory_sizes.emplace(*pointer, size);
+  return 0;
+}
+
+int32_t host::publish_shared_memory(std::string_view name, const void* memory, bool ignore_if_exist) noexcept {
+  if (name.empty() || memory == nullptr) {
+    return EINVAL;
+  }
+  const auto size_it{m_shared_memory_sizes.find(memory)};
+  if (size_it == m_shared_memory_sizes.end()) {
+    return ENOENT;
+  }
+  auto [it, inserted]{m_shared_memory.try_emplace(std::string{name}, memory, size_it->second)};
+  if (!inserted) {
+    if (!ignore_if_exist) {
+      return EEXIST;
+    }
+    it->second = {memory, size_it->second};
+  }
+  return 0;
+}
+
+int32_t host::get_shared_memory(std::string_view name, const void** pointer, size_t* size) noexcept {
+  if (name.empty() || pointer == nullptr) {
+    return EINVAL;
+  }
+  const auto it{m_shared_memory.find(std::string{name})};
+  if (it == m_shared_memory.end()) {
+    *pointer = nullptr;
+    return ENOENT;
+  }
+  *pointer = it->second.first;
+  if (size != nullptr) {
+    *size = it->second.second;
+  }
+  return 0;
+}
+
+// === streams and files ==========================================================================
+
+int32_t host::open_stream(uint64_t* stream_d, std::string_view name) noexcept {
+  if (name.empty()) {
+    *stream_d = 0;
+    return EINVAL;
+  }
+  auto stream{std::make_shared<channel>()};
+  stream->responder.emplace(name);
+  *stream_d = add_descriptor(stream_descriptor{.stream = std::move(stream)});
+  return 0;
+}
+
+int32_t host::open_file(uint64_t* fd, std::string_view path, std::string_view mode) noexcept {
+  *fd = 0;
+  if (path.empty() || mode.empty()) {
+    return EINVAL;
+  }
+  FILE* file{std::fopen(std::string{path}.c_str(), std::string{mode}.c_str())};
+  if (file == nullptr) {
+    return errno;
+  }
+  *fd = add_descriptor(file_descriptor{.file = file});
+  return 0;
+}
+
+void host::stream_status(uint64_t d, StreamStatus* status) noexcept {
+  *status = StreamStatus{.read_status = IOStatus::IOClosed, .write_status = IOStatus::IOClosed, .please_shutdown_write = 0, .libc_errno = 0};
+  const auto it{m_descriptors.find(d)};
+  if (it == m_descriptors.end()) {
+    status->libc_errno = EBADF;
+    return;
+  }
+  if (const auto* stream_desc{std::get_if<stream_descriptor>(std::addressof(it->second))}; stream_desc != nullptr) {
+    const auto& stream{*stream_desc->stream};
+    if (stream.inbound.available() != 0) {
+      status->read_status = IOStatus::IOAvailable;
+    } else {
+      status->read_status = stream.inbound.write_closed ? IOStatus::IOClosed : IOStatus::IOBlocked;
+    }
+    // in-memory streams are unbounded, so writing is never blocked
+    status->write_status = stream.outbound.write_closed ? IOStatus::IOClosed : IOStatus::IOAvailable;
+    status->please_shutdown_write = static_cast<int32_t>(stream.please_shutdown_write);
+  } else if (const auto* rpc{std::get_if<rpc_descriptor>(std::addressof(it->second))}; rpc != nullptr) {
+    status->read_status = rpc->response.has_value() ? IOStatus::IOAvailable : IOStatus::IOBlocked;
+  } else if (std::holds_alternative<file_descriptor>(it->second)) {
+    status->read_status = IOStatus::IOAvailable;
+    status->write_status = IOStatus::IOAvailable;
+  } else {
+    status->libc_errno = EBADR;
+  }
+}
+
+size_t host::write(uint64_t d, size_t len, const void* data) noexcept {
+  if (auto* stream_desc{get_descriptor<stream_descriptor>(d)}; stream_desc != nullptr) {
+    auto& outbound{stream_desc->stream->outbound};
+    if (outbound.write_closed) {
+      return 0;
+    }
+    outbound.data.append(static_cast<const char*>(data), len);
+    return len;
+  }
+  if (auto* file{get_descriptor<file_descriptor>(d)}; file != nullptr) {
+    return std::fwrite(data, 1, len, file->file);
+  }
+  return 0;
+}
+
+size_t host::read(uint64_t d, size_t len, void* buf) noexcept {
+  if (auto* stream_desc{get_descriptor<stream_descriptor>(d)}; stream_desc != nullptr) {
+    auto& inbound{stream_desc->stream->inbound};
+    const size_t read_len{std::min(len, inbound.available())};
+    std::memcpy(buf, inbound.data.data() + inbound.read_offset, read_len);
+    inbound.read_offset += read_len;
+    if (inbound.available() == 0) {
+      inbound.data.clear();
+      inbound.read_offset = 0;
+    }
+    return read_len;
+  }
+  if (auto* file{get_descriptor<file_descriptor>(d)}; file != nullptr) {
+    return std::fread(buf, 1, len, file->file);
+  }
+  return 0;
+}
+
+size_t host::pread(uint64_t d, size_t len, void* buf, uint64_t offset) noexcept {
+  if (auto* stream_desc{get_descriptor<stream_descriptor>(d)}; stream_desc != nullptr) {
+    const auto& inbound{stream_desc->stream->inbound};
+    if (offset >= inbound.available()) {
+      return 0;
+    }
+    const size_t read_len{std::min<size_t>(len, inbound.available() - offset)};
+    std::memcpy(buf, inbound.data.data() + inbound.read_offset + offset, read_len);
+    return read_len;
+  }
+  if (auto* file{get_descriptor<file_descriptor>(d)}; file != nullptr) {
+    return static_cast<size_t>(std::max<ssize_t>(::pread(fileno(file->file), buf, len, static_cast<off_t>(offset)), 0));
+  }
+  return 0;
+}
+
+size_t host::readline(uint64_t d, size_t len, void* buf) noexcept {
+  auto* file{get_descriptor<file_descriptor>(d)};
+  if (file == nullptr || len == 0 || std::fgets(static_cast<char*>(buf), static_cast<int>(std::min<size_t>(len, INT32_MAX)), file->file) == nullptr) {
+    return 0;
+  }
+  return std::strlen(static_cast<const char*>(buf));
+}
+
+int32_t host::fstat(uint64_t d, struct stat* statbuf) noexcept {
+  auto* file{get_descriptor<file_descriptor>(d)};
+  if (file == nullptr) {
+    return EBADF;
+  }
+  return ::fstat(fileno(file->file), statbuf) == 0 ? 0 : errno;
+}
+
+void* host::mmap(uint64_t* md, size_t len, int32_t prot, int32_t flags, uint64_t fd, uint64_t offset) noexcept {
+  *md = 0;
+  auto* file{get_descriptor<file_descriptor>(fd)};
+  if (file == nullptr) {
+    return MAP_FAILED;
+  }
+  void* addr{::mmap(nullptr, len, prot, flags, fileno(file->file), static_cast<off_t>(offset))};
+  if (addr != MAP_FAILED) {
+    *md = add_descriptor(mmap_descriptor{.addr = addr, .length = len});
+  }
+  return addr;
+}
+
+void host::shutdown_write(uint64_t d) noexcept {
+  auto* stream_desc{get_descriptor<stream_descriptor>(d)};
+  if (stream_desc == nullptr || std::exchange(stream_desc->stream->outbound.write_closed, true)) {
+    return;
+  }
+  if (stream_desc->stream->responder.has_value()) {
+    respond(stream_desc->stream, d);
+  }
+}
+
+void host::please_shutdown(uint64_t /*d*/) noexcept {
+  // the peers of the component are the host and the loopback responders, both of them shut down writing by themselves
+}
+
+void host::free_descriptor(uint64_t d) noexcept {
+  const auto it{m_descriptors.find(d)};
+  if (it == m_descriptors.end()) {
+    return;
+  }
+  if (auto* stream_desc{std::get_if<stream_descriptor>(std::addressof(it->second))}; stream_desc != nullptr) {
+    stream_desc->stream->outbound.write_closed = true;
+  } else if (auto* file{std::get_if<file_descriptor>(std::addressof(it->second))}; file != nullptr) {
+    std::fclose(file->file);
+  } else if (auto* mapping{std::get_if<mmap_descriptor>(std::addressof(it->second))}; mapping != nullptr) {
+    ::munmap(mapping->addr, mapping->length);
+  }
+  m_descriptors.erase(it);
+}
+
+// === timers and rpc =============================================================================
+
+int32_t host::new_timer(uint64_t* d, uint64_t duration_ns) noexcept {
+  const uint64_t timer_d{add_descriptor(timer_descriptor{.deadline_ns = instant_ns() + duration_ns})};
+  schedule(duration_ns, [this, timer_d]() noexcept {
+    if (m_descriptors.contains(timer_d)) {
+      push_update(timer_d, UpdateStatus::UpdateExisted);
+    }
+  });
+  *d = timer_d;
+  return 0;
+}
+
+int32_t host::timer_deadline(uint64_t d, TimePoint* deadline) noexcept {
+  deadline->time_point_ns = 0;
+  const auto it{m_descriptors.find(d)};
+  if (it == m_descriptors.end()) {
+    return EBADF;
+  }
+  const auto* timer{std::get_if<timer_descriptor>(std::addressof(it->second))};
+  if (timer == nullptr) {
+    return EBADR;
+  }
+  deadline->time_point_ns = timer->deadline_ns;
+  return 0;
+}
+
+int32_t host::rpc_send_request(std::string_view actor, std::string_view request, uint64_t* rpc_d) noexcept {
+  if (actor.empty()) {
+    return EINVAL;
+  }
+  const uint64_t d{add_descriptor(rpc_descriptor{})};
+  schedule(m_config.loopback_latency_ns, [this, d, actor = std::string{actor}, request = std::string{request}]() mutable noexcept {
+    auto* rpc{get_descriptor<rpc_descriptor>(d)};
+    if (rpc == nullptr) {
+      return;
+    }
+    const auto it{m_config.loopback_responses.find(actor)};
+    rpc->response.emplace(it != m_config.loopback_responses.end() ? it->second : std::move(request));
+    push_update(d, UpdateStatus::UpdateExisted);
+  });
+  *rpc_d = d;
+  return 0;
+}
+
+int32_t host::rpc_get_response_size(uint64_t rpc_d, size_t* size) noexcept {
+  *size = 0;
+  const auto* rpc{get_descriptor<rpc_descriptor>(rpc_d)};
+  if (rpc == nullptr) {
+    return EINVAL;
+  }
+  if (!rpc->response.has_value()) {
+    return EAGAIN;
+  }
+  *size = rpc->response->size();
+  return 0;
+}
+
+int32_t host::rpc_fetch_response(uint64_t rpc_d, void* buf, size_t buf_size) noexcept {
+  const auto* rpc{get_descriptor<rpc_descriptor>(rpc_d)};
+  if (rpc == nullptr) {
+    return EINVAL;
+  }
+  if (!rpc->response.has_value()) {
+    return EAGAIN;
+  }
+  if (buf_size < rpc->response->size()) {
+    return ENOBUFS;
+  }
+  std::memcpy(buf, rpc->response->data(), rpc->response->size());
+  return 0;
+}
+
+// === misc =======================================================================================
+
+int32_t host::write_metrics(const void* buf, size_t buf_len) noexcept {
+  metrics_fetcher fetcher{buf, buf_len};
+  while (!fetcher.empty()) {
+    const auto timestamp{fetcher.fetch_trivial<uint64_t>()};
+    const auto name{fetcher.fetch_string()};
+    const auto magic{fetcher.fetch_trivial<uint32_t>()};
+    if (!timestamp || !name || !magic) {
+      return EINVAL;
+    }
+
+    double value{};
+    switch (*magic) {
+    case tl::AnyMetricValue::VALUE_MAGIC: {
+      const auto opt_value{fetcher.fetch_trivial<double>()};
+      if (!opt_value) {
+        return EINVAL;
+      }
+      value = *opt_value;
+      break;
+    }
+    case tl::AnyMetricValue::VALUES_ARRAY_MAGIC: {
+      const auto len{fetcher.fetch_trivial<uint32_t>()};
+      for (uint32_t i = 0; len && i < *len; ++i) {
+        const auto opt_value{fetcher.fetch_trivial<double>()};
+        if (!opt_value) {
+          return EINVAL;
+        }
+        value += *opt_value;
+      }
+      break;
+    }
+    case tl::AnyMetricValue::COUNT_MAGIC: {
+      const auto count{fetcher.fetch_trivial<uint32_t>()};
+      if (!count) {
+        return EINVAL;
+      }
+      value = *count;
+      break;
+    }
+    case tl::AnyMetricValue::INC_MAGIC:
+      value = 1;
+      break;
+    default:
+      return EINVAL;
+    }
+
+    std::string key{*name};
+    const auto tags_count{fetcher.fetch_trivial<uint32_t>()};
+    if (!tags_count) {
+      return EINVAL;
+    }
+    for (uint32_t i = 0; i < *tags_count; ++i) {
+      const auto tag_name{fetcher.fetch_string()};
+      const auto tag_value{fetcher.fetch_string()};
+      if (!tag_name || !tag_value) {
+        return EINVAL;
+      }
+      key.append(i == 0 ? "{" : ",").append(*tag_name).append("=").append(*tag_value);
+    }
+    if (*tags_count != 0) {
+      key.append("}");
+    }
+
+    auto& metric{m_metrics[key]};
+    ++metric.writes;
+    metric.sum += value;
+  }
+  return 0;
+}
+
+void host::random_bytes(size_t len, void* bytes) noexcept {
+  auto* out{static_cast<unsigned char*>(bytes)};
+  for (size_t i = 0; i < len; i += sizeof(uint64_t)) {
+    const uint64_t value{m_random_engine()};
+    std::memcpy(out + i, std::addressof(value), std::min(sizeof(uint64_t), len - i));
+  }
+}
+
+void host::exit(int32_t exit_code) noexcept {
+  if (!m_is_polling) {
+    std::fprintf(stderr, "component exited with code %d outside of k2_poll\n", exit_code);
+    std::exit(exit_code == 0 ? EXIT_FAILURE : exit_code);
+  }
+  // k2-node drops the instance at once, so it's fine to skip the destructors of the component frames
+  m_exit_code = exit_code;
+  std::longjmp(m_exit_point, 1);
+}
+
+} // namespace kphp::k2_host
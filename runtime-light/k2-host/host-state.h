@@ -0,0 +1,250 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <csetjmp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#define K2_API_HEADER_H
+#include "runtime-light/k2-platform/k2-header.h"
+#undef K2_API_HEADER_H
+
+#include "common/mixin/not_copyable.h"
+
+// A single-process implementation of the K2 platform ABI: the host loads a component image with dlopen
+// and drives its image, component and instances the way k2-node does, but all the I/O stays in memory.
+// Incoming requests are streams prefilled by the host, outgoing streams and RPC queries are answered
+// by loopback responders, and timers are served by a fake clock that skips the time the component is blocked.
+namespace kphp::k2_host {
+
+enum class scope : uint8_t { image, component, instance };
+
+struct allocator_stats {
+  uint64_t allocations{};
+  uint64_t reallocations{};
+  uint64_t deallocations{};
+  size_t memory_usage{};
+  size_t peak_memory_usage{};
+};
+
+struct config {
+  std::vector<std::pair<std::string, std::string>> args;
+  std::vector<std::pair<std::string, std::string>> env;
+  // responses of loopback responders by component or actor name, streams and queries to other names are echoed
+  std::unordered_map<std::string, std::string> loopback_responses;
+  uint64_t loopback_latency_ns{};
+  size_t log_level{2};
+  uint64_t seed{};
+};
+
+// Aggregated values of the metrics sent by the component via k2_write_metrics, keyed by a name with tags
+struct metric_value {
+  uint64_t writes{};
+  double sum{};
+};
+
+struct request_result {
+  bool ok{};
+  bool instance_finished{};
+  uint64_t latency_ns{};
+  std::string response;
+  // the stats of the instance that handled the request, they are cumulative for multishot images
+  allocator_stats instance_allocator_stats;
+};
+
+// One direction of a stream
+struct stream_buffer {
+  std::string data;
+  size_t read_offset{};
+  bool write_closed{};
+
+  size_t available() const noexcept {
+    return data.size() - read_offset;
+  }
+};
+
+// A stream between the component and its peer: the host itself for incoming requests, or a loopback responder
+// for the streams opened by the component
+struct channel {
+  stream_buffer inbound;
+  stream_buffer outbound;
+  bool please_shutdown_write{};
+  std::optional<std::string> responder;
+};
+
+struct stream_descriptor {
+  std::shared_ptr<channel> stream;
+};
+
+struct timer_descriptor {
+  uint64_t deadline_ns{};
+};
+
+struct rpc_descriptor {
+  std::optional<std::string> response;
+};
+
+struct file_descriptor {
+  FILE* file{};
+};
+
+struct mmap_descriptor {
+  void* addr{};
+  size_t length{};
+};
+
+using descriptor = std::variant<stream_descriptor, timer_descriptor, rpc_descriptor, file_descriptor, mmap_descriptor>;
+
+class host final : vk::not_copyable {
+public:
+  static host& get() noexcept;
+
+  void set_config(config cfg) noexcept {
+    m_config = std::move(cfg);
+    m_random_engine.seed(m_config.seed);
+  }
+  const config& get_config() const noexcept {
+    return m_config;
+  }
+
+  // === driver interface =========================================================================
+
+  bool load_image(const char* path) noexcept;
+  const ImageInfo* describe() const noexcept;
+  bool warmup() noexcept;
+  request_result run_request(std::string_view request) noexcept;
+
+  const allocator_stats& get_allocator_stats(scope s) const noexcept {
+    return m_allocator_stats[static_cast<size_t>(s)];
+  }
+  const std::map<std::string, metric_value>& get_metrics() const noexcept {
+    return m_metrics;
+  }
+  uint64_t get_instances_created() const noexcept {
+    return m_instances_created;
+  }
+
+  // === platform interface =======================================================================
+
+  ControlFlags* control_flags() noexcept {
+    return std::addressof(m_control_flags);
+  }
+  ImageState* image_state() const noexcept {
+    return m_image_state;
+  }
+  ComponentState* component_state() const noexcept {
+    return m_component_state;
+  }
+  InstanceState* instance_state() const noexcept {
+    return m_instance_state;
+  }
+
+  void* alloc(size_t size, size_t align) noexcept;
+  void* realloc(void* ptr, size_t new_size) noexcept;
+  void* realloc_checked(void* ptr, size_t old_size, size_t align, size_t new_size) noexcept;
+  void free(void* ptr) noexcept;
+
+  int32_t open_stream(uint64_t* stream_d, std::string_view name) noexcept;
+  int32_t open_file(uint64_t* fd, std::string_view path, std::string_view mode) noexcept;
+  void stream_status(uint64_t d, StreamStatus* status) noexcept;
+  size_t write(uint64_t d, size_t len, const void* data) noexcept;
+  size_t read(uint64_t d, size_t len, void* buf) noexcept;
+  size_t pread(uint64_t d, size_t len, void* buf, uint64_t offset) noexcept;
+  size_t readline(uint64_t d, size_t len, void* buf) noexcept;
+  int32_t fstat(uint64_t d, struct stat* statbuf) noexcept;
+  void* mmap(uint64_t* md, size_t len, int32_t prot, int32_t flags, uint64_t fd, uint64_t offset) noexcept;
+  void shutdown_write(uint64_t d) noexcept;
+  void please_shutdown(uint64_t d) noexcept;
+  void free_descriptor(uint64_t d) noexcept;
+  UpdateStatus take_update(uint64_t* d) noexcept;
+
+  int32_t new_timer(uint64_t* d, uint64_t duration_ns) noexcept;
+  int32_t timer_deadline(uint64_t d, TimePoint* deadline) noexcept;
+  uint64_t instant_ns() const noexcept;
+  uint64_t system_time_ns() const noexcept;
+
+  int32_t rpc_send_request(std::string_view actor, std::string_view request, uint64_t* rpc_d) noexcept;
+  int32_t rpc_get_response_size(uint64_t rpc_d, size_t* size) noexcept;
+  int32_t rpc_fetch_response(uint64_t rpc_d, void* buf, size_t buf_size) noexcept;
+
+  int32_t alloc_shared_memory(size_t size, size_t align, void** pointer) noexcept;
+  int32_t publish_shared_memory(std::string_view name, const void* memory, bool ignore_if_exist) noexcept;
+  int32_t get_shared_memory(std::string_view name, const void** pointer, size_t* size) noexcept;
+
+  int32_t write_metrics(const void* buf, size_t buf_len) noexcept;
+  void random_bytes(size_t len, void* bytes) noexcept;
+  [[noreturn]] void exit(int32_t exit_code) noexcept;
+
+private:
+  host() = default;
+
+  template<typename T>
+  T* get_descriptor(uint64_t d) noexcept;
+  uint64_t add_descriptor(descriptor desc) noexcept;
+  void push_update(uint64_t d, UpdateStatus status) noexcept;
+  void schedule(uint64_t delay_ns, std::function<void()> event) noexcept;
+  bool advance_clock() noexcept;
+  void respond(std::shared_ptr<channel> stream, uint64_t d) noexcept;
+  void track_allocation(void* ptr, scope s) noexcept;
+  scope untrack_allocation(void* ptr) noexcept;
+
+  void create_instance() noexcept;
+  void destroy_instance() noexcept;
+  PollStatus poll(PollStatus (*poll_fn)()) noexcept;
+
+  config m_config;
+  ControlFlags m_control_flags{};
+  std::mt19937_64 m_random_engine;
+
+  // component entry points
+  PollStatus (*m_k2_poll)(){};
+  PollStatus (*m_k2_warmup)(){};
+  InstanceState* (*m_k2_create_instance)(){};
+  void (*m_k2_init_instance)(){};
+  const ImageInfo* (*m_k2_describe)(){};
+
+  ImageState* m_image_state{};
+  ComponentState* m_component_state{};
+  InstanceState* m_instance_state{};
+  uint64_t m_instances_created{};
+
+  scope m_scope{scope::image};
+  std::unordered_map<void*, scope> m_allocations;
+  std::array<allocator_stats, 3> m_allocator_stats{};
+
+  std::unordered_map<std::string, std::pair<const void*, size_t>> m_shared_memory;
+  std::unordered_map<const void*, size_t> m_shared_memory_sizes;
+
+  // descriptors are never reused, so the events of a freed descriptor may safely look it up
+  uint64_t m_next_descriptor{1};
+  std::unordered_map<uint64_t, descriptor> m_descriptors;
+  std::deque<std::pair<uint64_t, UpdateStatus>> m_updates;
+  std::multimap<uint64_t, std::function<void()>> m_events;
+  // the fake clock is the real monotonic clock plus the time skipped while the component was waiting for events
+  uint64_t m_skipped_ns{};
+
+  std::map<std::string, metric_value> m_metrics;
+
+  bool m_is_polling{};
+  std::jmp_buf m_exit_point{};
+  int32_t m_exit_code{};
+};
+
+} // namespace kphp::k2_host
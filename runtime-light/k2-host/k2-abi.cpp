@@ -0,0 +1,435 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+// The platform side of the K2 ABI, images resolve these symbols against the host executable at dlopen.
+// The functions without an in-memory counterpart (sockets, directories, commands) report ENOSYS.
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <iconv.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "runtime-light/k2-host/host-state.h"
+
+#define VISIBILITY_DEFAULT __attribute__((visibility("default")))
+
+using kphp::k2_host::host;
+
+namespace {
+
+constexpr std::string_view LOG_LEVEL_NAMES[]{"", "error", "warn", "info", "debug", "trace"};
+
+const std::pair<std::string, std::string>& get_arg(uint32_t arg_num) noexcept {
+  return host::get().get_config().args[arg_num];
+}
+
+const std::pair<std::string, std::string>& get_env(uint32_t env_num) noexcept {
+  return host::get().get_config().env[env_num];
+}
+
+} // namespace
+
+extern "C" {
+
+// === state ======================================================================================
+
+VISIBILITY_DEFAULT ControlFlags* k2_control_flags() {
+  return host::get().control_flags();
+}
+
+VISIBILITY_DEFAULT ImageState* k2_image_state() {
+  return host::get().image_state();
+}
+
+VISIBILITY_DEFAULT ComponentState* k2_component_state() {
+  return host::get().component_state();
+}
+
+VISIBILITY_DEFAULT InstanceState* k2_instance_state() {
+  return host::get().instance_state();
+}
+
+VISIBILITY_DEFAULT void k2_exit(int32_t exit_code) {
+  host::get().exit(exit_code);
+}
+
+// === memory =====================================================================================
+
+VISIBILITY_DEFAULT void* k2_alloc(size_t size, size_t align) {
+  return host::get().alloc(size, align);
+}
+
+VISIBILITY_DEFAULT void* k2_realloc(void* ptr, size_t new_size) {
+  return host::get().realloc(ptr, new_size);
+}
+
+VISIBILITY_DEFAULT void* k2_realloc_checked(void* ptr, size_t old_size, size_t align, size_t new_size) {
+  return host::get().realloc_checked(ptr, old_size, align, new_size);
+}
+
+VISIBILITY_DEFAULT void k2_free(void* ptr) {
+  host::get().free(ptr);
+}
+
+VISIBILITY_DEFAULT void k2_free_checked(void* ptr, size_t /*size*/, size_t /*align*/) {
+  host::get().free(ptr);
+}
+
+VISIBILITY_DEFAULT int32_t k2_alloc_shared_memory(size_t size, size_t align, void** pointer) {
+  return host::get().alloc_shared_memory(size, align, pointer);
+}
+
+VISIBILITY_DEFAULT int32_t k2_publish_shared_memory(const char* name, size_t name_len, const void* memory, uint64_t /*ttl*/, bool /*as_mut*/,
+                                                    bool ignore_if_exist) {
+  return name == nullptr ? EINVAL : host::get().publish_shared_memory({name, name_len}, memory, ignore_if_exist);
+}
+
+VISIBILITY_DEFAULT int32_t k2_get_shared_memory(const char* name, size_t name_len, const void** pointer, size_t* size) {
+  return name == nullptr ? EINVAL : host::get().get_shared_memory({name, name_len}, pointer, size);
+}
+
+VISIBILITY_DEFAULT void* k2_mmap(uint64_t* md, void* /*addr*/, size_t len, int32_t prot, int32_t flags, uint64_t fd, uint64_t offset) {
+  return host::get().mmap(md, len, prot, flags, fd, offset);
+}
+
+VISIBILITY_DEFAULT int32_t k2_madvise(void* addr, size_t length, int32_t advise) {
+  return ::madvise(addr, length, advise) == 0 ? 0 : errno;
+}
+
+// === streams and descriptors ====================================================================
+
+VISIBILITY_DEFAULT int32_t k2_open(uint64_t* stream_d, size_t name_len, const char* name) {
+  return host::get().open_stream(stream_d, {name, name_len});
+}
+
+VISIBILITY_DEFAULT int32_t k2_component_access(size_t name_len, const char* /*name*/) {
+  return name_len == 0 ? EINVAL : 0;
+}
+
+VISIBILITY_DEFAULT void k2_stream_status(uint64_t stream_d, StreamStatus* status) {
+  host::get().stream_status(stream_d, status);
+}
+
+VISIBILITY_DEFAULT size_t k2_write(uint64_t stream_d, size_t data_len, const void* data) {
+  return host::get().write(stream_d, data_len, data);
+}
+
+VISIBILITY_DEFAULT size_t k2_read(uint64_t stream_d, size_t buf_len, void* buf) {
+  return host::get().read(stream_d, buf_len, buf);
+}
+
+VISIBILITY_DEFAULT size_t k2_pread(uint64_t stream_d, size_t buf_len, void* buf, uint64_t offset) {
+  return host::get().pread(stream_d, buf_len, buf, offset);
+}
+
+VISIBILITY_DEFAULT size_t k2_readline(uint64_t stream_d, size_t buf_len, void* buf) {
+  return host::get().readline(stream_d, buf_len, buf);
+}
+
+VISIBILITY_DEFAULT void k2_please_shutdown(uint64_t stream_d) {
+  host::get().please_shutdown(stream_d);
+}
+
+VISIBILITY_DEFAULT void k2_shutdown_write(uint64_t stream_d) {
+  host::get().shutdown_write(stream_d);
+}
+
+VISIBILITY_DEFAULT void k2_free_descriptor(uint64_t descriptor) {
+  host::get().free_descriptor(descriptor);
+}
+
+VISIBILITY_DEFAULT UpdateStatus k2_take_update(uint64_t* update_d) {
+  return host::get().take_update(update_d);
+}
+
+VISIBILITY_DEFAULT int32_t k2_rpc_send_request(const char* actor_name, size_t actor_name_len, const void* request_ptr, size_t request_size,
+                                               RpcKind /*rpc_kind*/, uint64_t* rpc_d) {
+  return host::get().rpc_send_request({actor_name, actor_name_len}, {static_cast<const char*>(request_ptr), request_size}, rpc_d);
+}
+
+VISIBILITY_DEFAULT int32_t k2_rpc_get_response_size(uint64_t rpc_d, size_t* response_size) {
+  return host::get().rpc_get_response_size(rpc_d, response_size);
+}
+
+VISIBILITY_DEFAULT int32_t k2_rpc_fetch_response(uint64_t rpc_d, void* buf, size_t buf_size) {
+  return host::get().rpc_fetch_response(rpc_d, buf, buf_size);
+}
+
+// === time =======================================================================================
+
+VISIBILITY_DEFAULT void k2_instant(TimePoint* time_point) {
+  time_point->time_point_ns = host::get().instant_ns();
+}
+
+VISIBILITY_DEFAULT void k2_system_time(SystemTime* system_time) {
+  system_time->since_epoch_ns = host::get().system_time_ns();
+}
+
+VISIBILITY_DEFAULT int32_t k2_new_timer(uint64_t* descriptor, uint64_t duration_ns) {
+  return host::get().new_timer(descriptor, duration_ns);
+}
+
+VISIBILITY_DEFAULT int32_t k2_timer_deadline(uint64_t d, TimePoint* deadline) {
+  return host::get().timer_deadline(d, deadline);
+}
+
+VISIBILITY_DEFAULT int32_t k2_set_timezone(const char* timezone) {
+  if (timezone == nullptr || ::setenv("TZ", timezone, 1) != 0) {
+    return EINVAL;
+  }
+  ::tzset();
+  return 0;
+}
+
+VISIBILITY_DEFAULT tm* k2_localtime_r(const time_t* timer, tm* result) {
+  return ::localtime_r(timer, result);
+}
+
+// === diagnostics ================================================================================
+
+VISIBILITY_DEFAULT void k2_log(size_t level, size_t len, const char* msg, size_t kv_count, const LogKeyValuePair* kv_pairs) {
+  if (level == 0 || level >= std::size(LOG_LEVEL_NAMES) || level > host::get().get_config().log_level) {
+    return;
+  }
+  std::string line{"["};
+  line.append(LOG_LEVEL_NAMES[level]).append("] ").append(msg, len);
+  for (size_t i = 0; i < kv_count; ++i) {
+    line.append(" ").append(kv_pairs[i].key, kv_pairs[i].key_len).append("=").append(kv_pairs[i].value, kv_pairs[i].value_len);
+  }
+  line.append("\n");
+  std::fwrite(line.data(), 1, line.size(), stderr);
+}
+
+VISIBILITY_DEFAULT size_t k2_log_level_enabled() {
+  return host::get().get_config().log_level;
+}
+
+VISIBILITY_DEFAULT int32_t k2_write_metrics(const void* buf, size_t buf_len) {
+  return host::get().write_metrics(buf, buf_len);
+}
+
+VISIBILITY_DEFAULT size_t k2_stderr_write(size_t data_len, const void* data) {
+  return std::fwrite(data, 1, data_len, stderr) == data_len ? data_len : 0;
+}
+
+VISIBILITY_DEFAULT size_t k2_backtrace(void** buffer, size_t size) {
+  return static_cast<size_t>(std::max(::backtrace(buffer, static_cast<int>(std::min<size_t>(size, INT_MAX))), 0));
+}
+
+VISIBILITY_DEFAULT int32_t k2_code_segment_offset(uint64_t* /*offset*/) {
+  return ENODATA;
+}
+
+VISIBILITY_DEFAULT int32_t k2_symbol_name_len(void* /*addr*/, size_t* /*name_len*/) {
+  return ENODATA;
+}
+
+VISIBILITY_DEFAULT int32_t k2_symbol_filename_len(void* /*addr*/, size_t* /*filename_len*/) {
+  return ENODATA;
+}
+
+VISIBILITY_DEFAULT int32_t k2_resolve_symbol(void* /*addr*/, SymbolInfo* /*symbol_info*/) {
+  return ENODATA;
+}
+
+// === environment ================================================================================
+
+VISIBILITY_DEFAULT uint32_t k2_args_count() {
+  return static_cast<uint32_t>(host::get().get_config().args.size());
+}
+
+VISIBILITY_DEFAULT uint32_t k2_args_key_len(uint32_t arg_num) {
+  return static_cast<uint32_t>(get_arg(arg_num).first.size());
+}
+
+VISIBILITY_DEFAULT uint32_t k2_args_value_len(uint32_t arg_num) {
+  return static_cast<uint32_t>(get_arg(arg_num).second.size());
+}
+
+VISIBILITY_DEFAULT void k2_args_fetch(uint32_t arg_num, char* key, char* value) {
+  const auto& [arg_key, arg_value]{get_arg(arg_num)};
+  std::memcpy(key, arg_key.data(), arg_key.size());
+  std::memcpy(value, arg_value.data(), arg_value.size());
+}
+
+VISIBILITY_DEFAULT uint32_t k2_env_count() {
+  return static_cast<uint32_t>(host::get().get_config().env.size());
+}
+
+VISIBILITY_DEFAULT uint32_t k2_env_key_len(uint32_t env_num) {
+  return static_cast<uint32_t>(get_env(env_num).first.size());
+}
+
+VISIBILITY_DEFAULT uint32_t k2_env_value_len(uint32_t env_num) {
+  return static_cast<uint32_t>(get_env(env_num).second.size());
+}
+
+VISIBILITY_DEFAULT void k2_env_fetch(uint32_t env_num, char* key, char* value) {
+  const auto& [env_key, env_value]{get_env(env_num)};
+  std::memcpy(key, env_key.data(), env_key.size());
+  std::memcpy(value, env_value.data(), env_value.size());
+}
+
+VISIBILITY_DEFAULT void k2_os_rnd(size_t len, void* bytes) {
+  host::get().random_bytes(len, bytes);
+}
+
+// === libc analogues =============================================================================
+
+VISIBILITY_DEFAULT int64_t k2_sysconf(int32_t name) {
+  return ::sysconf(name);
+}
+
+VISIBILITY_DEFAULT uint32_t k2_getpid() {
+  return static_cast<uint32_t>(::getpid());
+}
+
+VISIBILITY_DEFAULT uid_t k2_getuid() {
+  return ::getuid();
+}
+
+VISIBILITY_DEFAULT int32_t k2_getpwuid_r(uid_t uid, passwd* pwd, char* buf, size_t buflen, passwd** result) {
+  return ::getpwuid_r(uid, pwd, buf, buflen, result);
+}
+
+VISIBILITY_DEFAULT int32_t k2_uname(utsname* buf) {
+  return ::uname(buf) == 0 ? 0 : errno;
+}
+
+VISIBILITY_DEFAULT int32_t k2_uselocale(int32_t category, const char* locale) {
+  return std::setlocale(category, locale) != nullptr ? 0 : EINVAL;
+}
+
+VISIBILITY_DEFAULT char* k2_current_locale_name(int32_t category) {
+  static char empty_name[]{""};
+  char* name{std::setlocale(category, nullptr)};
+  return name != nullptr ? name : empty_name;
+}
+
+VISIBILITY_DEFAULT int32_t k2_iconv_open(void** iconv_cd, const char* tocode, const char* fromcode) {
+  iconv_t cd{::iconv_open(tocode, fromcode)};
+  if (cd == reinterpret_cast<iconv_t>(-1)) {
+    *iconv_cd = nullptr;
+    return errno;
+  }
+  *iconv_cd = cd;
+  return 0;
+}
+
+VISIBILITY_DEFAULT void k2_iconv_close(void* iconv_cd) {
+  ::iconv_close(static_cast<iconv_t>(iconv_cd));
+}
+
+VISIBILITY_DEFAULT int32_t k2_iconv(size_t* result, void* iconv_cd, char** inbuf, size_t* inbytesleft, char** outbuf, size_t* outbytesleft) {
+  *result = ::iconv(static_cast<iconv_t>(iconv_cd), inbuf, inbytesleft, outbuf, outbytesleft);
+  return *result == static_cast<size_t>(-1) ? errno : 0;
+}
+
+// === file system ================================================================================
+
+VISIBILITY_DEFAULT int32_t k2_fopen(uint64_t* fd, const char* pathname, size_t pathname_len, const char* mode, size_t mode_len) {
+  return host::get().open_file(fd, {pathname, pathname_len}, {mode, mode_len});
+}
+
+VISIBILITY_DEFAULT int32_t k2_fstat(uint64_t fd, struct stat* statbuf) {
+  return host::get().fstat(fd, statbuf);
+}
+
+VISIBILITY_DEFAULT int32_t k2_stat(const char* pathname, size_t pathname_len, struct stat* statbuf) {
+  if (pathname == nullptr || statbuf == nullptr) {
+    return EINVAL;
+  }
+  return ::stat(std::string{pathname, pathname_len}.c_str(), statbuf) == 0 ? 0 : errno;
+}
+
+VISIBILITY_DEFAULT int32_t k2_lstat(const char* pathname, size_t pathname_len, struct stat* statbuf) {
+  if (pathname == nullptr || statbuf == nullptr) {
+    return EINVAL;
+  }
+  return ::lstat(std::string{pathname, pathname_len}.c_str(), statbuf) == 0 ? 0 : errno;
+}
+
+VISIBILITY_DEFAULT int32_t k2_access(const char* pathname, size_t pathname_len, int32_t mode) {
+  return ::access(std::string{pathname, pathname_len}.c_str(), mode) == 0 ? 0 : errno;
+}
+
+VISIBILITY_DEFAULT int32_t k2_unlink(const char* path, size_t path_len) {
+  return ::unlink(std::string{path, path_len}.c_str()) == 0 ? 0 : errno;
+}
+
+VISIBILITY_DEFAULT int32_t k2_canonicalize(const char* path, size_t pathlen, char* const* resolved_path, size_t* resolved_pathlen,
+                                           size_t* resolved_path_align) {
+  if (path == nullptr || resolved_path == nullptr || resolved_pathlen == nullptr || resolved_path_align == nullptr) {
+    return EINVAL;
+  }
+  char* real_path{::realpath(std::string{path, pathlen}.c_str(), nullptr)};
+  if (real_path == nullptr) {
+    return errno;
+  }
+  const size_t real_path_len{std::strlen(real_path)};
+  auto* buffer{static_cast<char*>(host::get().alloc(real_path_len, alignof(char)))};
+  if (buffer != nullptr) {
+    std::memcpy(buffer, real_path, real_path_len);
+  }
+  std::free(real_path);
+  if (buffer == nullptr) {
+    return ENOMEM;
+  }
+  *const_cast<char**>(resolved_path) = buffer;
+  *resolved_pathlen = real_path_len;
+  *resolved_path_align = alignof(char);
+  return 0;
+}
+
+VISIBILITY_DEFAULT int32_t k2_opendir(uint64_t* dd, const char* /*path*/, size_t /*path_len*/) {
+  *dd = 0;
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_readdir(uint64_t /*dd*/, DirEntry* /*entry*/, DirEntry** /*result*/) {
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_command(const char* /*cmd*/, size_t /*cmd_len*/, const CommandArg* /*args*/, size_t /*args_len*/, int32_t* /*exit_code*/,
+                                      char* const* /*output*/, size_t* /*output_len*/, size_t* /*output_align*/) {
+  return ENOSYS;
+}
+
+// === network ====================================================================================
+
+VISIBILITY_DEFAULT int32_t k2_socket(uint64_t* socket_d, int32_t /*domain*/, int32_t /*type*/, int32_t /*protocol*/) {
+  *socket_d = 0;
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_connect(uint64_t /*socket_d*/, const sockaddr_storage* /*addr*/, size_t /*addrlen*/) {
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_udp_connect(uint64_t* socket_d, const char* /*hostport*/, size_t /*hostport_len*/) {
+  *socket_d = 0;
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_tcp_connect(uint64_t* socket_d, const char* /*hostport*/, size_t /*hostport_len*/) {
+  *socket_d = 0;
+  return ENOSYS;
+}
+
+VISIBILITY_DEFAULT int32_t k2_lookup_host(const char* /*hostport*/, size_t /*hostport_len*/, SockAddr* /*result_buf*/, size_t* /*result_buf_len*/) {
+  return ENOSYS;
+}
+
+} // extern "C"
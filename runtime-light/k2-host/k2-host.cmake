@@ -0,0 +1,15 @@
+# k2-host: a local simulator of the K2 platform that loads a component image
+# and drives it with requests from files, used to benchmark components without k2-node
+set(K2_HOST_SRC
+    ${RUNTIME_LIGHT_DIR}/k2-host/host-state.cpp
+    ${RUNTIME_LIGHT_DIR}/k2-host/k2-abi.cpp
+    ${RUNTIME_LIGHT_DIR}/k2-host/k2-host.cpp
+    ${RUNTIME_LIGHT_DIR}/k2-host/k2-requests.cpp)
+
+add_executable(k2-host ${K2_HOST_SRC})
+# the image resolves the k2_* platform functions from the host executable
+set_target_properties(k2-host PROPERTIES ENABLE_EXPORTS ON RUNTIME_OUTPUT_DIRECTORY ${BIN_DIR})
+# the requests and the metrics are (de)serialized with the runtime-light TL definitions, they need the same standard library
+target_compile_options(k2-host PRIVATE -stdlib=libc++)
+target_link_options(k2-host PRIVATE -stdlib=libc++)
+target_link_libraries(k2-host PRIVATE ${CMAKE_DL_LIBS})
@@ -0,0 +1,259 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+// k2-host runs a component image in a single process and reports its performance, e.g.
+//   k2-host --requests 10000 --rpc --request-file query.bin --loopback memcache=response.bin component.so
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <getopt.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime-light/k2-host/host-state.h"
+#include "runtime-light/k2-host/k2-requests.h"
+
+namespace {
+
+using kphp::k2_host::host;
+using kphp::k2_host::make_http_request;
+using kphp::k2_host::make_rpc_request;
+using kphp::k2_host::scope;
+
+std::optional<std::string> read_file(const char* path) noexcept {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    std::fprintf(stderr, "can't read %s\n", path);
+    return std::nullopt;
+  }
+  return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+std::optional<std::pair<std::string, std::string>> split_key_value(const char* arg) noexcept {
+  const std::string_view arg_view{arg};
+  const auto pos{arg_view.find('=')};
+  if (pos == std::string_view::npos || pos == 0) {
+    std::fprintf(stderr, "expected key=value, got %s\n", arg);
+    return std::nullopt;
+  }
+  return std::pair{std::string{arg_view.substr(0, pos)}, std::string{arg_view.substr(pos + 1)}};
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted_values, double p) noexcept {
+  if (sorted_values.empty()) {
+    return 0;
+  }
+  return sorted_values[std::min(sorted_values.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted_values.size())))];
+}
+
+void print_usage(const char* program) noexcept {
+  std::fprintf(stderr,
+               "Usage: %s [options] <image.so>\n"
+               "  -n, --requests <N>            number of measured requests, 1000 by default\n"
+               "  -w, --warmup <N>              number of requests before the measurement, 10 by default\n"
+               "  -f, --request-file <path>     request payload, may be repeated to send the payloads in turn\n"
+               "      --rpc                     wrap payloads into K2 RPC invoke requests\n"
+               "      --http-uri <uri>          wrap payloads into K2 HTTP invoke requests for the uri, payload is the body\n"
+               "  -a, --arg <key=value>         component argument\n"
+               "  -e, --env <key=value>         component environment variable\n"
+               "  -l, --loopback <name=path>    response of streams and RPC queries to the component or actor, echo by default\n"
+               "      --loopback-latency-us <N> fake clock latency of loopback responses\n"
+               "      --log-level <N>           1 error, 2 warn (default), 3 info, 4 debug, 5 trace\n"
+               "      --seed <N>                seed of k2_os_rnd\n"
+               "      --print-response          print the last response to stdout\n"
+               "      --metrics                 print the metrics sent by the component\n",
+               program);
+}
+
+enum option_id : int {
+  RPC = 256,
+  HTTP_URI,
+  LOOPBACK_LATENCY_US,
+  LOG_LEVEL,
+  SEED,
+  PRINT_RESPONSE,
+  METRICS,
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  static const option long_options[]{
+      {"requests", required_argument, nullptr, 'n'},
+      {"warmup", required_argument, nullptr, 'w'},
+      {"request-file", required_argument, nullptr, 'f'},
+      {"rpc", no_argument, nullptr, option_id::RPC},
+      {"http-uri", required_argument, nullptr, option_id::HTTP_URI},
+      {"arg", required_argument, nullptr, 'a'},
+      {"env", required_argument, nullptr, 'e'},
+      {"loopback", required_argument, nullptr, 'l'},
+      {"loopback-latency-us", required_argument, nullptr, option_id::LOOPBACK_LATENCY_US},
+      {"log-level", required_argument, nullptr, option_id::LOG_LEVEL},
+      {"seed", required_argument, nullptr, option_id::SEED},
+      {"print-response", no_argument, nullptr, option_id::PRINT_RESPONSE},
+      {"metrics", no_argument, nullptr, option_id::METRICS},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0},
+  };
+
+  kphp::k2_host::config config;
+  uint64_t requests_count{1000};
+  uint64_t warmup_count{10};
+  std::vector<std::string> payloads;
+  bool wrap_rpc{false};
+  std::optional<std::string> http_uri;
+  bool print_response{false};
+  bool print_metrics{false};
+
+  for (int opt{}; (opt = getopt_long(argc, argv, "n:w:f:a:e:l:h", long_options, nullptr)) != -1;) {
+    switch (opt) {
+    case 'n':
+      requests_count = std::strtoull(optarg, nullptr, 10);
+      break;
+    case 'w':
+      warmup_count = std::strtoull(optarg, nullptr, 10);
+      break;
+    case 'f': {
+      auto payload{read_file(optarg)};
+      if (!payload) {
+        return EXIT_FAILURE;
+      }
+      payloads.push_back(std::move(*payload));
+      break;
+    }
+    case option_id::RPC:
+      wrap_rpc = true;
+      break;
+    case option_id::HTTP_URI:
+      http_uri.emplace(optarg);
+      break;
+    case 'a':
+    case 'e':
+    case 'l': {
+      auto key_value{split_key_value(optarg)};
+      if (!key_value) {
+        return EXIT_FAILURE;
+      }
+      if (opt == 'a') {
+        config.args.push_back(std::move(*key_value));
+      } else if (opt == 'e') {
+        config.env.push_back(std::move(*key_value));
+      } else {
+        auto response{read_file(key_value->second.c_str())};
+        if (!response) {
+          return EXIT_FAILURE;
+        }
+        config.loopback_responses.insert_or_assign(std::move(key_value->first), std::move(*response));
+      }
+      break;
+    }
+    case option_id::LOOPBACK_LATENCY_US:
+      config.loopback_latency_ns = std::strtoull(optarg, nullptr, 10) * 1000;
+      break;
+    case option_id::LOG_LEVEL:
+      config.log_level = std::strtoull(optarg, nullptr, 10);
+      break;
+    case option_id::SEED:
+      config.seed = std::strtoull(optarg, nullptr, 10);
+      break;
+    case option_id::PRINT_RESPONSE:
+      print_response = true;
+      break;
+    case option_id::METRICS:
+      print_metrics = true;
+      break;
+    default:
+      print_usage(argv[0]);
+      return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (optind + 1 != argc || (wrap_rpc && http_uri.has_value())) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (payloads.empty()) {
+    payloads.emplace_back();
+  }
+
+  auto& k2_host{host::get()};
+  k2_host.set_config(std::move(config));
+  if (!k2_host.load_image(argv[optind])) {
+    return EXIT_FAILURE;
+  }
+  const auto* image_info{k2_host.describe()};
+  if (!k2_host.warmup()) {
+    std::fprintf(stderr, "image warmup failed\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<uint64_t> latencies;
+  std::vector<uint64_t> peak_memory_usages;
+  latencies.reserve(requests_count);
+  peak_memory_usages.reserve(requests_count);
+  uint64_t errors{};
+  uint64_t instance_allocations{};
+  std::string last_response;
+  std::chrono::steady_clock::time_point start{};
+  for (uint64_t i = 0; i < warmup_count + requests_count; ++i) {
+    if (i == warmup_count) {
+      start = std::chrono::steady_clock::now();
+    }
+    const auto& payload{payloads[i % payloads.size()]};
+    std::string request{payload};
+    if (wrap_rpc) {
+      request = make_rpc_request(payload, static_cast<int64_t>(i + 1));
+    } else if (http_uri.has_value()) {
+      request = make_http_request(*http_uri, payload);
+    }
+
+    // multishot instances accumulate the stats of all the requests they handled
+    const auto allocations_before{k2_host.get_allocator_stats(scope::instance).allocations};
+    auto result{k2_host.run_request(request)};
+    if (i < warmup_count) {
+      continue;
+    }
+    errors += result.ok ? 0 : 1;
+    latencies.push_back(result.latency_ns);
+    peak_memory_usages.push_back(result.instance_allocator_stats.peak_memory_usage);
+    instance_allocations += result.instance_allocator_stats.allocations - allocations_before;
+    last_response = std::move(result.response);
+  }
+  const auto elapsed_ns{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()};
+
+  if (print_response) {
+    std::fwrite(last_response.data(), 1, last_response.size(), stdout);
+    std::fflush(stdout);
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  std::sort(peak_memory_usages.begin(), peak_memory_usages.end());
+  const double us{1000.0};
+  std::fprintf(stderr, "image: %s (%s)\n", image_info->image_name, image_info->is_oneshot ? "oneshot" : "multishot");
+  std::fprintf(stderr, "requests: %" PRIu64 ", errors: %" PRIu64 ", instances created: %" PRIu64 "\n", requests_count, errors, k2_host.get_instances_created());
+  if (requests_count != 0) {
+    std::fprintf(stderr, "throughput: %.1f requests/s\n", static_cast<double>(requests_count) * 1e9 / static_cast<double>(std::max<int64_t>(elapsed_ns, 1)));
+    std::fprintf(stderr, "latency, us: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n", static_cast<double>(percentile(latencies, 0.5)) / us,
+                 static_cast<double>(percentile(latencies, 0.9)) / us, static_cast<double>(percentile(latencies, 0.99)) / us,
+                 static_cast<double>(latencies.back()) / us);
+    std::fprintf(stderr, "instance memory, KiB: peak p50 %zu, max %zu; k2_alloc calls per request: %.1f\n",
+                 static_cast<size_t>(percentile(peak_memory_usages, 0.5) / 1024), static_cast<size_t>(peak_memory_usages.back() / 1024), static_cast<double>(instance_allocations) / static_cast<double>(requests_count));
+  }
+  std::fprintf(stderr, "image memory, KiB: %zu; component memory, KiB: %zu\n", k2_host.get_allocator_stats(scope::image).memory_usage / 1024,
+               k2_host.get_allocator_stats(scope::component).memory_usage / 1024);
+  if (print_metrics) {
+    for (const auto& [name, value] : k2_host.get_metrics()) {
+      std::fprintf(stderr, "metric %s: writes %" PRIu64 ", sum %.3f\n", name.c_str(), value.writes, value.sum);
+    }
+  }
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
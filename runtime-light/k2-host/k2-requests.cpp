@@ -0,0 +1,89 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime-light/k2-host/k2-requests.h"
+
+#include <memory>
+#include <utility>
+
+#include "runtime-light/tl/tl-functions.h"
+#include "runtime-light/tl/tl-types.h"
+
+namespace kphp::k2_host {
+
+namespace {
+
+constexpr uint32_t LOCALHOST_IP = 0x7f00'0001;
+
+// tl::storer keeps the data in the script memory of an instance, while the host builds the requests outside of it
+class tl_storer {
+public:
+  template<typename T>
+  void store_trivial(T value) noexcept {
+    m_buffer.append(reinterpret_cast<const char*>(std::addressof(value)), sizeof(T));
+  }
+
+  void store_string(std::string_view str) noexcept {
+    size_t header_len{1};
+    if (str.size() < 0xfe) {
+      store_trivial<uint8_t>(str.size());
+    } else {
+      header_len = 4;
+      store_trivial<uint32_t>((str.size() << 8) | 0xfe);
+    }
+    m_buffer.append(str);
+    m_buffer.append(((header_len + str.size() + 3) & ~3UL) - (header_len + str.size()), '\0');
+  }
+
+  void store_bytes(std::string_view bytes) noexcept {
+    m_buffer.append(bytes);
+  }
+
+  std::string release() noexcept {
+    return std::move(m_buffer);
+  }
+
+private:
+  std::string m_buffer;
+};
+
+} // namespace
+
+std::string make_rpc_request(std::string_view query, int64_t query_id) noexcept {
+  tl_storer tls;
+  tls.store_trivial(tl::K2_INVOKE_RPC_MAGIC);
+  tls.store_trivial<uint32_t>(0); // fields mask
+  tls.store_trivial(query_id);
+  // net pid
+  tls.store_trivial(LOCALHOST_IP);
+  tls.store_trivial<uint32_t>(0); // port and pid
+  tls.store_trivial<uint32_t>(0); // utime
+  tls.store_bytes(query);
+  return tls.release();
+}
+
+std::string make_http_request(std::string_view uri, std::string_view body) noexcept {
+  const auto query_pos{uri.find('?')};
+  tl_storer tls;
+  tls.store_trivial(tl::K2_INVOKE_HTTP_MAGIC);
+  tls.store_trivial<uint32_t>(0); // flags
+  // connection
+  tls.store_string("127.0.0.1");
+  tls.store_trivial<int32_t>(80);
+  tls.store_string("127.0.0.1");
+  tls.store_trivial<int32_t>(0);
+  tls.store_trivial(std::to_underlying(tl::HttpVersion::Version::V11));
+  tls.store_string(body.empty() ? "GET" : "POST");
+  // uri
+  tls.store_trivial<uint32_t>(query_pos != std::string_view::npos ? tl::httpUri::QUERY_FLAG : 0);
+  tls.store_string(uri.substr(0, query_pos));
+  if (query_pos != std::string_view::npos) {
+    tls.store_string(uri.substr(query_pos + 1));
+  }
+  tls.store_trivial<uint32_t>(0); // headers
+  tls.store_bytes(body);
+  return tls.release();
+}
+
+} // namespace kphp::k2_host
@@ -0,0 +1,18 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace kphp::k2_host {
+
+// The K2 invoke requests delivered to a component, serialized the way runtime-light/tl fetches them
+std::string make_rpc_request(std::string_view query, int64_t query_id) noexcept;
+// the uri may contain a query after '?', an empty body makes a GET request
+std::string make_http_request(std::string_view uri, std::string_view body) noexcept;
+
+} // namespace kphp::k2_host
@@ -67,6 +67,7 @@ combine_static_runtime_library(kphp-light-runtime-pic k2kphp-rt)
 # =================================================================================================
 
 include(${RUNTIME_LIGHT_DIR}/components/confdata/confdata.cmake)
+include(${RUNTIME_LIGHT_DIR}/k2-host/k2-host.cmake)
 
 # =================================================================================================
 
@@ -76,6 +77,8 @@ file(
   CONFIGURE_DEPENDS "${RUNTIME_LIGHT_DIR}/*.h")
 # confdata component has its own state types and is not a part of the kphp runtime
 list(FILTER KPHP_RUNTIME_ALL_HEADERS EXCLUDE REGEX "^runtime-light/components/confdata/")
+# k2-host is a standalone executable implementing the platform side of the ABI
+list(FILTER KPHP_RUNTIME_ALL_HEADERS EXCLUDE REGEX "^runtime-light/k2-host/")
 file(
   GLOB_RECURSE KPHP_RUNTIME_COMMON_ALL_HEADERS
   RELATIVE ${BASE_DIR}
@@ -70,12 +70,12 @@ struct metricInc final {
 };
 
 class AnyMetricValue final {
+public:
   static constexpr uint32_t VALUE_MAGIC = 0xcb5eb87U;
   static constexpr uint32_t VALUES_ARRAY_MAGIC = 0xd4a59582U;
   static constexpr uint32_t COUNT_MAGIC = 0x941bf7d1U;
   static constexpr uint32_t INC_MAGIC = 0x23e305abU;
 
-public:
   std::variant<metricValue, metricValuesArray, metricCount, metricInc> value;
 
   void store(tl::storer& tls) const noexcept {
@@ -23,13 +23,13 @@ ResultType f$msgpack_deserialize(const string& buffer, string* out_err_msg = nul
   SerializationInstanceState::get().clear_msgpack_error();
   string err_msg;
   vk::msgpack::unpacker unpacker{buffer};
-  vk::msgpack::object obj{unpacker.unpack()};
+  unpacker.check_input();
 
   if (unpacker.has_error()) {
-    // parsing or allocation errors
+    // parsing errors
     err_msg = unpacker.get_error_msg();
   } else {
-    auto res = obj.as<ResultType>();
+    auto res{unpacker.unpack<ResultType>()};
     if (unpacker.has_error()) {
       // scheme compliance errors
       err_msg = unpacker.get_error_msg();
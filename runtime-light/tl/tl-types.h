@@ -989,11 +989,11 @@ public:
 };
 
 class httpUri final {
+public:
   static constexpr auto SCHEME_FLAG = static_cast<uint32_t>(1U << 0U);
   static constexpr auto HOST_FLAG = static_cast<uint32_t>(1U << 1U);
   static constexpr auto QUERY_FLAG = static_cast<uint32_t>(1U << 2U);
 
-public:
   std::optional<tl::string> opt_scheme;
   std::optional<tl::string> opt_host;
   tl::string path;
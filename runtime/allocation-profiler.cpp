@@ -0,0 +1,213 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/allocation-profiler.h"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "common/fast-backtrace.h"
+#include "common/kprintf.h"
+#include "common/wrappers/string_view.h"
+
+#include "runtime/kphp-backtrace.h"
+
+namespace allocation_profiler {
+
+namespace {
+
+// the sample buffer is allocated once, a request with more samples keeps only their total size
+constexpr size_t MAX_SAMPLES = 4096;
+constexpr size_t MAX_BACKTRACE_DEPTH = 48;
+// the profiles are dumped at most once a second per worker: the dump is made synchronously inside PhpScript::finish,
+// before the worker takes the next request, and it takes backtrace_symbols() with demangling of up to MAX_SAMPLES * MAX_BACKTRACE_DEPTH
+// unique addresses and a file write, that is milliseconds for large profiles
+constexpr auto MIN_DUMP_INTERVAL = std::chrono::seconds{1};
+
+struct Sample {
+  double weight;
+  int32_t depth;
+  std::array<void*, MAX_BACKTRACE_DEPTH> backtrace;
+};
+
+struct Profiler {
+  size_t sample_size{0};
+  std::string dump_dir{"."};
+  size_t memory_threshold{0};
+  double time_threshold_sec{0};
+
+  std::mt19937_64 gen;
+  std::vector<Sample> samples;
+  double not_recorded_weight{0};
+  uint64_t dumped_requests{0};
+  std::chrono::steady_clock::time_point last_dump_tp;
+
+  size_t next_sample_distance() noexcept {
+    // the distances between samples are exponentially distributed, so every byte is sampled with the same probability
+    const double distance = std::exponential_distribution<double>{1.0 / static_cast<double>(sample_size)}(gen);
+    return static_cast<size_t>(distance) + 1;
+  }
+};
+
+Profiler profiler;
+
+// f$Namespace$C$Class$$method(...) -> Namespace\Class::method
+std::string make_php_function_name(vk::string_view func_name) noexcept {
+  std::string pretty_name;
+  func_name.remove_prefix(2);
+  // the arguments are dropped, and the folded stacks format doesn't allow the separators in the frame names
+  func_name = func_name.substr(0, func_name.find('('));
+  prettify_php_function_name(func_name, [&pretty_name](const char* part, size_t size) {
+    for (const char* it = part; it != part + size; ++it) {
+      if (*it != ';' && *it != ' ') {
+        pretty_name.push_back(*it);
+      }
+    }
+  });
+  return pretty_name;
+}
+
+std::unordered_map<void*, std::string> symbolize(const std::vector<Sample>& samples) noexcept {
+  std::unordered_map<void*, std::string> names;
+  std::vector<void*> addresses;
+  for (const Sample& sample : samples) {
+    for (int32_t i = 0; i != sample.depth; ++i) {
+      if (names.emplace(sample.backtrace[i], std::string{}).second) {
+        addresses.push_back(sample.backtrace[i]);
+      }
+    }
+  }
+
+  KphpBacktrace demangler{addresses.data(), static_cast<int32_t>(addresses.size())};
+  auto address = addresses.begin();
+  for (const char* name : demangler.make_demangled_backtrace_range()) {
+    const vk::string_view func_name{name ? name : ""};
+    // only the compiled PHP functions and builtins are kept, the runtime internals are skipped
+    if (func_name.starts_with("f$") && !func_name.ends_with("$run()")) {
+      names[*address] = make_php_function_name(func_name);
+    }
+    ++address;
+  }
+  return names;
+}
+
+void dump_profile(double script_time_sec, const memory_resource::MemoryStats& script_memory_stats) noexcept {
+  const auto names = symbolize(profiler.samples);
+
+  // folded stacks format: the frames from the root to the leaf separated by ';' and the sampled bytes
+  std::map<std::string, double> stacks;
+  for (const Sample& sample : profiler.samples) {
+    std::string stack;
+    for (int32_t i = sample.depth - 1; i >= 0; --i) {
+      const std::string& name = names.at(sample.backtrace[i]);
+      if (!name.empty()) {
+        stack.append(stack.empty() ? "" : ";").append(name);
+      }
+    }
+    stacks[stack.empty() ? "[unknown]" : stack] += sample.weight;
+  }
+  if (profiler.not_recorded_weight > 0) {
+    stacks["[not recorded]"] += profiler.not_recorded_weight;
+  }
+
+  std::array<char, PATH_MAX> path{};
+  snprintf(path.data(), path.size(), "%s/allocations.%d.%" PRIu64 ".folded", profiler.dump_dir.c_str(), static_cast<int>(getpid()), profiler.dumped_requests++);
+  FILE* out = fopen(path.data(), "w");
+  if (!out) {
+    kprintf("can't open allocation profile file '%s': %m\n", path.data());
+    return;
+  }
+  for (const auto& [stack, weight] : stacks) {
+    fprintf(out, "%s %.0f\n", stack.c_str(), weight);
+  }
+  fclose(out);
+  kprintf("allocation profile of the request (script time = %.3f s, max memory used = %zu) is dumped to '%s'\n", script_time_sec,
+          script_memory_stats.max_memory_used, path.data());
+}
+
+} // namespace
+
+void set_sample_size(size_t sample_size) noexcept {
+  profiler.sample_size = sample_size;
+  profiler.samples.reserve(sample_size ? MAX_SAMPLES : 0);
+}
+
+bool set_dump_dir(const char* dir) noexcept {
+  if (access(dir, W_OK) != 0) {
+    return false;
+  }
+  profiler.dump_dir = dir;
+  return true;
+}
+
+void set_memory_threshold(size_t memory_threshold) noexcept {
+  profiler.memory_threshold = memory_threshold;
+}
+
+void set_time_threshold(double time_threshold_sec) noexcept {
+  profiler.time_threshold_sec = time_threshold_sec;
+}
+
+void on_script_start() noexcept {
+  if (profiler.sample_size == 0) {
+    return;
+  }
+  profiler.samples.clear();
+  profiler.not_recorded_weight = 0;
+  details::bytes_until_sample = profiler.next_sample_distance();
+}
+
+void on_script_finish(double script_time_sec, const memory_resource::MemoryStats& script_memory_stats) noexcept {
+  if (profiler.sample_size == 0) {
+    return;
+  }
+  // nothing is sampled between requests
+  details::bytes_until_sample = std::numeric_limits<size_t>::max();
+
+  const bool no_thresholds = profiler.memory_threshold == 0 && profiler.time_threshold_sec == 0;
+  const bool exceeds_memory_threshold = profiler.memory_threshold != 0 && script_memory_stats.max_memory_used >= profiler.memory_threshold;
+  const bool exceeds_time_threshold = profiler.time_threshold_sec != 0 && script_time_sec >= profiler.time_threshold_sec;
+  if (!no_thresholds && !exceeds_memory_threshold && !exceeds_time_threshold) {
+    return;
+  }
+
+  const auto now_tp = std::chrono::steady_clock::now();
+  if (profiler.samples.empty() || now_tp - profiler.last_dump_tp < MIN_DUMP_INTERVAL) {
+    return;
+  }
+  profiler.last_dump_tp = now_tp;
+  dump_profile(script_time_sec, script_memory_stats);
+}
+
+namespace details {
+
+void take_sample(size_t size) noexcept {
+  bytes_until_sample = profiler.next_sample_distance();
+
+  // an allocation is sampled with the probability 1 - exp(-size / sample_size), so it represents size / probability bytes
+  const double probability = -std::expm1(-static_cast<double>(size) / static_cast<double>(profiler.sample_size));
+  const double weight = static_cast<double>(size) / probability;
+  if (profiler.samples.size() == MAX_SAMPLES) {
+    profiler.not_recorded_weight += weight;
+    return;
+  }
+
+  Sample& sample = profiler.samples.emplace_back();
+  sample.weight = weight;
+  sample.depth = fast_backtrace(sample.backtrace.data(), static_cast<int>(sample.backtrace.size()));
+}
+
+} // namespace details
+
+} // namespace allocation_profiler
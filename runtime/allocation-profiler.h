@@ -0,0 +1,44 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "common/wrappers/likely.h"
+#include "runtime-common/core/memory-resource/memory_resource.h"
+
+// A sampling profiler of the script memory allocations: an allocation is sampled with the probability
+// proportional to its size, one sample per the configured number of bytes on average, and the PHP backtrace
+// of the sampled allocation is recorded. The samples of the requests which have exceeded the memory or time
+// thresholds are dumped as folded stacks, ready to be rendered by flamegraph.pl or speedscope.
+namespace allocation_profiler {
+
+void set_sample_size(size_t sample_size) noexcept;
+bool set_dump_dir(const char* dir) noexcept;
+void set_memory_threshold(size_t memory_threshold) noexcept;
+void set_time_threshold(double time_threshold_sec) noexcept;
+
+void on_script_start() noexcept;
+void on_script_finish(double script_time_sec, const memory_resource::MemoryStats& script_memory_stats) noexcept;
+
+namespace details {
+
+// it never ends if the profiler is disabled
+inline size_t bytes_until_sample{std::numeric_limits<size_t>::max()};
+
+void take_sample(size_t size) noexcept;
+
+} // namespace details
+
+inline void on_allocation(size_t size) noexcept {
+  if (unlikely(size >= details::bytes_until_sample)) {
+    details::take_sample(size);
+  } else {
+    details::bytes_until_sample -= size;
+  }
+}
+
+} // namespace allocation_profiler
@@ -4,6 +4,7 @@
 
 #include "runtime/allocator.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <dlfcn.h>
@@ -15,6 +16,7 @@
 #include "common/macos-ports.h"
 #include "common/wrappers/likely.h"
 
+#include "runtime/allocation-profiler.h"
 #include "runtime/critical_section.h"
 #include "runtime/kphp-backtrace.h"
 #include "runtime/memory_resource_impl//dealer.h"
@@ -29,6 +31,47 @@ memory_resource::Dealer& get_memory_dealer() noexcept {
   return dealer;
 }
 
+// Most of the requests fit the bump pointer limit, and they don't need the free lists at all.
+// If a request leaves the bump pointer mode, the freed memory it has lost is likely to be needed by the next ones,
+// so the mode is skipped for a growing number of the following requests.
+class BumpModePolicy : vk::not_copyable {
+public:
+  static BumpModePolicy& get() noexcept {
+    static BumpModePolicy policy;
+    return policy;
+  }
+
+  void set_ratio(double ratio) noexcept {
+    ratio_ = ratio;
+  }
+
+  size_t get_bump_limit(size_t script_mem_size, const memory_resource::MemoryStats& previous_request_stats) noexcept {
+    if (ratio_ == 0) {
+      return 0;
+    }
+    if (previous_request_in_bump_mode_) {
+      requests_to_skip_ = previous_request_stats.bump_mode_fallbacks ? std::min(std::max(requests_to_skip_ * 2, 1U), MAX_REQUESTS_TO_SKIP) : 0;
+      skipped_requests_ = 0;
+    }
+    previous_request_in_bump_mode_ = skipped_requests_ == requests_to_skip_;
+    if (!previous_request_in_bump_mode_) {
+      ++skipped_requests_;
+      return 0;
+    }
+    return static_cast<size_t>(static_cast<double>(script_mem_size) * ratio_);
+  }
+
+private:
+  static constexpr uint32_t MAX_REQUESTS_TO_SKIP = 1024;
+
+  BumpModePolicy() = default;
+
+  double ratio_{0};
+  bool previous_request_in_bump_mode_{false};
+  uint32_t requests_to_skip_{0};
+  uint32_t skipped_requests_{0};
+};
+
 } // namespace
 
 bool script_allocator_enabled = false;
@@ -64,6 +107,10 @@ size_t get_heap_memory_used() noexcept {
   return get_memory_dealer().get_heap_resource().memory_used();
 }
 
+void set_bump_allocation_ratio(double ratio) noexcept {
+  BumpModePolicy::get().set_ratio(ratio);
+}
+
 void global_init_script_allocator() noexcept {
   auto& dealer = get_memory_dealer();
   php_assert(dealer.heap_script_resource_replacer());
@@ -83,9 +130,15 @@ void init_script_allocator(void* buffer, size_t script_mem_size, size_t oom_hand
   php_assert(!is_malloc_replaced());
 
   CriticalSectionGuard lock;
-  dealer.current_script_resource().init(buffer, script_mem_size, oom_handling_mem_size);
+  auto& resource = dealer.current_script_resource();
+  const size_t bump_limit = BumpModePolicy::get().get_bump_limit(script_mem_size, resource.get_memory_stats());
+  resource.init(buffer, script_mem_size, oom_handling_mem_size);
+  if (bump_limit) {
+    resource.enable_bump_mode(bump_limit);
+  }
   script_allocator_enabled = true;
   query_num++;
+  allocation_profiler::on_script_start();
 }
 
 void free_script_allocator() noexcept {
@@ -108,6 +161,7 @@ void* allocate(size_t size) noexcept {
     return nullptr;
   }
 
+  allocation_profiler::on_allocation(size);
   return dealer.current_script_resource().allocate(size);
 }
 
@@ -122,6 +176,7 @@ void* allocate0(size_t size) noexcept {
     return nullptr;
   }
 
+  allocation_profiler::on_allocation(size);
   return dealer.current_script_resource().allocate0(size);
 }
 
@@ -136,6 +191,7 @@ void* reallocate(void* mem, size_t new_size, size_t old_size) noexcept {
     return mem;
   }
 
+  allocation_profiler::on_allocation(new_size - old_size);
   return dealer.current_script_resource().reallocate(mem, new_size, old_size);
 }
 
@@ -29,6 +29,9 @@ void restore_default_script_allocator(bool force_disable) noexcept;
 const memory_resource::MemoryStats& get_script_memory_stats() noexcept;
 size_t get_heap_memory_used() noexcept;
 
+// the part of the script memory which may be served by the bump pointer, 0 disables the bump pointer mode
+void set_bump_allocation_ratio(double ratio) noexcept;
+
 void global_init_script_allocator() noexcept;
 void init_script_allocator(void* buffer, size_t script_mem_size, size_t oom_handling_mem_size) noexcept;
 void free_script_allocator() noexcept;
@@ -28,6 +28,10 @@ public:
     acquired_sample_ = nullptr;
   }
 
+  uint64_t get_generation() const noexcept {
+    return acquired_sample_ ? acquired_sample_->get_generation() : 0;
+  }
+
   const confdata_sample_storage& get_confdata_storage() const noexcept {
     php_assert(acquired_sample_);
     return acquired_sample_->get_confdata();
@@ -83,6 +87,10 @@ void free_confdata_functions_lib() {
   }
 }
 
+uint64_t confdata_get_generation() noexcept {
+  return ConfdataLocalManager::get().get_generation();
+}
+
 bool f$is_confdata_loaded() noexcept {
   return ConfdataLocalManager::get().is_initialized();
 }
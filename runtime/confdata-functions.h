@@ -8,6 +8,9 @@
 void init_confdata_functions_lib();
 void free_confdata_functions_lib();
 
+// changes every time confdata is updated, 0 if confdata is not initialized
+uint64_t confdata_get_generation() noexcept;
+
 bool f$is_confdata_loaded() noexcept;
 
 mixed f$confdata_get_value(const string& key) noexcept;
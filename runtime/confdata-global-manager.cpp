@@ -38,11 +38,17 @@ void ConfdataSample::init(memory_resource::unsynchronized_pool_resource& resourc
   auto* mem = resource_->allocate(sizeof(*confdata_storage_));
   php_assert(mem);
   confdata_storage_ = new (mem) confdata_sample_storage{confdata_sample_storage::allocator_type{*resource_}};
+  auto* generation_mem = resource_->allocate(sizeof(*generation_));
+  php_assert(generation_mem);
+  generation_ = new (generation_mem) uint64_t{0};
 }
 
 void ConfdataSample::reset(confdata_sample_storage&& new_confdata) noexcept {
+  // samples are updated only by master, so a plain counter is enough
+  static uint64_t last_generation = 0;
   clear();
   *confdata_storage_ = std::move(new_confdata);
+  *generation_ = ++last_generation;
 }
 
 void ConfdataSample::clear() noexcept {
@@ -73,8 +79,10 @@ void ConfdataSample::destroy() noexcept {
     clear();
     confdata_storage_->~map();
     resource_->deallocate(confdata_storage_, sizeof(*confdata_storage_));
+    resource_->deallocate(generation_, sizeof(*generation_));
 
     confdata_storage_ = nullptr;
+    generation_ = nullptr;
     resource_ = nullptr;
   }
 }
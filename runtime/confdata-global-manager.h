@@ -37,10 +37,16 @@ public:
     return *confdata_storage_;
   }
 
+  uint64_t get_generation() const noexcept {
+    return generation_ ? *generation_ : 0;
+  }
+
 private:
   memory_resource::unsynchronized_pool_resource* resource_{nullptr};
   confdata_sample_storage* confdata_storage_{nullptr};
   std::forward_list<ConfdataGarbageNode>* garbage_{nullptr};
+  // it's placed into the shared confdata memory next to the storage: samples are updated by master after workers are forked
+  uint64_t* generation_{nullptr};
 };
 
 class ConfdataGlobalManager : vk::not_copyable {
@@ -0,0 +1,135 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/instance-cache-spill-store.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+
+namespace {
+
+// The number of the index slots is chosen for the records of this size on average
+constexpr size_t AVERAGE_RECORD_SIZE{1024u};
+constexpr size_t MIN_SLOTS_COUNT{1024u};
+// A key may be found only in this number of slots after its hash position
+constexpr size_t SLOT_PROBES{8u};
+// A record can't take more than this part of the data, so a single element never wipes out the whole ring
+constexpr size_t MAX_RECORD_SIZE_RATIO{8u};
+
+constexpr size_t align8(size_t size) noexcept {
+  return (size + 7) & -8;
+}
+
+} // namespace
+
+bool InstanceCacheSpillStore::init(const char* path, size_t size) noexcept {
+  size_t slots_count = MIN_SLOTS_COUNT;
+  while (slots_count < size / AVERAGE_RECORD_SIZE) {
+    slots_count *= 2;
+  }
+  const size_t data_offset = align8(sizeof(Header)) + slots_count * sizeof(Slot);
+  const size_t data_size = align8(size);
+
+  unlink(path);
+  const int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    kprintf("Can't create instance cache spill file '%s': %s\n", path, strerror(errno));
+    return false;
+  }
+  // the file is sparse, so the header and the index are zeroed, i.e. there are no records
+  void* memory = ftruncate(fd, static_cast<off_t>(data_offset + data_size)) == 0
+                     ? mmap(nullptr, data_offset + data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+  const int mmap_errno = errno;
+  close(fd);
+  if (memory == MAP_FAILED) {
+    kprintf("Can't map instance cache spill file '%s': %s\n", path, strerror(mmap_errno));
+    unlink(path);
+    return false;
+  }
+
+  header_ = new (memory) Header{};
+  slots_ = reinterpret_cast<Slot*>(static_cast<char*>(memory) + align8(sizeof(Header)));
+  slots_mask_ = slots_count - 1;
+  data_ = static_cast<char*>(memory) + data_offset;
+  data_size_ = data_size;
+  return true;
+}
+
+bool InstanceCacheSpillStore::put(std::string_view key, const ElementInfo& info, std::string_view serialized) noexcept {
+  if (!is_enabled()) {
+    return false;
+  }
+  const size_t record_size = align8(sizeof(Record) + key.size() + serialized.size());
+  if (record_size > data_size_ / MAX_RECORD_SIZE_RATIO || record_size > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  const uint64_t key_hash = hash_key(key);
+
+  std::lock_guard<inter_process_mutex> lock{header_->mutex};
+  uint64_t position = header_->write_position;
+  // a record is never split, the tail of the ring is skipped instead
+  if (position % data_size_ + record_size > data_size_) {
+    position += data_size_ - position % data_size_;
+  }
+  header_->write_position = position + record_size;
+
+  auto* record = new (data_ + position % data_size_) Record{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(serialized.size()), info};
+  char* record_key = reinterpret_cast<char*>(record + 1);
+  std::memcpy(record_key, key.data(), key.size());
+  std::memcpy(record_key + key.size(), serialized.data(), serialized.size());
+
+  // the slot of the same key, otherwise an empty or a stale one, otherwise the one of the oldest record
+  Slot* target = nullptr;
+  for (size_t i = 0; i != SLOT_PROBES; ++i) {
+    Slot& slot = slots_[(key_hash + i) & slots_mask_];
+    if (slot.key_hash == key_hash) {
+      target = &slot;
+      break;
+    }
+    if (!target || (is_valid(*target) && (!is_valid(slot) || slot.position < target->position))) {
+      target = &slot;
+    }
+  }
+  target->key_hash = key_hash;
+  target->position = position + 1;
+  return true;
+}
+
+void InstanceCacheSpillStore::remove(std::string_view key) noexcept {
+  if (!is_enabled()) {
+    return;
+  }
+  const uint64_t key_hash = hash_key(key);
+  std::lock_guard<inter_process_mutex> lock{header_->mutex};
+  if (Slot* slot = find_slot(key_hash, key)) {
+    slot->position = 0;
+  }
+}
+
+uint64_t InstanceCacheSpillStore::hash_key(std::string_view key) noexcept {
+  return std::hash<std::string_view>{}(key);
+}
+
+InstanceCacheSpillStore::Slot* InstanceCacheSpillStore::find_slot(uint64_t key_hash, std::string_view key) const noexcept {
+  for (size_t i = 0; i != SLOT_PROBES; ++i) {
+    Slot& slot = slots_[(key_hash + i) & slots_mask_];
+    if (slot.key_hash == key_hash) {
+      if (!is_valid(slot)) {
+        return nullptr;
+      }
+      const Record& record = get_record(slot);
+      return std::string_view{get_record_key(record), record.key_size} == key ? &slot : nullptr;
+    }
+  }
+  return nullptr;
+}
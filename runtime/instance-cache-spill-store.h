@@ -0,0 +1,103 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/inter-process-mutex.h"
+
+// The second tier of the instance cache: the serialized elements that don't fit the shared memory are kept in a memory-mapped file on a local disk.
+// The file is a ring of records appended one after another, with a hash index in front of it:
+// a new record overwrites the oldest ones, and the index entries of the overwritten records become stale.
+// The master creates it before the workers are forked, then all of them use it under an inter-process mutex.
+class InstanceCacheSpillStore : vk::not_copyable {
+public:
+  struct ElementInfo {
+    // see msgpack_layout_hash of the generated classes
+    uint64_t layout_hash;
+    int64_t stored_at;
+    int64_t expiring_at;
+  };
+
+  // should be called from master; the previous file is unlinked, so the processes which still use it keep their own
+  bool init(const char* path, size_t size) noexcept;
+
+  bool is_enabled() const noexcept {
+    return header_ != nullptr;
+  }
+
+  // overwrites the oldest records if there is no room, returns false if the element is too large
+  bool put(std::string_view key, const ElementInfo& info, std::string_view serialized) noexcept;
+
+  // calls f(const ElementInfo& info, std::string_view serialized) under the lock, if the key is found
+  template<class F>
+  bool get(std::string_view key, F&& f) noexcept;
+
+  void remove(std::string_view key) noexcept;
+
+private:
+  struct Header {
+    inter_process_mutex mutex;
+    // the position of the next record, it only grows: the record is placed at position % data_size_
+    uint64_t write_position;
+  };
+
+  struct Slot {
+    uint64_t key_hash;
+    // the position of the record plus one, zero for an empty slot
+    uint64_t position;
+  };
+
+  // followed by the key and the serialized element
+  struct Record {
+    uint32_t key_size;
+    uint32_t serialized_size;
+    ElementInfo info;
+  };
+
+  static uint64_t hash_key(std::string_view key) noexcept;
+
+  // the record is valid until the ring is passed over it
+  bool is_valid(const Slot& slot) const noexcept {
+    return slot.position != 0 && header_->write_position <= slot.position - 1 + data_size_;
+  }
+
+  const Record& get_record(const Slot& slot) const noexcept {
+    return *reinterpret_cast<const Record*>(data_ + (slot.position - 1) % data_size_);
+  }
+
+  static const char* get_record_key(const Record& record) noexcept {
+    return reinterpret_cast<const char*>(&record + 1);
+  }
+
+  Slot* find_slot(uint64_t key_hash, std::string_view key) const noexcept;
+
+  Header* header_{nullptr};
+  Slot* slots_{nullptr};
+  size_t slots_mask_{0};
+  char* data_{nullptr};
+  size_t data_size_{0};
+};
+
+template<class F>
+bool InstanceCacheSpillStore::get(std::string_view key, F&& f) noexcept {
+  if (!is_enabled()) {
+    return false;
+  }
+  const uint64_t key_hash = hash_key(key);
+  std::lock_guard<inter_process_mutex> lock{header_->mutex};
+  const Slot* slot = find_slot(key_hash, key);
+  if (!slot) {
+    return false;
+  }
+  const Record& record = get_record(*slot);
+  f(record.info, std::string_view{get_record_key(record) + record.key_size, record.serialized_size});
+  return true;
+}
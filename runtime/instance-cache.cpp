@@ -5,10 +5,18 @@
 #include "runtime/instance-cache.h"
 
 #include <chrono>
+#include <cstdio>
+#include <fcntl.h>
 #include <forward_list>
 #include <map>
 #include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <typeindex>
+#include <unistd.h>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/kprintf.h"
 #include "common/wrappers/memory-utils.h"
@@ -17,8 +25,10 @@
 #include "runtime-common/core/memory-resource/resource_allocator.h"
 #include "runtime/allocator.h"
 #include "runtime/critical_section.h"
+#include "runtime/instance-cache-spill-store.h"
 #include "runtime/inter-process-mutex.h"
 #include "runtime/inter-process-resource.h"
+#include "runtime/memoize.h"
 
 namespace impl_ {
 
@@ -48,6 +58,79 @@ static constexpr std::chrono::minutes PHYSICAL_REMOVING_DELAY{1};
 static constexpr size_t DATA_SHARDS_COUNT{997u};
 // The buckets check step during the cache cleanup
 static constexpr size_t SHARDS_PURGE_PERIOD{5u};
+// With the online compaction, the buffer is compacted when it's used at least this much
+static constexpr double COMPACTION_REAL_MEMORY_USED_THRESHOLD{0.5};
+// and the live elements take not more than this ratio of the used part
+static constexpr double COMPACTION_MEMORY_USED_RATIO{0.75};
+// The elements are moved below this ratio of the live elements size, it leaves room for the fragmentation
+static constexpr double COMPACTION_MEMORY_TARGET_RATIO{1.125};
+// The buckets check step during the compaction
+static constexpr size_t SHARDS_COMPACTION_PERIOD{5u};
+// The memory amount relocated at most per compaction step, the workers can't store elements while it goes
+static constexpr size_t COMPACTION_STEP_MEMORY_LIMIT{16u * 1024u * 1024u};
+// The handover file starts with it, then the elements go one by one
+static constexpr uint64_t HANDOVER_MAGIC{0x316f68636e69706bULL};
+// The handed over instances are unpacked into a temporary memory, an element is skipped if it can't surely fit
+static constexpr size_t HANDOVER_UNPACKING_MEMORY_RATIO{16u};
+// The temporary memory grows with the largest element from this size up to the memory limit
+static constexpr size_t HANDOVER_MIN_UNPACKING_MEMORY_SIZE{1u * 1024u * 1024u};
+// The handover is done in steps of about this size, so that both masters aren't blocked by it for long
+static constexpr size_t HANDOVER_STEP_SIZE{16u * 1024u * 1024u};
+// The elements are spilled before the swap in steps of about this size, the swap is done after the last one
+static constexpr size_t SWAP_SPILL_STEP_SIZE{16u * 1024u * 1024u};
+// The spill file is this many times larger than the memory limit, if its size isn't set
+static constexpr size_t DEFAULT_SPILL_SIZE_RATIO{4u};
+
+struct HandoverElementHeader {
+  uint64_t layout_hash;
+  int64_t stored_at;
+  int64_t expiring_at;
+  uint32_t key_size;
+  uint32_t serialized_size;
+};
+
+enum class HandoverStepStatus { in_progress, finished, failed };
+
+// the handover file is written and read in steps, the state is kept between them
+struct HandoverState {
+  FILE* file{nullptr};
+  // the number of the elements saved or loaded so far
+  size_t elements{0};
+  // the old master: the shard to be saved at the next step
+  size_t next_shard_id{0};
+  // the new master: the memory to unpack the instances into
+  std::unique_ptr<char[]> unpacking_memory;
+  size_t unpacking_memory_size{0};
+};
+
+class HandoverClasses : vk::not_copyable {
+public:
+  static HandoverClasses& get() noexcept {
+    static HandoverClasses handover_classes;
+    return handover_classes;
+  }
+
+  void add(const std::type_info& instance_wrapper_type, const InstanceCacheHandoverClass& handover_class) noexcept {
+    by_instance_wrapper_type_.emplace(instance_wrapper_type, handover_class);
+    by_layout_hash_.emplace(handover_class.layout_hash, handover_class);
+  }
+
+  const InstanceCacheHandoverClass* find(const InstanceCopyistBase& instance_wrapper) const noexcept {
+    auto it = by_instance_wrapper_type_.find(typeid(instance_wrapper));
+    return it != by_instance_wrapper_type_.end() ? &it->second : nullptr;
+  }
+
+  const InstanceCacheHandoverClass* find(uint64_t layout_hash) const noexcept {
+    auto it = by_layout_hash_.find(layout_hash);
+    return it != by_layout_hash_.end() ? &it->second : nullptr;
+  }
+
+private:
+  HandoverClasses() = default;
+
+  std::unordered_map<std::type_index, InstanceCacheHandoverClass> by_instance_wrapper_type_;
+  std::unordered_map<uint64_t, InstanceCacheHandoverClass> by_layout_hash_;
+};
 
 class ElementHolder;
 
@@ -94,6 +177,17 @@ public:
     cache_context.stats.elements_created.fetch_add(1, std::memory_order_relaxed);
   }
 
+  // the relocated element is the same except the instance, which is copied into another place of the memory
+  ElementHolder(const ElementHolder& element, std::unique_ptr<InstanceCopyistBase>&& relocated_instance) noexcept
+      : stored_at(element.stored_at),
+        expiring_at(element.expiring_at),
+        early_fetch_performed(element.early_fetch_performed),
+        inserted_by_process(element.inserted_by_process),
+        instance_wrapper(std::move(relocated_instance)),
+        cache_context(element.cache_context) {
+    cache_context.stats.elements_created.fetch_add(1, std::memory_order_relaxed);
+  }
+
   // returns how long the element is lived in relation to the expected lifetime
   double freshness_ratio(std::chrono::nanoseconds now, double immortal_ratio = 0.5) const noexcept {
     // an immortal element
@@ -236,6 +330,9 @@ private:
 
 struct {
   size_t total_memory_limit{DEFAULT_MEMORY_LIMIT};
+  bool online_compaction{false};
+  std::string spill_file_path;
+  size_t spill_size{0};
 } static instance_cache_settings;
 
 class InstanceCache {
@@ -252,6 +349,10 @@ public:
   void global_init() {
     php_assert(!current_ && !context_);
     data_manager_.init(instance_cache_settings.total_memory_limit);
+    if (!instance_cache_settings.spill_file_path.empty()) {
+      const size_t spill_size = instance_cache_settings.spill_size ?: DEFAULT_SPILL_SIZE_RATIO * instance_cache_settings.total_memory_limit;
+      spill_store_.init(instance_cache_settings.spill_file_path.c_str(), spill_size);
+    }
   }
 
   void refresh() {
@@ -269,9 +370,10 @@ public:
     php_assert(current_ && context_);
     sync_delayed();
 
-    // request_cache_ and storing_delayed_ use a script memory
+    // request_cache_, storing_delayed_ and fetched_from_spill_ use a script memory
     storing_delayed_.clear();
     request_cache_.clear();
+    fetched_from_spill_.clear();
     // used_elements use a heap memory
     used_elements_.clear();
 
@@ -288,6 +390,18 @@ public:
   }
 
   InstanceCacheOpStatus store(const string& key, const InstanceCopyistBase& instance_wrapper, int64_t ttl) noexcept {
+    const InstanceCacheOpStatus status = store_into_memory(key, instance_wrapper, ttl);
+    if (status == InstanceCacheOpStatus::success) {
+      forget_spilled(key);
+    } else if (vk::any_of_equal(status, InstanceCacheOpStatus::memory_limit_exceeded, InstanceCacheOpStatus::memory_swap_required)) {
+      if (spill(key, instance_wrapper, ttl)) {
+        return InstanceCacheOpStatus::spilled;
+      }
+    }
+    return status;
+  }
+
+  InstanceCacheOpStatus store_into_memory(const string& key, const InstanceCopyistBase& instance_wrapper, int64_t ttl) noexcept {
     ic_debug("store '%s'\n", key.c_str());
     php_assert(current_ && context_);
     if (context_->memory_swap_required) {
@@ -348,12 +462,13 @@ public:
     bool element_logically_expired = false;
     {
       auto& data = current_->get_data(key);
-      std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
+      std::unique_lock<inter_process_mutex> shared_data_lock{data.storage_mutex};
       auto it = data.storage.find(key);
       if (it == data.storage.end()) {
         ic_debug("can't fetch '%s' because it is absent\n", key.c_str());
         context_->stats.elements_missed.fetch_add(1, std::memory_order_relaxed);
-        return nullptr;
+        shared_data_lock.unlock();
+        return fetch_spilled(key);
       }
 
       update_now();
@@ -428,6 +543,7 @@ public:
     // request_cache_ and storing_delayed_ use a script memory
     storing_delayed_.unset(key);
     request_cache_.unset(key);
+    forget_spilled(key);
     auto& data = current_->get_data(key);
     update_now();
     std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
@@ -501,13 +617,189 @@ public:
     last_memory_stats_ = context.memory_resource.get_memory_stats();
   }
 
+  // this function should be called only from master
+  // the elements placed beyond the size of the live memory are moved into the freed pieces below it,
+  // so the used part of the buffer shrinks and the fragmentation doesn't need the buffer swap
+  void compact_memory() {
+    auto& current_data = data_manager_.get_current_resource();
+    auto& context = current_data.get_context();
+    const auto& memory_stats = get_last_memory_stats();
+    const auto real_memory_used = static_cast<double>(memory_stats.real_memory_used);
+    const bool is_fragmented = real_memory_used >= COMPACTION_REAL_MEMORY_USED_THRESHOLD * static_cast<double>(memory_stats.memory_limit) &&
+                               static_cast<double>(memory_stats.memory_used) <= COMPACTION_MEMORY_USED_RATIO * real_memory_used;
+    if (!is_fragmented && !context.memory_swap_required) {
+      return;
+    }
+
+    // the same as in purge_expired()
+    dl::MemoryReplacementGuard shared_memory_guard{context.memory_resource, true};
+    // lock in this very order and do not move allocator_lock anywhere below, otherwise it will result in a deadlock!
+    std::lock_guard<inter_process_mutex> allocator_lock{context.allocator_mutex};
+    context.clear_garbage();
+    const auto& current_memory_stats = context.memory_resource.get_memory_stats();
+    const auto compacted_memory_size = static_cast<size_t>(COMPACTION_MEMORY_TARGET_RATIO * static_cast<double>(current_memory_stats.memory_used));
+    const char* compacted_memory_end = static_cast<const char*>(context.memory_resource.memory_begin()) + compacted_memory_size;
+    const size_t allocated_before = current_memory_stats.total_memory_allocated;
+    context.memory_resource.reserve_memory_above(compacted_memory_end);
+
+    std::vector<ElementStorage_::node_type> previous_nodes;
+    auto* data_shards = current_data.get_data_shards();
+    const size_t shards_count = current_data.get_data_shards_count();
+    for (size_t shard_id = compaction_shard_offset_; shard_id < shards_count; shard_id += SHARDS_COMPACTION_PERIOD) {
+      auto& data_shard = data_shards[shard_id];
+      if (data_shard.is_storage_empty.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
+      relocate_elements(data_shard, context, compacted_memory_end, previous_nodes);
+      if (current_memory_stats.total_memory_allocated - allocated_before >= COMPACTION_STEP_MEMORY_LIMIT) {
+        break;
+      }
+    }
+
+    compaction_shard_offset_ = (compaction_shard_offset_ + 1) % SHARDS_COMPACTION_PERIOD;
+
+    // the previous elements are destroyed only after the reservation, otherwise their memory would be taken by the next relocated ones
+    context.memory_resource.release_reserved_memory();
+    for (auto& previous_node : previous_nodes) {
+      InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(previous_node.key());
+    }
+    previous_nodes.clear();
+    context.clear_garbage();
+    // the freed pieces at the end of the used part are given back
+    context.memory_resource.perform_defragmentation();
+    last_memory_stats_ = context.memory_resource.get_memory_stats();
+  }
+
+  // this function should be called only from master
+  // saves the elements of the next shards, until about HANDOVER_STEP_SIZE bytes are written
+  HandoverStepStatus save_for_handover_step(HandoverState& state) {
+    if (state.next_shard_id == 0 && fwrite(&HANDOVER_MAGIC, sizeof(HANDOVER_MAGIC), 1, state.file) != 1) {
+      return HandoverStepStatus::failed;
+    }
+
+    update_now();
+    auto& current_data = data_manager_.get_current_resource();
+    size_t written = 0;
+    const auto save_element = [&state, &written](const string& key, const ElementHolder& element, uint64_t layout_hash, const string_buffer& serialized) {
+      // memoized results are bound to the confdata generation, which the new master counts anew
+      if (vk::string_view{key.c_str(), key.size()}.starts_with(impl_::MEMOIZE_KEY_PREFIX)) {
+        return true;
+      }
+      const HandoverElementHeader header{layout_hash, element.stored_at.count(), element.expiring_at.count(), key.size(), serialized.size()};
+      if (fwrite(&header, sizeof(header), 1, state.file) != 1 || fwrite(key.c_str(), 1, key.size(), state.file) != key.size() ||
+          fwrite(serialized.buffer(), 1, serialized.size(), state.file) != serialized.size()) {
+        return false;
+      }
+      written += sizeof(header) + key.size() + serialized.size();
+      ++state.elements;
+      return true;
+    };
+    for (; state.next_shard_id != current_data.get_data_shards_count(); ++state.next_shard_id) {
+      if (written >= HANDOVER_STEP_SIZE) {
+        return HandoverStepStatus::in_progress;
+      }
+      if (!for_each_serialized_element_of_shard(current_data, state.next_shard_id, save_element)) {
+        return HandoverStepStatus::failed;
+      }
+    }
+    return HandoverStepStatus::finished;
+  }
+
+  // this function should be called only from master
+  // loads the next elements, until about HANDOVER_STEP_SIZE bytes are read
+  HandoverStepStatus load_handover_step(HandoverState& state) {
+    FILE* file = state.file;
+    uint64_t magic = 0;
+    if (ftell(file) == 0 && (fread(&magic, sizeof(magic), 1, file) != 1 || magic != HANDOVER_MAGIC)) {
+      return HandoverStepStatus::failed;
+    }
+
+    update_now();
+    auto& current_data = data_manager_.get_current_resource();
+    auto& context = current_data.get_context();
+    const auto& handover_classes = HandoverClasses::get();
+    const size_t max_unpacking_memory_size = context.memory_resource.get_memory_stats().memory_limit;
+    memory_resource::unsynchronized_pool_resource unpacking_resource;
+
+    size_t read = 0;
+    size_t loaded = 0;
+    auto count_loaded = vk::finally([&state, &context, &loaded] {
+      state.elements += loaded;
+      context.stats.elements_handed_over.fetch_add(loaded, std::memory_order_relaxed);
+    });
+    HandoverElementHeader header{};
+    while (read < HANDOVER_STEP_SIZE) {
+      if (fread(&header, sizeof(header), 1, file) != 1) {
+        return feof(file) ? HandoverStepStatus::finished : HandoverStepStatus::failed;
+      }
+      read += sizeof(header) + header.key_size + header.serialized_size;
+
+      const InstanceCacheHandoverClass* handover_class = handover_classes.find(header.layout_hash);
+      const std::chrono::nanoseconds expiring_at{header.expiring_at};
+      // the key is allocated in the temporary memory too, so a broken key size makes the element skipped instead of overflowing it
+      const size_t unpacking_memory_size =
+        string::estimate_memory_usage(header.key_size) + static_cast<size_t>(header.serialized_size) * HANDOVER_UNPACKING_MEMORY_RATIO;
+      if (!handover_class || expiring_at <= now_ || unpacking_memory_size > max_unpacking_memory_size) {
+        if (fseek(file, static_cast<long>(header.key_size) + header.serialized_size, SEEK_CUR) != 0) {
+          return HandoverStepStatus::failed;
+        }
+        continue;
+      }
+      if (unpacking_memory_size > state.unpacking_memory_size) {
+        state.unpacking_memory_size =
+          std::min(std::max({unpacking_memory_size, HANDOVER_MIN_UNPACKING_MEMORY_SIZE, 2 * state.unpacking_memory_size}), max_unpacking_memory_size);
+        state.unpacking_memory.reset(new char[state.unpacking_memory_size]);
+      }
+
+      // nothing is freed into the temporary memory: it's reset for every element,
+      // and deallocations are ignored when the script allocator is disabled
+      unpacking_resource.init(state.unpacking_memory.get(), state.unpacking_memory_size);
+      string key;
+      std::unique_ptr<InstanceCopyistBase> instance_wrapper;
+      {
+        dl::MemoryReplacementGuard unpacking_memory_guard{unpacking_resource, true};
+        key = string{header.key_size, false};
+        string serialized{header.serialized_size, false};
+        if (fread(key.buffer(), 1, header.key_size, file) != header.key_size ||
+            fread(serialized.buffer(), 1, header.serialized_size, file) != header.serialized_size) {
+          return HandoverStepStatus::failed;
+        }
+        instance_wrapper = handover_class->deserialize(serialized);
+      }
+
+      if (instance_wrapper && insert_handed_over_element(current_data, key, *instance_wrapper, std::chrono::nanoseconds{header.stored_at}, expiring_at)) {
+        ++loaded;
+      }
+    }
+    return HandoverStepStatus::in_progress;
+  }
+
   // this function should be called only from master
   InstanceCacheSwapStatus try_swap_memory_resource() {
     const auto& memory_stats = get_last_memory_stats();
     const auto threshold = REAL_MEMORY_USED_THRESHOLD * static_cast<double>(memory_stats.memory_limit);
-    if (static_cast<double>(memory_stats.real_memory_used) < threshold && !data_manager_.get_current_resource().get_context().memory_swap_required) {
+    auto& context = data_manager_.get_current_resource().get_context();
+    if (instance_cache_settings.online_compaction) {
+      // the fragmentation is eliminated by compact_memory(), the swap is needed only if the live elements don't fit
+      if (static_cast<double>(memory_stats.memory_used) < threshold) {
+        context.memory_swap_required = false;
+        swap_spill_next_shard_id_ = 0;
+        return InstanceCacheSwapStatus::no_need;
+      }
+    } else if (static_cast<double>(memory_stats.real_memory_used) < threshold && !context.memory_swap_required) {
+      swap_spill_next_shard_id_ = 0;
       return InstanceCacheSwapStatus::no_need;
     }
+    // the elements of the current buffer are lost with the swap, so they are spilled to be fetched from the second tier;
+    // it's done in steps, meanwhile the workers spill the elements they store instead of putting them into the buffer
+    if (spill_store_.is_enabled() && data_manager_.is_next_resource_unused()) {
+      context.memory_swap_required = true;
+      if (!spill_before_swap_step()) {
+        return InstanceCacheSwapStatus::swap_in_progress;
+      }
+    }
+    swap_spill_next_shard_id_ = 0;
     return data_manager_.try_switch_to_next_unused_resource() ? InstanceCacheSwapStatus::swap_is_finished : InstanceCacheSwapStatus::swap_is_forbidden;
   }
 
@@ -559,9 +851,11 @@ private:
         }
         if (detach_processor.is_memory_limit_exceeded()) {
           fire_warning(delayed_instance.instance_wrapper->get_class());
+          spill(key, *delayed_instance.instance_wrapper, delayed_instance.ttl);
           return;
         }
       } else {
+        forget_spilled(key);
         ic_debug("element '%s' was successfully inserted with delay\n", key.c_str());
         context_->stats.elements_stored_with_delay.fetch_add(1, std::memory_order_relaxed);
         // request_cache_ uses script memory
@@ -571,8 +865,10 @@ private:
     }
   }
 
+  // if only_if_absent, the element stored earlier is kept and nullptr is returned
   ElementHolder* try_insert_element_into_cache(SharedDataStorages& data, const string& key_in_script_memory, int64_t ttl,
-                                               const InstanceCopyistBase& instance_wrapper, InstanceDeepCopyVisitor& detach_processor) noexcept {
+                                               const InstanceCopyistBase& instance_wrapper, InstanceDeepCopyVisitor& detach_processor,
+                                               bool only_if_absent = false) noexcept {
     // swap the allocator
     dl::MemoryReplacementGuard shared_memory_guard{context_->memory_resource};
 
@@ -591,6 +887,9 @@ private:
         vk::intrusive_ptr<ElementHolder> element{new (mem) ElementHolder{now_, ttl, std::move(cached_instance_wrapper), *context_}};
         std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
         auto it = data.storage.find(key_in_script_memory);
+        if (it != data.storage.end() && only_if_absent) {
+          return nullptr;
+        }
         if (it == data.storage.end()) {
           string key_in_shared_memory = key_in_script_memory;
           if (unlikely(!detach_processor.process(key_in_shared_memory))) {
@@ -623,6 +922,240 @@ private:
     return nullptr;
   }
 
+  // this function should be called only from master
+  // the element is not inserted if the key is already stored by a worker of the new master
+  bool insert_handed_over_element(SharedMemoryData& current_data, const string& key_in_script_memory, const InstanceCopyistBase& instance_wrapper,
+                                  std::chrono::nanoseconds stored_at, std::chrono::nanoseconds expiring_at) noexcept {
+    auto& context = current_data.get_context();
+    auto& data = current_data.get_data(key_in_script_memory);
+    dl::MemoryReplacementGuard shared_memory_guard{context.memory_resource, true};
+
+    // lock in this very order, otherwise it will result in a deadlock!
+    std::lock_guard<inter_process_mutex> allocator_lock{context.allocator_mutex};
+    auto clear_garbage = vk::finally([&context] { context.clear_garbage(); });
+
+    InstanceDeepCopyVisitor detach_processor{context.memory_resource, ExtraRefCnt::for_instance_cache};
+    auto cached_instance_wrapper = instance_wrapper.deep_copy_and_set_ref_cnt(detach_processor);
+    if (!cached_instance_wrapper) {
+      return false;
+    }
+    void* mem = detach_processor.prepare_raw_memory(sizeof(ElementHolder));
+    if (!mem) {
+      return false;
+    }
+    vk::intrusive_ptr<ElementHolder> element{new (mem) ElementHolder{stored_at, 0, std::move(cached_instance_wrapper), context}};
+    element->expiring_at = expiring_at;
+
+    std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
+    if (data.storage.find(key_in_script_memory) != data.storage.end()) {
+      return false;
+    }
+    string key_in_shared_memory = key_in_script_memory;
+    if (unlikely(!detach_processor.process(key_in_shared_memory))) {
+      return false;
+    }
+    constexpr auto node_max_size = ElementStorage_::allocator_type::max_value_type_size();
+    if (unlikely(!detach_processor.is_enough_memory_for(node_max_size))) {
+      InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(key_in_shared_memory);
+      return false;
+    }
+    data.storage.emplace(std::move(key_in_shared_memory), std::move(element));
+    data.is_storage_empty.store(false, std::memory_order_relaxed);
+    context.stats.elements_cached.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // this function should be called only from master, under the allocator and the storage locks, with the memory above compacted_memory_end reserved
+  static void relocate_elements(SharedDataStorages& data, CacheContext& context, const char* compacted_memory_end,
+                                std::vector<ElementStorage_::node_type>& previous_nodes) noexcept {
+    constexpr auto node_max_size = ElementStorage_::allocator_type::max_value_type_size();
+    const char* memory_end = static_cast<const char*>(context.memory_resource.memory_begin()) + context.memory_resource.get_memory_stats().memory_limit;
+    for (auto it = data.storage.begin(); it != data.storage.end();) {
+      // the element is relocated if anything it owns is above the boundary: the storage node, the key, the holder or the instance
+      InstanceMemoryRangeVisitor range_visitor{compacted_memory_end, memory_end};
+      range_visitor.process_memory(&*it, sizeof(*it));
+      range_visitor.process(it->first);
+      range_visitor.process_memory(it->second.get(), sizeof(ElementHolder));
+      it->second->instance_wrapper->process_memory(range_visitor);
+      if (!range_visitor.is_found()) {
+        ++it;
+        continue;
+      }
+
+      InstanceDeepCopyVisitor detach_processor{context.memory_resource, ExtraRefCnt::for_instance_cache};
+      auto relocated_instance_wrapper = it->second->instance_wrapper->deep_copy_and_set_ref_cnt(detach_processor);
+      void* mem = relocated_instance_wrapper ? detach_processor.prepare_raw_memory(sizeof(ElementHolder)) : nullptr;
+      // there is no suitable freed piece for this element, but there may be for the others
+      if (!mem) {
+        ++it;
+        continue;
+      }
+      vk::intrusive_ptr<ElementHolder> element{new (mem) ElementHolder{*it->second, std::move(relocated_instance_wrapper)}};
+      // the key and the storage node are relocated as well
+      string relocated_key = it->first;
+      if (unlikely(!detach_processor.process(relocated_key) || !detach_processor.is_enough_memory_for(node_max_size))) {
+        InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(relocated_key);
+        ++it;
+        continue;
+      }
+
+      ic_debug("relocate '%s'\n", it->first.c_str());
+      previous_nodes.emplace_back(data.storage.extract(it++));
+      data.storage.emplace_hint(it, std::move(relocated_key), std::move(element));
+      context.stats.elements_relocated.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // this function should be called only from master
+  // spills the elements of the next shards, until about SWAP_SPILL_STEP_SIZE bytes are written; returns true when all the shards are spilled
+  bool spill_before_swap_step() noexcept {
+    update_now();
+    auto& current_data = data_manager_.get_current_resource();
+    size_t written = 0;
+    size_t spilled = 0;
+    const auto spill_element = [this, &written, &spilled](const string& key, const ElementHolder& element, uint64_t layout_hash, const string_buffer& serialized) {
+      const InstanceCacheSpillStore::ElementInfo info{layout_hash, element.stored_at.count(), element.expiring_at.count()};
+      if (spill_store_.put({key.c_str(), key.size()}, info, {serialized.buffer(), serialized.size()})) {
+        written += key.size() + serialized.size();
+        ++spilled;
+      }
+      return true;
+    };
+    for (; swap_spill_next_shard_id_ != current_data.get_data_shards_count() && written < SWAP_SPILL_STEP_SIZE; ++swap_spill_next_shard_id_) {
+      for_each_serialized_element_of_shard(current_data, swap_spill_next_shard_id_, spill_element);
+    }
+    current_data.get_context().stats.elements_spilled.fetch_add(spilled, std::memory_order_relaxed);
+    return swap_spill_next_shard_id_ == current_data.get_data_shards_count();
+  }
+
+  // this function should be called only from master
+  // calls f(key, element, layout_hash, serialized) for every live element of a @kphp-serializable class in the shard,
+  // it stops and returns false as soon as f returns false
+  template<class F>
+  bool for_each_serialized_element_of_shard(SharedMemoryData& current_data, size_t shard_id, F&& f) noexcept {
+    auto& data_shard = current_data.get_data_shards()[shard_id];
+    if (data_shard.is_storage_empty.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    const auto& handover_classes = HandoverClasses::get();
+    struct SerializedElement {
+      const string* key;
+      vk::intrusive_ptr<ElementHolder> element;
+      const InstanceCacheHandoverClass* handover_class;
+    };
+    std::vector<SerializedElement> elements;
+    {
+      // keys are removed only by the master, so it's safe to use them after the lock is released
+      std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
+      for (const auto& [key, element] : data_shard.storage) {
+        const auto* handover_class = handover_classes.find(*element->instance_wrapper);
+        if (handover_class && element->expiring_at > now_) {
+          elements.push_back({&key, element, handover_class});
+        }
+      }
+    }
+
+    // elements are released without the allocator lock, they go to the garbage
+    string_buffer serialized;
+    for (const auto& [key, element, handover_class] : elements) {
+      if (serialize_element(*handover_class, *element->instance_wrapper, serialized) && !f(*key, *element, handover_class->layout_hash, serialized)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool serialize_element(const InstanceCacheHandoverClass& handover_class, const InstanceCopyistBase& instance_wrapper, string_buffer& out) noexcept {
+    auto& sb_context = RuntimeContext::get().sb_lib_context;
+    out.clean();
+    sb_context.error_flag = STRING_BUFFER_ERROR_FLAG_ON;
+    const bool ok = handover_class.serialize(instance_wrapper, out) && sb_context.error_flag != STRING_BUFFER_ERROR_FLAG_FAILED;
+    sb_context.error_flag = STRING_BUFFER_ERROR_FLAG_OFF;
+    return ok;
+  }
+
+  // the element which doesn't fit the shared memory goes to the second tier, if the class can be serialized;
+  // returns true if it's spilled
+  bool spill(const string& key, const InstanceCopyistBase& instance_wrapper, int64_t ttl) noexcept {
+    const auto* handover_class = spill_store_.is_enabled() ? HandoverClasses::get().find(instance_wrapper) : nullptr;
+    if (!handover_class) {
+      return false;
+    }
+    update_now();
+    const auto expiring_at = ttl > 0 ? now_ + std::chrono::seconds{ttl} : std::chrono::nanoseconds::max();
+    string_buffer serialized;
+    if (serialize_element(*handover_class, instance_wrapper, serialized) &&
+        spill_store_.put({key.c_str(), key.size()}, {handover_class->layout_hash, now_.count(), expiring_at.count()},
+                         {serialized.buffer(), serialized.size()})) {
+      ic_debug("spill '%s'\n", key.c_str());
+      context_->stats.elements_spilled.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  // the stored element makes the spilled one outdated
+  void forget_spilled(const string& key) noexcept {
+    spill_store_.remove({key.c_str(), key.size()});
+  }
+
+  // the spilled element is unpacked into the script memory and promoted back to the shared memory
+  const InstanceCopyistBase* fetch_spilled(const string& key) noexcept {
+    if (!spill_store_.is_enabled()) {
+      return nullptr;
+    }
+    update_now();
+    const InstanceCacheHandoverClass* handover_class = nullptr;
+    std::chrono::nanoseconds expiring_at{0};
+    string serialized;
+    spill_store_.get({key.c_str(), key.size()}, [&](const InstanceCacheSpillStore::ElementInfo& info, std::string_view spilled) {
+      expiring_at = std::chrono::nanoseconds{info.expiring_at};
+      if (expiring_at > now_) {
+        handover_class = HandoverClasses::get().find(info.layout_hash);
+        serialized = string{spilled.data(), static_cast<string::size_type>(spilled.size())};
+      }
+    });
+    auto instance_wrapper = handover_class ? handover_class->deserialize(serialized) : nullptr;
+    if (!instance_wrapper) {
+      ic_debug("can't fetch '%s' because it is absent in the spill file\n", key.c_str());
+      context_->stats.elements_missed_in_spill.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    ic_debug("fetch '%s' from the spill file\n", key.c_str());
+    context_->stats.elements_fetched_from_spill.fetch_add(1, std::memory_order_relaxed);
+
+    const int64_t ttl =
+        expiring_at == std::chrono::nanoseconds::max() ? 0 : std::max(std::chrono::ceil<std::chrono::seconds>(expiring_at - now_).count(), int64_t{1});
+    if (promote_spilled(key, *instance_wrapper, ttl)) {
+      forget_spilled(key);
+      context_->stats.elements_promoted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    class_instance<DelayedInstance> fetched_instance;
+    fetched_instance.alloc().get()->instance_wrapper = std::move(instance_wrapper);
+    const auto* result = fetched_instance.get()->instance_wrapper.get();
+    fetched_from_spill_.push_back(std::move(fetched_instance));
+    return result;
+  }
+
+  // the spilled element is inserted only if the key is still absent:
+  // it's older than anything stored by the other workers after the miss
+  bool promote_spilled(const string& key, const InstanceCopyistBase& instance_wrapper, int64_t ttl) noexcept {
+    if (context_->memory_swap_required) {
+      return false;
+    }
+    auto& data = current_->get_data(key);
+    InstanceDeepCopyVisitor detach_processor{context_->memory_resource, ExtraRefCnt::for_instance_cache};
+    const ElementHolder* inserted_element = try_insert_element_into_cache(data, key, ttl, instance_wrapper, detach_processor, true);
+    if (!inserted_element) {
+      return false;
+    }
+    ic_debug("element '%s' was promoted from the spill file\n", key.c_str());
+    // request_cache_ uses a script memory
+    request_cache_.set_value(key, inserted_element);
+    return true;
+  }
+
   void fire_warning(const char* class_name) noexcept {
     php_warning("Memory limit exceeded on saving instance of class '%s' into cache", class_name);
     context_->memory_swap_required = true;
@@ -656,10 +1189,16 @@ private:
     int64_t ttl{0};
   };
   array<class_instance<DelayedInstance>> storing_delayed_;
+  // The elements fetched from the second tier, uses script memory
+  array<class_instance<DelayedInstance>> fetched_from_spill_;
+  InstanceCacheSpillStore spill_store_;
 
   std::chrono::nanoseconds now_{std::chrono::nanoseconds::zero()};
   memory_resource::MemoryStats last_memory_stats_;
   size_t purge_shard_offset_{0};
+  size_t compaction_shard_offset_{0};
+  // the shard to be spilled at the next step before the swap
+  size_t swap_spill_next_shard_id_{0};
 };
 
 std::string_view instance_cache_store_status_to_str(InstanceCacheOpStatus status) {
@@ -670,6 +1209,10 @@ std::string_view instance_cache_store_status_to_str(InstanceCacheOpStatus status
     return "skipped";
   case InstanceCacheOpStatus::memory_limit_exceeded:
     return "memory_limit_exceeded";
+  case InstanceCacheOpStatus::memory_swap_required:
+    return "memory_swap_required";
+  case InstanceCacheOpStatus::spilled:
+    return "spilled";
   case InstanceCacheOpStatus::delayed:
     return "delayed";
   case InstanceCacheOpStatus::not_found:
@@ -689,6 +1232,10 @@ const InstanceCopyistBase* instance_cache_fetch_wrapper(const string& key, bool
   return InstanceCache::get().fetch(key, even_if_expired);
 }
 
+void register_instance_cache_handover_class(const std::type_info& instance_wrapper_type, const InstanceCacheHandoverClass& handover_class) noexcept {
+  HandoverClasses::get().add(instance_wrapper_type, handover_class);
+}
+
 } // namespace impl_
 
 void global_init_instance_cache_lib() {
@@ -708,6 +1255,21 @@ void set_instance_cache_memory_limit(size_t limit) {
   impl_::instance_cache_settings.total_memory_limit = limit;
 }
 
+// should be called only from master
+void enable_instance_cache_online_compaction() {
+  impl_::instance_cache_settings.online_compaction = true;
+}
+
+// should be called only from master
+void set_instance_cache_spill_file(const char* path) {
+  impl_::instance_cache_settings.spill_file_path = path;
+}
+
+// should be called only from master
+void set_instance_cache_spill_size(size_t size) {
+  impl_::instance_cache_settings.spill_size = size;
+}
+
 // should be called only from master
 InstanceCacheSwapStatus instance_cache_try_swap_memory() {
   return impl_::InstanceCache::get().try_swap_memory_resource();
@@ -728,6 +1290,88 @@ void instance_cache_purge_expired_elements() {
   impl_::InstanceCache::get().purge_expired();
 }
 
+// should be called only from master
+void instance_cache_compact_memory() {
+  if (impl_::instance_cache_settings.online_compaction) {
+    impl_::InstanceCache::get().compact_memory();
+  }
+}
+
+static impl_::HandoverState instance_cache_handover_state;
+
+// should be called only from master
+std::optional<size_t> instance_cache_save_for_handover(const char* path) {
+  auto& state = instance_cache_handover_state;
+  // the new master must never see a partially written file
+  const std::string tmp_path = std::string{path} + ".tmp";
+  if (!state.file) {
+    // the file is created anew, so that it can't be a symlink or a file of someone else
+    unlink(tmp_path.c_str());
+    const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    state.file = fd != -1 ? fdopen(fd, "wb") : nullptr;
+    if (!state.file) {
+      kprintf("Can't create instance cache handover file '%s': %s\n", tmp_path.c_str(), strerror(errno));
+      if (fd != -1) {
+        close(fd);
+      }
+      return 0;
+    }
+  }
+
+  const auto status = impl_::InstanceCache::get().save_for_handover_step(state);
+  if (status == impl_::HandoverStepStatus::in_progress) {
+    return std::nullopt;
+  }
+  const size_t saved = state.elements;
+  const bool closed = fclose(state.file) == 0;
+  state = impl_::HandoverState{};
+  if (status != impl_::HandoverStepStatus::finished || !closed || rename(tmp_path.c_str(), path) != 0) {
+    kprintf("Can't save instance cache handover file '%s': %s\n", path, strerror(errno));
+    unlink(tmp_path.c_str());
+    return 0;
+  }
+  return saved;
+}
+
+// should be called only from master
+std::optional<size_t> instance_cache_load_handover(const char* path) {
+  auto& state = instance_cache_handover_state;
+  if (!state.file) {
+    const int fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1) {
+      kprintf("Can't open instance cache handover file '%s': %s\n", path, strerror(errno));
+      return 0;
+    }
+    // it's needed only once
+    unlink(path);
+    // the file must be created by the old master, that is run by the same user
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_uid != geteuid() || (file_stat.st_mode & 077) != 0) {
+      kprintf("Instance cache handover file '%s' is not a private file of this user, it's ignored\n", path);
+      close(fd);
+      return 0;
+    }
+    state.file = fdopen(fd, "rb");
+    if (!state.file) {
+      kprintf("Can't open instance cache handover file '%s': %s\n", path, strerror(errno));
+      close(fd);
+      return 0;
+    }
+  }
+
+  const auto status = impl_::InstanceCache::get().load_handover_step(state);
+  if (status == impl_::HandoverStepStatus::in_progress) {
+    return std::nullopt;
+  }
+  if (status == impl_::HandoverStepStatus::failed) {
+    kprintf("Instance cache handover file '%s' is broken, only %zu elements are loaded\n", path, state.elements);
+  }
+  const size_t loaded = state.elements;
+  fclose(state.file);
+  state = impl_::HandoverState{};
+  return loaded;
+}
+
 void instance_cache_release_all_resources_acquired_by_this_proc() {
   impl_::InstanceCache::get().force_release_all_resources();
 }
@@ -15,10 +15,22 @@
 //  5) On fetch, all instances (and sub instances) are deeply cloned from instance cache;
 //  6) All instances (with all members) are destroyed strictly before or after request,
 //    and shouldn't be destroyed while request.
+//  7) With the online compaction, the master moves the elements into the freed pieces of the memory in the background,
+//    so the fragmentation doesn't need the buffer swap, see instance_cache_compact_memory();
+//  8) On graceful restart, the old master hands the elements over to the new one in the msgpack format,
+//    so only instances of @kphp-serializable classes are passed, and only if the class layout is the same in both binaries;
+//    results of @kphp-memoize functions are not passed, they are bound to the confdata generation of the old master.
+//  9) With the spill file, the elements of @kphp-serializable classes which don't fit the memory (or are lost with the buffer swap)
+//    are kept in msgpack format on a local disk, a missed fetch looks them up there and promotes them back into the memory;
+//    the buffer is spilled before the swap in steps of a bounded size, instance_cache_try_swap_memory() swaps it after the last one.
+
+#include <optional>
+#include <typeinfo>
 
 #include "common/mixin/not_copyable.h"
 
 #include "runtime-common/core/runtime-core.h"
+#include "runtime-common/stdlib/serialization/msgpack-functions.h"
 #include "runtime-common/stdlib/visitors/memory-visitors.h"
 #include "runtime/instance-copy-processor.h"
 #include "server/statshouse/statshouse-manager.h"
@@ -31,6 +43,56 @@ std::string_view instance_cache_store_status_to_str(InstanceCacheOpStatus status
 InstanceCacheOpStatus instance_cache_store(const string& key, const InstanceCopyistBase& instance_wrapper, int64_t ttl);
 const InstanceCopyistBase* instance_cache_fetch_wrapper(const string& key, bool even_if_expired);
 
+struct InstanceCacheHandoverClass {
+  // see msgpack_layout_hash of the generated classes
+  uint64_t layout_hash;
+  bool (*serialize)(const InstanceCopyistBase& instance_wrapper, string_buffer& out) noexcept;
+  // uses the script memory
+  std::unique_ptr<InstanceCopyistBase> (*deserialize)(const string& serialized) noexcept;
+};
+
+void register_instance_cache_handover_class(const std::type_info& instance_wrapper_type, const InstanceCacheHandoverClass& handover_class) noexcept;
+
+template<typename ClassInstanceType, typename = void>
+struct InstanceCacheHandover {
+  static void ensure_registered() noexcept {}
+};
+
+// polymorphic instances are not handed over, as the stored instance may be of a derived class
+template<typename T>
+struct InstanceCacheHandover<class_instance<T>, std::enable_if_t<!std::is_polymorphic_v<T>, std::void_t<decltype(T::msgpack_layout_hash)>>> {
+  static void ensure_registered() noexcept {
+    static_cast<void>(registered);
+  }
+
+private:
+  using InstanceWrapper = InstanceCopyistImpl<class_instance<T>>;
+
+  static bool serialize(const InstanceCopyistBase& instance_wrapper, string_buffer& out) noexcept {
+    vk::msgpack::packer_float32_decorator::clear();
+    SerializationLibContext::get().instance_depth = 0;
+    vk::msgpack::packer{out}.pack(static_cast<const InstanceWrapper&>(instance_wrapper).get_instance());
+    return !vk::msgpack::CheckInstanceDepth::is_exceeded();
+  }
+
+  static std::unique_ptr<InstanceCopyistBase> deserialize(const string& serialized) noexcept {
+    SerializationLibContext::get().clear_msgpack_error();
+    vk::msgpack::unpacker unpacker{serialized};
+    unpacker.check_input();
+    if (unpacker.has_error()) {
+      return {};
+    }
+    auto instance = unpacker.unpack<class_instance<T>>();
+    if (unpacker.has_error() || instance.is_null()) {
+      return {};
+    }
+    return make_unique_on_script_memory<InstanceWrapper>(instance);
+  }
+
+  static inline const bool registered =
+      (register_instance_cache_handover_class(typeid(InstanceWrapper), InstanceCacheHandoverClass{T::msgpack_layout_hash, serialize, deserialize}), true);
+};
+
 } // namespace impl_
 
 void global_init_instance_cache_lib();
@@ -39,6 +101,12 @@ void free_instance_cache_lib();
 
 // these function should be called from master
 void set_instance_cache_memory_limit(size_t limit);
+// these function should be called from master
+void enable_instance_cache_online_compaction();
+// these function should be called from master
+void set_instance_cache_spill_file(const char* path);
+// these function should be called from master
+void set_instance_cache_spill_size(size_t size);
 
 struct InstanceCacheStats : private vk::not_copyable {
   std::atomic<uint64_t> elements_stored{0};
@@ -56,15 +124,24 @@ struct InstanceCacheStats : private vk::not_copyable {
   std::atomic<uint64_t> elements_created{0};
   std::atomic<uint64_t> elements_destroyed{0};
   std::atomic<uint64_t> elements_cached{0};
+  std::atomic<uint64_t> elements_handed_over{0};
+  std::atomic<uint64_t> elements_relocated{0};
+
+  std::atomic<uint64_t> elements_spilled{0};
+  std::atomic<uint64_t> elements_fetched_from_spill{0};
+  std::atomic<uint64_t> elements_missed_in_spill{0};
+  std::atomic<uint64_t> elements_promoted{0};
 };
 
 enum class InstanceCacheSwapStatus {
   no_need,          // no need to do a swap
+  swap_in_progress, // the elements are being spilled before the swap, it's continued on the next call
   swap_is_finished, // swap succeeded
   swap_is_forbidden // swap is not possible - the memory is still being used
 };
 
-enum class InstanceCacheOpStatus { success, skipped, memory_limit_exceeded, memory_swap_required, delayed, not_found, failed };
+// spilled: the element didn't fit the shared memory, but it's stored into the spill file
+enum class InstanceCacheOpStatus { success, skipped, memory_limit_exceeded, memory_swap_required, spilled, delayed, not_found, failed };
 
 // these function should be called from master
 InstanceCacheSwapStatus instance_cache_try_swap_memory();
@@ -74,6 +151,17 @@ const InstanceCacheStats& instance_cache_get_stats();
 const memory_resource::MemoryStats& instance_cache_get_memory_stats();
 // these function should be called from master
 void instance_cache_purge_expired_elements();
+// these function should be called from master
+// moves the elements from the end of the used memory into the freed pieces, if the online compaction is enabled and the memory is fragmented
+void instance_cache_compact_memory();
+// these function should be called from master
+// the old master on graceful restart saves the elements for the new one into a file in a private directory;
+// it's done in steps of a bounded size: std::nullopt is returned until it's done, then the number of the saved elements
+std::optional<size_t> instance_cache_save_for_handover(const char* path);
+// these function should be called from master
+// the new master on graceful restart loads the elements saved by the old one, in steps as well:
+// std::nullopt is returned until it's done, then the number of the loaded elements
+std::optional<size_t> instance_cache_load_handover(const char* path);
 
 void instance_cache_release_all_resources_acquired_by_this_proc();
 
@@ -91,6 +179,7 @@ bool f$instance_cache_store(const string& key, const ClassInstanceType& instance
   if (instance.is_null()) {
     return false;
   }
+  impl_::InstanceCacheHandover<ClassInstanceType>::ensure_registered();
   InstanceCopyistImpl<ClassInstanceType> instance_wrapper{instance};
   InstanceCacheOpStatus status = impl_::instance_cache_store(key, instance_wrapper, ttl);
   send_extended_instance_cache_stats_if_enabled("store", status, key, instance);
@@ -100,6 +189,7 @@ bool f$instance_cache_store(const string& key, const ClassInstanceType& instance
 template<typename ClassInstanceType>
 ClassInstanceType f$instance_cache_fetch(const string& class_name, const string& key, bool even_if_expired = false) {
   static_assert(is_class_instance<ClassInstanceType>::value, "class_instance<> type expected");
+  impl_::InstanceCacheHandover<ClassInstanceType>::ensure_registered();
   if (const auto* base_wrapper = impl_::instance_cache_fetch_wrapper(key, even_if_expired)) {
     // do not use first parameter (class name) for verifying type,
     // because different classes from separated libs may have same names
@@ -6,6 +6,7 @@
 
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include "common/mixin/not_copyable.h"
@@ -111,6 +112,13 @@ private:
 
 constexpr static uint32_t VISITED_INSTANCE_MASK{0x80000000};
 
+// see has_flat_fields of the generated classes
+template<class T, class = void>
+struct has_flat_fields : std::false_type {};
+
+template<class T>
+struct has_flat_fields<T, std::enable_if_t<T::has_flat_fields>> : std::true_type {};
+
 } // namespace impl_
 
 class InstanceReferencesCountingVisitor : impl_::InstanceDeepBasicVisitor<InstanceReferencesCountingVisitor> {
@@ -203,40 +211,68 @@ public:
     return is_enough_memory_for(size) ? memory_pool_.allocate(size) : nullptr;
   }
 
+  // is_tree means that no instance is reachable from the instance twice, e.g. it has been copied without meeting any shared instances
   template<class I>
-  bool process_instance(class_instance<I>& instance) noexcept {
+  bool process_instance(class_instance<I>& instance, bool is_tree = false) noexcept {
     class_instance<I> instance_copy = instance;
-    const bool result = process(instance);
+    is_tree_ = is_tree;
+    has_shared_instances_ = false;
+    // nothing inside a flat instance may refer to it
+    const bool result = copy_instance(instance, is_tree || impl_::has_flat_fields<I>{});
     copied_instances_table.clear();
     return result;
   }
 
+  // whether the last copied instance has met some instance more than once, see process_instance()
+  bool has_shared_instances() const noexcept {
+    return has_shared_instances_;
+  }
+
 private:
   template<class I>
   bool process(class_instance<I>& instance) noexcept {
     if (instance.is_null()) {
       return true;
     }
+    // if the original field and the field of the copy are the only references to the instance and the field may be reached once,
+    // nothing else refers to the instance, so it isn't looked up in the table
+    return copy_instance(instance, is_tree_ || (is_visited_once_ && instance.get_reference_counter() == 2));
+  }
 
-    auto& copied_instance_ptr = copied_instances_table[instance.get()->get_instance_data_raw_ptr()];
-
-    if (copied_instance_ptr) {
-      instance = class_instance<I>::create_from_base_raw_ptr(copied_instance_ptr);
+  template<class I>
+  bool copy_instance(class_instance<I>& instance, bool is_unique) noexcept {
+    if (instance.is_null()) {
       return true;
     }
 
+    void** copied_instance_ptr = nullptr;
+    if (!is_unique) {
+      copied_instance_ptr = &copied_instances_table[instance.get()->get_instance_data_raw_ptr()];
+      if (*copied_instance_ptr) {
+        instance = class_instance<I>::create_from_base_raw_ptr(*copied_instance_ptr);
+        has_shared_instances_ = true;
+        return true;
+      }
+    }
+
     if (unlikely(!is_enough_memory_for(instance.estimate_memory_usage()))) {
       instance = class_instance<I>{};
       return false;
     }
 
     instance = instance.virtual_builtin_clone();
-    copied_instance_ptr = instance.get_base_raw_ptr();
+    if (copied_instance_ptr) {
+      *copied_instance_ptr = instance.get_base_raw_ptr();
+    }
 
     if (const auto extra_ref_cnt = get_memory_ref_cnt()) {
       instance.set_reference_counter_to(extra_ref_cnt);
     }
-    return Basic::process(instance);
+    // every instance is copied once, so are its fields
+    const bool was_visited_once = std::exchange(is_visited_once_, true);
+    const bool res = Basic::process(instance);
+    is_visited_once_ = was_visited_once;
+    return res;
   }
 
   template<class T>
@@ -257,6 +293,8 @@ private:
       memory_limit_exceeded_ = true;
       return false;
     }
+    // arrays are copied on every reach, their elements may be reached once only if the array may be
+    const bool is_array_visited_once = is_visited_once_ && arr.get_reference_counter() == 2;
     // begin mutates array implicitly, therefore call it separately
     auto first = arr.begin();
     // mutates may make array as constant again (e.g. empty array), therefore check again
@@ -269,7 +307,13 @@ private:
       arr.set_reference_counter_to(extra_ref_cnt);
     }
     const bool primitive_array = is_primitive<T>{} && arr.has_no_string_keys();
-    return primitive_array || Basic::process_range(first, arr.end());
+    if (primitive_array) {
+      return true;
+    }
+    const bool was_visited_once = std::exchange(is_visited_once_, is_array_visited_once);
+    const bool res = Basic::process_range(first, arr.end());
+    is_visited_once_ = was_visited_once;
+    return res;
   }
 
   template<class T>
@@ -283,6 +327,10 @@ private:
   }
 
   bool memory_limit_exceeded_{false};
+  bool is_tree_{false};
+  // whether the currently copied value may be reached only once
+  bool is_visited_once_{false};
+  bool has_shared_instances_{false};
   memory_resource::unsynchronized_pool_resource& memory_pool_;
   ResourceCallbackOOM oom_callback_{nullptr};
 
@@ -314,9 +362,13 @@ public:
 
   bool process(string& str) noexcept;
 
+  // is_tree means that every instance inside is referenced once, see InstanceDeepCopyVisitor::has_shared_instances()
   template<class I>
-  bool process_instance(class_instance<I>& instance) noexcept {
-    InstanceReferencesCountingVisitor{instances_refcnt_table}.process_instance(instance);
+  bool process_instance(class_instance<I>& instance, bool is_tree = false) noexcept {
+    is_tree_ = is_tree;
+    if (!is_tree) {
+      InstanceReferencesCountingVisitor{instances_refcnt_table}.process_instance(instance);
+    }
     auto res = process(instance);
     instances_refcnt_table.clear();
     return res;
@@ -325,6 +377,7 @@ public:
 private:
   dl::CriticalSectionGuard guard; // as we use STL container
   std::unordered_map<void*, uint32_t> instances_refcnt_table;
+  bool is_tree_{false};
 
   template<typename I>
   bool process(class_instance<I>& instance) noexcept {
@@ -332,6 +385,13 @@ private:
       return true;
     }
 
+    if (is_tree_) {
+      Basic::process(instance);
+      instance.force_destroy(get_memory_ref_cnt());
+      instance = class_instance<I>{};
+      return true;
+    }
+
     uint32_t& refcnt_info = instances_refcnt_table[instance.get()->get_instance_data_raw_ptr()];
     if (refcnt_info & impl_::VISITED_INSTANCE_MASK) {
       refcnt_info ^= impl_::VISITED_INSTANCE_MASK;
@@ -346,11 +406,79 @@ private:
   }
 };
 
+// finds out whether any piece of memory taken by a value is placed in the given range,
+// e.g. the instance cache compaction relocates the elements having something in the memory to be freed
+class InstanceMemoryRangeVisitor : impl_::InstanceDeepBasicVisitor<InstanceMemoryRangeVisitor> {
+public:
+  friend class impl_::InstanceDeepBasicVisitor<InstanceMemoryRangeVisitor>;
+
+  using Basic = impl_::InstanceDeepBasicVisitor<InstanceMemoryRangeVisitor>;
+  using Basic::process;
+  using Basic::operator();
+
+  InstanceMemoryRangeVisitor(const void* range_begin, const void* range_end) noexcept
+      : Basic(*this),
+        range_begin_(static_cast<const char*>(range_begin)),
+        range_end_(static_cast<const char*>(range_end)) {}
+
+  void process_memory(const void* memory, size_t size) noexcept {
+    const auto* begin = static_cast<const char*>(memory);
+    is_found_ = is_found_ || (begin < range_end_ && begin + size > range_begin_);
+  }
+
+  bool process(const string& str) noexcept {
+    if (!str.is_reference_counter(ExtraRefCnt::for_global_const)) {
+      process_memory(str.c_str() - string::inner_sizeof(), str.estimate_memory_usage());
+    }
+    return true;
+  }
+
+  template<class T>
+  bool process(array<T>& arr) noexcept {
+    if (!arr.is_reference_counter(ExtraRefCnt::for_global_const)) {
+      // the identity is a bit further than the beginning of a map, the size covers it
+      process_memory(arr.get_inner_identity(), arr.estimate_memory_usage());
+      Basic::process_range(arr.begin_no_mutate(), arr.end_no_mutate());
+    }
+    return true;
+  }
+
+  template<class I>
+  bool process_instance(class_instance<I>& instance) noexcept {
+    process(instance);
+    processed_instances_.clear();
+    return true;
+  }
+
+  bool is_found() const noexcept {
+    return is_found_;
+  }
+
+private:
+  template<class I>
+  bool process(class_instance<I>& instance) noexcept {
+    if (instance.is_null() || !processed_instances_.insert(instance.get()->get_instance_data_raw_ptr()).second) {
+      return true;
+    }
+    process_memory(instance.get()->get_instance_data_raw_ptr(), instance.estimate_memory_usage());
+    return Basic::process(instance);
+  }
+
+  const char* range_begin_;
+  const char* range_end_;
+  bool is_found_{false};
+
+  dl::CriticalSectionGuard guard; // as we use STL container
+  std::unordered_set<void*> processed_instances_;
+};
+
 class InstanceCopyistBase : public ManagedThroughDlAllocator, vk::not_copyable {
 public:
   virtual const char* get_class() const noexcept = 0;
   virtual std::unique_ptr<InstanceCopyistBase> deep_copy_and_set_ref_cnt(InstanceDeepCopyVisitor& detach_processor) const noexcept = 0;
   virtual std::unique_ptr<InstanceCopyistBase> shallow_copy() const noexcept = 0;
+  // checks the memory of the wrapper and of the instance
+  virtual void process_memory(InstanceMemoryRangeVisitor& range_visitor) const noexcept = 0;
   virtual ~InstanceCopyistBase() noexcept = default;
 };
 
@@ -363,9 +491,10 @@ public:
   explicit InstanceCopyistImpl(const class_instance<I>& instance) noexcept
       : instance_(instance) {}
 
-  InstanceCopyistImpl(class_instance<I>&& instance, ExtraRefCnt memory_ref_cnt) noexcept
+  InstanceCopyistImpl(class_instance<I>&& instance, ExtraRefCnt memory_ref_cnt, bool is_tree) noexcept
       : instance_(std::move(instance)),
-        memory_ref_cnt_(memory_ref_cnt) {}
+        memory_ref_cnt_(memory_ref_cnt),
+        is_tree_(is_tree) {}
 
   const char* get_class() const noexcept final {
     return instance_.get_class();
@@ -373,7 +502,9 @@ public:
 
   std::unique_ptr<InstanceCopyistBase> deep_copy_and_set_ref_cnt(InstanceDeepCopyVisitor& detach_processor) const noexcept final {
     auto detached_instance = instance_;
-    detach_processor.process_instance(detached_instance);
+    // the copy of a tree is a tree as well, it doesn't need to be checked for the shared instances
+    detach_processor.process_instance(detached_instance, memory_ref_cnt_ && is_tree_);
+    const bool is_tree = !detach_processor.has_shared_instances();
 
     const auto memory_ref_cnt = detach_processor.get_memory_ref_cnt();
 
@@ -383,26 +514,34 @@ public:
       InstanceDeepDestroyVisitor{memory_ref_cnt}.process_instance(detached_instance);
       return {};
     }
-    return make_unique_on_script_memory<InstanceCopyistImpl<class_instance<I>>>(std::move(detached_instance), memory_ref_cnt);
+    return make_unique_on_script_memory<InstanceCopyistImpl<class_instance<I>>>(std::move(detached_instance), memory_ref_cnt, is_tree);
   }
 
   std::unique_ptr<InstanceCopyistBase> shallow_copy() const noexcept final {
     return make_unique_on_script_memory<InstanceCopyistImpl<class_instance<I>>>(instance_);
   }
 
+  void process_memory(InstanceMemoryRangeVisitor& range_visitor) const noexcept final {
+    range_visitor.process_memory(this, sizeof(*this));
+    auto instance = instance_;
+    range_visitor.process_instance(instance);
+  }
+
   class_instance<I> get_instance() const noexcept {
     return instance_;
   }
 
   ~InstanceCopyistImpl() noexcept final {
     if (memory_ref_cnt_ && !instance_.is_null()) {
-      InstanceDeepDestroyVisitor{static_cast<ExtraRefCnt::extra_ref_cnt_value>(memory_ref_cnt_)}.process_instance(instance_);
+      InstanceDeepDestroyVisitor{static_cast<ExtraRefCnt::extra_ref_cnt_value>(memory_ref_cnt_)}.process_instance(instance_, is_tree_);
     }
   }
 
 private:
   class_instance<I> instance_;
   const int memory_ref_cnt_{0};
+  // no instance is referenced twice inside, so the instance is destroyed without counting the references
+  const bool is_tree_{false};
 };
 
 template<class T>
@@ -2454,6 +2454,7 @@ static void free_runtime_libs() {
   vk::singleton<database_drivers::Adaptor>::get().reset();
   vk::singleton<curl_async::CurlAdaptor>::get().reset();
   hard_reset_var(SerializationLibContext::get().last_json_processor_error);
+  hard_reset_var(StringLibContext::get().strtr_matchers);
 
   // Confdata and InstanceCache MUST be freed at the very end
   // They call force_destroy() on runtime primitives inside, which forcibly sets refcnt to zero
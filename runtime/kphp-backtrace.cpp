@@ -149,22 +149,7 @@ array<string> f$kphp_backtrace(bool pretty) noexcept {
       continue;
     }
     string pretty_name{static_cast<string::size_type>(func_name.size()), true};
-    for (const auto* it = func_name.begin(); it != func_name.end();) {
-      const auto* next = std::next(it);
-      if (*it == '$') {
-        if (next != func_name.end() && *next == '$') {
-          pretty_name.append_unsafe("::", 2);
-          ++next;
-        } else {
-          pretty_name.append_unsafe("\\", 1);
-        }
-      } else if (*it == 'C' && next != func_name.end() && *next == '$') {
-        ++next;
-      } else {
-        pretty_name.append_unsafe(it, 1);
-      }
-      it = next;
-    }
+    prettify_php_function_name(func_name, [&pretty_name](const char* part, size_t size) { pretty_name.append_unsafe(part, size); });
     pretty_name.finish_append();
     backtrace.emplace_back(std::move(pretty_name));
   }
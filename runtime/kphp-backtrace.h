@@ -5,10 +5,13 @@
 #pragma once
 
 #include <array>
+#include <cctype>
 #include <forward_list>
+#include <iterator>
 
 #include "common/mixin/not_copyable.h"
 #include "common/wrappers/iterator_range.h"
+#include "common/wrappers/string_view.h"
 #include "runtime-common/core/runtime-core.h"
 
 class KphpBacktrace : vk::not_copyable {
@@ -41,6 +44,37 @@ private:
 
 array<string> f$kphp_backtrace(bool pretty = true) noexcept;
 
+// turns a demangled name of a compiled function without the f$ prefix into the PHP one, passing it to append(const char*, size_t) by parts:
+// ABC$Foo$$bar(class_instance<C$ABC$Baz> const&) -> ABC\Foo::bar(class_instance<ABC\Baz> const&)
+template<typename Append>
+void prettify_php_function_name(vk::string_view func_name, Append&& append) noexcept {
+  // the C$ prefix is skipped only in the beginning of a class name in the arguments, not in the names like ABC$Foo,
+  // the function name itself never has it, though it may start with a C namespace or class: C$$bar, C$Foo$$bar
+  auto starts_identifier = [&func_name](const char* it) {
+    if (it == func_name.begin()) {
+      return false;
+    }
+    const char prev = *std::prev(it);
+    return !std::isalnum(static_cast<unsigned char>(prev)) && prev != '_' && prev != '$';
+  };
+  for (const char* it = func_name.begin(); it != func_name.end();) {
+    const char* next = std::next(it);
+    if (*it == '$') {
+      if (next != func_name.end() && *next == '$') {
+        append("::", 2);
+        ++next;
+      } else {
+        append("\\", 1);
+      }
+    } else if (*it == 'C' && next != func_name.end() && *next == '$' && starts_identifier(it)) {
+      ++next;
+    } else {
+      append(it, 1);
+    }
+    it = next;
+  }
+}
+
 void parse_kphp_backtrace(char* buffer, size_t buffer_len, void* const* raw_backtrace, int backtrace_len);
 
 void free_kphp_backtrace() noexcept;
@@ -0,0 +1,15 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/memoize.h"
+
+#include "runtime/confdata-functions.h"
+
+string impl_::memoize_key_prefix(const char *func_name) noexcept {
+  string key{MEMOIZE_KEY_PREFIX};
+  key.append(func_name);
+  key.push_back(':');
+  key.append(static_cast<int64_t>(confdata_get_generation()));
+  return key;
+}
@@ -0,0 +1,59 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include "runtime-common/core/runtime-core.h"
+#include "runtime/instance-cache.h"
+
+// @kphp-memoize functions are codegenerated as `return memoize_call("f", [&] { body }, args...);`
+// results are placed into instance cache, so they survive requests and are shared between workers;
+// a key consists of a function name, a confdata generation and all arguments (the compiler allows only primitive ones),
+// so results calculated for a previous confdata are never reused (they are evicted by instance cache later)
+namespace impl_ {
+
+constexpr const char* MEMOIZE_KEY_PREFIX = "kphp_memoize:";
+
+string memoize_key_prefix(const char *func_name) noexcept;
+
+inline void memoize_append_key(string &key, int64_t arg) noexcept {
+  key.push_back(':');
+  key.append(arg);
+}
+
+inline void memoize_append_key(string &key, double arg) noexcept {
+  int64_t bits = 0;
+  std::memcpy(&bits, &arg, sizeof(bits));
+  memoize_append_key(key, bits);
+}
+
+inline void memoize_append_key(string &key, bool arg) noexcept {
+  key.push_back(':');
+  key.push_back(arg ? '1' : '0');
+}
+
+inline void memoize_append_key(string &key, const string &arg) noexcept {
+  memoize_append_key(key, int64_t{arg.size()});
+  key.push_back(':');
+  key.append(arg);
+}
+
+} // namespace impl_
+
+template<class F, class... Args>
+std::invoke_result_t<F> memoize_call(const char *func_name, F &&calc, const Args &...args) {
+  using ClassInstanceType = std::invoke_result_t<F>;
+  string key = impl_::memoize_key_prefix(func_name);
+  (impl_::memoize_append_key(key, args), ...);
+
+  ClassInstanceType result = f$instance_cache_fetch<ClassInstanceType>(string{func_name}, key);
+  if (result.is_null()) {
+    result = calc();
+    f$instance_cache_store(key, result);
+  }
+  return result;
+}
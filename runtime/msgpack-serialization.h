@@ -55,13 +55,13 @@ inline ResultType f$msgpack_deserialize(const string& buffer, string* out_err_ms
   const auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator();
   string err_msg;
   vk::msgpack::unpacker unpacker{buffer};
-  vk::msgpack::object obj = unpacker.unpack();
+  unpacker.check_input();
 
   if (unpacker.has_error()) {
-    // parsing or allocation errors
+    // parsing errors
     err_msg = unpacker.get_error_msg();
   } else {
-    auto res = obj.as<ResultType>();
+    auto res = unpacker.unpack<ResultType>();
     if (unpacker.has_error()) {
       // scheme compliance errors
       err_msg = unpacker.get_error_msg();
@@ -4,6 +4,8 @@
 
 #include "runtime/php-script-globals.h"
 
+#include <algorithm>
+
 static PhpScriptMutableGlobals php_script_mutable_globals_singleton;
 
 // actually, g_linear_mem is allocated and never freed (since workers live forever),
@@ -29,6 +31,29 @@ void PhpScriptMutableGlobals::once_alloc_linear_mem(unsigned int n_bytes) {
   memset(g_linear_mem, 0, n_bytes);
 }
 
+void PhpScriptMutableGlobals::once_alloc_batches(std::vector<unsigned int> batch_start_offsets) {
+  php_assert(dirty_batches.empty() && batch_start_offsets.size() >= 2);
+  dirty_batches.assign(batch_start_offsets.size() - 1, 1);
+  batch_offsets = std::move(batch_start_offsets);
+}
+
+void PhpScriptMutableGlobals::save_pristine_snapshot() {
+  php_assert(g_linear_mem != nullptr && !pristine_linear_mem && !batch_offsets.empty());
+  const unsigned int n_bytes = batch_offsets.back();
+  pristine_linear_mem = std::make_unique<char[]>(n_bytes);
+  memcpy(pristine_linear_mem.get(), g_linear_mem, n_bytes);
+  std::fill(dirty_batches.begin(), dirty_batches.end(), 0);
+}
+
+void PhpScriptMutableGlobals::restore_dirty_batches_from_snapshot() noexcept {
+  for (int batch_idx = 0; batch_idx < static_cast<int>(dirty_batches.size()); ++batch_idx) {
+    if (pop_batch_dirty(batch_idx)) {
+      const unsigned int offset = batch_offsets[batch_idx];
+      memcpy(g_linear_mem + offset, pristine_linear_mem.get() + offset, batch_offsets[batch_idx + 1] - offset);
+    }
+  }
+}
+
 void PhpScriptMutableGlobals::once_alloc_linear_mem(const char* lib_name, unsigned int n_bytes) {
   int64_t key_lib_name = string_hash(lib_name, strlen(lib_name));
   php_assert(libs_linear_mem.find(key_lib_name) == libs_linear_mem.end());
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "runtime-common/core/runtime-core.h"
 
@@ -29,17 +32,53 @@ struct PhpScriptBuiltInSuperGlobals {
 // on worker start, once_alloc_linear_mem() is called from codegen
 // it initializes g_linear_mem, and every mutable global access is codegenerated
 // as smth line `(*reinterpret_cast<T*>(&php_globals.mem()+offset))`
+//
+// globals are split into batches by the compiler (see GlobalsBatchedMem), and every batch has a dirty flag:
+// a function marks batches of globals it accesses as dirty on entry, and after a request
+// only dirty batches are reset (all flags are set initially, so that the first reset is full)
+//
+// the first reset on worker start runs codegenerated constructors and is saved as a pristine image of g_linear_mem;
+// further resets just copy dirty batches from this image: reset values never point to script memory
+// (they are either empty or refer to constants initialized in master), so the image stays valid
 class PhpScriptMutableGlobals {
   char* g_linear_mem{nullptr};
   std::unordered_map<int64_t, char*> libs_linear_mem;
+  std::vector<uint8_t> dirty_batches;
+  std::vector<unsigned int> batch_offsets; // n_batches + 1, the last one is the end of g_linear_mem
+  std::unique_ptr<char[]> pristine_linear_mem;
+  int n_batches_reset{0};
   PhpScriptBuiltInSuperGlobals superglobals;
 
+  // returns whether a batch should be reset and clears its flag
+  bool pop_batch_dirty(int batch_idx) noexcept {
+    if (!dirty_batches[batch_idx]) {
+      return false;
+    }
+    dirty_batches[batch_idx] = 0;
+    n_batches_reset++;
+    return true;
+  }
+
 public:
   static PhpScriptMutableGlobals& current();
   ~PhpScriptMutableGlobals();
 
   void once_alloc_linear_mem(unsigned int n_bytes);
   void once_alloc_linear_mem(const char* lib_name, unsigned int n_bytes);
+  void once_alloc_batches(std::vector<unsigned int> batch_start_offsets);
+
+  void mark_batch_dirty(int batch_idx) noexcept {
+    dirty_batches[batch_idx] = 1;
+  }
+  bool has_pristine_snapshot() const noexcept {
+    return pristine_linear_mem != nullptr;
+  }
+  void save_pristine_snapshot();
+  void restore_dirty_batches_from_snapshot() noexcept;
+
+  int get_and_clear_batches_reset_count() noexcept {
+    return std::exchange(n_batches_reset, 0);
+  }
 
   char* mem() const {
     return g_linear_mem;
@@ -57,6 +57,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         ${KPHP_RUNTIME_PDO_SOURCES}
         ${KPHP_RUNTIME_PDO_MYSQL_SOURCES}
         ${KPHP_RUNTIME_PDO_PGSQL_SOURCES}
+        allocation-profiler.cpp
         allocator.cpp
         context/runtime-core-allocator.cpp
         context/runtime-context.cpp
@@ -75,6 +76,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         exec.cpp
         files.cpp
         instance-cache.cpp
+        instance-cache-spill-store.cpp
         instance-copy-processor.cpp
         inter-process-mutex.cpp
         interface.cpp
@@ -85,6 +87,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         mail.cpp
         math_functions.cpp
         memcache.cpp
+        memoize.cpp
         memory_usage.cpp
         misc.cpp
         mysql.cpp
@@ -141,6 +144,7 @@ allow_deprecated_declarations_for_apple(${BASE_DIR}/runtime/inter-process-mutex.
 #### NO PIC
 vk_add_library_no_pic(kphp-runtime-no-pic STATIC ${KPHP_RUNTIME_ALL_SOURCES})
 target_include_directories(kphp-runtime-no-pic PUBLIC ${BASE_DIR})
+target_compile_options(kphp-runtime-no-pic PRIVATE ${RUNTIME_PROFILE_FLAGS})
 
 set(RUNTIME_LIBS_NO_PIC
         vk::no-pic::kphp-server
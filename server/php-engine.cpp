@@ -66,6 +66,8 @@
 #include "runtime-common/core/memory-resource/memory_resource.h"
 #include "runtime-common/stdlib/kml/models-context.h"
 #include "runtime-common/stdlib/serialization/json-functions.h"
+#include "runtime/allocation-profiler.h"
+#include "runtime/allocator.h"
 #include "runtime/interface.h"
 #include "runtime/kml.h"
 #include "runtime/profiler.h"
@@ -1632,6 +1634,9 @@ void start_server() {
 }
 
 void set_instance_cache_memory_limit(size_t limit);
+void enable_instance_cache_online_compaction();
+void set_instance_cache_spill_file(const char *path);
+void set_instance_cache_spill_size(size_t size);
 const char *get_php_scripts_version() noexcept;
 char **get_runtime_options(int *count) noexcept;
 
@@ -2246,6 +2251,60 @@ int main_args_handler(int i, const char *long_option) {
       runtime_builtins_stats::is_server_option_enabled = true;
       return 0;
     }
+    case 2043: {
+      enable_instance_cache_online_compaction();
+      return 0;
+    }
+    case 2044: {
+      set_instance_cache_spill_file(optarg);
+      return 0;
+    }
+    case 2045: {
+      int64_t instance_cache_spill_size = parse_memory_limit(optarg);
+      if (instance_cache_spill_size <= 0) {
+        kprintf("--%s option: couldn't parse argument\n", long_option);
+        return -1;
+      }
+      set_instance_cache_spill_size(static_cast<size_t>(instance_cache_spill_size));
+      return 0;
+    }
+    case 2046: {
+      const int64_t sample_size = parse_memory_limit(optarg);
+      if (sample_size <= 0) {
+        kprintf("--%s option: couldn't parse argument\n", long_option);
+        return -1;
+      }
+      allocation_profiler::set_sample_size(static_cast<size_t>(sample_size));
+      return 0;
+    }
+    case 2047: {
+      if (!*optarg || !allocation_profiler::set_dump_dir(optarg)) {
+        kprintf("--%s option: is not a writable directory\n", long_option);
+        return -1;
+      }
+      return 0;
+    }
+    case 2048: {
+      const int64_t memory_threshold = parse_memory_limit(optarg);
+      if (memory_threshold <= 0) {
+        kprintf("--%s option: couldn't parse argument\n", long_option);
+        return -1;
+      }
+      allocation_profiler::set_memory_threshold(static_cast<size_t>(memory_threshold));
+      return 0;
+    }
+    case 2049: {
+      double time_threshold_sec = 0;
+      const int res = read_option_to(long_option, 0.0, std::numeric_limits<double>::max(), time_threshold_sec);
+      allocation_profiler::set_time_threshold(time_threshold_sec);
+      return res;
+    }
+    case 2050: {
+      double bump_allocation_ratio = 0;
+      const int res = read_option_to(long_option, 0.0, 1.0, bump_allocation_ratio);
+      dl::set_bump_allocation_ratio(bump_allocation_ratio);
+      return res;
+    }
     default:
       return -1;
   }
@@ -2361,6 +2420,14 @@ void parse_main_args(int argc, char *argv[]) {
   parse_option("confdata-how-long-wait-binlog-until-alert", required_argument, 2040, "Time in seconds to wait before starting to alert if the next binlog part is not found");
   parse_option("kml-dir", required_argument, 2041, "Directory that contains .kml files");
   parse_option("enable-request-builtin-stats", no_argument, 2042, "Enables the recording of statistics for built-in function calls during request processing");
+  parse_option("instance-cache-online-compaction", no_argument, 2043, "compact the instance cache memory in the background instead of swapping the buffers on fragmentation");
+  parse_option("instance-cache-spill-file", required_argument, 2044, "a file on a local disk for the instance cache elements which don't fit the memory");
+  parse_option("instance-cache-spill-size", required_argument, 2045, "the size of the instance cache spill file (default: 4 times the instance cache memory limit)");
+  parse_option("allocation-profiler-sample-size", required_argument, 2046, "enables the sampling profiler of the script memory allocations: one sample per the given number of bytes on average");
+  parse_option("allocation-profiler-dir", required_argument, 2047, "a directory for the allocation profiles of the requests in folded stacks format (default: the current directory)");
+  parse_option("allocation-profiler-memory-threshold", required_argument, 2048, "dump the allocation profiles of the requests using at least the given amount of script memory");
+  parse_option("allocation-profiler-time-threshold", required_argument, 2049, "dump the allocation profiles of the requests running at least the given number of seconds");
+  parse_option("bump-allocation-ratio", required_argument, 2050, "the part of the script memory served by a bump pointer before falling back to the pooled allocation, from 0.0 to 1.0 (default: 0, disabled)");
 
 
   parse_engine_options_long(argc, argv, main_args_handler);
@@ -2378,6 +2445,7 @@ void init_default() {
     kprintf ("fatal: not enough workers for general purposes\n");
     exit(1);
   }
+  StatsHouseManager::get().init_aggregation(vk::singleton<WorkersControl>::get().get_total_workers_count());
   now = (int)time(nullptr);
 
   pid = getpid();
@@ -175,6 +175,8 @@ void master_init(master_data_t *me, master_data_t *other) {
   me->sent_http_fds_generation = 0;
 
   me->instance_cache_elements_cached = 0;
+  me->ask_instance_cache_handover_generation = 0;
+  me->sent_instance_cache_handover_generation = 0;
 
   me->is_alive = true; //NB: must be the last operation.
 }
@@ -37,7 +37,11 @@ struct master_data_t {
 
   uint16_t http_ports[HttpServerContext::MAX_PORTS];
 
-  int reserved[50 - 1 - HttpServerContext::MAX_PORTS / 2];
+  // they are zero for the masters without the instance cache handover, so such ones don't take part in it
+  int ask_instance_cache_handover_generation;
+  int sent_instance_cache_handover_generation;
+
+  int reserved[50 - 1 - HttpServerContext::MAX_PORTS / 2 - 2];
 };
 
 struct shared_data_t {
@@ -685,6 +685,7 @@ int run_worker(WorkerType worker_type) {
     ConfdataGlobalManager::get().force_release_all_resources_acquired_by_this_proc_if_init();
     vk::singleton<job_workers::SharedMemoryManager>::get().forcibly_release_all_attached_messages();
     vk::singleton<ServerStats>::get().after_fork(pid, active_special_connections, max_special_connections, worker_unique_id, worker_type);
+    StatsHouseManager::get().attach_worker(worker_unique_id, pid);
     return 1;
   }
 
@@ -1168,6 +1169,12 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, stats_tag_kphp_server) {
   stats->add_gauge_stat(instance_cache_element_stats.elements_created, "instance_cache.elements.created");
   stats->add_gauge_stat(instance_cache_element_stats.elements_destroyed, "instance_cache.elements.destroyed");
   stats->add_gauge_stat(instance_cache_element_stats.elements_cached, "instance_cache.elements.cached");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_handed_over, "instance_cache.elements.handed_over");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_relocated, "instance_cache.elements.relocated");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_spilled, "instance_cache.elements.spilled");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_fetched_from_spill, "instance_cache.elements.fetched_from_spill");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_missed_in_spill, "instance_cache.elements.missed_in_spill");
+  stats->add_gauge_stat(instance_cache_element_stats.elements_promoted, "instance_cache.elements.promoted");
   stats->add_gauge_stat(instance_cache_element_stats.elements_logically_expired_and_ignored, "instance_cache.elements.logically_expired_and_ignored");
   stats->add_gauge_stat(instance_cache_element_stats.elements_logically_expired_but_fetched, "instance_cache.elements.logically_expired_but_fetched");
 
@@ -1237,6 +1244,22 @@ void run_master_off_in_graceful_shutdown() {
   }
 }
 
+// the file name is predictable, so it's kept in a directory that only the user running the masters can access;
+// an empty path is returned if there is no such directory
+static std::string get_instance_cache_handover_path() {
+  const std::string dir = std::string{P_tmpdir} + "/" + vk::singleton<MasterName>::get().get_master_name() + "_kphp_instance_cache";
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    kprintf("Can't create instance cache handover directory '%s': %s\n", dir.c_str(), strerror(errno));
+    return {};
+  }
+  struct stat dir_stat {};
+  if (lstat(dir.c_str(), &dir_stat) != 0 || !S_ISDIR(dir_stat.st_mode) || dir_stat.st_uid != geteuid() || (dir_stat.st_mode & 077) != 0) {
+    kprintf("Instance cache handover directory '%s' must be a directory accessible only by its owner\n", dir.c_str());
+    return {};
+  }
+  return dir + "/handover";
+}
+
 void run_master_off_in_graceful_restart() {
   kprintf("master off in graceful restart\n");
   assert (other->is_alive);
@@ -1249,6 +1272,17 @@ void run_master_off_in_graceful_restart() {
     changed = 1;
   }
 
+  if (other->is_alive && other->ask_instance_cache_handover_generation > me->sent_instance_cache_handover_generation) {
+    static const std::string handover_path = get_instance_cache_handover_path();
+    // it's saved in steps, the new master is told when it's done
+    const std::optional<size_t> saved = handover_path.empty() ? 0 : instance_cache_save_for_handover(handover_path.c_str());
+    if (saved.has_value()) {
+      tvkprintf(graceful_restart, 1, "Graceful restart: %zu instance cache elements are saved for new master\n", *saved);
+      me->sent_instance_cache_handover_generation = static_cast<int>(generation);
+    }
+    changed = 1;
+  }
+
   if (other->to_kill_generation > me->generation) {
     // old master kills as many workers as new master told
     general_workers_to_kill = other->to_kill;
@@ -1355,6 +1389,21 @@ void run_master_on() {
     job_workers_to_run = control.get_count(WorkerType::job_worker) - control.get_alive_count(WorkerType::job_worker);
 
     if (other->is_alive) {
+      // the old master saves its instance cache on request, so we don't need to wait until the workers fill ours
+      static bool instance_cache_handover_loaded = false;
+      if (me->ask_instance_cache_handover_generation == 0) {
+        me->ask_instance_cache_handover_generation = static_cast<int>(generation);
+        changed = 1;
+      } else if (!instance_cache_handover_loaded && other->sent_instance_cache_handover_generation > me->ask_instance_cache_handover_generation) {
+        static const std::string handover_path = get_instance_cache_handover_path();
+        // it's loaded in steps, one per iteration
+        const std::optional<size_t> loaded = handover_path.empty() ? 0 : instance_cache_load_handover(handover_path.c_str());
+        if (loaded.has_value()) {
+          tvkprintf(graceful_restart, 1, "Graceful restart: %zu instance cache elements are loaded from old master\n", *loaded);
+          instance_cache_handover_loaded = true;
+        }
+      }
+
       auto &warm_up_ctx = WarmUpContext::get();
       warm_up_ctx.try_start_warmup();
 
@@ -1400,6 +1449,7 @@ int signal_epoll_handler(int fd, void *data __attribute__((unused)), event_t *ev
 void check_and_instance_cache_try_swap_memory() {
   switch(instance_cache_try_swap_memory()) {
     case InstanceCacheSwapStatus::no_need:
+    case InstanceCacheSwapStatus::swap_in_progress:
       return;
     case InstanceCacheSwapStatus::swap_is_finished:
       kprintf("instance cache memory resource successfully swapped\n");
@@ -1423,6 +1473,7 @@ static void master_cron() {
   create_all_outbound_connections();
   vk::singleton<ServerStats>::get().aggregate_stats();
   StatsHouseManager::get().generic_cron();
+  StatsHouseManager::get().flush_aggregated_metrics();
 
   unsigned long long cpu_total = 0;
   unsigned long long utime = 0;
@@ -1462,6 +1513,7 @@ static void master_cron() {
   vk::singleton<SharedData>::get().store_worker_stats({general_workers_stat.running_workers, general_workers_stat.waiting_workers,
                                                         general_workers_stat.ready_for_accept_workers, general_workers_stat.total_workers});
   instance_cache_purge_expired_elements();
+  instance_cache_compact_memory();
   check_and_instance_cache_try_swap_memory();
   confdata_binlog_update_cron();
   tvkprintf(master_process, 3, "master process cron work [utime = %llu, stime = %llu, alive_workers_count = %d]. "
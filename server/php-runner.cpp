@@ -23,6 +23,7 @@
 #include "common/wrappers/overloaded.h"
 #include "common/ucontext/ucontext-portable.h"
 #include "runtime-common/stdlib/tracing/tracing-functions.h"
+#include "runtime/allocation-profiler.h"
 #include "runtime/allocator.h"
 #include "runtime/critical_section.h"
 #include "runtime/curl.h"
@@ -384,6 +385,7 @@ void PhpScript::finish() noexcept {
 
   vk::singleton<ServerStats>::get().add_request_stats(script_time, net_time, script_max_running_interval, script_init_time_sec, connection_process_time_sec,
                                                       queries_cnt, long_queries_cnt, script_mem_stats, runtime_builtins_stats::request_stats, vk::singleton<CurlMemoryUsage>::get().total_allocated, script_rusage, error_type);
+  allocation_profiler::on_script_finish(script_time, script_mem_stats);
   if (save_state == run_state_t::error) {
     assert (error_message != nullptr);
     kprintf("Critical error during script execution: %s\n", error_message);
@@ -422,7 +424,9 @@ void PhpScript::finish() noexcept {
 
 void PhpScript::clear() noexcept {
   assert_state(run_state_t::uncleared);
+  const double reset_start_time = dl_time();
   run_main->clear(PhpScriptMutableGlobals::current());
+  vk::singleton<ServerStats>::get().add_globals_reset_stats(dl_time() - reset_start_time, PhpScriptMutableGlobals::current().get_and_clear_batches_reset_count());
   free_runtime_environment(PhpScriptMutableGlobals::current().get_superglobals());
   state = run_state_t::empty;
   if (use_madvise_dontneed) {
@@ -88,6 +88,14 @@ struct JobCommonMemorySamples : WithStatType<uint64_t> {
   };
 };
 
+struct GlobalsResetSamples : WithStatType<uint64_t> {
+  enum class Key {
+    reset_time = 0,
+    batches_reset,
+    types_count
+  };
+};
+
 struct MallocStat : WithStatType<uint64_t> {
   enum class Key {
     non_mmaped_allocated_bytes = 0,
@@ -300,7 +308,8 @@ public:
 
 struct WorkerSharedStats : private vk::not_copyable {
   explicit WorkerSharedStats(std::mt19937 *gen) noexcept:
-    script_samples(gen) {
+    script_samples(gen),
+    globals_reset_samples(gen) {
   }
 
   void add_request_stats(const EnumTable<QueriesStat> &queries, script_error_t error,
@@ -331,10 +340,22 @@ struct WorkerSharedStats : private vk::not_copyable {
     script_samples.add_sample(sample);
   }
 
+  void add_globals_reset_stats(uint64_t reset_time_ns, uint64_t batches_reset) noexcept {
+    EnumTable<GlobalsResetSamples> sample;
+    sample[GlobalsResetSamples::Key::reset_time] = reset_time_ns;
+    sample[GlobalsResetSamples::Key::batches_reset] = batches_reset;
+    for (size_t i = 0; i != sample.size(); ++i) {
+      total_globals_reset_stat[i].fetch_add(sample[i], std::memory_order_relaxed);
+    }
+    globals_reset_samples.add_sample(sample);
+  }
+
   std::array<std::atomic<uint32_t>, static_cast<size_t>(script_error_t::errors_count)> errors{};
 
   EnumTable<QueriesStat, std::atomic<QueriesStat::StatType>> total_queries_stat;
   SharedSamplesBundle<ScriptSamples> script_samples;
+  EnumTable<GlobalsResetSamples, std::atomic<GlobalsResetSamples::StatType>> total_globals_reset_stat;
+  SharedSamplesBundle<GlobalsResetSamples> globals_reset_samples;
 };
 
 struct JobWorkerSharedStats : WorkerSharedStats {
@@ -557,12 +578,14 @@ struct WorkerPercentilesBundle : EnumTable<E, Percentiles<typename E::StatType>>
 
 struct WorkerAggregatedStats {
   explicit WorkerAggregatedStats(std::mt19937 *gen) noexcept:
-    script_samples(gen) {
+    script_samples(gen),
+    globals_reset_samples(gen) {
   }
 
-  void recalc(SharedSamplesBundle<ScriptSamples> &script_shared_samples, std::chrono::steady_clock::time_point now_tp,
+  void recalc(WorkerSharedStats &shared_stats, std::chrono::steady_clock::time_point now_tp,
               const WorkerProcessStats &stats, uint16_t first_id, uint16_t last_id) noexcept {
-    script_samples.recalc(script_shared_samples, now_tp);
+    script_samples.recalc(shared_stats.script_samples, now_tp);
+    globals_reset_samples.recalc(shared_stats.globals_reset_samples, now_tp);
     heap_samples.recalc(stats.heap_stats, first_id, last_id);
     malloc_samples.recalc(stats.malloc_stats, first_id, last_id);
     vm_samples.recalc(stats.vm_stats, first_id, last_id);
@@ -570,6 +593,7 @@ struct WorkerAggregatedStats {
   }
 
   AggregatedSamplesBundle<ScriptSamples> script_samples;
+  AggregatedSamplesBundle<GlobalsResetSamples> globals_reset_samples;
   WorkerSamplesBundle<MallocStat> malloc_samples;
   WorkerSamplesBundle<HeapStat> heap_samples;
   WorkerSamplesBundle<VMStat> vm_samples;
@@ -676,6 +700,12 @@ void ServerStats::add_job_common_memory_stats(int64_t common_request_memory_used
   StatsHouseManager::get().add_job_common_memory_stats(common_request_memory_used, common_request_real_memory_used);
 }
 
+void ServerStats::add_globals_reset_stats(double reset_time_sec, int64_t batches_reset) noexcept {
+  auto &stats = worker_type_ == WorkerType::job_worker ? shared_stats_->job_workers : shared_stats_->general_workers;
+  const auto reset_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(reset_time_sec));
+  stats.add_globals_reset_stats(reset_time.count(), batches_reset);
+}
+
 void ServerStats::update_this_worker_stats() noexcept {
   const auto now_tp = std::chrono::steady_clock::now();
   if (now_tp - last_update_aggr_stats >= std::chrono::seconds{5}) {
@@ -712,12 +742,12 @@ void ServerStats::aggregate_stats() noexcept {
   const uint16_t general_workers = workers_control.get_count(WorkerType::general_worker);
   const uint16_t job_workers = workers_control.get_count(WorkerType::job_worker);
 
-  aggregated_stats_->general_workers.recalc(shared_stats_->general_workers.script_samples, now_tp,
+  aggregated_stats_->general_workers.recalc(shared_stats_->general_workers, now_tp,
                                             shared_stats_->workers, 0, general_workers);
 
   aggregated_stats_->job_workers.job_samples.recalc(shared_stats_->job_workers.job_samples, now_tp);
   aggregated_stats_->job_workers.job_common_memory_samples.recalc(shared_stats_->job_workers.job_common_memory_samples, now_tp);
-  aggregated_stats_->job_workers.recalc(shared_stats_->job_workers.script_samples, now_tp,
+  aggregated_stats_->job_workers.recalc(shared_stats_->job_workers, now_tp,
                                         shared_stats_->workers, general_workers, job_workers + general_workers);
 
   aggregated_stats_->master_process.vm_stats = get_virtual_memory_stat();
@@ -771,6 +801,8 @@ void write_to(stats_t *stats, const char *prefix, const WorkerAggregatedStats &a
   stats->add_gauge_stat(ns2double(shared.total_queries_stat[QueriesStat::Key::net_time]), prefix, ".requests.net_time.total");
   stats->add_gauge_stat(ns2double(shared.total_queries_stat[QueriesStat::Key::script_init_time]), prefix, ".requests.script_init_time.total");
   stats->add_gauge_stat(ns2double(shared.total_queries_stat[QueriesStat::Key::http_connection_process_time]), prefix, ".requests.http_connection_process_time.total");
+  stats->add_gauge_stat(ns2double(shared.total_globals_reset_stat[GlobalsResetSamples::Key::reset_time]), prefix, ".requests.globals_reset_time.total");
+  stats->add_gauge_stat(shared.total_globals_reset_stat[GlobalsResetSamples::Key::batches_reset], prefix, ".requests.globals_reset_batches.total");
   stats->add_gauge_stat(shared.total_queries_stat[QueriesStat::Key::incoming_queries], prefix, ".requests.total_incoming_queries");
   stats->add_gauge_stat(shared.total_queries_stat[QueriesStat::Key::outgoing_queries], prefix, ".requests.total_outgoing_queries");
   stats->add_gauge_stat(shared.total_queries_stat[QueriesStat::Key::outgoing_long_queries], prefix, ".requests.total_outgoing_long_queries");
@@ -790,6 +822,8 @@ void write_to(stats_t *stats, const char *prefix, const WorkerAggregatedStats &a
   write_to(stats, prefix, ".requests.script_voluntary_context_switches", agg.script_samples[ScriptSamples::Key::voluntary_context_switches]);
   write_to(stats, prefix, ".requests.script_involuntary_context_switches", agg.script_samples[ScriptSamples::Key::involuntary_context_switches]);
   write_to(stats, prefix, ".requests.working_time", agg.script_samples[ScriptSamples::Key::working_time], ns2double);
+  write_to(stats, prefix, ".requests.globals_reset_time", agg.globals_reset_samples[GlobalsResetSamples::Key::reset_time], ns2double);
+  write_to(stats, prefix, ".requests.globals_reset_batches", agg.globals_reset_samples[GlobalsResetSamples::Key::batches_reset]);
   write_to(stats, prefix, ".memory.script_usage", agg.script_samples[ScriptSamples::Key::memory_used]);
   write_to(stats, prefix, ".memory.script_real_usage", agg.script_samples[ScriptSamples::Key::real_memory_used]);
   write_to(stats, prefix, ".memory.script_allocated_total", agg.script_samples[ScriptSamples::Key::memory_allocated_total]);
@@ -28,6 +28,7 @@ public:
   void add_job_stats(double job_wait_time_sec, int64_t request_memory_used, int64_t request_real_memory_used, int64_t response_memory_used,
                      int64_t response_real_memory_used) noexcept;
   void add_job_common_memory_stats(int64_t common_request_memory_used, int64_t common_request_real_memory_used) noexcept;
+  void add_globals_reset_stats(double reset_time_sec, int64_t batches_reset) noexcept;
   void update_this_worker_stats() noexcept;
   void update_active_connections(uint64_t active_connections, uint64_t max_connections) noexcept;
 
@@ -0,0 +1,326 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/statshouse/statshouse-aggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+#include "common/wrappers/memory-utils.h"
+
+namespace {
+
+constexpr uint64_t IDLE_EPOCH = std::numeric_limits<uint64_t>::max();
+constexpr size_t MAX_WAITING_ITERATIONS = 1000;
+
+// the key is serialized as the force_tag_host flag followed by the name and the tags separated by zeros
+size_t serialize_key(const StatsHouseAggregator::MetricKey &key, std::array<char, StatsHouseAggregator::MAX_KEY_LENGTH> &buffer) noexcept {
+  size_t length = 0;
+  buffer[length++] = key.force_tag_host ? '\1' : '\0';
+  auto append = [&buffer, &length](std::string_view part) noexcept {
+    if (part.size() >= buffer.size() - length || part.find('\0') != std::string_view::npos) {
+      return false;
+    }
+    std::memcpy(buffer.data() + length, part.data(), part.size());
+    length += part.size();
+    buffer[length++] = '\0';
+    return true;
+  };
+  if (!append(key.name)) {
+    return 0;
+  }
+  for (size_t i = 0; i != key.tags_count; ++i) {
+    if (!append(key.tags[i])) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+uint64_t hash_key(std::string_view key, StatsHouseAggregator::MetricKind kind) noexcept {
+  // FNV-1a, zero is reserved for empty entries
+  uint64_t hash = 14695981039346656037ULL ^ static_cast<uint64_t>(kind);
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+  }
+  return hash != 0 ? hash : 1;
+}
+
+} // namespace
+
+struct StatsHouseAggregator::WorkerSlot {
+  struct Entry {
+    uint64_t hash;
+    double count;
+    double sum;
+    double min;
+    double max;
+    uint32_t samples_count;
+    uint16_t key_length;
+    MetricKind kind;
+    std::array<double, WORKER_SAMPLES> samples;
+    std::array<char, MAX_KEY_LENGTH> key;
+
+    std::string_view get_key() const noexcept {
+      return {key.data(), key_length};
+    }
+  };
+
+  struct Table {
+    uint32_t used;
+    uint32_t capacity;
+    // the entries are mapped by master before fork, so the pointer is valid in all processes
+    Entry *entries;
+
+    Entry *find_or_insert(std::string_view key, MetricKind kind, uint64_t hash) noexcept {
+      for (size_t i = 0; i != capacity; ++i) {
+        Entry &entry = entries[(hash + i) % capacity];
+        if (entry.hash == 0) {
+          // tables are never filled completely to keep the probe sequences short
+          if (used >= capacity * 3 / 4) {
+            return nullptr;
+          }
+          ++used;
+          entry.hash = hash;
+          entry.count = 0;
+          entry.sum = 0;
+          entry.min = std::numeric_limits<double>::infinity();
+          entry.max = -std::numeric_limits<double>::infinity();
+          entry.samples_count = 0;
+          entry.kind = kind;
+          entry.key_length = static_cast<uint16_t>(key.size());
+          std::memcpy(entry.key.data(), key.data(), key.size());
+          return &entry;
+        }
+        if (entry.hash == hash && entry.kind == kind && entry.get_key() == key) {
+          return &entry;
+        }
+      }
+      return nullptr;
+    }
+
+    void clear() noexcept {
+      // the untouched pages of large tables are not written to stay unpopulated
+      for (size_t i = 0; i != capacity; ++i) {
+        if (entries[i].hash != 0) {
+          entries[i].hash = 0;
+        }
+      }
+      used = 0;
+    }
+  };
+
+  // the epoch of the table being written by the worker right now
+  std::atomic<uint64_t> writing_epoch{IDLE_EPOCH};
+  std::array<Table, 2> tables;
+};
+
+struct StatsHouseAggregator::Storage {
+  std::atomic<uint64_t> epoch{0};
+};
+
+void StatsHouseAggregator::init(uint16_t workers_count, size_t entries_per_table) noexcept {
+  assert(!storage_);
+  static_assert(alignof(WorkerSlot::Entry) <= alignof(WorkerSlot));
+  void *memory = mmap_shared(sizeof(Storage) + sizeof(WorkerSlot) * workers_count + sizeof(WorkerSlot::Entry) * entries_per_table * 2 * workers_count);
+  storage_ = new (memory) Storage{};
+  workers_ = reinterpret_cast<WorkerSlot *>(storage_ + 1);
+  workers_count_ = workers_count;
+  // the entries are left default initialized, the mapped memory is zeroed and populated lazily
+  auto *entries = reinterpret_cast<WorkerSlot::Entry *>(workers_ + workers_count_);
+  for (size_t i = 0; i != workers_count_; ++i) {
+    auto *slot = new (workers_ + i) WorkerSlot;
+    for (WorkerSlot::Table &table : slot->tables) {
+      table.capacity = static_cast<uint32_t>(entries_per_table);
+      table.entries = entries;
+      entries += entries_per_table;
+    }
+  }
+}
+
+void StatsHouseAggregator::attach_worker(uint16_t worker_unique_id, uint64_t seed) noexcept {
+  if (storage_) {
+    assert(worker_unique_id < workers_count_);
+    worker_slot_ = workers_ + worker_unique_id;
+    gen_.seed(seed);
+  }
+}
+
+bool StatsHouseAggregator::add(const MetricKey &key, MetricKind kind, double value) noexcept {
+  if (!worker_slot_) {
+    return false;
+  }
+  std::array<char, MAX_KEY_LENGTH> buffer;
+  const size_t key_length = serialize_key(key, buffer);
+  if (key_length == 0) {
+    return false;
+  }
+  const std::string_view serialized_key{buffer.data(), key_length};
+  const uint64_t hash = hash_key(serialized_key, kind);
+
+  // announce the epoch we are going to write into and make sure the master hasn't bumped it meanwhile,
+  // then the master either sees our epoch and waits for us, or we see its new epoch
+  uint64_t epoch = storage_->epoch.load();
+  while (true) {
+    worker_slot_->writing_epoch.store(epoch);
+    const uint64_t current_epoch = storage_->epoch.load();
+    if (current_epoch == epoch) {
+      break;
+    }
+    epoch = current_epoch;
+  }
+
+  WorkerSlot::Entry *entry = worker_slot_->tables[epoch % 2].find_or_insert(serialized_key, kind, hash);
+  if (entry) {
+    if (kind == MetricKind::count) {
+      entry->count += value;
+    } else {
+      entry->sum += value;
+      entry->min = std::min(entry->min, value);
+      entry->max = std::max(entry->max, value);
+      // reservoir sampling: every value ends up in the sample with the same probability
+      if (entry->samples_count < WORKER_SAMPLES) {
+        entry->samples[entry->samples_count++] = value;
+      } else {
+        const auto i = std::uniform_int_distribution<uint64_t>{0, static_cast<uint64_t>(entry->count)}(gen_);
+        if (i < WORKER_SAMPLES) {
+          entry->samples[i] = value;
+        }
+      }
+      entry->count += 1;
+    }
+  }
+
+  worker_slot_->writing_epoch.store(IDLE_EPOCH, std::memory_order_release);
+  return entry != nullptr;
+}
+
+std::vector<StatsHouseAggregator::AggregatedMetric> StatsHouseAggregator::collect() noexcept {
+  if (!storage_) {
+    return {};
+  }
+
+  struct MergedMetric {
+    MetricKind kind{MetricKind::count};
+    double count{0};
+    double sum{0};
+    double min{std::numeric_limits<double>::infinity()};
+    double max{-std::numeric_limits<double>::infinity()};
+    // the values with the number of events each of them represents
+    std::vector<std::pair<double, double>> weighted_samples;
+  };
+  std::unordered_map<std::string, MergedMetric> merged;
+
+  const uint64_t epoch = storage_->epoch.fetch_add(1);
+  for (size_t worker_id = 0; worker_id != workers_count_; ++worker_id) {
+    WorkerSlot &slot = workers_[worker_id];
+    // a worker may still write into the table of an older epoch with the same parity if it has been stopped for a while
+    auto is_writing_table = [&slot, epoch] {
+      const uint64_t writing_epoch = slot.writing_epoch.load();
+      return writing_epoch != IDLE_EPOCH && writing_epoch % 2 == epoch % 2;
+    };
+    for (size_t i = 0; i != MAX_WAITING_ITERATIONS && is_writing_table(); ++i) {
+      std::this_thread::yield();
+    }
+    if (is_writing_table()) {
+      // the worker is stuck or has been killed in the middle of writing, the table will be read on one of the next rounds
+      continue;
+    }
+
+    WorkerSlot::Table &table = slot.tables[epoch % 2];
+    if (table.used == 0) {
+      continue;
+    }
+    for (size_t i = 0; i != table.capacity; ++i) {
+      const WorkerSlot::Entry &entry = table.entries[i];
+      if (entry.hash == 0) {
+        continue;
+      }
+      std::string key{entry.get_key()};
+      key.push_back(static_cast<char>(entry.kind));
+      auto &metric = merged[std::move(key)];
+      metric.kind = entry.kind;
+      metric.count += entry.count;
+      if (entry.samples_count != 0) {
+        metric.sum += entry.sum;
+        metric.min = std::min(metric.min, entry.min);
+        metric.max = std::max(metric.max, entry.max);
+        const double weight = entry.count / entry.samples_count;
+        for (size_t j = 0; j != entry.samples_count; ++j) {
+          metric.weighted_samples.emplace_back(entry.samples[j], weight);
+        }
+      }
+    }
+    table.clear();
+  }
+
+  std::vector<AggregatedMetric> result;
+  result.reserve(merged.size());
+  for (auto &[key, metric] : merged) {
+    AggregatedMetric &aggregated = result.emplace_back();
+    aggregated.kind = metric.kind;
+    aggregated.count = metric.count;
+    aggregated.force_tag_host = key.front() == '\1';
+
+    // skip the flag in the beginning and the kind in the end, every part is terminated by zero
+    std::string_view parts{key.data() + 1, key.size() - 2};
+    const size_t name_end = parts.find('\0');
+    aggregated.name = parts.substr(0, name_end);
+    parts.remove_prefix(name_end + 1);
+    while (!parts.empty()) {
+      const size_t tag_end = parts.find('\0');
+      aggregated.tags.emplace_back(parts.substr(0, tag_end));
+      parts.remove_prefix(tag_end + 1);
+    }
+
+    auto &samples = metric.weighted_samples;
+    if (samples.empty()) {
+      continue;
+    }
+    aggregated.sum = metric.sum;
+    aggregated.min = metric.min;
+    aggregated.max = metric.max;
+    const bool all_values_kept = std::all_of(samples.begin(), samples.end(), [](const auto &sample) { return sample.second == 1; });
+    if (all_values_kept && samples.size() <= MASTER_SAMPLES) {
+      for (const auto &sample : samples) {
+        aggregated.values.push_back(sample.first);
+      }
+    } else {
+      // workers' samples represent different numbers of events, so they are resampled according to their weights;
+      // the extremes are lost by sampling, so they are sent explicitly instead of two samples
+      std::vector<double> weights;
+      weights.reserve(samples.size());
+      for (const auto &sample : samples) {
+        weights.push_back(sample.second);
+      }
+      std::discrete_distribution<size_t> distribution{weights.begin(), weights.end()};
+      aggregated.values.push_back(metric.min);
+      aggregated.values.push_back(metric.max);
+      double values_sum = metric.min + metric.max;
+      for (size_t i = 2; i != MASTER_SAMPLES; ++i) {
+        values_sum += aggregated.values.emplace_back(samples[distribution(gen_)].first);
+      }
+      // statshouse restores the sum as the mean of the values multiplied by count, so the samples are shifted evenly to keep it exact,
+      // the clamped ones pass the rest of the shift to the others
+      double deficit = metric.sum / metric.count * MASTER_SAMPLES - values_sum;
+      for (size_t pass = 0; pass != MASTER_SAMPLES && std::abs(deficit) > 1e-9 * std::max(1.0, std::abs(metric.sum)); ++pass) {
+        const double shift = deficit / (MASTER_SAMPLES - 2);
+        for (size_t i = 2; i != MASTER_SAMPLES; ++i) {
+          double &value = aggregated.values[i];
+          const double shifted = std::clamp(value + shift, metric.min, metric.max);
+          deficit -= shifted - value;
+          value = shifted;
+        }
+      }
+    }
+  }
+  return result;
+}
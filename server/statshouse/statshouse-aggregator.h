@@ -0,0 +1,142 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2026 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "server/statshouse/statshouse-client.h"
+
+/**
+ * Per-request metrics are not sent by workers directly: every worker records them into its own slot in shared memory,
+ * where they are pre-aggregated by (metric, tags), and the master merges the slots of all workers and sends the result
+ * once per cron tick. Counters are summed, values are kept as the number of events, their sum, min, max and a reservoir sample.
+ *
+ * Each slot has two tables, the worker writes into the table of the current epoch, and the master bumps the epoch
+ * before reading the table of the previous one. The handshake is lock-free, so a killed worker can't block the master.
+ */
+class StatsHouseAggregator : vk::not_copyable {
+public:
+  static constexpr size_t MAX_KEY_LENGTH{128};
+  static constexpr size_t MAX_TAGS{16};
+  static constexpr size_t DEFAULT_ENTRIES_PER_TABLE{128};
+  // the number of values kept per (metric, tags) by a worker and sent per (metric, tags) by the master
+  static constexpr size_t WORKER_SAMPLES{8};
+  static constexpr size_t MASTER_SAMPLES{64};
+
+  enum class MetricKind : uint8_t { count, value };
+
+  struct MetricKey {
+    std::string_view name;
+    bool force_tag_host{false};
+    std::array<std::string_view, MAX_TAGS> tags{};
+    size_t tags_count{0};
+  };
+
+  struct AggregatedMetric {
+    std::string name;
+    std::vector<std::string> tags;
+    bool force_tag_host{false};
+    MetricKind kind{MetricKind::count};
+    // the sum of counts for counters, the number of events for values
+    double count{0};
+    // for values only, exact
+    double sum{0};
+    double min{0};
+    double max{0};
+    // for values only, if it's smaller than count, it's a sample of the values, which always contains min and max
+    // and has the same mean as all the values have, as long as it's possible
+    std::vector<double> values;
+  };
+
+  /**
+   * Must be called from master process only, before workers are forked
+   */
+  void init(uint16_t workers_count, size_t entries_per_table = DEFAULT_ENTRIES_PER_TABLE) noexcept;
+
+  bool is_initialized() const noexcept {
+    return storage_ != nullptr;
+  }
+
+  void attach_worker(uint16_t worker_unique_id, uint64_t seed) noexcept;
+
+  // return false if the metric can't be aggregated, it should be sent directly then
+  bool add_count(const MetricKey &key, double count) noexcept {
+    return add(key, MetricKind::count, count);
+  }
+
+  bool add_value(const MetricKey &key, double value) noexcept {
+    return add(key, MetricKind::value, value);
+  }
+
+  /**
+   * Must be called from master process only
+   */
+  std::vector<AggregatedMetric> collect() noexcept;
+
+private:
+  struct Storage;
+  struct WorkerSlot;
+
+  bool add(const MetricKey &key, MetricKind kind, double value) noexcept;
+
+  Storage *storage_{nullptr};
+  WorkerSlot *workers_{nullptr};
+  uint16_t workers_count_{0};
+  WorkerSlot *worker_slot_{nullptr};
+  std::mt19937_64 gen_;
+};
+
+/**
+ * The same interface as statshouse::TransportUDPBase::MetricBuilder has:
+ * a metric is recorded into the aggregator of the worker or sent directly if it can't be aggregated.
+ */
+class AggregatedMetricBuilder {
+public:
+  AggregatedMetricBuilder(StatsHouseAggregator &aggregator, StatsHouseClient &client, std::string_view name, bool force_tag_host) noexcept
+    : aggregator_(aggregator)
+    , client_(client) {
+    key_.name = name;
+    key_.force_tag_host = force_tag_host;
+  }
+
+  AggregatedMetricBuilder &tag(std::string_view str) noexcept {
+    if (key_.tags_count < key_.tags.size()) {
+      key_.tags[key_.tags_count++] = str;
+    }
+    return *this;
+  }
+
+  void write_count(double count) noexcept {
+    if (!aggregator_.add_count(key_, count)) {
+      make_client_metric().write_count(count);
+    }
+  }
+
+  void write_value(double value) noexcept {
+    if (!aggregator_.add_value(key_, value)) {
+      make_client_metric().write_value(value);
+    }
+  }
+
+private:
+  statshouse::TransportUDPBase::MetricBuilder make_client_metric() const noexcept {
+    auto builder = client_.metric(key_.name, key_.force_tag_host);
+    for (size_t i = 0; i != key_.tags_count; ++i) {
+      builder.tag(key_.tags[i]);
+    }
+    return builder;
+  }
+
+  StatsHouseAggregator &aggregator_;
+  StatsHouseClient &client_;
+  StatsHouseAggregator::MetricKey key_;
+};
@@ -64,7 +64,8 @@ const char *script_error_to_str(script_error_t error) {
 } // namespace
 
 StatsHouseManager::StatsHouseManager(const std::string &ip, int port)
-  : client(ip, port){};
+  : client(ip, port)
+  , aggregation_enabled(!ip.empty()){};
 
 void StatsHouseManager::set_common_tags() {
   const auto &config = vk::singleton<ServerConfig>::get();
@@ -110,6 +111,25 @@ void StatsHouseManager::generic_cron_check_if_tag_host_needed() {
   }
 }
 
+void StatsHouseManager::flush_aggregated_metrics() noexcept {
+  flush_aggregated_metrics(aggregator);
+  flush_aggregated_metrics(builtin_stats_aggregator);
+}
+
+void StatsHouseManager::flush_aggregated_metrics(StatsHouseAggregator &from) noexcept {
+  for (const auto &metric : from.collect()) {
+    auto builder = client.metric(metric.name, metric.force_tag_host);
+    for (const auto &tag : metric.tags) {
+      builder.tag(tag);
+    }
+    if (metric.kind == StatsHouseAggregator::MetricKind::count) {
+      builder.write_count(metric.count);
+    } else {
+      builder.write_values(metric.values.data(), metric.values.size(), metric.count);
+    }
+  }
+}
+
 void StatsHouseManager::add_request_stats(uint64_t script_time_ns, uint64_t net_time_ns, uint64_t script_max_running_interval_ns,  script_error_t error,
                                           const memory_resource::MemoryStats &script_memory_stats, const std::optional<runtime_builtins_stats::request_stats_t> &builtin_stats,
                                           uint64_t script_queries, uint64_t long_script_queries,
@@ -119,73 +139,76 @@ void StatsHouseManager::add_request_stats(uint64_t script_time_ns, uint64_t net_
   const char *worker_type = get_current_worker_type();
   const char *status = script_error_to_str(error);
 
-  client.metric("kphp_request_time").tag("script").tag(worker_type).tag(status).write_value(script_time_ns);
-  client.metric("kphp_request_time").tag("net").tag(worker_type).tag(status).write_value(net_time_ns);
-  client.metric("kphp_request_script_time_max_running_interval").tag(worker_type).tag(status).write_value(script_max_running_interval_ns);
-  client.metric("kphp_request_cpu_time").tag("user").tag(worker_type).tag(status).write_value(script_user_time_ns);
-  client.metric("kphp_request_cpu_time").tag("system").tag(worker_type).tag(status).write_value(script_system_time_ns);
-  client.metric("kphp_request_init_time").tag(worker_type).tag(status).write_value(script_init_time);
+  aggregated_metric("kphp_request_time").tag("script").tag(worker_type).tag(status).write_value(script_time_ns);
+  aggregated_metric("kphp_request_time").tag("net").tag(worker_type).tag(status).write_value(net_time_ns);
+  aggregated_metric("kphp_request_script_time_max_running_interval").tag(worker_type).tag(status).write_value(script_max_running_interval_ns);
+  aggregated_metric("kphp_request_cpu_time").tag("user").tag(worker_type).tag(status).write_value(script_user_time_ns);
+  aggregated_metric("kphp_request_cpu_time").tag("system").tag(worker_type).tag(status).write_value(script_system_time_ns);
+  aggregated_metric("kphp_request_init_time").tag(worker_type).tag(status).write_value(script_init_time);
   if (process_type == ProcessType::http_worker) {
-    client.metric("kphp_http_connection_process_time").tag(status).write_value(http_connection_process_time);
+    aggregated_metric("kphp_http_connection_process_time").tag(status).write_value(http_connection_process_time);
   }
 
-  client.metric("kphp_by_host_request_time", true).tag("script").tag(worker_type).write_value(script_time_ns);
-  client.metric("kphp_by_host_request_time", true).tag("net").tag(worker_type).write_value(net_time_ns);
-  client.metric("kphp_by_host_request_cpu_time", true).tag("user").tag(worker_type).tag(status).write_value(script_user_time_ns);
-  client.metric("kphp_by_host_request_cpu_time", true).tag("system").tag(worker_type).tag(status).write_value(script_system_time_ns);
-  client.metric("kphp_by_host_request_init_time", true).tag(worker_type).tag(status).write_value(script_init_time);
+  aggregated_metric("kphp_by_host_request_time", true).tag("script").tag(worker_type).write_value(script_time_ns);
+  aggregated_metric("kphp_by_host_request_time", true).tag("net").tag(worker_type).write_value(net_time_ns);
+  aggregated_metric("kphp_by_host_request_cpu_time", true).tag("user").tag(worker_type).tag(status).write_value(script_user_time_ns);
+  aggregated_metric("kphp_by_host_request_cpu_time", true).tag("system").tag(worker_type).tag(status).write_value(script_system_time_ns);
+  aggregated_metric("kphp_by_host_request_init_time", true).tag(worker_type).tag(status).write_value(script_init_time);
   if (process_type == ProcessType::http_worker) {
-    client.metric("kphp_by_host_http_connection_process_time", true).tag(status).write_value(http_connection_process_time);
+    aggregated_metric("kphp_by_host_http_connection_process_time", true).tag(status).write_value(http_connection_process_time);
   }
 
   if (error != script_error_t::no_error) {
-    client.metric("kphp_request_errors").tag(status).tag(worker_type).write_count(1);
-    client.metric("kphp_by_host_request_errors", true).tag(status).tag(worker_type).write_count(1);
+    aggregated_metric("kphp_request_errors").tag(status).tag(worker_type).write_count(1);
+    aggregated_metric("kphp_by_host_request_errors", true).tag(status).tag(worker_type).write_count(1);
   }
 
   if (builtin_stats.has_value()) {
     for (const auto& [builtin_name, call_number] : (*builtin_stats).builtin_stats) {
-      client.metric("kphp_request_builtin_stats").tag(builtin_name).write_value(call_number);
+      AggregatedMetricBuilder{builtin_stats_aggregator, client, "kphp_request_builtin_stats", false}.tag(builtin_name).write_value(call_number);
     }
     for (const auto& [virtual_builtin_name, call_number] : (*builtin_stats).virtual_builtin_stats) {
-      client.metric("kphp_request_builtin_stats").tag(virtual_builtin_name.c_str()).write_value(call_number);
+      AggregatedMetricBuilder{builtin_stats_aggregator, client, "kphp_request_builtin_stats", false}.tag(virtual_builtin_name.c_str()).write_value(call_number);
     }
   }
 
-  client.metric("kphp_memory_script_usage").tag("used").tag(worker_type).write_value(script_memory_stats.memory_used);
-  client.metric("kphp_memory_script_usage").tag("real_used").tag(worker_type).write_value(script_memory_stats.real_memory_used);
+  aggregated_metric("kphp_memory_script_usage").tag("used").tag(worker_type).write_value(script_memory_stats.memory_used);
+  aggregated_metric("kphp_memory_script_usage").tag("real_used").tag(worker_type).write_value(script_memory_stats.real_memory_used);
 
-  client.metric("kphp_by_host_memory_script_usage", true).tag("used").tag(worker_type).write_value(script_memory_stats.memory_used);
-  client.metric("kphp_by_host_memory_script_usage", true).tag("real_used").tag(worker_type).write_value(script_memory_stats.real_memory_used);
+  aggregated_metric("kphp_by_host_memory_script_usage", true).tag("used").tag(worker_type).write_value(script_memory_stats.memory_used);
+  aggregated_metric("kphp_by_host_memory_script_usage", true).tag("real_used").tag(worker_type).write_value(script_memory_stats.real_memory_used);
 
-  client.metric("kphp_memory_script_allocated_total").tag(worker_type).write_value(script_memory_stats.total_memory_allocated);
-  client.metric("kphp_memory_script_allocations_count").tag(worker_type).write_value(script_memory_stats.total_allocations);
+  aggregated_metric("kphp_memory_script_allocated_total").tag(worker_type).write_value(script_memory_stats.total_memory_allocated);
+  aggregated_metric("kphp_memory_script_allocations_count").tag(worker_type).write_value(script_memory_stats.total_allocations);
+  if (script_memory_stats.bump_allocations || script_memory_stats.bump_mode_fallbacks) {
+    aggregated_metric("kphp_memory_script_bump_mode").tag(worker_type).tag(script_memory_stats.bump_mode_fallbacks ? "fallback" : "bump").write_count(1);
+  }
 
-  client.metric("kphp_requests_outgoing_queries").tag(worker_type).write_value(script_queries);
-  client.metric("kphp_requests_outgoing_long_queries").tag(worker_type).write_value(long_script_queries);
+  aggregated_metric("kphp_requests_outgoing_queries").tag(worker_type).write_value(script_queries);
+  aggregated_metric("kphp_requests_outgoing_long_queries").tag(worker_type).write_value(long_script_queries);
 
-  client.metric("kphp_request_scheduler_context_switches").tag("voluntary").tag(status).write_value(voluntary_context_switches);
-  client.metric("kphp_request_scheduler_context_switches").tag("involuntary").tag(status).write_value(involuntary_context_switches);
+  aggregated_metric("kphp_request_scheduler_context_switches").tag("voluntary").tag(status).write_value(voluntary_context_switches);
+  aggregated_metric("kphp_request_scheduler_context_switches").tag("involuntary").tag(status).write_value(involuntary_context_switches);
 
-  client.metric("kphp_by_host_request_scheduler_context_switches", true).tag("voluntary").tag(status).write_value(voluntary_context_switches);
-  client.metric("kphp_by_host_request_scheduler_context_switches", true).tag("involuntary").tag(status).write_value(involuntary_context_switches);
+  aggregated_metric("kphp_by_host_request_scheduler_context_switches", true).tag("voluntary").tag(status).write_value(voluntary_context_switches);
+  aggregated_metric("kphp_by_host_request_scheduler_context_switches", true).tag("involuntary").tag(status).write_value(involuntary_context_switches);
 }
 
 void StatsHouseManager::add_job_stats(uint64_t job_wait_ns, uint64_t request_memory_used, uint64_t request_real_memory_used, uint64_t response_memory_used,
                                      uint64_t response_real_memory_used) {
-  client.metric("kphp_job_queue_time").write_value(job_wait_ns);
+  aggregated_metric("kphp_job_queue_time").write_value(job_wait_ns);
 
-  client.metric("kphp_job_request_memory_usage").tag("used").write_value(request_memory_used);
-  client.metric("kphp_job_request_memory_usage").tag("real_used").write_value(request_real_memory_used);
+  aggregated_metric("kphp_job_request_memory_usage").tag("used").write_value(request_memory_used);
+  aggregated_metric("kphp_job_request_memory_usage").tag("real_used").write_value(request_real_memory_used);
 
-  client.metric("kphp_job_response_memory_usage").tag("used").write_value(response_memory_used);
-  client.metric("kphp_job_response_memory_usage").tag("real_used").write_value(response_real_memory_used);
+  aggregated_metric("kphp_job_response_memory_usage").tag("used").write_value(response_memory_used);
+  aggregated_metric("kphp_job_response_memory_usage").tag("real_used").write_value(response_real_memory_used);
 }
 
 void StatsHouseManager::add_job_common_memory_stats(uint64_t job_common_request_memory_used, uint64_t job_common_request_real_memory_used) {
   dl::CriticalSectionGuard guard; // It's called from script context, so we need to ensure SIGALRM won't interrupt us here
-  client.metric("kphp_job_common_request_memory").tag("used").write_value(job_common_request_memory_used);
-  client.metric("kphp_job_common_request_memory").tag("real_used").write_value(job_common_request_real_memory_used);
+  aggregated_metric("kphp_job_common_request_memory").tag("used").write_value(job_common_request_memory_used);
+  aggregated_metric("kphp_job_common_request_memory").tag("real_used").write_value(job_common_request_real_memory_used);
 }
 
 void StatsHouseManager::add_worker_memory_stats(const mem_info_t &mem_stats) {
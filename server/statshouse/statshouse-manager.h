@@ -14,6 +14,7 @@
 #include "runtime/runtime-builtin-stats.h"
 #include "server/job-workers/job-stats.h"
 #include "server/php-queries.h"
+#include "server/statshouse/statshouse-aggregator.h"
 #include "server/statshouse/statshouse-client.h"
 #include "server/workers-control.h"
 #include "server/workers-stats.h"
@@ -36,6 +37,29 @@ public:
 
   void set_common_tags();
 
+  /**
+   * Must be called from master process only, before workers are forked
+   */
+  void init_aggregation(uint16_t workers_count) noexcept {
+    if (aggregation_enabled) {
+      aggregator.init(workers_count);
+      if (runtime_builtins_stats::is_server_option_enabled) {
+        builtin_stats_aggregator.init(workers_count, BUILTIN_STATS_ENTRIES_PER_TABLE);
+      }
+    }
+  }
+
+  // per-request metrics of the worker are pre-aggregated in shared memory and sent by master
+  void attach_worker(uint16_t worker_unique_id, uint64_t seed) noexcept {
+    aggregator.attach_worker(worker_unique_id, seed);
+    builtin_stats_aggregator.attach_worker(worker_unique_id, seed);
+  }
+
+  /**
+   * Must be called from master process only
+   */
+  void flush_aggregated_metrics() noexcept;
+
   // Runs in master and workers cron with 1 sec period
   void generic_cron() {
     generic_cron_check_if_tag_host_needed();
@@ -98,6 +122,11 @@ public:
 
 private:
   StatsHouseClient client;
+  // builtin stats have a key per called builtin, so they have their own larger tables not to push out the other metrics
+  static constexpr size_t BUILTIN_STATS_ENTRIES_PER_TABLE = 1024;
+  StatsHouseAggregator aggregator;
+  StatsHouseAggregator builtin_stats_aggregator;
+  bool aggregation_enabled = false;
   bool need_write_enable_tag_host = false;
   normalization_function instance_cache_key_normalization_function = nullptr;
 
@@ -112,6 +141,12 @@ private:
 
   void generic_cron_check_if_tag_host_needed();
 
+  AggregatedMetricBuilder aggregated_metric(std::string_view name, bool force_tag_host = false) noexcept {
+    return {aggregator, client, name, force_tag_host};
+  }
+
+  void flush_aggregated_metrics(StatsHouseAggregator &from) noexcept;
+
   void add_job_workers_shared_memory_stats(const job_workers::JobStats &job_stats);
 
   size_t add_job_workers_shared_messages_stats(const job_workers::JobStats::MemoryBufferStats &memory_buffers_stats,
@@ -0,0 +1,67 @@
+<?php
+
+class BenchmarkJsonDecode {
+  /** @var string[] */
+  private $corpus = [];
+
+  public function __construct() {
+    $users = [];
+    for ($i = 0; $i < 500; $i++) {
+      $users[] = [
+        'id' => 1000000 + $i,
+        'first_name' => "Имя $i",
+        'last_name' => "Фамилия \"$i\"",
+        'is_closed' => $i % 7 === 0,
+        'photo' => "https://example.com/photos/$i/photo_200.jpg",
+        'counters' => ['friends' => $i * 3, 'followers' => $i * 11, 'groups' => null],
+        'tags' => ['tag' . ($i % 10), 'tag' . ($i % 13), 'tag' . ($i % 17)],
+      ];
+    }
+    $this->corpus['api_response'] = json_encode(['response' => ['count' => count($users), 'items' => $users]]);
+
+    $matrix = [];
+    for ($i = 0; $i < 200; $i++) {
+      $row = [];
+      for ($j = 0; $j < 50; $j++) {
+        $row[] = $i * $j - 5000;
+      }
+      $matrix[] = $row;
+    }
+    $this->corpus['numbers'] = json_encode($matrix);
+
+    $texts = [];
+    for ($i = 0; $i < 100; $i++) {
+      $texts["post_$i"] = str_repeat("Lorem ipsum dolor sit amet, \"consectetur\" adipiscing elit\\n\ttab ", 20) . "\u{1F600}";
+    }
+    $this->corpus['long_strings'] = json_encode($texts);
+
+    $deep = 'leaf';
+    for ($i = 0; $i < 100; $i++) {
+      $deep = ['level' => $i, 'next' => $deep, 'siblings' => [$i, "$i", [$i]]];
+    }
+    $this->corpus['deep'] = json_encode($deep);
+
+    // decoding must not change anything
+    foreach ($this->corpus as $name => $json) {
+      if (json_encode(json_decode($json, true)) !== $json) {
+        throw new Exception("json_decode() result differs for $name");
+      }
+    }
+  }
+
+  public function benchmarkApiResponse() {
+    return json_decode($this->corpus['api_response'], true);
+  }
+
+  public function benchmarkNumbers() {
+    return json_decode($this->corpus['numbers'], true);
+  }
+
+  public function benchmarkLongStrings() {
+    return json_decode($this->corpus['long_strings'], true);
+  }
+
+  public function benchmarkDeep() {
+    return json_decode($this->corpus['deep'], true);
+  }
+}
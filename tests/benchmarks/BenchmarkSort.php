@@ -0,0 +1,69 @@
+<?php
+
+class BenchmarkSort {
+  /** @var int[] */
+  private $ids = [];
+  /** @var int[] */
+  private $sorted_ids = [];
+  /** @var float[] */
+  private $scores = [];
+  /** @var float[] */
+  private $scores_by_id = [];
+  /** @var string[] */
+  private $names = [];
+
+  public function __construct() {
+    mt_srand(42);
+    for ($i = 0; $i < 100000; $i++) {
+      $id = mt_rand(1, 2000000000);
+      $this->ids[] = $id;
+      $this->scores[] = mt_rand() / mt_getrandmax() - 0.5;
+      $this->scores_by_id[$id] = mt_rand(0, 1000) / 10;
+      $this->names[] = 'user_' . mt_rand();
+    }
+    $this->sorted_ids = $this->ids;
+    sort($this->sorted_ids);
+  }
+
+  public function benchmarkSortIds() {
+    $ids = $this->ids;
+    sort($ids);
+    return $ids[0];
+  }
+
+  public function benchmarkSortSortedIds() {
+    $ids = $this->sorted_ids;
+    sort($ids);
+    return $ids[0];
+  }
+
+  public function benchmarkRsortScores() {
+    $scores = $this->scores;
+    rsort($scores);
+    return $scores[0];
+  }
+
+  public function benchmarkArsortScoresById() {
+    $scores = $this->scores_by_id;
+    arsort($scores);
+    return count($scores);
+  }
+
+  public function benchmarkKsortIds() {
+    $scores = $this->scores_by_id;
+    ksort($scores);
+    return count($scores);
+  }
+
+  public function benchmarkSortNames() {
+    $names = $this->names;
+    sort($names, SORT_STRING);
+    return $names[0];
+  }
+
+  public function benchmarkUsortIds() {
+    $ids = $this->ids;
+    usort($ids, function(int $lhs, int $rhs) { return $lhs <=> $rhs; });
+    return $ids[0];
+  }
+}
@@ -0,0 +1,64 @@
+<?php
+
+class BenchmarkStrtr {
+  const ENTITIES = [
+    '&' => '&amp;', '<' => '&lt;', '>' => '&gt;', '"' => '&quot;', "'" => '&#039;',
+    '<<' => '&laquo;', '>>' => '&raquo;', '--' => '&mdash;', '(c)' => '&copy;', '(r)' => '&reg;',
+  ];
+
+  /** @var string[] */
+  private $placeholders = [];
+  private $text = '';
+  private $template = '';
+
+  public function __construct() {
+    for ($i = 0; $i < 200; $i++) {
+      $this->placeholders["{var$i}"] = "value_$i";
+    }
+    $this->text = str_repeat('Tom & Jerry say <<hello>> -- "see" (c) it\'s <b>bold</b>. ', 100);
+    $this->template = str_repeat('Dear {var1}, your order {var17} of {var150} is {var199}. {var2}{var20}{unknown} ', 50);
+
+    // the results must be the same as of the straightforward leftmost-longest implementation
+    if (strtr($this->text, self::ENTITIES) !== self::strtrReference($this->text, self::ENTITIES) ||
+        strtr($this->template, $this->placeholders) !== self::strtrReference($this->template, $this->placeholders)) {
+      throw new Exception('strtr() result differs from the reference one');
+    }
+  }
+
+  /**
+   * @param string[] $pairs
+   */
+  private static function strtrReference(string $subject, array $pairs): string {
+    $result = '';
+    $offset = 0;
+    while (true) {
+      $best_pos = -1;
+      $best_key = '';
+      foreach ($pairs as $key => $_) {
+        $key = (string)$key;
+        $pos = strpos($subject, $key, $offset);
+        if ($pos !== false && ($best_pos === -1 || $pos < $best_pos || ($pos === $best_pos && strlen($key) > strlen($best_key)))) {
+          $best_pos = $pos;
+          $best_key = $key;
+        }
+      }
+      if ($best_pos === -1) {
+        return $result . substr($subject, $offset);
+      }
+      $result .= substr($subject, $offset, $best_pos - $offset) . $pairs[$best_key];
+      $offset = $best_pos + strlen($best_key);
+    }
+  }
+
+  public function benchmarkEscapeConstPairs() {
+    return strlen(strtr($this->text, self::ENTITIES));
+  }
+
+  public function benchmarkTemplate200Pairs() {
+    return strlen(strtr($this->template, $this->placeholders));
+  }
+
+  public function benchmarkNoMatches() {
+    return strlen(strtr($this->template, self::ENTITIES));
+  }
+}
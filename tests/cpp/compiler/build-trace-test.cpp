@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <ftw.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compiler/data/src-file.h"
+#include "compiler/index.h"
+#include "compiler/make/make-runner.h"
+#include "compiler/make/target.h"
+#include "compiler/scheduler/pipe.h"
+#include "compiler/threading/build-trace.h"
+#include "compiler/threading/data-stream.h"
+
+namespace {
+
+int remove_cb(const char *fpath, const struct stat *, int, struct FTW *) {
+  return remove(fpath);
+}
+
+class TouchTarget : public Target {
+public:
+  explicit TouchTarget(File *file) {
+    set_file(file);
+  }
+
+  std::string get_cmd() final {
+    return "touch " + get_name();
+  }
+};
+
+} // namespace
+
+struct BuildTraceTestF {
+  void execute(SrcFilePtr file, DataStream<SrcFilePtr> &os) {
+    os << file;
+  }
+
+  void on_finish(DataStream<SrcFilePtr> &) {}
+};
+
+class BuildTraceTest : public ::testing::Test {
+protected:
+  using TestPipe = Pipe<BuildTraceTestF, DataStream<SrcFilePtr>, DataStream<SrcFilePtr>>;
+
+  void SetUp() override {
+    ASSERT_EQ(mkdir(dir_.c_str(), 0777), 0);
+    vk::singleton<BuildTrace>::get().enable(trace_file_);
+  }
+
+  // the trace is a process-wide singleton, so it's disabled not to record the next tests
+  void TearDown() override {
+    vk::singleton<BuildTrace>::get().disable();
+    nftw(dir_.c_str(), remove_cb, 64, FTW_DEPTH | FTW_PHYS);
+  }
+
+  // returns the summary printed to stderr, the trace itself is read into trace_
+  std::string flush() {
+    testing::internal::CaptureStderr();
+    vk::singleton<BuildTrace>::get().flush();
+    std::string summary = testing::internal::GetCapturedStderr();
+    std::ifstream trace_stream{trace_file_};
+    std::stringstream buffer;
+    buffer << trace_stream.rdbuf();
+    trace_ = buffer.str();
+    return summary;
+  }
+
+  void run_test_pipe() {
+    DataStream<SrcFilePtr> input{true};
+    DataStream<SrcFilePtr> output{true};
+    TestPipe pipe{false};
+    pipe.set_input_stream(&input);
+    pipe.get_output_stream() = &output;
+
+    SrcFilePtr file{new SrcFile{dir_ + "/trace_test.php", "trace_test.php", LibPtr{}}};
+    file->relative_file_name = "trace_test.php";
+    input << file;
+    std::unique_ptr<Task> task{pipe.get_task()};
+    ASSERT_NE(task, nullptr);
+    task->execute();
+    pipe.on_finish();
+  }
+
+  const std::string dir_ = std::string{P_tmpdir} + "/kphp_build_trace_test_" + std::to_string(getpid());
+  const std::string trace_file_ = dir_ + "/trace.json";
+  std::string trace_;
+};
+
+TEST_F(BuildTraceTest, test_pipe_events) {
+  run_test_pipe();
+  const std::string summary = flush();
+
+  // a task of the pipe with its input and the sync stage after it
+  ASSERT_NE(trace_.find(R"("name":"BuildTraceTestF","cat":"pipe")"), std::string::npos);
+  ASSERT_NE(trace_.find(R"("args":{"input":"trace_test.php"})"), std::string::npos);
+  ASSERT_NE(trace_.find(R"("name":"BuildTraceTestF::on_finish","cat":"sync")"), std::string::npos);
+
+  const size_t sync_points = summary.find("Sync points");
+  ASSERT_NE(sync_points, std::string::npos);
+  ASSERT_NE(summary.find("BuildTraceTestF::on_finish", sync_points), std::string::npos);
+  ASSERT_NE(summary.find("trace_test.php"), std::string::npos);
+}
+
+TEST_F(BuildTraceTest, test_disabled) {
+  vk::singleton<BuildTrace>::get().disable();
+  run_test_pipe();
+  vk::singleton<BuildTrace>::get().enable(trace_file_);
+  flush();
+
+  ASSERT_EQ(trace_.find("BuildTraceTestF"), std::string::npos);
+}
+
+TEST_F(BuildTraceTest, test_make_critical_path) {
+  File a_file{dir_ + "/a.o"};
+  File b_file{dir_ + "/b.o"};
+  File c_file{dir_ + "/c.o"};
+  // the targets are owned by the runner
+  auto *a = new TouchTarget{&a_file};
+  auto *b = new TouchTarget{&b_file};
+  auto *c = new TouchTarget{&c_file};
+
+  // the jobs are run one after another, so all of them are on the critical path
+  MakeRunner runner{nullptr};
+  runner.register_target(a, {});
+  runner.register_target(b, {a});
+  runner.register_target(c, {b});
+  testing::internal::CaptureStderr();
+  ASSERT_TRUE(runner.make_targets({c}, "Test build", 2));
+  testing::internal::GetCapturedStderr();
+  const std::string summary = flush();
+
+  for (const auto *file : {&a_file, &b_file, &c_file}) {
+    ASSERT_NE(trace_.find(R"("name":")" + file->path + R"(","cat":"make")"), std::string::npos);
+  }
+
+  const size_t critical_path = summary.find("Test build critical path: 3 jobs");
+  ASSERT_NE(critical_path, std::string::npos);
+  const size_t a_pos = summary.find(a_file.path, critical_path);
+  const size_t b_pos = summary.find(b_file.path, critical_path);
+  const size_t c_pos = summary.find(c_file.path, critical_path);
+  ASSERT_NE(a_pos, std::string::npos);
+  ASSERT_LT(a_pos, b_pos);
+  ASSERT_LT(b_pos, c_pos);
+  ASSERT_NE(c_pos, std::string::npos);
+}
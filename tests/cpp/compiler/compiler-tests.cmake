@@ -1,8 +1,11 @@
 prepend(COMPILER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/compiler/
         _compiler-tests-env.cpp
+        build-trace-test.cpp
         data/performance-inspections-test.cpp
+        frontend-cache-test.cpp
         phpdoc-test.cpp
         typedata-test.cpp
+        unity-build-test.cpp
         lexer-test.cpp
         ffi-parser-test.cpp
         utils/string-utils-test.cpp)
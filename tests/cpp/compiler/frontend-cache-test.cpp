@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <string>
+#include <unistd.h>
+
+#include "compiler/data/src-file.h"
+#include "compiler/frontend-cache.h"
+#include "compiler/lexer.h"
+
+namespace {
+
+int remove_cb(const char *fpath, const struct stat *, int, struct FTW *) {
+  return remove(fpath);
+}
+
+} // namespace
+
+class FrontendCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(mkdir(cache_dir_.c_str(), 0777), 0);
+  }
+
+  // the cache is a process-wide singleton, so it's disabled not to point the next tests to the removed directory
+  void TearDown() override {
+    vk::singleton<FrontendCache>::get().init({}, {});
+    nftw(cache_dir_.c_str(), remove_cb, 64, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const std::string cache_dir_ = std::string{P_tmpdir} + "/kphp_frontend_cache_test_" + std::to_string(getpid());
+};
+
+TEST_F(FrontendCacheTest, test_tokens_round_trip) {
+  auto &cache = vk::singleton<FrontendCache>::get();
+  cache.init(cache_dir_ + "/", "test-version");
+  ASSERT_TRUE(cache.is_enabled());
+
+  SrcFilePtr file{new SrcFile{"/tmp/kphp_frontend_cache_test.php", "kphp_frontend_cache_test.php", LibPtr{}}};
+  file->text = "<?php\n$a = \"x\\ny\";\necho $a . 'z';\nfunction f(int $x) { return $x ** 2; }\n";
+  file->loaded = true;
+
+  EXPECT_FALSE(cache.load_tokens(file).has_value());
+
+  const auto tokens = php_text_to_tokens(file->text);
+  cache.store_tokens(file, tokens);
+
+  const auto cached_tokens = cache.load_tokens(file);
+  ASSERT_TRUE(cached_tokens.has_value());
+  ASSERT_EQ(cached_tokens->size(), tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ((*cached_tokens)[i].type(), tokens[i].type());
+    EXPECT_EQ((*cached_tokens)[i].line_num, tokens[i].line_num);
+    EXPECT_EQ((*cached_tokens)[i].str_val, tokens[i].str_val);
+    EXPECT_EQ((*cached_tokens)[i].debug_str, tokens[i].debug_str);
+  }
+
+  // changed contents invalidate the entry
+  file->text += "echo 1;\n";
+  EXPECT_FALSE(cache.load_tokens(file).has_value());
+
+  // the entries written by another compiler build are not used either
+  cache.store_tokens(file, php_text_to_tokens(file->text));
+  EXPECT_TRUE(cache.load_tokens(file).has_value());
+  cache.init(cache_dir_ + "/", "other-version");
+  EXPECT_FALSE(cache.load_tokens(file).has_value());
+}
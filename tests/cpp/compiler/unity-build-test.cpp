@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <string>
+#include <unistd.h>
+
+#include "compiler/unity-build.h"
+
+namespace {
+
+int remove_cb(const char *fpath, const struct stat *, int, struct FTW *) {
+  return remove(fpath);
+}
+
+std::vector<UnityBuild::Source> make_sources() {
+  // a -> b -> c, d -> e, f
+  return {
+    {"o_1/a.cpp", {"o_2/b.cpp"}},
+    {"o_2/b.cpp", {"o_1/c.cpp", "o_1/inline.cpp"}},
+    {"o_1/c.cpp", {}},
+    {"o_3/d.cpp", {"o_3/e.cpp"}},
+    {"o_3/e.cpp", {}},
+    {"o_4/f.cpp", {}},
+  };
+}
+
+} // namespace
+
+class UnityBuildTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(mkdir(dir_.c_str(), 0777), 0);
+  }
+
+  // the directory is removed even if an assertion has failed in the middle of a test
+  void TearDown() override {
+    nftw(dir_.c_str(), remove_cb, 64, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const std::string dir_ = std::string{P_tmpdir} + "/kphp_unity_build_test_" + std::to_string(getpid());
+  const std::string state_file_ = dir_ + "/unity_build_state";
+};
+
+TEST_F(UnityBuildTest, test_assignment_is_stable) {
+  auto &unity_build = vk::singleton<UnityBuild>::get();
+  unity_build.init(state_file_);
+  ASSERT_TRUE(unity_build.is_enabled());
+
+  // nothing is measured yet, so every source is estimated equally and at most two of them fit a unit
+  auto units = unity_build.assign(make_sources(), 0.5, 0);
+  const std::map<uint32_t, std::vector<std::string>> expected_units{
+    {0, {"o_1/a.cpp", "o_2/b.cpp"}},
+    {1, {"o_1/c.cpp", "o_3/d.cpp"}},
+    {2, {"o_3/e.cpp", "o_4/f.cpp"}},
+  };
+  ASSERT_EQ(units, expected_units);
+  unity_build.save_state();
+
+  // a new source doesn't move the other ones
+  unity_build.init(state_file_);
+  auto sources = make_sources();
+  sources.push_back({"o_4/g.cpp", {"o_4/f.cpp"}});
+  units = unity_build.assign(std::move(sources), 0.5, 0);
+  auto expected_units_with_new = expected_units;
+  expected_units_with_new[3] = {"o_4/g.cpp"};
+  ASSERT_EQ(units, expected_units_with_new);
+
+  // the units are limited by the number of jobs
+  unity_build.init(state_file_);
+  units = unity_build.assign(make_sources(), 0.5, 6);
+  ASSERT_EQ(units.size(), 6);
+}
+
+TEST_F(UnityBuildTest, test_measured_compile_time) {
+  auto &unity_build = vk::singleton<UnityBuild>::get();
+  unity_build.init(state_file_);
+  unity_build.assign(make_sources(), 0.5, 0);
+  unity_build.on_unity_compiled({"o_1/a.cpp", "o_2/b.cpp"}, 2.0);
+  unity_build.on_unity_compiled({"o_1/c.cpp", "o_3/d.cpp"}, 0.4);
+  unity_build.on_unity_compiled({"o_3/e.cpp", "o_4/f.cpp"}, 0.4);
+  unity_build.save_state();
+
+  // the unit turned out to be too heavy, so it's split
+  unity_build.init(state_file_);
+  const auto units = unity_build.assign(make_sources(), 0.5, 0);
+  const std::map<uint32_t, std::vector<std::string>> expected_units{
+    {0, {"o_1/a.cpp"}},
+    {1, {"o_1/c.cpp", "o_3/d.cpp"}},
+    {2, {"o_3/e.cpp", "o_4/f.cpp"}},
+    {3, {"o_2/b.cpp"}},
+  };
+  ASSERT_EQ(units, expected_units);
+}
@@ -0,0 +1,16 @@
+# the requests built by k2-host are decoded by a mock image with the runtime-light TL definitions and sent back
+add_library(k2-host-mock-image MODULE ${BASE_DIR}/tests/cpp/k2-host/mock-image.cpp)
+target_compile_options(k2-host-mock-image PRIVATE -stdlib=libc++)
+target_link_options(k2-host-mock-image PRIVATE -stdlib=libc++)
+set_target_properties(k2-host-mock-image PROPERTIES FOLDER tests)
+
+set(K2_HOST_TEST_ARGS --requests 1 --warmup 0 --request-file ${BASE_DIR}/tests/cpp/k2-host/data/payload.txt --print-response --metrics)
+
+add_test(NAME k2-host-rpc-round-trip COMMAND k2-host ${K2_HOST_TEST_ARGS} --rpc $<TARGET_FILE:k2-host-mock-image>)
+set_tests_properties(k2-host-rpc-round-trip PROPERTIES PASS_REGULAR_EXPRESSION "rpc 1 ping")
+
+add_test(NAME k2-host-http-round-trip COMMAND k2-host ${K2_HOST_TEST_ARGS} --http-uri /path?key=value $<TARGET_FILE:k2-host-mock-image>)
+set_tests_properties(k2-host-http-round-trip PROPERTIES PASS_REGULAR_EXPRESSION "http 1\\.1 POST /path\\?key=value ping")
+
+add_test(NAME k2-host-metrics COMMAND k2-host ${K2_HOST_TEST_ARGS} --rpc $<TARGET_FILE:k2-host-mock-image>)
+set_tests_properties(k2-host-metrics PROPERTIES PASS_REGULAR_EXPRESSION "metric mock_requests: writes 1, sum 2\\.000")
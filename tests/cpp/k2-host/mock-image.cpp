@@ -0,0 +1,200 @@
+// A oneshot component for the k2-host round-trip test: it decodes the invoke request with the runtime-light TL definitions,
+// answers with the decoded fields and sends a metric, so that the host and runtime-light can't silently diverge
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "runtime-light/k2-platform/k2-api.h"
+#include "runtime-light/k2-platform/k2-header.h"
+#include "runtime-light/stdlib/diagnostics/metrics.h"
+#include "runtime-light/tl/tl-core.h"
+#include "runtime-light/tl/tl-functions.h"
+#include "runtime-light/tl/tl-types.h"
+
+#define VISIBILITY_DEFAULT __attribute__((visibility("default")))
+
+struct ImageState {};
+struct ComponentState {};
+
+struct InstanceState {
+  std::optional<uint64_t> request_d;
+  std::string request;
+};
+
+namespace {
+
+std::string_view as_string_view(std::span<const std::byte> bytes) noexcept {
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+// tl::string::fetch is defined in the runtime, the image has only the header definitions
+std::optional<std::string_view> fetch_string(tl::fetcher& tlf) noexcept {
+  const auto first_byte{tlf.fetch_trivial<uint8_t>()};
+  if (!first_byte) {
+    return std::nullopt;
+  }
+  size_t header_len{1};
+  size_t len{*first_byte};
+  if (*first_byte == 0xfe) {
+    const auto len_bytes{tlf.fetch_bytes(3)};
+    if (!len_bytes) {
+      return std::nullopt;
+    }
+    header_len = 4;
+    len = 0;
+    for (size_t i = 0; i < 3; ++i) {
+      len |= static_cast<size_t>((*len_bytes)[i]) << (8 * i);
+    }
+  }
+  const auto str{tlf.fetch_bytes(len)};
+  if (!str || !tlf.fetch_bytes(((header_len + len + 3) & ~size_t{3}) - (header_len + len))) {
+    return std::nullopt;
+  }
+  return as_string_view(*str);
+}
+
+// the image can't use K2InvokeRpc::fetch as is, the request extra is fetched by the runtime
+std::optional<std::string> answer_rpc(tl::fetcher& tlf) noexcept {
+  tl::magic magic{};
+  tl::mask flags{};
+  tl::i64 query_id{};
+  tl::netPid net_pid{};
+  if (!magic.fetch(tlf) || !magic.expect(tl::K2_INVOKE_RPC_MAGIC) || !flags.fetch(tlf) || flags.value != 0 || !query_id.fetch(tlf) ||
+      !net_pid.fetch(tlf)) {
+    return std::nullopt;
+  }
+  return std::string{"rpc "}.append(std::to_string(query_id.value)).append(" ").append(as_string_view(*tlf.fetch_bytes(tlf.remaining())));
+}
+
+std::optional<std::string> answer_http(tl::fetcher& tlf) noexcept {
+  tl::magic magic{};
+  tl::mask flags{};
+  if (!magic.fetch(tlf) || !magic.expect(tl::K2_INVOKE_HTTP_MAGIC) || !flags.fetch(tlf)) {
+    return std::nullopt;
+  }
+  // connection
+  tl::i32 port{};
+  if (!fetch_string(tlf) || !port.fetch(tlf) || !fetch_string(tlf) || !port.fetch(tlf)) {
+    return std::nullopt;
+  }
+  tl::HttpVersion version{};
+  const auto method{version.fetch(tlf) ? fetch_string(tlf) : std::nullopt};
+  tl::mask uri_flags{};
+  const auto path{method && uri_flags.fetch(tlf) ? fetch_string(tlf) : std::nullopt};
+  if (!path) {
+    return std::nullopt;
+  }
+  std::string response{"http "};
+  response.append(version.string_view()).append(" ").append(*method).append(" ").append(*path);
+  if (static_cast<bool>(uri_flags.value & tl::httpUri::QUERY_FLAG)) {
+    const auto query{fetch_string(tlf)};
+    if (!query) {
+      return std::nullopt;
+    }
+    response.append("?").append(*query);
+  }
+  tl::u32 headers_count{};
+  if (!headers_count.fetch(tlf) || headers_count.value != 0) {
+    return std::nullopt;
+  }
+  return response.append(" ").append(as_string_view(*tlf.fetch_bytes(tlf.remaining())));
+}
+
+template<typename T>
+void append_trivial(std::string& buffer, T value) noexcept {
+  buffer.append(reinterpret_cast<const char*>(std::addressof(value)), sizeof(T));
+}
+
+// tl::storer allocates the script memory of the runtime, so the metric is serialized by hand
+void write_request_metric() noexcept {
+  static constexpr std::string_view METRIC_NAME = "mock_requests";
+  std::string metric;
+  append_trivial<uint64_t>(metric, 0); // timestamp
+  append_trivial<uint8_t>(metric, METRIC_NAME.size());
+  metric.append(METRIC_NAME);
+  metric.append(((1 + METRIC_NAME.size() + 3) & ~size_t{3}) - (1 + METRIC_NAME.size()), '\0');
+  append_trivial<uint32_t>(metric, tl::AnyMetricValue::COUNT_MAGIC);
+  append_trivial<uint32_t>(metric, 2); // count
+  append_trivial<uint32_t>(metric, 0); // tags
+  k2_write_metrics(metric.data(), metric.size());
+}
+
+} // namespace
+
+VISIBILITY_DEFAULT ImageState* k2_create_image() {
+  return static_cast<ImageState*>(k2_alloc(sizeof(ImageState), alignof(ImageState)));
+}
+
+VISIBILITY_DEFAULT void k2_init_image() {}
+
+VISIBILITY_DEFAULT ComponentState* k2_create_component() {
+  return static_cast<ComponentState*>(k2_alloc(sizeof(ComponentState), alignof(ComponentState)));
+}
+
+VISIBILITY_DEFAULT void k2_init_component() {}
+
+VISIBILITY_DEFAULT InstanceState* k2_create_instance() {
+  return static_cast<InstanceState*>(k2_alloc(sizeof(InstanceState), alignof(InstanceState)));
+}
+
+VISIBILITY_DEFAULT void k2_init_instance() {
+  new (k2_instance_state()) InstanceState{};
+}
+
+VISIBILITY_DEFAULT k2::PollStatus k2_warmup() {
+  return k2::PollStatus::PollFinishedOk;
+}
+
+VISIBILITY_DEFAULT k2::PollStatus k2_poll() {
+  auto& instance{*k2_instance_state()};
+  uint64_t d{};
+  while (k2_take_update(std::addressof(d)) != NoUpdates) {
+    instance.request_d.emplace(d);
+  }
+  if (!instance.request_d) {
+    return k2::PollStatus::PollBlocked;
+  }
+
+  std::array<char, 256> buffer{};
+  for (size_t read{}; (read = k2_read(*instance.request_d, buffer.size(), buffer.data())) != 0;) {
+    instance.request.append(buffer.data(), read);
+  }
+  StreamStatus status{};
+  k2_stream_status(*instance.request_d, std::addressof(status));
+  if (status.read_status != IOClosed) {
+    return k2::PollStatus::PollBlocked;
+  }
+
+  const std::span request{reinterpret_cast<const std::byte*>(instance.request.data()), instance.request.size()};
+  tl::fetcher tlf{request};
+  tl::magic magic{};
+  magic.fetch(tlf);
+  tlf.reset(0);
+  const auto response{magic.expect(tl::K2_INVOKE_RPC_MAGIC) ? answer_rpc(tlf) : answer_http(tlf)};
+  if (!response) {
+    return k2::PollStatus::PollFinishedError;
+  }
+  write_request_metric();
+  k2_write(*instance.request_d, response->size(), response->data());
+  k2_shutdown_write(*instance.request_d);
+  return k2::PollStatus::PollFinishedOk;
+}
+
+VISIBILITY_DEFAULT const ImageInfo* k2_describe() {
+  static constexpr ImageInfo image_info{.image_name = "k2-host-mock-image",
+                                        .is_oneshot = 1,
+                                        .build_timestamp = 0,
+                                        .header_h_version = K2_PLATFORM_HEADER_H_VERSION,
+                                        .version = "0.0.1",
+                                        .extra_info_size = 0,
+                                        .extra_info = nullptr};
+  return std::addressof(image_info);
+}
@@ -1,6 +1,25 @@
+#include <algorithm>
 #include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
 
 #include "runtime-common/core/runtime-core.h"
+#include "runtime-common/stdlib/array/array-functions.h"
+#include "runtime-common/stdlib/math/math-functions.h"
+
+namespace {
+
+template<class T>
+std::vector<T> get_values(const array<T>& arr) {
+  std::vector<T> values;
+  for (const auto& it : arr) {
+    values.push_back(it.get_value());
+  }
+  return values;
+}
+
+} // namespace
 
 TEST(array_test, find_no_mutate_in_empy_array) {
   array<int> arr;
@@ -132,3 +151,183 @@ TEST(array_test, test_mutate_shared_map) {
   ASSERT_EQ(arr_copy.get_reference_counter(), 1);
   ASSERT_FALSE(arr_copy.is_equal_inner_pointer(arr));
 }
+
+TEST(array_test, test_sort_numbers) {
+  std::mt19937_64 rng{42};
+  for (int64_t n : {2, 10, 100, 1000, 10000}) {
+    std::vector<int64_t> ints(n);
+    std::vector<double> floats(n);
+    for (int64_t i = 0; i != n; ++i) {
+      ints[i] = static_cast<int64_t>(rng() % 2000) - 1000 + (i % 3 == 0 ? static_cast<int64_t>(rng()) : 0);
+      floats[i] = static_cast<double>(ints[i]) / 7;
+    }
+
+    array<int64_t> int_arr;
+    array<double> float_arr;
+    array<int64_t> int_map;
+    for (int64_t i = 0; i != n; ++i) {
+      int_arr.push_back(ints[i]);
+      float_arr.push_back(floats[i]);
+      int_map.set_value(ints[i], i);
+    }
+    auto int_arr_desc = int_arr;
+    auto int_arr_numeric = int_arr;
+    f$sort(int_arr);
+    f$rsort(int_arr_desc);
+    f$sort(int_arr_numeric, SORT_NUMERIC);
+    f$sort(float_arr);
+    f$ksort(int_map);
+
+    std::sort(ints.begin(), ints.end());
+    std::sort(floats.begin(), floats.end());
+    ASSERT_EQ(get_values(int_arr), ints);
+    ASSERT_EQ(get_values(int_arr_numeric), ints);
+    ASSERT_EQ(get_values(float_arr), floats);
+    std::reverse(ints.begin(), ints.end());
+    ASSERT_EQ(get_values(int_arr_desc), ints);
+    ASSERT_TRUE(std::is_sorted(int_map.begin(), int_map.end(), [](const auto& lhs, const auto& rhs) { return lhs.get_key().to_int() < rhs.get_key().to_int(); }));
+  }
+}
+
+TEST(array_test, test_asort_keeps_keys) {
+  std::mt19937_64 rng{42};
+  const int64_t n = 1000;
+  array<int64_t> arr;
+  for (int64_t i = 0; i != n; ++i) {
+    arr.set_value(string{"key"}.append(i), static_cast<int64_t>(rng() % 100));
+  }
+  const auto original = arr;
+  f$arsort(arr);
+
+  ASSERT_EQ(arr.count(), n);
+  int64_t prev = std::numeric_limits<int64_t>::max();
+  for (const auto& it : arr) {
+    ASSERT_EQ(original.get_value(it.get_key()), it.get_value());
+    ASSERT_LE(it.get_value(), prev);
+    prev = it.get_value();
+  }
+}
+
+TEST(array_test, test_sort_strings) {
+  std::mt19937_64 rng{42};
+  std::vector<string> strings;
+  array<string> arr;
+  for (int64_t i = 0; i != 1000; ++i) {
+    string str;
+    for (size_t length = rng() % 12; length != 0; --length) {
+      str.push_back("ab\0c"[rng() % 4]);
+    }
+    strings.push_back(str);
+    arr.push_back(str);
+  }
+  auto arr_desc = arr;
+  f$sort(arr, SORT_STRING);
+  f$rsort(arr_desc, SORT_STRING);
+
+  std::sort(strings.begin(), strings.end(), [](const string& lhs, const string& rhs) { return lhs.compare(rhs) < 0; });
+  ASSERT_EQ(get_values(arr), strings);
+  std::reverse(strings.begin(), strings.end());
+  ASSERT_EQ(get_values(arr_desc), strings);
+}
+
+TEST(array_test, test_sort_with_inconsistent_comparator) {
+  std::mt19937_64 rng{42};
+  array<int64_t> arr;
+  for (int64_t i = 0; i != 1000; ++i) {
+    arr.push_back(i);
+  }
+  arr.sort([&rng](int64_t, int64_t) { return static_cast<int64_t>(rng() % 3) - 1; }, true);
+
+  auto values = get_values(arr);
+  std::sort(values.begin(), values.end());
+  for (int64_t i = 0; i != 1000; ++i) {
+    ASSERT_EQ(values[i], i);
+  }
+}
+
+TEST(array_test, test_search_in_vectors) {
+  array<int64_t> ints;
+  array<double> floats;
+  array<string> strings;
+  for (int64_t i = 0; i != 100; ++i) {
+    ints.push_back(i * 3 - 50);
+    floats.push_back(static_cast<double>(i) / 2);
+    strings.push_back(string{"long string prefix "}.append(i));
+  }
+  strings.push_back(string{"short"});
+  ASSERT_TRUE(ints.is_vector() && floats.is_vector() && strings.is_vector());
+
+  ASSERT_TRUE(f$in_array(int64_t{-50}, ints));
+  ASSERT_TRUE(f$in_array(int64_t{247}, ints, true));
+  ASSERT_FALSE(f$in_array(int64_t{248}, ints));
+  ASSERT_TRUE(equals(f$array_search(int64_t{100}, ints), mixed{50}));
+  ASSERT_TRUE(equals(f$array_search(int64_t{101}, ints), mixed{false}));
+
+  ASSERT_TRUE(f$in_array(-0.0, floats));
+  ASSERT_TRUE(equals(f$array_search(49.5, floats, true), mixed{99}));
+  ASSERT_FALSE(f$in_array(0.25, floats));
+
+  ASSERT_TRUE(f$in_array(string{"long string prefix 42"}, strings, true));
+  ASSERT_TRUE(equals(f$array_search(string{"short"}, strings, true), mixed{100}));
+  ASSERT_FALSE(f$in_array(string{"long string prefix 100"}, strings, true));
+  ASSERT_FALSE(f$in_array(string{"shor"}, strings, true));
+  // the non-strict comparison of the strings is left to the generic loop
+  array<string> numeric_strings = array<string>::create(string{"1e1"}, string{"5"});
+  ASSERT_TRUE(f$in_array(string{"10"}, numeric_strings));
+  ASSERT_FALSE(f$in_array(string{"10"}, numeric_strings, true));
+
+  ASSERT_EQ(f$array_sum(ints), 100 * 99 / 2 * 3 - 50 * 100);
+  ASSERT_EQ(f$min(ints), -50);
+  ASSERT_EQ(f$max(ints), 247);
+
+  // maps are handled by the generic loops
+  ints.set_value(string{"key"}, int64_t{1000});
+  ASSERT_FALSE(ints.is_vector());
+  ASSERT_TRUE(equals(f$array_search(int64_t{1000}, ints), mixed{string{"key"}}));
+  ASSERT_EQ(f$array_sum(ints), 100 * 99 / 2 * 3 - 50 * 100 + 1000);
+  ASSERT_EQ(f$max(ints), 1000);
+}
+
+TEST(array_test, test_merge_self) {
+  auto vector = array<int64_t>::create(1, 2);
+  const auto vector_copy = vector;
+  f$_array_merge_self(vector, array<int64_t>::create(3, 4));
+  ASSERT_EQ(get_values(vector), (std::vector<int64_t>{1, 2, 3, 4}));
+  ASSERT_EQ(get_values(vector_copy), (std::vector<int64_t>{1, 2}));
+
+  // the integer keys of a map are renumbered as array_merge() does
+  array<int64_t> map;
+  map.set_value(int64_t{10}, int64_t{1});
+  map.set_value(string{"key"}, int64_t{2});
+  f$_array_merge_self(map, array<int64_t>::create(3));
+  ASSERT_EQ(get_values(map), (std::vector<int64_t>{1, 2, 3}));
+  ASSERT_TRUE(map.has_key(int64_t{0}) && map.has_key(string{"key"}) && map.has_key(int64_t{1}));
+  ASSERT_FALSE(map.has_key(int64_t{10}));
+}
+
+TEST(array_test, test_reserve_for_push_back) {
+  auto arr = array<int64_t>::create(1, 2);
+  const auto base = array<int64_t>::create(3, 4, 5);
+  f$_array_reserve_for_push_back(arr, base);
+  ASSERT_TRUE(arr.is_vector());
+  ASSERT_EQ(get_values(arr), (std::vector<int64_t>{1, 2}));
+  for (const auto &it : base) {
+    arr.push_back(it.get_value());
+  }
+  ASSERT_EQ(get_values(arr), (std::vector<int64_t>{1, 2, 3, 4, 5}));
+
+  // an inner loop reserves the same array on every iteration of an outer one, it mustn't be reallocated every time
+  array<int64_t> nested;
+  int64_t reallocations = 0;
+  for (int64_t i = 0; i != 1000; ++i) {
+    const size_t memory_usage = nested.estimate_memory_usage();
+    f$_array_reserve_for_push_back(nested, base);
+    reallocations += memory_usage != nested.estimate_memory_usage();
+    for (const auto &it : base) {
+      nested.push_back(it.get_value());
+    }
+  }
+  ASSERT_EQ(nested.count(), 3000);
+  ASSERT_TRUE(nested.is_vector());
+  ASSERT_LE(reallocations, 20);
+}
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "runtime/confdata-functions.h"
 #include "runtime/confdata-global-manager.h"
+#include "runtime/memoize.h"
 
 namespace {
 
@@ -129,3 +132,40 @@ TEST(confdata_functions_test, test_confdata_get_values_by_bad_wildcard) {
     ASSERT_EQ(f$confdata_get_values_by_any_wildcard(string{bad_wildcard}).count(), 0);
   }
 }
+
+TEST(confdata_functions_test, test_confdata_update_after_fork_changes_memoize_key) {
+  init_global_confdata_confdata();
+
+  const uint64_t generation_before_update = confdata_get_generation();
+  const string memoize_key_before_update = impl_::memoize_key_prefix("f");
+
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+  const pid_t worker_pid = fork();
+  ASSERT_GE(worker_pid, 0);
+  if (worker_pid == 0) {
+    close(pipe_fds[1]);
+    char c = 0;
+    bool ok = read(pipe_fds[0], &c, 1) == 1;
+    // a new request of the worker sees the sample updated by master
+    free_confdata_functions_lib();
+    init_confdata_functions_lib();
+    ok = ok && equals(f$confdata_get_value(string{"_key_updated"}), string{"value_updated"});
+    ok = ok && confdata_get_generation() != generation_before_update;
+    ok = ok && impl_::memoize_key_prefix("f") != memoize_key_before_update;
+    _exit(ok ? 0 : 1);
+  }
+
+  close(pipe_fds[0]);
+  auto &global_manager = ConfdataGlobalManager::get();
+  auto updated_confdata = global_manager.get_current().get_confdata();
+  updated_confdata[string{"_key_updated"}] = string{"value_updated"};
+  ASSERT_TRUE(global_manager.try_switch_to_next_sample(std::move(updated_confdata)));
+  ASSERT_EQ(write(pipe_fds[1], "x", 1), 1);
+  close(pipe_fds[1]);
+
+  int status = 0;
+  ASSERT_EQ(waitpid(worker_pid, &status, 0), worker_pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+}
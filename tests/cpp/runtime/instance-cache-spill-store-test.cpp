@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+#include "runtime/instance-cache-spill-store.h"
+
+namespace {
+
+std::string get_spill_file_path() {
+  return std::string{P_tmpdir} + "/kphp_instance_cache_spill_test_" + std::to_string(getpid());
+}
+
+std::string get(InstanceCacheSpillStore& store, std::string_view key, InstanceCacheSpillStore::ElementInfo* info = nullptr) {
+  std::string result = "<absent>";
+  store.get(key, [&](const InstanceCacheSpillStore::ElementInfo& element_info, std::string_view serialized) {
+    result = serialized;
+    if (info) {
+      *info = element_info;
+    }
+  });
+  return result;
+}
+
+} // namespace
+
+TEST(instance_cache_spill_store_test, test_put_get_remove) {
+  const std::string path = get_spill_file_path();
+  InstanceCacheSpillStore store;
+  ASSERT_FALSE(store.is_enabled());
+  ASSERT_FALSE(store.put("key", {1, 2, 3}, "value"));
+  ASSERT_EQ(get(store, "key"), "<absent>");
+
+  ASSERT_TRUE(store.init(path.c_str(), 1024 * 1024));
+  ASSERT_TRUE(store.is_enabled());
+  ASSERT_EQ(get(store, "key"), "<absent>");
+
+  ASSERT_TRUE(store.put("key", {1, 2, 3}, "value"));
+  ASSERT_TRUE(store.put("other key", {4, 5, 6}, "other value"));
+  ASSERT_TRUE(store.put("empty", {7, 8, 9}, ""));
+  InstanceCacheSpillStore::ElementInfo info{};
+  ASSERT_EQ(get(store, "key", &info), "value");
+  ASSERT_EQ(info.layout_hash, 1);
+  ASSERT_EQ(info.stored_at, 2);
+  ASSERT_EQ(info.expiring_at, 3);
+  ASSERT_EQ(get(store, "other key"), "other value");
+  ASSERT_EQ(get(store, "empty"), "");
+  ASSERT_EQ(get(store, "ke"), "<absent>");
+
+  ASSERT_TRUE(store.put("key", {1, 2, 4}, "new value"));
+  ASSERT_EQ(get(store, "key", &info), "new value");
+  ASSERT_EQ(info.expiring_at, 4);
+
+  store.remove("key");
+  store.remove("unknown");
+  ASSERT_EQ(get(store, "key"), "<absent>");
+  ASSERT_EQ(get(store, "other key"), "other value");
+  ASSERT_TRUE(store.put("key", {1, 2, 5}, "value again"));
+  ASSERT_EQ(get(store, "key"), "value again");
+
+  // a too large element
+  ASSERT_FALSE(store.put("large", {1, 2, 3}, std::string(512 * 1024, 'x')));
+  ASSERT_EQ(get(store, "large"), "<absent>");
+  unlink(path.c_str());
+}
+
+TEST(instance_cache_spill_store_test, test_overwriting_the_oldest) {
+  const std::string path = get_spill_file_path();
+  InstanceCacheSpillStore store;
+  ASSERT_TRUE(store.init(path.c_str(), 64 * 1024));
+
+  const std::string value(1000, 'v');
+  const int elements_count = 1000;
+  for (int i = 0; i != elements_count; ++i) {
+    ASSERT_TRUE(store.put("key" + std::to_string(i), {0, i, i}, value + std::to_string(i)));
+  }
+
+  // the ring keeps only the latest elements, all the found ones are intact
+  int found = 0;
+  for (int i = 0; i != elements_count; ++i) {
+    const std::string result = get(store, "key" + std::to_string(i));
+    if (result != "<absent>") {
+      ASSERT_EQ(result, value + std::to_string(i));
+      ++found;
+    }
+  }
+  ASSERT_GT(found, 40);
+  ASSERT_LE(found, 64);
+  ASSERT_EQ(get(store, "key0"), "<absent>");
+  ASSERT_EQ(get(store, "key" + std::to_string(elements_count - 1)), value + std::to_string(elements_count - 1));
+
+  // the file is recreated
+  InstanceCacheSpillStore new_store;
+  ASSERT_TRUE(new_store.init(path.c_str(), 64 * 1024));
+  ASSERT_EQ(get(new_store, "key" + std::to_string(elements_count - 1)), "<absent>");
+  ASSERT_EQ(get(store, "key" + std::to_string(elements_count - 1)), value + std::to_string(elements_count - 1));
+  unlink(path.c_str());
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "runtime-common/stdlib/serialization/json-functions.h"
+#include "runtime-common/stdlib/serialization/json-tape.h"
+
+namespace {
+
+std::optional<mixed> decode(const string& json) {
+  return json_decode({json.c_str(), json.size()});
+}
+
+string encode(const mixed& v) {
+  return f$json_encode(v).val();
+}
+
+mixed random_value(std::mt19937& gen, int depth) {
+  static const char* strings[] = {"", "abc", "with \"quotes\"", "back\\slash", "[not, an: array]", "{\"not\": \"an object\"}", "\xD0\x9F\xD1\x80\xD0\xB8",
+                                  "0", "17", "tab\tand\nnewline"};
+  const int kind = std::uniform_int_distribution<int>{0, depth > 0 ? 6 : 4}(gen);
+  switch (kind) {
+    case 0:
+      return mixed{};
+    case 1:
+      return std::uniform_int_distribution<int>{0, 1}(gen) == 1;
+    case 2:
+      return std::uniform_int_distribution<int64_t>{-1000000, 1000000}(gen);
+    case 3:
+    case 4:
+      return string{strings[std::uniform_int_distribution<size_t>{0, std::size(strings) - 1}(gen)]};
+    case 5: {
+      array<mixed> vector;
+      const int size = std::uniform_int_distribution<int>{0, 40}(gen);
+      for (int i = 0; i < size; ++i) {
+        vector.push_back(random_value(gen, depth - 1));
+      }
+      return vector;
+    }
+    default: {
+      array<mixed> map;
+      const int size = std::uniform_int_distribution<int>{1, 40}(gen);
+      for (int i = 0; i < size; ++i) {
+        map.set_value(string{strings[std::uniform_int_distribution<size_t>{1, std::size(strings) - 1}(gen)]}.append(string{static_cast<int64_t>(i)}),
+                      random_value(gen, depth - 1));
+      }
+      return map;
+    }
+  }
+}
+
+} // namespace
+
+TEST(json_functions, decode_large_vector) {
+  string json{"["};
+  for (int64_t i = 0; i < 1000; ++i) {
+    json.append(i ? ", " : "").append(string{i});
+  }
+  json.append("]");
+
+  const auto decoded = decode(json);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_TRUE(decoded->is_array());
+  ASSERT_TRUE(decoded->as_array().is_vector());
+  ASSERT_EQ(decoded->as_array().count(), 1000);
+  ASSERT_EQ(decoded->as_array().get_value(999).to_int(), 999);
+}
+
+TEST(json_functions, decode_object_with_numeric_keys_is_vector) {
+  string json{"{"};
+  for (int64_t i = 0; i < 100; ++i) {
+    json.append(i ? ", \"" : "\"").append(string{i}).append("\": \"value\"");
+  }
+  json.append("}");
+
+  const auto decoded = decode(json);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_TRUE(decoded->as_array().is_vector());
+  ASSERT_EQ(decoded->as_array().count(), 100);
+}
+
+TEST(json_functions, decode_strings) {
+  string long_string;
+  for (int i = 0; i < 100; ++i) {
+    long_string.append("plain text ");
+  }
+  ASSERT_EQ(decode(string{"\""}.append(long_string).append("\""))->to_string(), long_string);
+  ASSERT_EQ(decode(string{"\"a\\\"b\\\\c\\/d\\n\\u0416\""})->to_string(), string{"a\"b\\c/d\n\xD0\x96"});
+  ASSERT_EQ(decode(string{"[\"[\\\"]\", \"{,}\", \":\"]"})->as_array().count(), 3);
+}
+
+TEST(json_functions, decode_malformed) {
+  for (const char* json : {"\"abc", "\"abc\\\"", "\"abc\\", "[1, 2", "{\"a\": 1,}", "[1 2]", "{\"a\" 1}"}) {
+    ASSERT_FALSE(decode(string{json}).has_value()) << json;
+  }
+
+  string commas{"["};
+  string unclosed{"["};
+  for (int i = 0; i < 1000; ++i) {
+    commas.append(",");
+    unclosed.append("[1, 2, 3], ");
+  }
+  commas.append("]");
+  ASSERT_FALSE(decode(commas).has_value());
+  ASSERT_FALSE(decode(unclosed).has_value());
+}
+
+TEST(json_functions, encode_decode_roundtrip) {
+  std::mt19937 gen{3};
+  for (int iteration = 0; iteration < 300; ++iteration) {
+    const mixed value = random_value(gen, 4);
+    const string json = encode(value);
+    const auto decoded = decode(json);
+    ASSERT_TRUE(decoded.has_value()) << json.c_str();
+    ASSERT_EQ(encode(*decoded), json);
+  }
+}
+
+TEST(json_tape, accepts_the_same_jsons) {
+  for (const char* json : {"\"abc", "[1, 2", "{\"a\": 1,}", "[1 2]", "{1: 2}", "nul", "[] []", " {\"a\": [1, {\"b\": null}]} ", "\"\\u0416\"", "-1.5e3"}) {
+    JsonTape tape;
+    ASSERT_EQ(tape.parse(json, "__json_obj_magic"), json_decode(json, "__json_obj_magic").has_value()) << json;
+  }
+}
+
+TEST(json_tape, describes_decoded_values) {
+  std::mt19937 gen{5};
+  for (int iteration = 0; iteration < 300; ++iteration) {
+    const string json = encode(random_value(gen, 4));
+    JsonTape tape;
+    ASSERT_TRUE(tape.parse({json.c_str(), json.size()}, {}));
+    const mixed decoded = tape.root().to_mixed();
+    ASSERT_EQ(encode(decoded), json);
+    ASSERT_STREQ(tape.root().get_type_c_str(), decoded.get_type_c_str());
+    if (decoded.is_array()) {
+      ASSERT_EQ(tape.root().is_vector(), decoded.as_array().is_vector());
+      ASSERT_EQ(tape.root().get_array_size().size, decoded.as_array().count());
+    }
+  }
+}
+
+TEST(json_tape, members) {
+  const std::string_view json = R"({"0": "zero", "1": 1, "a\"b": true, "a": 1, "a": [2.5]})";
+  JsonTape tape;
+  ASSERT_TRUE(tape.parse(json, {}));
+  const auto root = tape.root();
+  ASSERT_FALSE(root.is_vector());
+  ASSERT_EQ(root.get_array_size().size, 5);
+  ASSERT_TRUE(root.find_member("a\"b").has_value());
+  ASSERT_TRUE(root.find_member("a\"b")->as_bool());
+  ASSERT_TRUE(root.find_member("a")->is_array());
+  ASSERT_FALSE(root.find_member("b").has_value());
+  ASSERT_EQ(root.find_member("0")->as_string(), string{"zero"});
+
+  std::vector<std::string> keys;
+  root.for_each_element([&keys](const mixed& key, JsonTape::Value) { keys.emplace_back(key.to_string().c_str()); });
+  ASSERT_EQ(keys, (std::vector<std::string>{"0", "1", "a\"b", "a"}));
+
+  ASSERT_TRUE(tape.parse(R"({"0": 1, "1": 2})", {}));
+  ASSERT_TRUE(tape.root().is_vector());
+}
+
+TEST(json_tape, indexed_members) {
+  const std::string_view json = R"({"k0": 0, "k1": 1, "k2": 2, "k3": 3, "k4": 4, "k5": 5, "7": "seven", "k\u0036": 6, "k1": "one", "k8": 8})";
+  JsonTape tape;
+  ASSERT_TRUE(tape.parse(json, {}));
+  const JsonTape::Members members{tape.root()};
+  for (const char* key : {"k0", "k1", "k2", "k5", "k6", "7", "k8", "k9", "k", "", "8"}) {
+    const auto indexed = members.find(key);
+    const auto scanned = tape.root().find_member(key);
+    ASSERT_EQ(indexed.has_value(), scanned.has_value()) << key;
+    if (indexed) {
+      ASSERT_TRUE(equals(indexed->to_mixed(), scanned->to_mixed())) << key;
+    }
+  }
+  ASSERT_EQ(members.find("k1")->as_string(), string{"one"});
+  ASSERT_EQ(members.find("k6")->as_int(), 6);
+  ASSERT_EQ(members.find("7")->as_string(), string{"seven"});
+
+  ASSERT_TRUE(tape.parse(R"({"a": 1})", {}));
+  ASSERT_EQ(JsonTape::Members{tape.root()}.find("a")->as_int(), 1);
+  ASSERT_FALSE(JsonTape::Members{tape.root()}.find("b").has_value());
+}
+
+TEST(json_tape, to_mixed_with_magic_key) {
+  for (const char* json : {"{}", "[{}, {\"a\": {}}]", "{\"0\": [], \"1\": {}}", "{\"b\": 1, \"a\": 2, \"b\": 3}"}) {
+    JsonTape tape;
+    ASSERT_TRUE(tape.parse(json, "__json_obj_magic"));
+    const auto decoded = json_decode(json, "__json_obj_magic");
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(encode(tape.root().to_mixed()), encode(*decoded)) << json;
+  }
+}
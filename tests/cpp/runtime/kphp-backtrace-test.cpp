@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "runtime/kphp-backtrace.h"
+
+namespace {
+
+std::string prettify(vk::string_view func_name) {
+  std::string pretty_name;
+  prettify_php_function_name(func_name, [&pretty_name](const char* part, size_t size) { pretty_name.append(part, size); });
+  return pretty_name;
+}
+
+} // namespace
+
+TEST(kphp_backtrace_test, test_prettify_function) {
+  ASSERT_EQ(prettify("fun1()"), "fun1()");
+  ASSERT_EQ(prettify("Foo$Bar$fun2(long)"), "Foo\\Bar\\fun2(long)");
+}
+
+TEST(kphp_backtrace_test, test_prettify_method) {
+  ASSERT_EQ(prettify("ClassA$$func_a(class_instance<C$ClassA> const&, long)"), "ClassA::func_a(class_instance<ClassA> const&, long)");
+  ASSERT_EQ(prettify("VK$Api$Client$$send(class_instance<C$VK$Api$Request> const&)"), "VK\\Api\\Client::send(class_instance<VK\\Api\\Request> const&)");
+}
+
+TEST(kphp_backtrace_test, test_prettify_names_ending_with_c) {
+  ASSERT_EQ(prettify("ABC$Foo$$bar()"), "ABC\\Foo::bar()");
+  ASSERT_EQ(prettify("NS$ABC$$bar(class_instance<C$ABC> const&)"), "NS\\ABC::bar(class_instance<ABC> const&)");
+  ASSERT_EQ(prettify("C$$bar(class_instance<C$C> const&)"), "C::bar(class_instance<C> const&)");
+  ASSERT_EQ(prettify("C$Foo$$bar(class_instance<C$C$Foo> const&)"), "C\\Foo::bar(class_instance<C\\Foo> const&)");
+}
@@ -335,3 +335,85 @@ TEST(unsynchronized_pool_resource_test, test_auto_defragmentation_with_extra_mem
 
   resource.deallocate(mem2048, 2048);
 }
+
+TEST(unsynchronized_pool_resource_test, reserve_memory_above) {
+  std::array<char, static_cast<size_t>(1024 * 128)> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(some_memory.data(), some_memory.size());
+
+  constexpr size_t piece_size = 1024 * 20;
+  std::array<void *, 4> pieces{};
+  for (auto &mem: pieces) {
+    mem = resource.allocate(piece_size);
+  }
+  void *mem64 = resource.allocate(64);
+  resource.deallocate(pieces[0], piece_size);
+  resource.deallocate(pieces[2], piece_size);
+
+  // only the first hole is available
+  resource.reserve_memory_above(static_cast<char *>(pieces[1]) + piece_size);
+  ASSERT_TRUE(resource.is_enough_memory_for(piece_size));
+  void *relocated = resource.allocate(piece_size);
+  ASSERT_EQ(relocated, pieces[0]);
+  ASSERT_FALSE(resource.is_enough_memory_for(piece_size));
+  ASSERT_FALSE(resource.is_enough_memory_for(64));
+
+  resource.deallocate(pieces[3], piece_size);
+  resource.deallocate(mem64, 64);
+  resource.release_reserved_memory();
+
+  // the reserved pieces are merged and given back
+  resource.perform_defragmentation();
+  auto mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.real_memory_used, 2 * piece_size);
+  ASSERT_EQ(mem_stats.memory_used, 2 * piece_size);
+  ASSERT_EQ(mem_stats.huge_memory_pieces, 0);
+  ASSERT_EQ(mem_stats.small_memory_pieces, 0);
+  ASSERT_TRUE(resource.is_enough_memory_for(some_memory.size() - 2 * piece_size));
+
+  resource.deallocate(relocated, piece_size);
+  resource.deallocate(pieces[1], piece_size);
+}
+
+TEST(unsynchronized_pool_resource_test, bump_mode) {
+  std::array<char, static_cast<size_t>(1024 * 128)> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(some_memory.data(), some_memory.size());
+  resource.enable_bump_mode(1024);
+  ASSERT_TRUE(resource.is_bump_mode_enabled());
+
+  void *mem1 = resource.allocate(64);
+  void *mem2 = resource.allocate(64);
+  void *mem3 = resource.allocate(64);
+  ASSERT_EQ(static_cast<char *>(mem2), static_cast<char *>(mem1) + 64);
+  ASSERT_EQ(static_cast<char *>(mem3), static_cast<char *>(mem2) + 64);
+
+  // the freed pieces are not reused, but the last one is given back
+  resource.deallocate(mem2, 64);
+  resource.deallocate(mem3, 64);
+  ASSERT_EQ(resource.allocate(64), mem3);
+  resource.deallocate(mem3, 64);
+
+  auto mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.bump_allocations, 4);
+  ASSERT_EQ(mem_stats.bump_mode_fallbacks, 0);
+  ASSERT_EQ(mem_stats.memory_used, 64);
+  ASSERT_EQ(mem_stats.real_memory_used, 128);
+
+  // the limit is exceeded, the pooled allocation takes over
+  void *big_mem = resource.allocate(1024);
+  ASSERT_FALSE(resource.is_bump_mode_enabled());
+  ASSERT_EQ(big_mem, mem3);
+  mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.bump_allocations, 4);
+  ASSERT_EQ(mem_stats.bump_mode_fallbacks, 1);
+
+  resource.deallocate(big_mem, 1024);
+  ASSERT_EQ(resource.allocate(1024), big_mem);
+  resource.deallocate(big_mem, 1024);
+  resource.deallocate(mem1, 64);
+
+  resource.init(some_memory.data(), some_memory.size());
+  ASSERT_FALSE(resource.is_bump_mode_enabled());
+  ASSERT_EQ(resource.get_memory_stats().bump_mode_fallbacks, 0);
+}
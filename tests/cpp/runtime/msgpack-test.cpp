@@ -139,34 +139,36 @@ struct Stub : public refcountable_php_classes<Stub> {
     packer.pack(5);
     vk::msgpack::packer_float32_decorator::pack_value(packer, a);
   }
-  void msgpack_unpack(const vk::msgpack::object &msgpack_o) {
+  void msgpack_unpack(vk::msgpack::unpacker &unpacker) {
+    auto msgpack_o = unpacker.next();
     if (msgpack_o.type != vk::msgpack::stored_type::ARRAY) {
+      unpacker.skip_nested(msgpack_o);
       return;
     }
-    auto arr = msgpack_o.via.array;
-    for (size_t counter = 0; counter < arr.size; counter += 2) {
-      auto tag = arr.ptr[counter].as<uint8_t>();
-      auto elem = arr.ptr[counter + 1];
+    for (size_t counter = 0; counter + 1 < msgpack_o.via.array.size; counter += 2) {
+      auto tag = unpacker.unpack<uint8_t>();
       switch (tag) {
         case 1:
-          elem.convert(d);
+          unpacker.unpack(d);
           break;
         case 2:
-          elem.convert(i);
+          unpacker.unpack(i);
           break;
         case 3:
-          elem.convert(s);
+          unpacker.unpack(s);
           break;
         case 4:
-          elem.convert(m);
+          unpacker.unpack(m);
           break;
         case 5:
-          elem.convert(a);
+          unpacker.unpack(a);
           break;
         default:
+          unpacker.skip();
           break;
       }
     }
+    unpacker.skip(msgpack_o.via.array.size % 2);
   }
 };
 
@@ -199,3 +201,47 @@ TEST(msgpack, array_extended) {
                                                  Stub(42_i64, -0.0, 42_i64, {}, array<mixed>::create(string("0"), string(""), 42, -0.0)),
                                                  Stub({}, -0.0, 42_i64, string("string"), array<mixed>::create(string("0"), string(""), 42, -0.0))));
 }
+
+TEST(msgpack, unknown_fields_are_skipped) {
+  // tag 7 is unknown: its value (a nested map) must be skipped entirely
+  string_buffer buffer;
+  vk::msgpack::packer packer{buffer};
+  packer.pack_array(6);
+  packer.pack(7);
+  packer.pack_map(1);
+  packer.pack(string("key"));
+  packer.pack(array<mixed>::create(1, array<mixed>::create(2, 3), string("4")));
+  packer.pack(2);
+  packer.pack(42);
+  packer.pack(3);
+  packer.pack(string("after"));
+
+  string err_msg;
+  const auto stub = f$msgpack_deserialize<Stub>(buffer.str(), &err_msg);
+  ASSERT_TRUE(err_msg.empty()) << err_msg.c_str();
+  ASSERT_EQ(stub.i, 42);
+  ASSERT_EQ(stub.s, string("after"));
+}
+
+TEST(msgpack, errors) {
+  const auto error_of = [](const string &buffer) {
+    string err_msg;
+    f$msgpack_deserialize<array<mixed>>(buffer, &err_msg);
+    return std::string{err_msg.c_str()};
+  };
+  const string vector = f$msgpack_serialize(array<mixed>::create(1, string("two"), array<mixed>::create(3))).val();
+
+  ASSERT_EQ(error_of(vector), "");
+  ASSERT_EQ(error_of(vector.substr(0, vector.size() - 1)), "insufficient bytes");
+  ASSERT_EQ(error_of(string(vector).append(1, '\x01')),
+            "Consumed only first " + std::to_string(vector.size()) + " characters of " + std::to_string(vector.size() + 1) + " during deserialization");
+  ASSERT_EQ(error_of(string("\x92\x01\xc1", 3)), "parse error");
+  ASSERT_EQ(error_of(f$msgpack_serialize(string("not an array")).val()), "couldn't recognize type of unpacking array");
+
+  // a parse error is reported even if a scheme error comes before it
+  string err_msg;
+  f$msgpack_deserialize<array<int64_t>>(string("\x92\xa1x\xc1", 4), &err_msg);
+  ASSERT_EQ(std::string{err_msg.c_str()}, "parse error");
+  f$msgpack_deserialize<array<int64_t>>(string("\x92\xa1x\x01", 4), &err_msg);
+  ASSERT_EQ(std::string{err_msg.c_str()}, "Unknown type found during deserialization");
+}
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include "runtime/php-script-globals.h"
+
+TEST(php_script_globals_test, test_restore_only_dirty_batches) {
+  PhpScriptMutableGlobals php_globals;
+  php_globals.once_alloc_linear_mem(2048);
+  php_globals.once_alloc_batches({0, 1024, 2048});
+
+  auto &g0 = *reinterpret_cast<int64_t *>(php_globals.mem() + 8);
+  auto &g1 = *reinterpret_cast<int64_t *>(php_globals.mem() + 1024 + 8);
+  g0 = 10;
+  g1 = 20;
+  php_globals.save_pristine_snapshot();
+  ASSERT_TRUE(php_globals.has_pristine_snapshot());
+
+  g0 = 11;
+  g1 = 21;
+  php_globals.mark_batch_dirty(0);
+  php_globals.restore_dirty_batches_from_snapshot();
+  ASSERT_EQ(g0, 10);
+  ASSERT_EQ(g1, 21);
+  ASSERT_EQ(php_globals.get_and_clear_batches_reset_count(), 1);
+
+  php_globals.mark_batch_dirty(1);
+  php_globals.restore_dirty_batches_from_snapshot();
+  ASSERT_EQ(g1, 20);
+
+  php_globals.restore_dirty_batches_from_snapshot();
+  ASSERT_EQ(php_globals.get_and_clear_batches_reset_count(), 1);
+}
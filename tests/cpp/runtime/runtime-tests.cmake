@@ -8,10 +8,14 @@ prepend(RUNTIME_TESTS_SOURCES ${BASE_DIR}/tests/cpp/runtime/
         confdata-key-maker-test.cpp
         confdata-predefined-wildcards-test.cpp
         flex-test.cpp
+        instance-cache-spill-store-test.cpp
         inter-process-mutex-test.cpp
         inter-process-resource-test.cpp
+        json-functions-test.cpp
         json-writer-test.cpp
+        kphp-backtrace-test.cpp
         number-string-comparison.cpp
+        php-script-globals-test.cpp
         kphp-type-traits-test.cpp
         msgpack-test.cpp
         memory_resource/details/memory_chunk_list-test.cpp
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <random>
 
 #include "runtime-common/core/runtime-core.h"
 #include "runtime-common/stdlib/string/string-functions.h"
@@ -159,3 +160,79 @@ TEST(string_test, test_hex_to_int) {
   ASSERT_EQ(hex_to_int('E'), 14);
   ASSERT_EQ(hex_to_int('F'), 15);
 }
+
+// the implementation of strtr() before kphp::strings::strtr_matcher: the leftmost key wins, the longest one among keys at the same position
+static string strtr_reference(const string &subject, const array<string> &replace_pairs) {
+  const char *piece = subject.c_str();
+  const char *piece_end = subject.c_str() + subject.size();
+  string result;
+  while (true) {
+    const char *best_pos = nullptr;
+    int64_t best_len = -1;
+    string replace;
+    for (auto p = replace_pairs.begin(); p != replace_pairs.end(); ++p) {
+      const string search = f$strval(p.get_key());
+      if (search.empty()) {
+        return subject;
+      }
+      const char *pos = static_cast<const char *>(memmem(piece, piece_end - piece, search.c_str(), search.size()));
+      if (pos != nullptr && (best_pos == nullptr || best_pos > pos || (best_pos == pos && static_cast<int64_t>(search.size()) > best_len))) {
+        best_pos = pos;
+        best_len = search.size();
+        replace = p.get_value();
+      }
+    }
+    if (best_pos == nullptr) {
+      result.append(piece, piece_end - piece);
+      return result;
+    }
+    result.append(piece, best_pos - piece);
+    result.append(replace);
+    piece = best_pos + best_len;
+  }
+}
+
+TEST(string_test, test_strtr_array) {
+  array<string> html_pairs;
+  html_pairs.set_value(string{"&"}, string{"&amp;"});
+  html_pairs.set_value(string{"<"}, string{"&lt;"});
+  html_pairs.set_value(string{"<<"}, string{"&laquo;"});
+  html_pairs.set_value(string{">"}, string{"&gt;"});
+  ASSERT_EQ(f$strtr(string{"a <<b>> & <c>"}, html_pairs), string{"a &laquo;b&gt;&gt; &amp; &lt;c&gt;"});
+  ASSERT_EQ(f$strtr(string{"nothing to replace"}, html_pairs), string{"nothing to replace"});
+  ASSERT_EQ(f$strtr(string{""}, html_pairs), string{""});
+  ASSERT_EQ(f$strtr(string{"a<b"}, array<string>{}), string{"a<b"});
+
+  array<string> int_keys;
+  int_keys.set_value(1, string{"one"});
+  int_keys.set_value(12, string{"twelve"});
+  ASSERT_EQ(f$strtr(string{"1 12 123"}, int_keys), string{"one twelve twelve3"});
+
+  html_pairs.set_value(string{""}, string{"empty"});
+  ASSERT_EQ(f$strtr(string{"a <b>"}, html_pairs), string{"a <b>"});
+}
+
+TEST(string_test, test_strtr_array_matches_reference) {
+  std::mt19937 gen{42};
+  const auto random_string = [&gen](int max_len, char max_char) {
+    string res;
+    const int len = std::uniform_int_distribution<int>{0, max_len}(gen);
+    for (int i = 0; i < len; ++i) {
+      res.push_back(static_cast<char>(std::uniform_int_distribution<int>{'a', max_char}(gen)));
+    }
+    return res;
+  };
+
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    array<string> replace_pairs;
+    const int pairs_count = std::uniform_int_distribution<int>{0, 50}(gen);
+    for (int i = 0; i < pairs_count; ++i) {
+      string key = random_string(5, 'e');
+      if (!key.empty() || iteration % 100 == 0) {
+        replace_pairs.set_value(key, random_string(4, 'z'));
+      }
+    }
+    const string subject = random_string(300, 'f');
+    ASSERT_EQ(f$strtr(subject, replace_pairs), strtr_reference(subject, replace_pairs)) << "subject=" << subject.c_str();
+  }
+}
@@ -4,6 +4,7 @@ prepend(SERVER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/server/
         server-config-test.cpp
         confdata-binlog-events-test.cpp
         php-engine-test.cpp
+        statshouse-aggregator-test.cpp
         workers-control-test.cpp)
 
 # Suppress YAML-cpp-related warnings
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <string>
+
+#include "server/statshouse/statshouse-aggregator.h"
+
+namespace {
+
+StatsHouseAggregator::MetricKey make_key(std::string_view name, std::initializer_list<std::string_view> tags, bool force_tag_host = false) {
+  StatsHouseAggregator::MetricKey key;
+  key.name = name;
+  key.force_tag_host = force_tag_host;
+  for (auto tag : tags) {
+    key.tags[key.tags_count++] = tag;
+  }
+  return key;
+}
+
+const StatsHouseAggregator::AggregatedMetric *find_metric(const std::vector<StatsHouseAggregator::AggregatedMetric> &metrics, std::string_view name) {
+  auto it = std::find_if(metrics.begin(), metrics.end(), [name](const auto &metric) { return metric.name == name; });
+  return it != metrics.end() ? &*it : nullptr;
+}
+
+} // namespace
+
+TEST(statshouse_aggregator_test, test_not_attached) {
+  StatsHouseAggregator aggregator;
+  ASSERT_FALSE(aggregator.add_count(make_key("counter", {}), 1));
+  ASSERT_TRUE(aggregator.collect().empty());
+
+  aggregator.init(1);
+  ASSERT_TRUE(aggregator.is_initialized());
+  ASSERT_FALSE(aggregator.add_count(make_key("counter", {}), 1));
+}
+
+TEST(statshouse_aggregator_test, test_merge_workers) {
+  StatsHouseAggregator aggregator;
+  aggregator.init(2);
+
+  aggregator.attach_worker(0, 0);
+  ASSERT_TRUE(aggregator.add_count(make_key("errors", {"timeout", ""}, true), 1));
+  ASSERT_TRUE(aggregator.add_value(make_key("time", {"script"}), 10));
+  ASSERT_TRUE(aggregator.add_value(make_key("time", {"net"}), 100));
+
+  aggregator.attach_worker(1, 1);
+  ASSERT_TRUE(aggregator.add_count(make_key("errors", {"timeout", ""}, true), 2));
+  ASSERT_TRUE(aggregator.add_value(make_key("time", {"script"}), 20));
+
+  const auto metrics = aggregator.collect();
+  ASSERT_EQ(metrics.size(), 3);
+
+  const auto *errors = find_metric(metrics, "errors");
+  ASSERT_NE(errors, nullptr);
+  ASSERT_EQ(errors->kind, StatsHouseAggregator::MetricKind::count);
+  ASSERT_TRUE(errors->force_tag_host);
+  ASSERT_EQ(errors->tags, (std::vector<std::string>{"timeout", ""}));
+  ASSERT_EQ(errors->count, 3);
+
+  for (const auto &metric : metrics) {
+    if (metric.name == "time" && metric.tags == std::vector<std::string>{"script"}) {
+      ASSERT_EQ(metric.kind, StatsHouseAggregator::MetricKind::value);
+      ASSERT_FALSE(metric.force_tag_host);
+      ASSERT_EQ(metric.count, 2);
+      ASSERT_EQ(metric.sum, 30);
+      ASSERT_EQ(metric.min, 10);
+      ASSERT_EQ(metric.max, 20);
+      auto values = metric.values;
+      std::sort(values.begin(), values.end());
+      ASSERT_EQ(values, (std::vector<double>{10, 20}));
+    }
+  }
+
+  ASSERT_TRUE(aggregator.collect().empty());
+}
+
+TEST(statshouse_aggregator_test, test_sampling) {
+  StatsHouseAggregator aggregator;
+  aggregator.init(4);
+
+  for (uint16_t worker = 0; worker != 4; ++worker) {
+    aggregator.attach_worker(worker, worker);
+    for (size_t i = 0; i != 1000; ++i) {
+      ASSERT_TRUE(aggregator.add_value(make_key("memory", {"used"}), worker * 1000 + i));
+    }
+  }
+
+  const auto metrics = aggregator.collect();
+  ASSERT_EQ(metrics.size(), 1);
+  ASSERT_EQ(metrics[0].count, 4000);
+  ASSERT_EQ(metrics[0].sum, 4000 * 3999 / 2);
+  ASSERT_EQ(metrics[0].min, 0);
+  ASSERT_EQ(metrics[0].max, 3999);
+  const auto &values = metrics[0].values;
+  ASSERT_EQ(values.size(), StatsHouseAggregator::MASTER_SAMPLES);
+  for (double value : values) {
+    ASSERT_GE(value, 0);
+    ASSERT_LT(value, 4000);
+  }
+  // the extremes and the sum are not lost by sampling
+  ASSERT_EQ(*std::min_element(values.begin(), values.end()), 0);
+  ASSERT_EQ(*std::max_element(values.begin(), values.end()), 3999);
+  const double values_sum = std::accumulate(values.begin(), values.end(), 0.0);
+  ASSERT_NEAR(values_sum / values.size() * metrics[0].count, metrics[0].sum, 1e-3);
+}
+
+TEST(statshouse_aggregator_test, test_overflow) {
+  StatsHouseAggregator aggregator;
+  aggregator.init(1);
+  aggregator.attach_worker(0, 0);
+
+  ASSERT_FALSE(aggregator.add_count(make_key(std::string(StatsHouseAggregator::MAX_KEY_LENGTH, 'x'), {}), 1));
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i != StatsHouseAggregator::DEFAULT_ENTRIES_PER_TABLE; ++i) {
+    names.emplace_back("metric_" + std::to_string(i));
+  }
+  size_t added = 0;
+  for (const auto &name : names) {
+    added += aggregator.add_count(make_key(name, {}), 1);
+  }
+  ASSERT_GT(added, 0);
+  ASSERT_LT(added, names.size());
+  // the known keys are still aggregated when there is no space for the new ones
+  ASSERT_TRUE(aggregator.add_count(make_key(names[0], {}), 1));
+
+  const auto metrics = aggregator.collect();
+  ASSERT_EQ(metrics.size(), added);
+}
+
+TEST(statshouse_aggregator_test, test_large_table) {
+  constexpr size_t entries_per_table = 1024;
+  StatsHouseAggregator aggregator;
+  aggregator.init(2, entries_per_table);
+
+  std::vector<std::string> tags;
+  for (size_t i = 0; i != entries_per_table / 2; ++i) {
+    tags.emplace_back("builtin_" + std::to_string(i));
+  }
+  for (uint16_t worker = 0; worker != 2; ++worker) {
+    aggregator.attach_worker(worker, worker);
+    for (const auto &tag : tags) {
+      ASSERT_TRUE(aggregator.add_value(make_key("builtin_stats", {tag}), worker + 1));
+    }
+  }
+
+  const auto metrics = aggregator.collect();
+  ASSERT_EQ(metrics.size(), tags.size());
+  for (const auto &metric : metrics) {
+    ASSERT_EQ(metric.count, 2);
+    ASSERT_EQ(metric.sum, 3);
+  }
+}
@@ -0,0 +1,92 @@
+@ok non-idempotent
+<?php
+
+require_once 'kphp_tester_include.php';
+
+/** @kphp-immutable-class */
+class Point {
+  /** @var int */
+  public $x = 0;
+  /** @var ?string */
+  public $name = null;
+
+  public function __construct(int $x, ?string $name = null) {
+    $this->x = $x;
+    $this->name = $name;
+  }
+}
+
+/** @kphp-immutable-class */
+class Shape {
+  /** @var Point */
+  public $center;
+  /** @var Point[] */
+  public $points = [];
+  /** @var Point[] */
+  public $same_points = [];
+  /** @var ?Shape */
+  public $inner = null;
+
+  /**
+   * @param Point $center
+   * @param Point[] $points
+   */
+  public function __construct(Point $center, array $points) {
+    $this->center = $center;
+    $this->points = $points;
+    $this->same_points = $points;
+  }
+}
+
+function test_flat_instance() {
+  var_dump(instance_cache_store("point", new Point(1, "one")));
+  $point = instance_cache_fetch(Point::class, "point");
+  var_dump($point->x, $point->name);
+}
+
+function test_unique_instances() {
+  $points = [];
+  for ($i = 0; $i < 100; ++$i) {
+    $points[] = new Point($i, "p$i");
+  }
+  var_dump(instance_cache_store("unique", new Shape(new Point(-1), $points)));
+  $shape = instance_cache_fetch(Shape::class, "unique");
+  $sum = 0;
+  foreach ($shape->points as $i => $point) {
+    $sum += $point->x;
+    if ($point->name !== "p$i") {
+      var_dump($point->name);
+    }
+  }
+  var_dump($sum, $shape->center->x);
+}
+
+function test_shared_instances() {
+  $center = new Point(0, "center");
+  $other = new Point(1);
+  $shape = new Shape($center, [$center, $other, $other]);
+  $shape->inner = new Shape($other, [new Point(2)]);
+  var_dump(instance_cache_store("shared", $shape));
+  $shape = null;
+
+  $shape = instance_cache_fetch(Shape::class, "shared");
+  var_dump($shape->center === $shape->points[0]);
+  var_dump($shape->points[1] === $shape->points[2]);
+  var_dump($shape->points[1] === $shape->same_points[1]);
+  var_dump($shape->inner->center === $shape->points[1]);
+  var_dump($shape->points[0] === $shape->points[1]);
+  var_dump($shape->inner->points[0]->x);
+}
+
+function test_instance_referenced_from_script() {
+  $point = new Point(5);
+  $shape = new Shape(new Point(6), [$point]);
+  var_dump(instance_cache_store("referenced", $shape));
+  $cached = instance_cache_fetch(Shape::class, "referenced");
+  var_dump($cached->points[0]->x, $cached->points[0] === $cached->same_points[0]);
+}
+
+test_flat_instance();
+test_unique_instances();
+test_shared_instances();
+test_instance_referenced_from_script();
@@ -0,0 +1,47 @@
+@ok k2_skip
+<?php
+
+/** @kphp-immutable-class
+ *  @kphp-serializable */
+class Table {
+  /** @var int[]
+   * @kphp-serialized-field 0 */
+  public $values;
+  /** @var string
+   * @kphp-serialized-field 1 */
+  public $name;
+
+  /** @param int[] $values */
+  public function __construct(array $values, string $name) {
+    $this->values = $values;
+    $this->name = $name;
+  }
+}
+
+/** @kphp-memoize */
+function build_table(int $n, string $name): Table {
+  $values = [];
+  for ($i = 0; $i < $n; ++$i) {
+    $values[] = square($i);
+  }
+  return new Table($values, $name);
+}
+
+function square(int $x): int {
+  return $x * $x;
+}
+
+$t1 = build_table(5, "squares");
+$t2 = build_table(5, "squares");
+$t3 = build_table(3, "squares");
+$t4 = build_table(5, "squares");
+var_dump($t1->values, $t1->name);
+var_dump($t2->values === $t1->values);
+var_dump($t3->values);
+
+// both results are fetched from instance cache, so it's the same shared instance; it's not the case without memoization
+#ifndef KPHP
+var_dump(true);
+if (false)
+#endif
+var_dump($t2 === $t4);
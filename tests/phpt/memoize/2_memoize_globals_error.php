@@ -0,0 +1,28 @@
+@kphp_should_fail k2_skip
+/@kphp-memoize function build is not pure: it uses global or static variables/
+/read_counter/
+<?php
+
+/** @kphp-immutable-class
+ *  @kphp-serializable */
+class A {
+  /** @var int
+   * @kphp-serialized-field 0 */
+  public $x = 0;
+}
+
+$counter = 0;
+
+function read_counter(): int {
+  global $counter;
+  return $counter;
+}
+
+/** @kphp-memoize */
+function build(int $x): A {
+  $a = new A;
+  $a->x = $x + read_counter();
+  return $a;
+}
+
+build(1);
@@ -0,0 +1,16 @@
+@kphp_should_fail k2_skip
+/Can not store instance of mutable class A with @kphp-memoize function/
+<?php
+
+class A {
+  public $x = 0;
+}
+
+/** @kphp-memoize */
+function build(int $x): A {
+  $a = new A;
+  $a->x = $x;
+  return $a;
+}
+
+build(1);
@@ -0,0 +1,27 @@
+@kphp_should_fail k2_skip
+/@kphp-memoize function build is not pure: it calls time\(\), which may have side effects or depend on something besides its arguments/
+/stamp/
+<?php
+
+/** @kphp-immutable-class
+ *  @kphp-serializable */
+class A {
+  /** @var int
+   * @kphp-serialized-field 0 */
+  public $x = 0;
+
+  public function __construct(int $x) {
+    $this->x = $x;
+  }
+}
+
+function stamp(int $x): int {
+  return $x + time();
+}
+
+/** @kphp-memoize */
+function build(int $x): A {
+  return new A(stamp($x));
+}
+
+build(1);
@@ -0,0 +1,74 @@
+@ok
+KPHP_AUTO_APPLY_PERFORMANCE_INSPECTIONS=1
+<?php
+
+/**
+ * @param int[] $xs
+ */
+function merge_in_loop(array $xs) {
+  $result = [];
+  foreach ($xs as $x) {
+    $result = array_merge($result, [$x, $x * 2]);
+  }
+  var_dump($result);
+}
+
+/**
+ * @param int[] $a
+ * @param int[] $b
+ */
+function merge_map(array $a, array $b) {
+  $a = array_merge($a, $b);
+  var_dump($a);
+}
+
+/**
+ * @param int[] $a
+ */
+function merge_with_itself(array $a) {
+  $a = array_merge($a, $a);
+  var_dump($a);
+  $copy = $a;
+  $a = array_merge($a, [100]);
+  var_dump($copy);
+  var_dump($a);
+}
+
+/**
+ * @param int[] $xs
+ */
+function reserve_in_loop(array $xs) {
+  $doubled = [1000];
+  $squares = [];
+  foreach ($xs as $k => $x) {
+    $doubled[] = $x * 2;
+    $squares[] = $x * $x;
+    $xs[] = $k;
+  }
+  var_dump($doubled);
+  var_dump($squares);
+  var_dump(count($xs));
+}
+
+/**
+ * @param int[] $xs
+ */
+function reserve_in_loop_with_break(array $xs) {
+  $result = [];
+  foreach ($xs as $x) {
+    if ($x > 3) {
+      break;
+    }
+    $result[] = $x;
+  }
+  var_dump($result);
+}
+
+merge_in_loop([1, 2, 3]);
+merge_map([5 => 1, 7 => 2, 'key' => 3], [5 => 4, 'key' => 5]);
+merge_map([], [10 => 1]);
+merge_with_itself([1, 2]);
+reserve_in_loop([1, 2, 3, 4, 5]);
+reserve_in_loop([3 => 1, 'key' => 2]);
+reserve_in_loop([]);
+reserve_in_loop_with_break([1, 2, 3, 4, 5]);
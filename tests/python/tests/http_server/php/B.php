@@ -0,0 +1,7 @@
+<?php
+
+/** @kphp-immutable-class */
+class B {
+  /** @var int */
+  public $a = 42;
+}
@@ -93,6 +93,8 @@ if (isset($_SERVER["JOB_ID"])) {
   echo "after sleep";
 } else if ($_SERVER["PHP_SELF"] === "/store-in-instance-cache") {
   echo instance_cache_store("test_key" . rand(), new A);
+} else if ($_SERVER["PHP_SELF"] === "/store-not-serializable-in-instance-cache") {
+  echo instance_cache_store("test_key" . rand(), new B);
 } else if ($_SERVER["PHP_SELF"] === "/test_zstd") {
   $res = "";
   switch($_GET["type"]) {
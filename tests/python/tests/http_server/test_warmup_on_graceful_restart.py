@@ -22,8 +22,8 @@ class TestWarmUpOnGracefulRestart(WebServerAutoTestCase):
         self.web_server.restart()
         return self.web_server.pid
 
-    def trigger_kphp_to_store_element_in_instance_cache(self):
-        resp = self.web_server.http_get(uri='/store-in-instance-cache')
+    def trigger_kphp_to_store_element_in_instance_cache(self, uri='/store-in-instance-cache'):
+        resp = self.web_server.http_get(uri=uri)
         self.assertEqual(resp.status_code, 200)
         self.assertEqual(resp.text, "1")
 
@@ -31,19 +31,20 @@ class TestWarmUpOnGracefulRestart(WebServerAutoTestCase):
         timeout_sec = 1
         old_pid = self.prepare_for_test(workers_part=0.01, instance_cache_part=1, timeout_sec=timeout_sec)
 
-        self.trigger_kphp_to_store_element_in_instance_cache()
+        self.trigger_kphp_to_store_element_in_instance_cache('/store-not-serializable-in-instance-cache')
         time.sleep(1)  # to be sure master saved stat in shared memory
         self.web_server.start()
         time.sleep(timeout_sec * 4)
 
-        # Can exit only on timeout because instance cache is always cold (new master stores to instance cache nothing)
+        # Can exit only on timeout because instance cache is always cold
+        # (new master stores to instance cache nothing, and not serializable instances are not handed over)
         self.assertEqual(os.waitpid(old_pid, os.WNOHANG)[0], old_pid)
         self.web_server.assert_log(["[warmup_timeout_expired = 1]"], "Warm up timeout was not expired on restart")
 
     def test_warmup_instance_cache_becomes_hot(self):
         old_pid = self.prepare_for_test(workers_part=0.01, instance_cache_part=0.001, timeout_sec=30)
 
-        self.trigger_kphp_to_store_element_in_instance_cache()
+        self.trigger_kphp_to_store_element_in_instance_cache('/store-not-serializable-in-instance-cache')
         time.sleep(1)  # to be sure master saved stat in shared memory
         self.web_server.start()
 
@@ -59,3 +60,17 @@ class TestWarmUpOnGracefulRestart(WebServerAutoTestCase):
         # here it must be hot enough
         self.assertEqual(os.waitpid(old_pid, os.WNOHANG)[0], old_pid)
         self.web_server.assert_log(["[is_instance_cache_hot_enough = 1]"], "Instance cache was not warmed up")
+
+    def test_warmup_instance_cache_handed_over(self):
+        old_pid = self.prepare_for_test(workers_part=0.01, instance_cache_part=1, timeout_sec=30)
+
+        for _ in range(10):
+            self.trigger_kphp_to_store_element_in_instance_cache()
+        time.sleep(1)  # to be sure master saved stat in shared memory
+        self.web_server.start()
+
+        time.sleep(5)
+        # serializable instances are handed over by the old master, so the new one doesn't wait for the timeout
+        self.assertEqual(os.waitpid(old_pid, os.WNOHANG)[0], old_pid)
+        self.web_server.assert_log(["instance cache elements are loaded from old master",
+                                    "[is_instance_cache_hot_enough = 1]"], "Instance cache was not handed over")
@@ -14,6 +14,14 @@ function main() {
       test_delete();
       return;
     }
+    case "/store_sized": {
+      test_store_sized();
+      return;
+    }
+    case "/fetch_sized_and_verify": {
+      test_fetch_sized_and_verify();
+      return;
+    }
   }
 
   critical_error("unknown test " . $_SERVER["PHP_SELF"]);
@@ -135,6 +143,22 @@ class TestClassABC {
   public $c = [];
 }
 
+/** @kphp-immutable-class */
+class TestClassSized {
+  /**
+   * @param int $size
+   * @param string $tag
+   */
+  function __construct($size, $tag) {
+    for ($i = 0; $i != $size; ++$i) {
+      $this->values["key $i"] = str_repeat($tag, 256) . " $i";
+    }
+  }
+
+  /** @var string[] */
+  public $values = [];
+}
+
 function test_store() {
   $data = json_decode(file_get_contents('php://input'));
   echo json_encode(["result" => instance_cache_store((string)$data["key"], new TestClassABC, 5)]);
@@ -156,4 +180,23 @@ function test_delete() {
   instance_cache_delete((string)$data["key"]);
 }
 
+function test_store_sized() {
+  $data = json_decode(file_get_contents('php://input'));
+  $key = (string)$data["key"];
+  echo json_encode(["result" => instance_cache_store($key, new TestClassSized((int)$data["size"], $key))]);
+}
+
+function test_fetch_sized_and_verify() {
+  $data = json_decode(file_get_contents('php://input'));
+  $key = (string)$data["key"];
+  $size = (int)$data["size"];
+  /** @var TestClassSized $instance */
+  $instance = instance_cache_fetch(TestClassSized::class, $key);
+  $ok = $instance && count($instance->values) === $size;
+  for ($i = 0; $ok && $i != $size; ++$i) {
+    $ok = $instance->values["key $i"] === str_repeat($key, 256) . " $i";
+  }
+  echo json_encode(["result" => $ok]);
+}
+
 main();
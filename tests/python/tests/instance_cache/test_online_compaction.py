@@ -0,0 +1,60 @@
+import time
+
+import pytest
+from python.lib.testcase import WebServerAutoTestCase
+
+
+@pytest.mark.k2_skip_suite
+class TestOnlineCompaction(WebServerAutoTestCase):
+    ELEMENT_SIZE = 16
+
+    @classmethod
+    def extra_class_setup(cls):
+        cls.web_server.update_options({
+            "--instance-cache-memory-limit": "16M",
+            "--instance-cache-online-compaction": True,
+        })
+
+    def _store(self, key):
+        resp = self.web_server.http_post(
+            uri="/store_sized",
+            json={"key": key, "size": self.ELEMENT_SIZE})
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.json(), {"result": True})
+
+    def _fetch_and_verify(self, key):
+        resp = self.web_server.http_post(
+            uri="/fetch_sized_and_verify",
+            json={"key": key, "size": self.ELEMENT_SIZE})
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.json(), {"result": True})
+
+    def test_fragmented_memory_is_compacted(self):
+        elements = 160
+        keys = ["compaction_key{}".format(i) for i in range(elements)]
+        for key in keys:
+            self._store(key)
+
+        # every other element is deleted, so the live elements are spread over the whole used memory
+        for key in keys[::2]:
+            resp = self.web_server.http_post(uri="/delete", json={"key": key})
+            self.assertEqual(resp.status_code, 200)
+        live_keys = keys[1::2]
+
+        stats_before = self.web_server.get_stats(prefix="kphp_server.instance_cache_")
+        stats = stats_before
+        start = time.time()
+        while time.time() - start < 60:
+            stats = self.web_server.get_stats(prefix="kphp_server.instance_cache_")
+            if stats["elements_relocated"] > stats_before["elements_relocated"] and \
+                    stats["memory_real_used"] < stats_before["memory_real_used"]:
+                break
+            time.sleep(1)
+
+        self.assertGreater(stats["elements_relocated"], stats_before["elements_relocated"])
+        self.assertLess(stats["memory_real_used"], stats_before["memory_real_used"])
+        # the fragmentation is eliminated without the buffer swap
+        self.assertEqual(stats["memory_buffer_swaps_ok"], stats_before["memory_buffer_swaps_ok"])
+
+        for key in live_keys:
+            self._fetch_and_verify(key)
@@ -19,6 +19,7 @@ if(KPHP_TESTS)
     include(net/net-tests.cmake)
     include(tests/cpp/compiler/compiler-tests.cmake)
     if (COMPILE_RUNTIME_LIGHT)
+        include(tests/cpp/k2-host/k2-host-tests.cmake)
     else ()
         include(tests/cpp/runtime/runtime-tests.cmake)
         include(tests/cpp/server/server-tests.cmake)